@@ -19,9 +19,23 @@ QT += core widgets gui sql network
 # Input
 HEADERS += mainwindow.h \
            src/core/AIApiClient.h \
+           src/core/AICircuitBreaker.h \
+           src/core/AIModelRouter.h \
+           src/core/AttachmentStore.h \
+           src/core/AvailabilityChecker.h \
+           src/core/BloomFilter.h \
+           src/core/ChatHistoryLoader.h \
            src/core/ChatStorage.h \
+           src/core/ConversationContextBuilder.h \
            src/core/DatabaseManager.h \
+           src/core/ImagePipeline.h \
+           src/core/ResponseFormatter.h \
            src/core/RichMessageTypes.h \
+           src/core/SharedValue.h \
+           src/core/StartupProfiler.h \
+           src/core/StringPool.h \
+           src/core/SymptomMatcher.h \
+           src/core/TriageCache.h \
            src/core/UserRole.h \
            build/HospAI_autogen/include/ui_LoginDialog.h \
            build/HospAI_autogen/include/ui_SettingsDialog.h \
@@ -34,6 +48,12 @@ HEADERS += mainwindow.h \
            src/views/admin/SystemConfigWidget.h \
            src/views/admin/SystemStatsWidget.h \
            src/views/admin/UserManageWidget.h \
+           src/views/common/AttachmentTextBrowser.h \
+           src/views/common/ChatBubbleDelegate.h \
+           src/views/common/ChatTranscriptModel.h \
+           src/views/common/ChatTranscriptView.h \
+           src/views/common/UpdateScheduler.h \
+           src/views/common/HospitalStyle.h \
            src/views/common/BaseWindow.h \
            src/views/common/ExampleUsageWidget.h \
            src/views/common/HospitalNavigationWidget.h \
@@ -57,6 +77,7 @@ HEADERS += mainwindow.h \
            src/views/staff/KnowledgeBaseWidget.h \
            src/views/staff/ManualChatWidget.h \
            src/views/staff/RecordWidget.h \
+           src/views/staff/SessionListModel.h \
            src/views/staff/StaffChatManager.h \
            src/views/staff/StaffMainWidget.h \
            src/views/staff/StaffWindow.h \
@@ -68,8 +89,22 @@ FORMS += mainwindow.ui \
 SOURCES += main.cpp \
            mainwindow.cpp \
            src/core/AIApiClient.cpp \
+           src/core/AICircuitBreaker.cpp \
+           src/core/AIModelRouter.cpp \
+           src/core/AttachmentStore.cpp \
+           src/core/AvailabilityChecker.cpp \
+           src/core/BloomFilter.cpp \
+           src/core/ChatHistoryLoader.cpp \
            src/core/ChatStorage.cpp \
+           src/core/ConversationContextBuilder.cpp \
            src/core/DatabaseManager.cpp \
+           src/core/ImagePipeline.cpp \
+           src/core/ResponseFormatter.cpp \
+           src/core/RichMessageTypes.cpp \
+           src/core/StartupProfiler.cpp \
+           src/core/StringPool.cpp \
+           src/core/SymptomMatcher.cpp \
+           src/core/TriageCache.cpp \
            src/views/admin/AdminMainWidget.cpp \
            src/views/admin/AdminWindow.cpp \
            src/views/admin/AuditLogWidget.cpp \
@@ -79,6 +114,12 @@ SOURCES += main.cpp \
            src/views/admin/SystemConfigWidget.cpp \
            src/views/admin/SystemStatsWidget.cpp \
            src/views/admin/UserManageWidget.cpp \
+           src/views/common/AttachmentTextBrowser.cpp \
+           src/views/common/ChatBubbleDelegate.cpp \
+           src/views/common/ChatTranscriptModel.cpp \
+           src/views/common/ChatTranscriptView.cpp \
+           src/views/common/UpdateScheduler.cpp \
+           src/views/common/HospitalStyle.cpp \
            src/views/common/BaseWindow.cpp \
            src/views/common/ExampleUsageWidget.cpp \
            src/views/common/HospitalNavigationWidget.cpp \
@@ -102,10 +143,12 @@ SOURCES += main.cpp \
            src/views/staff/KnowledgeBaseWidget.cpp \
            src/views/staff/ManualChatWidget.cpp \
            src/views/staff/RecordWidget.cpp \
+           src/views/staff/SessionListModel.cpp \
            src/views/staff/StaffChatManager.cpp \
            src/views/staff/StaffMainWidget.cpp \
            src/views/staff/StaffWindow.cpp \
            src/views/staff/StatsWidget.cpp
+RESOURCES += resources/resources.qrc
 TRANSLATIONS += build/CMakeFiles/HospAI.dir/compiler_depend.ts \
                 build/CMakeFiles/HospAI_autogen.dir/compiler_depend.ts \
                 build/CMakeFiles/HospAI_autogen_timestamp_deps.dir/compiler_depend.ts
@@ -6,6 +6,8 @@
 #include "src/views/common/ExampleUsageWidget.h"
 #include "src/views/common/UIStyleManager.h"
 #include "src/core/DatabaseManager.h"
+#include "src/core/AttachmentStore.h"
+#include "src/core/StartupProfiler.h"
 #include "src/views/common/LoginDialog.h"
 #include <QApplication>
 #include <QStyleFactory>
@@ -17,6 +19,7 @@
 #include <QDebug>
 #include <QTranslator>
 #include <QLibraryInfo>
+#include <QTimer>
 
 // 创建一个启动选择对话框
 class StartupDialog : public QDialog
@@ -87,7 +90,12 @@ private:
 
 int main(int argc, char *argv[])
 {
+    // 启动阶段计时从这里开始；--startup-trace 时记录各阶段并在启动完成后导出
+    StartupProfiler* profiler = StartupProfiler::instance();
+    profiler->configureFromArguments(argc, argv);
+    
     QApplication a(argc, argv);
+    profiler->mark("QApplication");
     
     // 设置应用程序信息
     a.setApplicationName("HospAI");
@@ -96,21 +104,66 @@ int main(int argc, char *argv[])
     a.setOrganizationDomain("hospai.com");
     
     // 跨平台字体设置，会在 UIStyleManager 中进一步优化
-    UIStyleManager::setupFonts();
+    {
+        StartupProfiler::Scope phase("UIStyleManager::setupFonts");
+        UIStyleManager::setupFonts();
+    }
     
     // 应用跨平台优化的全局样式
-    UIStyleManager::applyGlobalStyleSheet(&a);
+    {
+        StartupProfiler::Scope phase("UIStyleManager::applyGlobalStyleSheet");
+        UIStyleManager::applyGlobalStyleSheet(&a);
+    }
     
     // 初始化数据库
     DatabaseManager* dbManager = DatabaseManager::instance();
-    if (!dbManager->initDatabase()) {
-        QMessageBox::critical(nullptr, "数据库错误", 
-                            "无法初始化数据库！\n应用程序将退出。");
+    bool databaseReady = false;
+    {
+        StartupProfiler::Scope phase("DatabaseManager::initDatabase");
+        databaseReady = dbManager->initDatabase();
+    }
+    if (!databaseReady) {
+        // trace 模式可能运行在无界面的 CI 中，不弹出对话框
+        if (!profiler->isEnabled()) {
+            QMessageBox::critical(nullptr, "数据库错误", 
+                                "无法初始化数据库！\n应用程序将退出。");
+        }
+        qDebug() << "数据库初始化失败，应用程序退出";
         return -1;
     }
     
     qDebug() << "数据库初始化成功";
     
+    // 清理未被任何消息引用的附件
+    {
+        StartupProfiler::Scope phase("AttachmentStore::collectGarbage");
+        AttachmentStore::instance()->collectGarbage();
+    }
+    
+    // 启动 trace 模式：不等待登录，依次构造并显示登录框和主窗口后导出结果退出，
+    // 可配合 QT_QPA_PLATFORM=offscreen 和 --startup-budget 在 CI 中检查启动耗时
+    if (profiler->isEnabled()) {
+        LoginDialog loginDialog;
+        {
+            StartupProfiler::Scope phase("LoginDialog::show");
+            loginDialog.show();
+            QCoreApplication::processEvents();
+        }
+        loginDialog.hide();
+        
+        MainWindow w;
+        {
+            StartupProfiler::Scope phase("MainWindow::setDatabaseManager");
+            w.setDatabaseManager(dbManager);
+        }
+        {
+            StartupProfiler::Scope phase("MainWindow::show");
+            w.show();
+            QCoreApplication::processEvents();
+        }
+        return profiler->finish();
+    }
+    
     // 显示登录对话框
     LoginDialog loginDialog;
     
@@ -122,7 +175,7 @@ int main(int argc, char *argv[])
     
     // 获取登录用户信息
     UserInfo currentUser = loginDialog.getLoggedInUser();
-    qDebug() << "用户登录成功:" << currentUser.username << "角色:" << currentUser.role;
+    qDebug() << "用户登录成功:" << currentUser.username << "角色:" << currentUser.roleName();
     
     // 根据用户角色创建相应的主窗口
     MainWindow w;
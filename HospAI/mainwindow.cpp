@@ -3,6 +3,7 @@
 #include "src/views/staff/StaffMainWidget.h"
 #include "src/views/patient/PatientMainWidget.h"
 #include "src/views/common/LoginDialog.h"
+#include "src/core/StartupProfiler.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QMenuBar>
@@ -19,6 +20,7 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_dbManager(nullptr)
 {
+    StartupProfiler::Scope phase("MainWindow");
     setupUI();
     setupMenus();
     setupStatusBar();
@@ -46,9 +48,21 @@ void MainWindow::setupUI()
     setCentralWidget(m_centralStack);
     
     // 预创建各角色的主界面
-    AdminMainWidget* adminWidget = new AdminMainWidget;
-    StaffMainWidget* staffWidget = new StaffMainWidget;
-    PatientMainWidget* patientWidget = new PatientMainWidget;
+    AdminMainWidget* adminWidget = nullptr;
+    StaffMainWidget* staffWidget = nullptr;
+    PatientMainWidget* patientWidget = nullptr;
+    {
+        StartupProfiler::Scope phase("AdminMainWidget");
+        adminWidget = new AdminMainWidget;
+    }
+    {
+        StartupProfiler::Scope phase("StaffMainWidget");
+        staffWidget = new StaffMainWidget;
+    }
+    {
+        StartupProfiler::Scope phase("PatientMainWidget");
+        patientWidget = new PatientMainWidget;
+    }
     
     m_centralStack->addWidget(adminWidget);  // 索引 0
     m_centralStack->addWidget(staffWidget);  // 索引 1
@@ -120,12 +134,12 @@ void MainWindow::setCurrentUser(const UserInfo& user)
     
     // 更新状态栏
     m_userLabel->setText(user.realName.isEmpty() ? user.username : user.realName);
-    m_roleLabel->setText(user.role);
+    m_roleLabel->setText(user.roleName());
     
     // 更新窗口标题
     setWindowTitle(QString("HospAI - 医院智慧客服系统 [%1 - %2]")
                    .arg(user.realName.isEmpty() ? user.username : user.realName)
-                   .arg(user.role));
+                   .arg(user.roleName()));
     
     // 传递用户信息给各个界面组件
     AdminMainWidget* adminWidget = qobject_cast<AdminMainWidget*>(m_centralStack->widget(0));
@@ -179,17 +193,17 @@ void MainWindow::setDatabaseManager(DatabaseManager* dbManager)
 void MainWindow::updateUIForRole()
 {
     // 根据用户角色显示相应界面
-    if (m_currentUser.role == "管理员") {
+    if (m_currentUser.role == UserRole::Admin) {
         m_centralStack->setCurrentIndex(0);
         m_adminAction->setEnabled(true);
         m_staffAction->setEnabled(true);
         m_patientAction->setEnabled(true);
-    } else if (m_currentUser.role == "客服") {
+    } else if (m_currentUser.role == UserRole::Staff) {
         m_centralStack->setCurrentIndex(1);
         m_adminAction->setEnabled(false);
         m_staffAction->setEnabled(true);
         m_patientAction->setEnabled(false);
-    } else if (m_currentUser.role == "患者") {
+    } else if (m_currentUser.role == UserRole::Patient) {
         m_centralStack->setCurrentIndex(2);
         m_adminAction->setEnabled(false);
         m_staffAction->setEnabled(false);
@@ -199,7 +213,7 @@ void MainWindow::updateUIForRole()
 
 void MainWindow::showAdminPanel()
 {
-    if (m_currentUser.role == "管理员") {
+    if (m_currentUser.role == UserRole::Admin) {
         m_centralStack->setCurrentIndex(0);
         statusBar()->showMessage("已切换到管理员界面", 2000);
     } else {
@@ -209,7 +223,7 @@ void MainWindow::showAdminPanel()
 
 void MainWindow::showStaffPanel()
 {
-    if (m_currentUser.role == "管理员" || m_currentUser.role == "客服") {
+    if (m_currentUser.role == UserRole::Admin || m_currentUser.role == UserRole::Staff) {
         m_centralStack->setCurrentIndex(1);
         statusBar()->showMessage("已切换到客服界面", 2000);
     } else {
@@ -239,7 +253,7 @@ void MainWindow::showUserProfile()
      .arg(m_currentUser.realName.isEmpty() ? "未设置" : m_currentUser.realName)
      .arg(m_currentUser.email.isEmpty() ? "未设置" : m_currentUser.email)
      .arg(m_currentUser.phone.isEmpty() ? "未设置" : m_currentUser.phone)
-     .arg(m_currentUser.role)
+     .arg(m_currentUser.roleName())
      .arg(m_currentUser.createdAt.toString("yyyy-MM-dd hh:mm:ss"))
      .arg(m_currentUser.lastLogin.toString("yyyy-MM-dd hh:mm:ss"));
     
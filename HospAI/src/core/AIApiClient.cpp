@@ -1,49 +1,130 @@
 #include "AIApiClient.h"
+#include "TriageCache.h"
+#include "SymptomMatcher.h"
+#include "AICircuitBreaker.h"
+#include "ConversationContextBuilder.h"
 #include <QNetworkRequest>
 #include <QUrlQuery>
 #include <QSslError>
+#include <QSslConfiguration>
+#include <QUrl>
 #include <QDebug>
 #include <QApplication>
+#include <QRandomGenerator>
+#include <algorithm>
+
+static QString requestTypeName(AIApiClient::RequestType type)
+{
+    switch (type) {
+    case AIApiClient::SymptomRequest:
+        return "symptom";
+    case AIApiClient::DepartmentRequest:
+        return "department";
+    default:
+        return "triage";
+    }
+}
+
+AICancellationToken::AICancellationToken()
+    : m_state(new State)
+{
+}
+
+void AICancellationToken::cancel()
+{
+    if (!m_state->cancelled.testAndSetOrdered(0, 1)) {
+        return;
+    }
+    
+    QList<std::function<void()>> handlers;
+    {
+        QMutexLocker locker(&m_state->mutex);
+        handlers = m_state->cancelHandlers.values();
+        m_state->cancelHandlers.clear();
+    }
+    for (const auto& handler : handlers) {
+        handler();
+    }
+}
+
+quint64 AICancellationToken::addCancelHandler(const std::function<void()>& handler)
+{
+    QMutexLocker locker(&m_state->mutex);
+    quint64 handlerId = m_state->nextHandlerId++;
+    m_state->cancelHandlers.insert(handlerId, handler);
+    return handlerId;
+}
+
+void AICancellationToken::removeCancelHandler(quint64 handlerId)
+{
+    QMutexLocker locker(&m_state->mutex);
+    m_state->cancelHandlers.remove(handlerId);
+}
+
+bool AICancellationToken::isCancelled() const
+{
+    return m_state->cancelled.loadAcquire() != 0;
+}
 
 AIApiClient::AIApiClient(QObject *parent)
     : QObject(parent)
     , m_networkManager(new QNetworkAccessManager(this))
-    , m_currentReply(nullptr)
     , m_isConnected(false)
-    , m_timeoutTimer(new QTimer(this))
-    , m_currentRequestType(TriageRequest)
+    , m_nextRequestId(1)
+    , m_maxConcurrent(DEFAULT_MAX_CONCURRENT)
+    , m_shuttingDown(false)
+    , m_keepAliveTimer(new QTimer(this))
+    , m_warmedUp(false)
 {
     // 设置默认配置
     setupDefaultConfig();
     
-    // 配置超时定时器
-    m_timeoutTimer->setSingleShot(true);
-    m_timeoutTimer->setInterval(15000); // 15秒超时
-    
-    connect(m_timeoutTimer, &QTimer::timeout, this, [this]() {
-        if (m_currentReply) {
-            m_currentReply->abort();
-            emit apiError("请求超时，请检查网络连接");
-        }
-    });
-    
-    // SSL错误信号将在请求时连接
+    m_keepAliveTimer->setInterval(KEEPALIVE_INTERVAL_MS);
+    connect(m_keepAliveTimer, &QTimer::timeout, this, &AIApiClient::onKeepAliveTimer);
+    m_lastActivity.start();
 }
 
 AIApiClient::~AIApiClient()
 {
-    if (m_currentReply) {
-        m_currentReply->abort();
-        m_currentReply->deleteLater();
+    // 析构时不再回调调用方
+    m_shuttingDown = true;
+    
+    // 令牌可能比本对象活得久，未完成请求的取消处理函数一并移除
+    QList<Request*> unfinished = m_pending;
+    unfinished += m_cacheHits.values();
+    unfinished += m_localAnswers.values();
+    unfinished += m_failFast.values();
+    unfinished += m_retrying.values();
+    m_pending.clear();
+    m_cacheHits.clear();
+    m_localAnswers.clear();
+    m_failFast.clear();
+    m_retrying.clear();
+    
+    const QList<Request*> active = m_active.values();
+    m_active.clear();
+    for (Request* request : active) {
+        if (request->hedgeReply) {
+            discardReply(request->hedgeReply);
+        }
+        if (request->reply) {
+            discardReply(request->reply);
+        }
+    }
+    unfinished += active;
+    
+    for (Request* request : unfinished) {
+        request->cancelToken.removeCancelHandler(request->cancelHandlerId);
+        delete request;
     }
 }
 
 void AIApiClient::setupDefaultConfig()
 {
-    // 使用硬编码的API配置
-    m_baseUrl = "https://ark.cn-beijing.volces.com/api/v3";
-    m_apiKey = "cb103329-5b77-418e-89f2-fea182318c91";
-    m_model = "doubao-lite-32k-character-250228";
+    // 使用硬编码的API配置；环境变量可以改指向本地模拟服务（tools/ 下的 hospai_mock_llm_server）或其他兼容服务
+    m_baseUrl = qEnvironmentVariable("HOSPAI_AI_BASE_URL", "https://ark.cn-beijing.volces.com/api/v3");
+    m_apiKey = qEnvironmentVariable("HOSPAI_AI_API_KEY", "cb103329-5b77-418e-89f2-fea182318c91");
+    m_model = qEnvironmentVariable("HOSPAI_AI_MODEL", "doubao-lite-32k-character-250228");
     
     qDebug() << "AI API客户端初始化完成";
     qDebug() << "Base URL:" << m_baseUrl;
@@ -57,6 +138,62 @@ void AIApiClient::setApiConfig(const QString& baseUrl, const QString& apiKey, co
     m_model = model;
     
     qDebug() << "API配置已更新 - URL:" << baseUrl << "Model:" << model;
+    
+    // 地址变了，之前预热的连接用不上
+    if (m_warmedUp) {
+        preconnect();
+    }
+}
+
+void AIApiClient::warmUp()
+{
+    m_warmedUp = true;
+    m_lastActivity.restart();
+    preconnect();
+    m_keepAliveTimer->start();
+}
+
+void AIApiClient::setKeepAliveEnabled(bool enabled)
+{
+    if (enabled && m_warmedUp) {
+        m_keepAliveTimer->start();
+    } else {
+        m_keepAliveTimer->stop();
+    }
+}
+
+void AIApiClient::preconnect()
+{
+    QUrl url(m_baseUrl);
+    if (url.host().isEmpty()) {
+        return;
+    }
+    
+    if (url.scheme() == "https") {
+        // 通过ALPN协商HTTP/2，之后的请求在同一条连接上多路复用
+        QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
+        sslConfig.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                           QSslConfiguration::NextProtocolHttp1_1});
+        m_networkManager->connectToHostEncrypted(url.host(), url.port(443), sslConfig);
+    } else {
+        m_networkManager->connectToHost(url.host(), url.port(80));
+    }
+    
+    qDebug() << "预连接AI服务:" << url.host();
+}
+
+void AIApiClient::onKeepAliveTimer()
+{
+    if (m_lastActivity.elapsed() >= KEEPALIVE_MAX_IDLE_MS) {
+        qDebug() << "AI服务长时间无请求，停止连接保活";
+        m_keepAliveTimer->stop();
+        return;
+    }
+    
+    // 有请求在进行时连接本身就是活跃的
+    if (m_active.isEmpty()) {
+        preconnect();
+    }
 }
 
 bool AIApiClient::isConnected() const
@@ -69,94 +206,567 @@ QString AIApiClient::getLastError() const
     return m_lastError;
 }
 
-void AIApiClient::sendTriageRequest(const QString& userInput, const QString& conversationHistory)
+bool AIApiClient::isEmergencyInput(const QString& text)
 {
-    if (m_currentReply) {
-        qDebug() << "请求正在进行中，忽略新请求";
-        return;
+    // 急症词条与本地分诊共用同一份词典
+    return SymptomMatcher::instance()->match(text).emergency;
+}
+
+quint64 AIApiClient::sendTriageRequest(const QString& userInput, const QString& conversationHistory,
+                                       QObject* context, const ResponseCallback& callback,
+                                       const RequestOptions& options)
+{
+    // 按输入长度、词典匹配程度和急症描述选择档位
+    AIModelRouter::Decision route = AIModelRouter::instance()->route(userInput, conversationHistory, options.tier,
+                                                                     options.allowLocal);
+    
+    RequestOptions triageOptions = options;
+    if (triageOptions.priority != EmergencyPriority && route.emergency) {
+        triageOptions.priority = EmergencyPriority;
+        qDebug() << "检测到急症描述，分诊请求提升为紧急优先级";
+    }
+    
+    // 本地规则档不需要提示词和缓存
+    QJsonObject requestBody;
+    QString cacheKey;
+    if (route.tier != AIModelRouter::LocalTier) {
+        QString systemPrompt = createTriagePrompt(userInput, conversationHistory);
+        requestBody = createRequestBody(systemPrompt, userInput, route.tier);
+        cacheKey = cacheKeyFor("triage", userInput, conversationHistory, modelFor(route.tier), triageOptions);
+    }
+    
+    return enqueue(TriageRequest, route, requestBody, "智能分诊请求: " + userInput, cacheKey, context, callback, triageOptions);
+}
+
+quint64 AIApiClient::sendSymptomAnalysis(const QString& symptoms, int age, const QString& gender,
+                                         QObject* context, const ResponseCallback& callback,
+                                         const RequestOptions& options)
+{
+    AIModelRouter::Decision route = AIModelRouter::instance()->route(symptoms, QString(), options.tier, false);
+    QString systemPrompt = createSymptomPrompt(symptoms, age, gender);
+    QJsonObject requestBody = createRequestBody(systemPrompt, symptoms, route.tier);
+    QString cacheKey = cacheKeyFor("symptom", symptoms, QString("%1|%2").arg(age).arg(gender), modelFor(route.tier), options);
+    
+    return enqueue(SymptomRequest, route, requestBody, "症状分析请求: " + symptoms, cacheKey, context, callback, options);
+}
+
+quint64 AIApiClient::sendDepartmentRecommendation(const QString& symptoms, const QString& analysis,
+                                                  QObject* context, const ResponseCallback& callback,
+                                                  const RequestOptions& options)
+{
+    AIModelRouter::Decision route = AIModelRouter::instance()->route(symptoms, analysis, options.tier, false);
+    QString systemPrompt = createDepartmentPrompt(symptoms, analysis);
+    QJsonObject requestBody = createRequestBody(systemPrompt, symptoms, route.tier);
+    QString cacheKey = cacheKeyFor("department", symptoms, analysis, modelFor(route.tier), options);
+    
+    return enqueue(DepartmentRequest, route, requestBody, "科室推荐请求: " + symptoms, cacheKey, context, callback, options);
+}
+
+QString AIApiClient::cacheKeyFor(const QString& requestType, const QString& prompt, const QString& history,
+                                 const QString& model, const RequestOptions& options) const
+{
+    if (!options.useCache) {
+        return QString();
+    }
+    
+    // 急症描述必须拿到针对本次输入的实时回复
+    if (isEmergencyInput(prompt)) {
+        TriageCache::instance()->recordBypass();
+        return QString();
     }
     
-    m_currentRequestType = TriageRequest;
-    emit requestStarted();
+    return TriageCache::makeKey(requestType, model, prompt, history);
+}
+
+QString AIApiClient::modelFor(AIModelRouter::Tier tier) const
+{
+    // 档位未单独配置模型时使用当前API配置的模型
+    QString model = AIModelRouter::instance()->config(tier).model;
+    return model.isEmpty() ? m_model : model;
+}
+
+quint64 AIApiClient::enqueue(RequestType type, const AIModelRouter::Decision& route, const QJsonObject& body,
+                             const QString& description, const QString& cacheKey, QObject* context,
+                             const ResponseCallback& callback, const RequestOptions& options)
+{
+    // 调用方没有指定超时时用档位的超时
+    int tierTimeoutMs = AIModelRouter::instance()->config(route.tier).timeoutMs;
     
-    QString systemPrompt = createTriagePrompt(userInput, conversationHistory);
-    QJsonObject requestBody = createRequestBody(systemPrompt, userInput);
+    Request* request = new Request;
+    request->id = m_nextRequestId++;
+    request->type = type;
+    request->priority = options.priority;
+    request->timeoutMs = options.timeoutMs > 0 ? options.timeoutMs
+                       : tierTimeoutMs > 0 ? tierTimeoutMs : DEFAULT_TIMEOUT_MS;
+    request->route = route;
+    request->model = body["model"].toString();
+    const QJsonArray messages = body["messages"].toArray();
+    for (const QJsonValue& message : messages) {
+        request->promptTokens += ConversationContextBuilder::estimateTokens(message.toObject()["content"].toString());
+    }
+    request->body = body;
+    request->description = description;
+    request->hasContext = context != nullptr;
+    request->context = context;
+    request->callback = callback;
+    request->cancelToken = options.cancelToken;
+    request->maxRetries = qMax(0, options.maxRetries);
+    request->hedge = options.hedge;
+    request->stream = options.stream;
+    request->cacheKey = cacheKey;
+    if (request->stream) {
+        request->body["stream"] = true;
+    }
+    request->queuedTimer.start();
+    
+    // 令牌被取消时回到本对象所在线程取消请求
+    QPointer<AIApiClient> self(this);
+    quint64 requestId = request->id;
+    request->cancelHandlerId = request->cancelToken.addCancelHandler([self, requestId]() {
+        if (self) {
+            QMetaObject::invokeMethod(self, [self, requestId]() {
+                if (self) {
+                    self->cancelRequest(requestId);
+                }
+            });
+        }
+    });
     
-    QNetworkRequest request = createApiRequest();
+    // 本地规则档不发网络请求，与缓存命中一样在下一轮事件循环回调
+    if (request->route.tier == AIModelRouter::LocalTier) {
+        m_localAnswers.insert(requestId, request);
+        QMetaObject::invokeMethod(this, [this, requestId]() {
+            deliverLocalAnswer(requestId);
+        }, Qt::QueuedConnection);
+        qDebug() << "请求由本地规则回答 #" << requestId << description;
+        return requestId;
+    }
     
-    QJsonDocument doc(requestBody);
-    m_currentReply = m_networkManager->post(request, doc.toJson());
+    // 命中缓存时不占用网络名额，下一轮事件循环回调，与网络回复的时序一致
+    if (!request->cacheKey.isEmpty() && TriageCache::instance()->lookup(request->cacheKey, &request->cachedResponse)) {
+        m_cacheHits.insert(requestId, request);
+        QMetaObject::invokeMethod(this, [this, requestId]() {
+            deliverCachedResponse(requestId);
+        }, Qt::QueuedConnection);
+        qDebug() << "请求命中缓存 #" << requestId << description;
+        return requestId;
+    }
     
-    connect(m_currentReply, &QNetworkReply::finished, 
-            this, &AIApiClient::handleTriageResponse);
-    connect(m_currentReply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &AIApiClient::handleNetworkError);
-    connect(m_currentReply, &QNetworkReply::sslErrors,
-            this, &AIApiClient::handleSslErrors);
+    // 插到同优先级的最后，保持先到先发
+    int position = 0;
+    while (position < m_pending.size() && m_pending[position]->priority <= request->priority) {
+        ++position;
+    }
+    m_pending.insert(position, request);
     
-    m_timeoutTimer->start();
+    qDebug() << "请求入队 #" << requestId << "优先级:" << request->priority
+             << "排队:" << m_pending.size() << "进行中:" << m_active.size();
     
-    qDebug() << "发送智能分诊请求:" << userInput;
+    dispatchPending();
+    return requestId;
 }
 
-void AIApiClient::sendSymptomAnalysis(const QString& symptoms, int age, const QString& gender)
+bool AIApiClient::canStart(RequestPriority priority) const
 {
-    if (m_currentReply) {
-        qDebug() << "请求正在进行中，忽略新请求";
+    // 上限大于1时，非紧急请求最多占用 上限-1 个名额，保证急症分诊随时能发出
+    int limit = m_maxConcurrent;
+    if (priority != EmergencyPriority && m_maxConcurrent > 1) {
+        limit = m_maxConcurrent - 1;
+    }
+    return m_active.size() < limit;
+}
+
+void AIApiClient::dispatchPending()
+{
+    while (!m_pending.isEmpty() && !m_shuttingDown) {
+        Request* request = m_pending.first();
+        
+        if (request->cancelToken.isCancelled()) {
+            m_pending.removeFirst();
+            request->cancelled = true;
+            Response response;
+            finishRequest(request, response);
+            continue;
+        }
+        
+        // 队首是最高优先级，队首发不出去时后面的也不发
+        if (!canStart(request->priority)) {
+            break;
+        }
+        
+        m_pending.removeFirst();
+        
+        // 服务持续出错时不再等待超时，直接失败让调用方走本地分诊
+        if (!AICircuitBreaker::instance()->allowRequest()) {
+            failFast(request);
+            continue;
+        }
+        
+        startRequest(request);
+    }
+}
+
+void AIApiClient::startRequest(Request* request)
+{
+    // 重试时沿用首次发出的时间，耗时按患者实际等待计算
+    if (!request->latencyTimer.isValid()) {
+        request->queuedMs = request->queuedTimer.elapsed();
+        request->latencyTimer.start();
+    }
+    request->attemptStartedMs = request->latencyTimer.elapsed();
+    request->attempts++;
+    
+    // 重试只用预算剩下的时间，首次发出用完整超时
+    qint64 budgetLeftMs = qint64(RETRY_BUDGET_FACTOR) * request->timeoutMs - request->attemptStartedMs;
+    request->attemptTimeoutMs = request->attempts > 1
+        ? int(qBound(qint64(qMin(RETRY_MIN_TIMEOUT_MS, request->timeoutMs)), budgetLeftMs, qint64(request->timeoutMs)))
+        : request->timeoutMs;
+    m_active.insert(request->id, request);
+    
+    m_lastActivity.restart();
+    if (m_warmedUp && !m_keepAliveTimer->isActive()) {
+        m_keepAliveTimer->start();
+    }
+    
+    QNetworkRequest networkRequest = createApiRequest();
+    if (request->stream) {
+        networkRequest.setRawHeader("Accept", "text/event-stream");
+    }
+    QJsonDocument doc(request->body);
+    request->reply = m_networkManager->post(networkRequest, doc.toJson());
+    trackConnectionTiming(request);
+    
+    quint64 requestId = request->id;
+    connectReply(requestId, request->reply, request->stream);
+    
+    // 每个请求独立计时，超时只中止自己；流式请求每收到数据重新计时
+    request->timeoutTimer = new QTimer(this);
+    request->timeoutTimer->setSingleShot(true);
+    connect(request->timeoutTimer, &QTimer::timeout, this, [this, requestId]() {
+        Request* active = m_active.value(requestId);
+        if (active && active->reply) {
+            active->timedOut = true;
+            abortReplies(active);
+        }
+    });
+    request->timeoutTimer->start(request->attemptTimeoutMs);
+    
+    // 每次发出最多对冲一次，服务已经在出错时不再加压
+    if (request->hedge && AICircuitBreaker::instance()->state() == AICircuitBreaker::Closed) {
+        request->hedgeTimer = new QTimer(this);
+        request->hedgeTimer->setSingleShot(true);
+        connect(request->hedgeTimer, &QTimer::timeout, this, [this, requestId]() {
+            sendHedge(requestId);
+        });
+        request->hedgeTimer->start(int(hedgeDelayMs(request->stream)));
+    }
+    
+    emit requestStarted(requestId);
+    qDebug() << "发送" << request->description << "#" << requestId << "第" << request->attempts << "次"
+             << "排队耗时" << request->queuedMs << "ms";
+}
+
+void AIApiClient::connectReply(quint64 requestId, QNetworkReply* reply, bool stream)
+{
+    connect(reply, &QNetworkReply::finished, this, [this, requestId, reply]() {
+        handleReplyFinished(requestId, reply);
+    });
+    if (stream) {
+        connect(reply, &QNetworkReply::readyRead, this, [this, requestId, reply]() {
+            handleStreamData(requestId, reply);
+        });
+    }
+    connect(reply, &QNetworkReply::sslErrors, this, [reply](const QList<QSslError>& errors) {
+        qDebug() << "SSL错误数量:" << errors.size();
+        for (const QSslError& error : errors) {
+            qDebug() << "SSL错误:" << error.errorString();
+        }
+        
+        // 在生产环境中，应该更严格地处理SSL错误
+        // 这里为了测试方便，忽略SSL错误
+        reply->ignoreSslErrors();
+    });
+}
+
+qint64 AIApiClient::hedgeDelayMs(bool stream) const
+{
+    QList<qint64> samples = stream ? m_recentFirstTokens : m_recentLatencies;
+    if (samples.size() < HEDGE_MIN_SAMPLES) {
+        return HEDGE_DEFAULT_DELAY_MS;
+    }
+    
+    std::sort(samples.begin(), samples.end());
+    int index = qMin<int>(samples.size() - 1, (samples.size() * 95 + 99) / 100 - 1);
+    return qMax<qint64>(HEDGE_MIN_DELAY_MS, samples[index]);
+}
+
+void AIApiClient::sendHedge(quint64 requestId)
+{
+    Request* request = m_active.value(requestId);
+    if (!request || !request->hedgeTimer) {
         return;
     }
+    request->hedgeTimer->deleteLater();
+    request->hedgeTimer = nullptr;
     
-    m_currentRequestType = SymptomRequest;
-    emit requestStarted();
+    // 已经有结果或流式已经开始输出时不再对冲
+    bool started = request->stream ? !request->sseBuffer.isEmpty() || request->firstTokenMs >= 0
+                                   : request->reply && request->reply->isFinished();
+    if (!request->reply || request->hedgeReply || request->cancelled || request->timedOut || started) {
+        return;
+    }
     
-    QString systemPrompt = createSymptomPrompt(symptoms, age, gender);
-    QJsonObject requestBody = createRequestBody(systemPrompt, symptoms);
+    QNetworkRequest networkRequest = createApiRequest();
+    if (request->stream) {
+        networkRequest.setRawHeader("Accept", "text/event-stream");
+    }
+    request->hedgeReply = m_networkManager->post(networkRequest, QJsonDocument(request->body).toJson());
+    request->hedged = true;
+    connectReply(requestId, request->hedgeReply, request->stream);
+    AICircuitBreaker::instance()->recordHedgeSent();
+    
+    qDebug() << "请求 #" << requestId << "超过" << request->latencyTimer.elapsed() - request->attemptStartedMs
+             << "ms 未返回，发出对冲请求";
+}
+
+void AIApiClient::promoteReply(Request* request, QNetworkReply* winner)
+{
+    // 先有结果的一路胜出，另一路中止
+    QNetworkReply* loser = winner == request->reply ? request->hedgeReply : request->reply;
+    if (winner == request->hedgeReply) {
+        request->hedgeWon = true;
+        AICircuitBreaker::instance()->recordHedgeWin();
+        qDebug() << "请求 #" << request->id << "对冲请求先返回";
+    }
+    request->reply = winner;
+    request->hedgeReply = nullptr;
+    if (loser) {
+        discardReply(loser);
+    }
+}
+
+void AIApiClient::abortReplies(Request* request)
+{
+    // 对冲的一路直接丢弃，主请求中止后在 finished 中统一收尾
+    if (request->hedgeReply) {
+        discardReply(request->hedgeReply);
+        request->hedgeReply = nullptr;
+    }
+    if (request->reply) {
+        request->reply->abort();
+    }
+}
+
+void AIApiClient::discardReply(QNetworkReply* reply)
+{
+    reply->disconnect(this);
+    reply->abort();
+    reply->deleteLater();
+}
+
+void AIApiClient::deliverCachedResponse(quint64 requestId)
+{
+    Request* request = m_cacheHits.take(requestId);
+    if (!request) {
+        return;
+    }
+    
+    Response response;
+    response.success = true;
+    response.fromCache = true;
+    response.result = resultFromContent(request->cachedResponse);
     
-    QNetworkRequest request = createApiRequest();
+    TriageCache* cache = TriageCache::instance();
+    cache->recordHitLatency(request->queuedTimer.elapsed());
+    TriageCache::Stats stats = cache->stats();
+    qDebug() << "AI回复缓存命中率" << QString::number(stats.hitRatio() * 100, 'f', 1) + "%"
+             << "估计节省" << stats.estimatedSavedMs() << "ms";
     
-    QJsonDocument doc(requestBody);
-    m_currentReply = m_networkManager->post(request, doc.toJson());
+    finishRequest(request, response);
+}
+
+void AIApiClient::deliverLocalAnswer(quint64 requestId)
+{
+    Request* request = m_localAnswers.take(requestId);
+    if (!request) {
+        return;
+    }
     
-    connect(m_currentReply, &QNetworkReply::finished, 
-            this, &AIApiClient::handleSymptomResponse);
-    connect(m_currentReply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &AIApiClient::handleNetworkError);
-    connect(m_currentReply, &QNetworkReply::sslErrors,
-            this, &AIApiClient::handleSslErrors);
+    // 与聊天窗口的本地回复使用同一份词典条目
+    SymptomMatcher* matcher = SymptomMatcher::instance();
+    const SymptomMatcher::Category& category = matcher->category(request->route.matchedCategory);
+    SymptomMatcher::MatchResult match;
+    match.bestCategory = request->route.matchedCategory;
+    match.confident = request->route.confident;
+    match.emergency = request->route.emergency;
+    match.urgent = request->route.urgent;
     
-    m_timeoutTimer->start();
+    Response response;
+    response.success = true;
+    response.result.symptomAnalysis = category.reason;
+    response.result.recommendedDepartment = category.department;
+    response.result.emergencyLevel = matcher->emergencyLevel(match);
+    response.result.needsHumanConsult = category.action == "transfer";
+    response.result.aiResponse = category.response;
     
-    qDebug() << "发送症状分析请求:" << symptoms;
+    finishRequest(request, response);
 }
 
-void AIApiClient::sendDepartmentRecommendation(const QString& symptoms, const QString& analysis)
+void AIApiClient::failFast(Request* request)
 {
-    if (m_currentReply) {
-        qDebug() << "请求正在进行中，忽略新请求";
+    AICircuitBreaker::instance()->recordShortCircuit();
+    
+    // 与缓存命中一样在下一轮事件循环回调，调用方先拿到请求ID
+    quint64 requestId = request->id;
+    m_failFast.insert(requestId, request);
+    QMetaObject::invokeMethod(this, [this, requestId]() {
+        deliverFailFast(requestId);
+    }, Qt::QueuedConnection);
+    qDebug() << "AI服务熔断中，请求 #" << requestId << "直接失败";
+}
+
+void AIApiClient::deliverFailFast(quint64 requestId)
+{
+    Request* request = m_failFast.take(requestId);
+    if (!request) {
         return;
     }
     
-    m_currentRequestType = DepartmentRequest;
-    emit requestStarted();
+    Response response;
+    response.circuitOpen = true;
+    response.error = "AI服务暂时不可用，已切换为本地分诊";
+    m_lastError = response.error;
+    finishRequest(request, response);
+}
+
+void AIApiClient::trackConnectionTiming(Request* request)
+{
+    // 记录建连、发出请求、收到响应头的时间点，区分握手耗时和服务端耗时
+    quint64 requestId = request->id;
+    QNetworkReply* reply = request->reply;
     
-    QString systemPrompt = createDepartmentPrompt(symptoms, analysis);
-    QJsonObject requestBody = createRequestBody(systemPrompt, symptoms);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [this, requestId]() {
+        Request* active = m_active.value(requestId);
+        if (active && active->connectStartedMs < 0) {
+            active->connectStartedMs = active->latencyTimer.elapsed();
+        }
+    });
+    connect(reply, &QNetworkReply::requestSent, this, [this, requestId]() {
+        Request* active = m_active.value(requestId);
+        if (active && active->requestSentMs < 0) {
+            active->requestSentMs = active->latencyTimer.elapsed();
+        }
+    });
+#endif
+    connect(reply, &QNetworkReply::encrypted, this, [this, requestId]() {
+        Request* active = m_active.value(requestId);
+        if (active && active->encryptedMs < 0) {
+            active->encryptedMs = active->latencyTimer.elapsed();
+        }
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, requestId]() {
+        Request* active = m_active.value(requestId);
+        if (active && active->headersReceivedMs < 0) {
+            active->headersReceivedMs = active->latencyTimer.elapsed();
+        }
+    });
+}
+
+void AIApiClient::fillTiming(const Request* request, QNetworkReply* reply, Response& response) const
+{
+    bool newConnection = request->connectStartedMs >= 0 || request->encryptedMs >= 0;
     
-    QNetworkRequest request = createApiRequest();
+    // 没有 requestSent 信号时以TLS握手完成作为发出时间
+    qint64 sentAt = request->attemptStartedMs;
+    if (request->requestSentMs >= 0) {
+        sentAt = request->requestSentMs;
+    } else if (request->encryptedMs >= 0) {
+        sentAt = request->encryptedMs;
+    }
     
-    QJsonDocument doc(requestBody);
-    m_currentReply = m_networkManager->post(request, doc.toJson());
+    response.connectionReused = !newConnection;
+    response.handshakeMs = newConnection ? sentAt - request->attemptStartedMs : 0;
+    response.serverMs = request->headersReceivedMs >= 0 ? request->headersReceivedMs - sentAt : -1;
+    response.http2Used = reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+}
+
+void AIApiClient::cancelRequest(quint64 requestId)
+{
+    if (m_cacheHits.contains(requestId) || m_failFast.contains(requestId) || m_localAnswers.contains(requestId)) {
+        Request* request = m_cacheHits.contains(requestId) ? m_cacheHits.take(requestId)
+                         : m_failFast.contains(requestId) ? m_failFast.take(requestId)
+                         : m_localAnswers.take(requestId);
+        request->cancelled = true;
+        Response response;
+        finishRequest(request, response);
+        return;
+    }
     
-    connect(m_currentReply, &QNetworkReply::finished, 
-            this, &AIApiClient::handleDepartmentResponse);
-    connect(m_currentReply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &AIApiClient::handleNetworkError);
-    connect(m_currentReply, &QNetworkReply::sslErrors,
-            this, &AIApiClient::handleSslErrors);
+    if (m_retrying.contains(requestId)) {
+        Request* request = m_retrying.take(requestId);
+        request->retryTimer->deleteLater();
+        request->retryTimer = nullptr;
+        request->cancelled = true;
+        Response response;
+        finishRequest(request, response);
+        return;
+    }
     
-    m_timeoutTimer->start();
+    for (int i = 0; i < m_pending.size(); ++i) {
+        if (m_pending[i]->id == requestId) {
+            Request* request = m_pending.takeAt(i);
+            request->cancelled = true;
+            Response response;
+            finishRequest(request, response);
+            return;
+        }
+    }
+    
+    // 进行中的请求中止后在 finished 中统一收尾
+    Request* request = m_active.value(requestId);
+    if (request && request->reply && !request->cancelled) {
+        request->cancelled = true;
+        abortReplies(request);
+    }
+}
+
+void AIApiClient::cancelAll()
+{
+    QList<quint64> requestIds;
+    for (Request* request : m_pending) {
+        requestIds.append(request->id);
+    }
+    requestIds.append(m_cacheHits.keys());
+    requestIds.append(m_localAnswers.keys());
+    requestIds.append(m_failFast.keys());
+    requestIds.append(m_retrying.keys());
+    requestIds.append(m_active.keys());
     
-    qDebug() << "发送科室推荐请求:" << symptoms;
+    for (quint64 requestId : requestIds) {
+        cancelRequest(requestId);
+    }
+}
+
+void AIApiClient::setMaxConcurrentRequests(int maxConcurrent)
+{
+    m_maxConcurrent = qMax(1, maxConcurrent);
+    dispatchPending();
+}
+
+int AIApiClient::maxConcurrentRequests() const
+{
+    return m_maxConcurrent;
+}
+
+int AIApiClient::pendingRequestCount() const
+{
+    return m_pending.size();
+}
+
+int AIApiClient::activeRequestCount() const
+{
+    return m_active.size();
 }
 
 QNetworkRequest AIApiClient::createApiRequest()
@@ -166,14 +776,18 @@ QNetworkRequest AIApiClient::createApiRequest()
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
     request.setRawHeader("User-Agent", "HospAI/1.0");
+    // 服务端支持时走HTTP/2，多个并发请求共用一条连接
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
     
     return request;
 }
 
-QJsonObject AIApiClient::createRequestBody(const QString& systemPrompt, const QString& userMessage)
+QJsonObject AIApiClient::createRequestBody(const QString& systemPrompt, const QString& userMessage, AIModelRouter::Tier tier)
 {
+    AIModelRouter::TierConfig config = AIModelRouter::instance()->config(tier);
+    
     QJsonObject requestBody;
-    requestBody["model"] = m_model;
+    requestBody["model"] = modelFor(tier);
     requestBody["stream"] = false;
     
     QJsonArray messages;
@@ -192,9 +806,9 @@ QJsonObject AIApiClient::createRequestBody(const QString& systemPrompt, const QS
     
     requestBody["messages"] = messages;
     
-    // 参数设置
-    requestBody["temperature"] = 0.7;
-    requestBody["max_tokens"] = 1000;
+    // 参数设置，回复长度和温度按档位
+    requestBody["temperature"] = config.temperature;
+    requestBody["max_tokens"] = config.maxTokens;
     requestBody["top_p"] = 0.9;
     
     return requestBody;
@@ -293,103 +907,376 @@ QString AIApiClient::createDepartmentPrompt(const QString& symptoms, const QStri
     return prompt.arg(symptoms, analysis);
 }
 
-void AIApiClient::handleTriageResponse()
+void AIApiClient::handleReplyFinished(quint64 requestId, QNetworkReply* reply)
 {
-    m_timeoutTimer->stop();
-    
-    if (!m_currentReply) {
+    Request* request = m_active.value(requestId);
+    if (!request || (reply != request->reply && reply != request->hedgeReply)) {
         return;
     }
     
-    QNetworkReply* reply = m_currentReply;
-    m_currentReply = nullptr;
+    bool replyFailed = reply->error() != QNetworkReply::NoError;
+    if (request->hedgeReply) {
+        if (replyFailed) {
+            // 对冲中的一路失败时等另一路的结果
+            qDebug() << "请求 #" << requestId << "其中一路失败，等待另一路:" << networkErrorMessage(reply);
+            request->reply = reply == request->reply ? request->hedgeReply : request->reply;
+            request->hedgeReply = nullptr;
+            reply->disconnect(this);
+            reply->deleteLater();
+            return;
+        }
+        promoteReply(request, reply);
+    }
+    
+    m_active.remove(requestId);
+    request->reply = nullptr;
+    if (request->timeoutTimer) {
+        request->timeoutTimer->stop();
+        request->timeoutTimer->deleteLater();
+        request->timeoutTimer = nullptr;
+    }
+    if (request->hedgeTimer) {
+        request->hedgeTimer->stop();
+        request->hedgeTimer->deleteLater();
+        request->hedgeTimer = nullptr;
+    }
+    
+    AICircuitBreaker* breaker = AICircuitBreaker::instance();
+    if (!request->cancelled && replyFailed) {
+        int delayMs = retryDelayMs(request, reply);
+        if (shouldRetry(request, reply, delayMs)) {
+            breaker->recordFailure();
+            qDebug() << "请求 #" << requestId << "第" << request->attempts << "次失败:"
+                     << (request->timedOut ? QString("超时") : networkErrorMessage(reply))
+                     << "，" << delayMs << "ms 后重试";
+            reply->deleteLater();
+            scheduleRetry(request, delayMs);
+            dispatchPending();
+            return;
+        }
+    }
     
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray data = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(data);
+    Response response;
+    if (request->cancelled) {
+        qDebug() << "请求已取消 #" << requestId;
+    } else if (request->timedOut) {
+        response.error = "请求超时，请检查网络连接";
+        m_lastError = response.error;
+        breaker->recordFailure();
+    } else if (!replyFailed) {
+        response.success = true;
+        breaker->recordSuccess();
+        
+        QString content;
+        QByteArray data = request->sseBuffer + reply->readAll();
+        if (request->stream && !(request->streamedText.isEmpty() && data.trimmed().startsWith('{'))) {
+            request->sseBuffer = data;
+            QString delta = consumeSseEvents(request, true);
+            recordStreamedText(request, delta);
+            content = request->streamedText;
+        } else {
+            // 服务端未按流式返回时按普通响应解析
+            QJsonDocument doc = QJsonDocument::fromJson(data);
+            
+            if (request->type == TriageRequest) {
+                qDebug() << "收到分诊响应:" << doc.toJson(QJsonDocument::Compact);
+            }
+            
+            content = parseApiResponse(doc);
+        }
         
-        qDebug() << "收到分诊响应:" << doc.toJson(QJsonDocument::Compact);
+        // 结构化字段在完整文本上解析
+        response.result = resultFromContent(content);
+        if (!request->cacheKey.isEmpty()) {
+            TriageCache::instance()->store(request->cacheKey, content, request->latencyTimer.elapsed());
+        }
         
-        AIDiagnosisResult result = parseApiResponse(doc);
-        m_isConnected = true;
-        emit connectionStatusChanged(true);
-        emit triageResponseReceived(result);
+        // 只用一次就成功、未经对冲的耗时估计对冲延迟，避免重试把分位数拉高
+        if (request->attempts == 1 && !request->hedgeWon) {
+            QList<qint64>& samples = request->stream ? m_recentFirstTokens : m_recentLatencies;
+            qint64 sample = request->stream ? request->firstTokenMs : request->latencyTimer.elapsed();
+            if (sample >= 0) {
+                samples.append(sample);
+                if (samples.size() > HEDGE_SAMPLE_LIMIT) {
+                    samples.removeFirst();
+                }
+            }
+        }
         
+        if (!m_isConnected) {
+            m_isConnected = true;
+            emit connectionStatusChanged(true);
+        }
     } else {
-        QString error = QString("网络请求失败: %1").arg(reply->errorString());
-        m_lastError = error;
-        m_isConnected = false;
-        emit connectionStatusChanged(false);
-        emit apiError(error);
+        response.error = networkErrorMessage(reply);
+        m_lastError = response.error;
+        breaker->recordFailure();
+        if (m_isConnected) {
+            m_isConnected = false;
+            emit connectionStatusChanged(false);
+        }
     }
     
+    fillTiming(request, reply, response);
     reply->deleteLater();
-    emit requestFinished();
+    finishRequest(request, response);
+    
+    // 空出名额后继续发送排队中的请求
+    dispatchPending();
 }
 
-void AIApiClient::handleSymptomResponse()
+int AIApiClient::retryDelayMs(const Request* request, QNetworkReply* reply) const
 {
-    m_timeoutTimer->stop();
+    // 指数退避加随机抖动，避免大量客户端在同一时刻重试
+    int exponential = qMin(RETRY_MAX_DELAY_MS, RETRY_BASE_DELAY_MS << qBound(0, request->attempts - 1, 10));
+    int delayMs = exponential / 2 + int(QRandomGenerator::global()->bounded(exponential / 2 + 1));
     
-    if (!m_currentReply) {
-        return;
+    // 服务端给出 Retry-After（秒）时至少等这么久
+    bool ok = false;
+    int retryAfterSecs = reply->rawHeader("Retry-After").toInt(&ok);
+    if (ok && retryAfterSecs > 0) {
+        delayMs = qMax(delayMs, qMin(retryAfterSecs * 1000, RETRY_MAX_DELAY_MS));
+    }
+    return delayMs;
+}
+
+bool AIApiClient::shouldRetry(const Request* request, QNetworkReply* reply, int delayMs) const
+{
+    if (request->attempts > request->maxRetries) {
+        return false;
     }
     
-    QNetworkReply* reply = m_currentReply;
-    m_currentReply = nullptr;
+    // 流式已经向界面输出部分文本，重试会重复显示
+    if (!request->streamedText.isEmpty()) {
+        return false;
+    }
     
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray data = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        
-        AIDiagnosisResult result = parseApiResponse(doc);
-        m_isConnected = true;
-        emit connectionStatusChanged(true);
-        emit symptomAnalysisReceived(result);
-        
-    } else {
-        QString error = QString("症状分析请求失败: %1").arg(reply->errorString());
-        m_lastError = error;
-        emit apiError(error);
+    // 熔断后不再重试，交给本地分诊
+    if (AICircuitBreaker::instance()->state() != AICircuitBreaker::Closed) {
+        return false;
     }
     
-    reply->deleteLater();
-    emit requestFinished();
+    // 超时后已经用掉一整个超时，按剩余预算判断；下一次的超时在 startRequest 中缩短到剩余预算
+    qint64 budgetLeftMs = qint64(RETRY_BUDGET_FACTOR) * request->timeoutMs
+                        - request->latencyTimer.elapsed() - delayMs;
+    if (budgetLeftMs < qMin(RETRY_MIN_TIMEOUT_MS, request->timeoutMs)) {
+        return false;
+    }
+    
+    if (request->timedOut) {
+        return true;
+    }
+    
+    // 限流和服务端错误可以重试，其他HTTP错误（如401、400）重试也不会成功
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status > 0) {
+        return status == 429 || status >= 500;
+    }
+    
+    switch (reply->error()) {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::UnknownNetworkError:
+            return true;
+        default:
+            return false;
+    }
 }
 
-void AIApiClient::handleDepartmentResponse()
+void AIApiClient::scheduleRetry(Request* request, int delayMs)
 {
-    m_timeoutTimer->stop();
+    request->timedOut = false;
+    request->sseBuffer.clear();
+    request->connectStartedMs = -1;
+    request->encryptedMs = -1;
+    request->requestSentMs = -1;
+    request->headersReceivedMs = -1;
     
-    if (!m_currentReply) {
+    quint64 requestId = request->id;
+    m_retrying.insert(requestId, request);
+    request->retryTimer = new QTimer(this);
+    request->retryTimer->setSingleShot(true);
+    connect(request->retryTimer, &QTimer::timeout, this, [this, requestId]() {
+        retryRequest(requestId);
+    });
+    request->retryTimer->start(delayMs);
+}
+
+void AIApiClient::retryRequest(quint64 requestId)
+{
+    Request* request = m_retrying.take(requestId);
+    if (!request) {
         return;
     }
+    request->retryTimer->deleteLater();
+    request->retryTimer = nullptr;
+    AICircuitBreaker::instance()->recordRetry();
     
-    QNetworkReply* reply = m_currentReply;
-    m_currentReply = nullptr;
+    // 回到同优先级的最前面，熔断已打开时在 dispatchPending 中直接失败
+    int position = 0;
+    while (position < m_pending.size() && m_pending[position]->priority < request->priority) {
+        ++position;
+    }
+    m_pending.insert(position, request);
+    dispatchPending();
+}
+
+void AIApiClient::handleStreamData(quint64 requestId, QNetworkReply* reply)
+{
+    Request* request = m_active.value(requestId);
+    if (!request || request->cancelled || request->timedOut) {
+        return;
+    }
+    if (reply != request->reply && reply != request->hedgeReply) {
+        return;
+    }
     
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray data = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        
-        AIDiagnosisResult result = parseApiResponse(doc);
-        m_isConnected = true;
-        emit connectionStatusChanged(true);
-        emit departmentRecommendationReceived(result);
+    if (request->hedgeReply) {
+        // 错误响应体不算有结果，留给 finished 处理
+        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400) {
+            return;
+        }
+        promoteReply(request, reply);
+    }
+    
+    request->sseBuffer += reply->readAll();
+    if (request->timeoutTimer) {
+        request->timeoutTimer->start(request->attemptTimeoutMs);
+    }
+    
+    // 服务端忽略 stream 参数直接返回整段JSON时，留到完成后统一解析
+    if (request->streamedText.isEmpty() && request->sseBuffer.trimmed().startsWith('{')) {
+        return;
+    }
+    
+    QString delta = consumeSseEvents(request, false);
+    // 信号接收方可能取消请求，发出信号后不再访问 request
+    recordStreamedText(request, delta);
+}
+
+QString AIApiClient::consumeSseEvents(Request* request, bool flushAll)
+{
+    QString delta;
+    request->sseBuffer.replace("\r\n", "\n");
+    
+    while (!request->sseBuffer.isEmpty()) {
+        // 事件以空行分隔，不完整的事件留到下次
+        int end = request->sseBuffer.indexOf("\n\n");
+        QByteArray event;
+        if (end >= 0) {
+            event = request->sseBuffer.left(end);
+            request->sseBuffer.remove(0, end + 2);
+        } else if (flushAll) {
+            event = request->sseBuffer;
+            request->sseBuffer.clear();
+        } else {
+            break;
+        }
         
-    } else {
-        QString error = QString("科室推荐请求失败: %1").arg(reply->errorString());
-        m_lastError = error;
-        emit apiError(error);
+        const QList<QByteArray> lines = event.split('\n');
+        for (const QByteArray& line : lines) {
+            if (!line.startsWith("data:")) {
+                continue;
+            }
+            
+            QByteArray payload = line.mid(5).trimmed();
+            if (payload.isEmpty() || payload == "[DONE]") {
+                continue;
+            }
+            
+            QJsonObject chunk = QJsonDocument::fromJson(payload).object();
+            QJsonArray choices = chunk["choices"].toArray();
+            if (!choices.isEmpty()) {
+                delta += choices[0].toObject()["delta"].toObject()["content"].toString();
+            }
+        }
     }
     
-    reply->deleteLater();
-    emit requestFinished();
+    return delta;
 }
 
-AIDiagnosisResult AIApiClient::parseApiResponse(const QJsonDocument& response)
+void AIApiClient::recordStreamedText(Request* request, const QString& delta)
 {
-    AIDiagnosisResult result;
+    if (delta.isEmpty()) {
+        return;
+    }
+    
+    quint64 requestId = request->id;
+    bool firstToken = request->firstTokenMs < 0;
+    if (firstToken) {
+        request->firstTokenMs = request->latencyTimer.elapsed();
+        qDebug() << "请求 #" << requestId << "首个token耗时" << request->firstTokenMs << "ms";
+    }
+    qint64 firstTokenMs = request->firstTokenMs;
+    request->streamedText += delta;
+    
+    if (firstToken) {
+        emit firstTokenReceived(requestId, firstTokenMs);
+    }
+    emit partialTextReceived(requestId, delta);
+}
+
+void AIApiClient::finishRequest(Request* request, Response& response)
+{
+    response.requestId = request->id;
+    response.type = request->type;
+    response.cancelled = request->cancelled;
+    response.timedOut = request->timedOut;
+    // 没发出就结束的请求，排队时间算到结束为止
+    response.queuedMs = request->latencyTimer.isValid() ? request->queuedMs : request->queuedTimer.elapsed();
+    response.latencyMs = request->latencyTimer.isValid() ? request->latencyTimer.elapsed() : 0;
+    response.firstTokenMs = request->firstTokenMs;
+    response.attempts = request->attempts;
+    response.hedged = request->hedged;
+    response.hedgeWon = request->hedgeWon;
+    response.tier = request->route.tier;
+    response.model = request->model;
+    
+    // 取消的请求没有结果，不计入路由记录；发出几次就按几次估算提示词token
+    if (!response.cancelled) {
+        AIModelRouter::Outcome outcome;
+        outcome.requestType = requestTypeName(request->type);
+        outcome.model = request->model;
+        outcome.success = response.success;
+        outcome.timedOut = response.timedOut;
+        outcome.fromCache = response.fromCache;
+        outcome.latencyMs = response.queuedMs + response.latencyMs;
+        outcome.firstTokenMs = response.firstTokenMs;
+        outcome.attempts = response.attempts;
+        outcome.promptTokens = request->promptTokens * (response.attempts + (response.hedged ? 1 : 0));
+        if (response.success && !response.fromCache && request->route.tier != AIModelRouter::LocalTier) {
+            outcome.completionTokens = ConversationContextBuilder::estimateTokens(response.result.aiResponse);
+        }
+        AIModelRouter::instance()->record(request->route, outcome);
+    }
+    
+    qDebug() << "请求完成 #" << response.requestId << AIModelRouter::tierName(response.tier) << "成功:" << response.success
+             << "发出" << response.attempts << "次" << (response.hedged ? "有对冲" : "")
+             << "排队" << response.queuedMs << "ms 首token" << response.firstTokenMs
+             << "ms 耗时" << response.latencyMs << "ms 握手" << response.handshakeMs
+             << "ms 服务端" << response.serverMs << "ms"
+             << (response.connectionReused ? "复用连接" : "新建连接")
+             << (response.http2Used ? "HTTP/2" : "HTTP/1.1");
+    
+    // 调用方已销毁时不再回调
+    bool contextAlive = !request->hasContext || request->context;
+    if (!m_shuttingDown && contextAlive && request->callback) {
+        request->callback(response);
+    }
+    
+    quint64 requestId = request->id;
+    request->cancelToken.removeCancelHandler(request->cancelHandlerId);
+    delete request;
+    emit requestFinished(requestId);
+}
+
+QString AIApiClient::parseApiResponse(const QJsonDocument& response)
+{
+    QString content;
     
     QJsonObject rootObj = response.object();
     
@@ -399,14 +1286,25 @@ AIDiagnosisResult AIApiClient::parseApiResponse(const QJsonDocument& response)
             QJsonObject firstChoice = choices[0].toObject();
             if (firstChoice.contains("message")) {
                 QJsonObject message = firstChoice["message"].toObject();
-                result.aiResponse = message["content"].toString();
-                
-                // 解析AI回复内容，提取结构化信息
-                parseAIResponseContent(result);
+                content = message["content"].toString();
             }
         }
     }
     
+    return content;
+}
+
+AIDiagnosisResult AIApiClient::resultFromContent(const QString& content)
+{
+    AIDiagnosisResult result;
+    result.needsHumanConsult = false;
+    result.aiResponse = content;
+    
+    if (!result.aiResponse.isEmpty()) {
+        // 解析AI回复内容，提取结构化信息
+        parseAIResponseContent(result);
+    }
+    
     if (result.aiResponse.isEmpty()) {
         result.aiResponse = "抱歉，暂时无法获取AI回复，请稍后重试或转人工客服。";
         result.needsHumanConsult = true;
@@ -447,55 +1345,20 @@ void AIApiClient::parseAIResponseContent(AIDiagnosisResult& result)
                               content.contains("专业医生") || result.emergencyLevel == "critical";
 }
 
-void AIApiClient::handleNetworkError(QNetworkReply::NetworkError error)
+QString AIApiClient::networkErrorMessage(QNetworkReply* reply) const
 {
-    m_timeoutTimer->stop();
-    
-    QString errorMsg;
-    switch (error) {
+    switch (reply->error()) {
         case QNetworkReply::ConnectionRefusedError:
-            errorMsg = "连接被拒绝，请检查网络设置";
-            break;
+            return "连接被拒绝，请检查网络设置";
         case QNetworkReply::RemoteHostClosedError:
-            errorMsg = "远程主机关闭连接";
-            break;
+            return "远程主机关闭连接";
         case QNetworkReply::HostNotFoundError:
-            errorMsg = "无法找到服务器，请检查网络连接";
-            break;
+            return "无法找到服务器，请检查网络连接";
         case QNetworkReply::TimeoutError:
-            errorMsg = "请求超时，请稍后重试";
-            break;
+            return "请求超时，请稍后重试";
         case QNetworkReply::SslHandshakeFailedError:
-            errorMsg = "SSL连接失败";
-            break;
+            return "SSL连接失败";
         default:
-            errorMsg = QString("网络错误: %1").arg(m_currentReply ? m_currentReply->errorString() : "未知错误");
-            break;
+            return QString("网络错误: %1").arg(reply->errorString());
     }
-    
-    m_lastError = errorMsg;
-    m_isConnected = false;
-    emit connectionStatusChanged(false);
-    emit apiError(errorMsg);
-    
-    if (m_currentReply) {
-        m_currentReply->deleteLater();
-        m_currentReply = nullptr;
-    }
-    
-    emit requestFinished();
 }
-
-void AIApiClient::handleSslErrors(const QList<QSslError>& errors)
-{
-    qDebug() << "SSL错误数量:" << errors.size();
-    for (const QSslError& error : errors) {
-        qDebug() << "SSL错误:" << error.errorString();
-    }
-    
-    // 在生产环境中，应该更严格地处理SSL错误
-    // 这里为了测试方便，忽略SSL错误
-    if (m_currentReply) {
-        m_currentReply->ignoreSslErrors();
-    }
-} 
\ No newline at end of file
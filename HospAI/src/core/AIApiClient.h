@@ -9,6 +9,15 @@
 #include <QJsonArray>
 #include <QString>
 #include <QTimer>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <functional>
+#include "AIModelRouter.h"
 
 // AI诊断结果结构
 struct AIDiagnosisResult {
@@ -21,78 +30,278 @@ struct AIDiagnosisResult {
     QString aiResponse;           // AI完整回复
 };
 
+// 取消令牌：可复制，副本共享同一状态。cancel() 后排队中的请求直接丢弃，
+// 进行中的请求被中止；同一令牌可以绑定多个请求
+class AICancellationToken
+{
+public:
+    AICancellationToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    friend class AIApiClient;
+
+    // 每个请求登记一个处理函数，请求结束时按编号移除，长期复用的令牌不会越积越多
+    quint64 addCancelHandler(const std::function<void()>& handler);
+    void removeCancelHandler(quint64 handlerId);
+
+    struct State {
+        QAtomicInt cancelled;
+        QMutex mutex;
+        quint64 nextHandlerId = 1;
+        QHash<quint64, std::function<void()>> cancelHandlers;
+    };
+    QSharedPointer<State> m_state;
+};
+
 class AIApiClient : public QObject
 {
     Q_OBJECT
 
 public:
+    // 请求类型
+    enum RequestType {
+        TriageRequest,
+        SymptomRequest,
+        DepartmentRequest
+    };
+
+    // 优先级：排队时高优先级在前，同优先级先到先发
+    enum RequestPriority {
+        EmergencyPriority,
+        NormalPriority,
+        BackgroundPriority
+    };
+
+    static constexpr int DEFAULT_TIMEOUT_MS = 15000;
+    static constexpr int DEFAULT_MAX_CONCURRENT = 4;
+    static constexpr int DEFAULT_MAX_RETRIES = 2;
+    // 重试退避：基数按次数翻倍，在 [一半, 全部] 之间随机，不超过上限
+    static constexpr int RETRY_BASE_DELAY_MS = 500;
+    static constexpr int RETRY_MAX_DELAY_MS = 8000;
+    // 含重试在内的最长等待为单次超时的这么多倍，超出预算时不再重试
+    static constexpr int RETRY_BUDGET_FACTOR = 2;
+    // 预算剩余不足这么多（且不足单次超时）时不再重试；重试的超时缩短到剩余预算
+    static constexpr int RETRY_MIN_TIMEOUT_MS = 1000;
+    // 对冲延迟取最近耗时的p95，样本不足时用默认值
+    static constexpr int HEDGE_DEFAULT_DELAY_MS = 3000;
+    static constexpr int HEDGE_MIN_DELAY_MS = 500;
+    static constexpr int HEDGE_MIN_SAMPLES = 10;
+    static constexpr int HEDGE_SAMPLE_LIMIT = 50;
+    // 空闲超过该时间后重新预连接，赶在服务端关闭空闲连接之前
+    static constexpr int KEEPALIVE_INTERVAL_MS = 45000;
+    // 连续这么久没有请求就停止保活
+    static constexpr int KEEPALIVE_MAX_IDLE_MS = 10 * 60 * 1000;
+
+    struct RequestOptions {
+        RequestPriority priority = NormalPriority;
+        int timeoutMs = 0;                    // 0 表示用所选档位的超时；流式请求为两次数据之间的最长间隔
+        AICancellationToken cancelToken;
+        bool stream = false;                  // 以SSE流式返回，过程中发出 partialTextReceived
+        bool useCache = true;                 // 相同提问直接用缓存的回复；急症输入始终绕过缓存
+        int maxRetries = DEFAULT_MAX_RETRIES; // 超时、断连、429和5xx时退避重试；流式已输出部分文本后不重试
+        bool hedge = false;                   // 超过近期p95仍无结果（流式为首token）时再发一份，先到者胜出
+        AIModelRouter::Tier tier = AIModelRouter::AutoTier; // 默认按复杂度选择本地规则、快速模型或大模型
+        bool allowLocal = true;               // 为 false 时分诊请求不走本地规则档，始终拿到模型的回复
+    };
+
+    // 单个请求的结果，只回调给发起请求的调用方
+    struct Response {
+        quint64 requestId = 0;
+        RequestType type = TriageRequest;
+        bool success = false;
+        bool cancelled = false;
+        bool timedOut = false;
+        bool fromCache = false;
+        bool circuitOpen = false; // 熔断中未发出请求，调用方应直接使用本地分诊
+        int attempts = 0;         // 实际发出的次数，含重试
+        bool hedged = false;      // 发出过对冲请求
+        bool hedgeWon = false;    // 结果来自对冲请求
+        AIModelRouter::Tier tier = AIModelRouter::LargeTier; // 实际使用的档位
+        QString model;            // 本地规则时为空
+        QString error;
+        AIDiagnosisResult result;
+        qint64 queuedMs = 0;   // 排队等待时间
+        qint64 latencyMs = 0;  // 首次发出请求到完成的时间，含重试
+        qint64 firstTokenMs = -1; // 发出请求到首个token的时间，非流式或未收到内容时为-1
+        qint64 handshakeMs = 0;   // DNS、TCP、TLS建连耗时，复用连接时为0
+        qint64 serverMs = -1;     // 请求发出到收到响应头的时间
+        bool connectionReused = false;
+        bool http2Used = false;
+    };
+    using ResponseCallback = std::function<void(const Response& response)>;
+
     explicit AIApiClient(QObject *parent = nullptr);
     ~AIApiClient();
-    
-    // 发送智能分诊请求
-    void sendTriageRequest(const QString& userInput, const QString& conversationHistory = "");
-    
+
+    // 发送智能分诊请求；输入包含急症关键词时自动提升为紧急优先级。
+    // 词典能明确回答的描述不发网络请求，直接以本地规则的结果回调
+    quint64 sendTriageRequest(const QString& userInput, const QString& conversationHistory,
+                              QObject* context, const ResponseCallback& callback,
+                              const RequestOptions& options = RequestOptions());
+
     // 发送症状分析请求
-    void sendSymptomAnalysis(const QString& symptoms, int age = 0, const QString& gender = "");
-    
+    quint64 sendSymptomAnalysis(const QString& symptoms, int age, const QString& gender,
+                                QObject* context, const ResponseCallback& callback,
+                                const RequestOptions& options = RequestOptions());
+
     // 发送科室推荐请求
-    void sendDepartmentRecommendation(const QString& symptoms, const QString& analysis = "");
-    
+    quint64 sendDepartmentRecommendation(const QString& symptoms, const QString& analysis,
+                                         QObject* context, const ResponseCallback& callback,
+                                         const RequestOptions& options = RequestOptions());
+
+    // 取消请求：排队中的直接移除，进行中的中止；回调收到 cancelled 结果
+    void cancelRequest(quint64 requestId);
+    void cancelAll();
+
+    // 同时进行的请求上限；上限大于1时保留一个名额给紧急请求
+    void setMaxConcurrentRequests(int maxConcurrent);
+    int maxConcurrentRequests() const;
+    int pendingRequestCount() const;
+    int activeRequestCount() const;
+
+    // 预先完成DNS、TCP和TLS握手，之后的请求直接复用连接；同时开启空闲保活
+    void warmUp();
+    void setKeepAliveEnabled(bool enabled);
+
+    // 判断输入是否包含需要优先处理的急症描述
+    static bool isEmergencyInput(const QString& text);
+
     // 设置API配置
     void setApiConfig(const QString& baseUrl, const QString& apiKey, const QString& model);
-    
+
     // 检查API连接状态
     bool isConnected() const;
-    
+
     // 获取错误信息
     QString getLastError() const;
 
 signals:
-    // AI响应信号
-    void triageResponseReceived(const AIDiagnosisResult& result);
-    void symptomAnalysisReceived(const AIDiagnosisResult& result);
-    void departmentRecommendationReceived(const AIDiagnosisResult& result);
-    
-    // 错误和状态信号
-    void apiError(const QString& error);
+    // 状态信号，结果本身通过各请求的回调返回
     void connectionStatusChanged(bool connected);
-    void requestStarted();
-    void requestFinished();
-
-private slots:
-    void handleTriageResponse();
-    void handleSymptomResponse(); 
-    void handleDepartmentResponse();
-    void handleNetworkError(QNetworkReply::NetworkError error);
-    void handleSslErrors(const QList<QSslError>& errors);
+    void requestStarted(quint64 requestId);
+    void requestFinished(quint64 requestId);
+    // 流式请求：收到首个token、每段新增文本
+    void firstTokenReceived(quint64 requestId, qint64 elapsedMs);
+    void partialTextReceived(quint64 requestId, const QString& delta);
 
 private:
+    struct Request {
+        quint64 id = 0;
+        RequestType type = TriageRequest;
+        RequestPriority priority = NormalPriority;
+        int timeoutMs = DEFAULT_TIMEOUT_MS;
+        int attemptTimeoutMs = DEFAULT_TIMEOUT_MS;   // 本次发出的超时，重试时不超过剩余预算
+        int maxRetries = DEFAULT_MAX_RETRIES;
+        int attempts = 0;
+        bool hedge = false;
+        AIModelRouter::Decision route;
+        QString model;
+        int promptTokens = 0;     // 估算值，用于路由记录
+        QJsonObject body;
+        QString description;
+        bool hasContext = false;
+        QPointer<QObject> context;
+        ResponseCallback callback;
+        AICancellationToken cancelToken;
+        quint64 cancelHandlerId = 0;
+        QElapsedTimer queuedTimer;
+        QElapsedTimer latencyTimer;
+        qint64 queuedMs = 0;
+        QNetworkReply* reply = nullptr;
+        QNetworkReply* hedgeReply = nullptr;   // 对冲请求，与 reply 谁先有结果用谁
+        QTimer* timeoutTimer = nullptr;
+        QTimer* hedgeTimer = nullptr;
+        QTimer* retryTimer = nullptr;
+        bool hedged = false;
+        bool hedgeWon = false;
+        bool cancelled = false;
+        bool timedOut = false;
+        bool stream = false;
+        QByteArray sseBuffer;     // 尚未凑成完整事件的数据
+        QString streamedText;     // 已收到的全部文本
+        qint64 firstTokenMs = -1;
+        QString cacheKey;         // 为空时不查也不写缓存
+        QString cachedResponse;
+        // 相对 latencyTimer 的时间点，未发生为-1
+        qint64 attemptStartedMs = 0;
+        qint64 connectStartedMs = -1;
+        qint64 encryptedMs = -1;
+        qint64 requestSentMs = -1;
+        qint64 headersReceivedMs = -1;
+    };
+
+    quint64 enqueue(RequestType type, const AIModelRouter::Decision& route, const QJsonObject& body,
+                    const QString& description, const QString& cacheKey, QObject* context,
+                    const ResponseCallback& callback, const RequestOptions& options);
+    QString cacheKeyFor(const QString& requestType, const QString& prompt, const QString& history,
+                        const QString& model, const RequestOptions& options) const;
+    QString modelFor(AIModelRouter::Tier tier) const;
+    void deliverCachedResponse(quint64 requestId);
+    void deliverLocalAnswer(quint64 requestId);
+    void failFast(Request* request);
+    void deliverFailFast(quint64 requestId);
+    void trackConnectionTiming(Request* request);
+    void fillTiming(const Request* request, QNetworkReply* reply, Response& response) const;
+    void preconnect();
+    void onKeepAliveTimer();
+    void dispatchPending();
+    bool canStart(RequestPriority priority) const;
+    void startRequest(Request* request);
+    void connectReply(quint64 requestId, QNetworkReply* reply, bool stream);
+    void sendHedge(quint64 requestId);
+    void promoteReply(Request* request, QNetworkReply* winner);
+    void abortReplies(Request* request);
+    void discardReply(QNetworkReply* reply);
+    qint64 hedgeDelayMs(bool stream) const;
+    int retryDelayMs(const Request* request, QNetworkReply* reply) const;
+    bool shouldRetry(const Request* request, QNetworkReply* reply, int delayMs) const;
+    void scheduleRetry(Request* request, int delayMs);
+    void retryRequest(quint64 requestId);
+    void handleReplyFinished(quint64 requestId, QNetworkReply* reply);
+    void handleStreamData(quint64 requestId, QNetworkReply* reply);
+    QString consumeSseEvents(Request* request, bool flushAll);
+    void recordStreamedText(Request* request, const QString& delta);
+    void finishRequest(Request* request, Response& response);
+    QString networkErrorMessage(QNetworkReply* reply) const;
+
     // 网络管理
     QNetworkAccessManager* m_networkManager;
-    QNetworkReply* m_currentReply;
-    
+
     // API配置
     QString m_baseUrl;
     QString m_apiKey;
     QString m_model;
-    
+
     // 状态管理
     bool m_isConnected;
     QString m_lastError;
-    QTimer* m_timeoutTimer;
-    
-    // 请求类型枚举
-    enum RequestType {
-        TriageRequest,
-        SymptomRequest,
-        DepartmentRequest
-    };
-    RequestType m_currentRequestType;
-    
+
+    // 请求调度
+    quint64 m_nextRequestId;
+    int m_maxConcurrent;
+    bool m_shuttingDown;
+    QList<Request*> m_pending;           // 按优先级排序
+    QHash<quint64, Request*> m_active;   // 进行中的请求
+    QHash<quint64, Request*> m_cacheHits; // 命中缓存、等待回调的请求
+    QHash<quint64, Request*> m_localAnswers; // 路由到本地规则、等待回调的请求
+    QHash<quint64, Request*> m_failFast;  // 熔断中直接失败、等待回调的请求
+    QHash<quint64, Request*> m_retrying;  // 退避等待重试的请求
+    QList<qint64> m_recentLatencies;     // 最近成功请求的耗时，用于对冲延迟
+    QList<qint64> m_recentFirstTokens;   // 最近流式请求的首token耗时
+
+    // 连接预热与保活
+    QTimer* m_keepAliveTimer;
+    QElapsedTimer m_lastActivity;
+    bool m_warmedUp;
+
     // 私有方法
     QNetworkRequest createApiRequest();
-    QJsonObject createRequestBody(const QString& systemPrompt, const QString& userMessage);
-    AIDiagnosisResult parseApiResponse(const QJsonDocument& response);
+    QJsonObject createRequestBody(const QString& systemPrompt, const QString& userMessage, AIModelRouter::Tier tier);
+    QString parseApiResponse(const QJsonDocument& response);
+    AIDiagnosisResult resultFromContent(const QString& content);
     void parseAIResponseContent(AIDiagnosisResult& result);
     void setupDefaultConfig();
     QString createTriagePrompt(const QString& userInput, const QString& history);
@@ -100,4 +309,4 @@ private:
     QString createDepartmentPrompt(const QString& symptoms, const QString& analysis);
 };
 
-#endif // AIAPICLIENT_H 
\ No newline at end of file
+#endif // AIAPICLIENT_H
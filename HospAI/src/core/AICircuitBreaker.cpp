@@ -0,0 +1,284 @@
+#include "AICircuitBreaker.h"
+#include "DatabaseManager.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include <QUuid>
+#include <QDebug>
+
+AICircuitBreaker* AICircuitBreaker::m_instance = nullptr;
+
+AICircuitBreaker* AICircuitBreaker::instance()
+{
+    if (!m_instance) {
+        m_instance = new AICircuitBreaker;
+    }
+    return m_instance;
+}
+
+AICircuitBreaker::AICircuitBreaker(int openDurationMs, int maxOpenDurationMs, QObject *parent)
+    : QObject(parent)
+    , m_state(Closed)
+    , m_consecutiveFailures(0)
+    , m_baseOpenDurationMs(openDurationMs)
+    , m_maxOpenDurationMs(maxOpenDurationMs)
+    , m_openDurationMs(openDurationMs)
+    , m_probeInFlight(false)
+    , m_instanceId(QUuid::createUuid().toString(QUuid::WithoutBraces))
+    , m_startedAt(QDateTime::currentDateTimeUtc())
+    , m_flushTimer(new QTimer(this))
+    , m_logPruned(false)
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &AICircuitBreaker::flush);
+
+    // 退出前写入还没落库的计数
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            if (m_flushTimer->isActive()) {
+                flush();
+            }
+        });
+    }
+}
+
+bool AICircuitBreaker::allowRequest()
+{
+    if (m_state == Open && m_openTimer.elapsed() >= m_openDurationMs) {
+        setState(HalfOpen);
+        m_probeInFlight = false;
+    }
+
+    switch (m_state) {
+    case Closed:
+        return true;
+    case Open:
+        return false;
+    case HalfOpen:
+        // 探测请求被取消时没有结果，超过一个冷却期后允许再发一个
+        if (m_probeInFlight && m_probeTimer.elapsed() < m_openDurationMs) {
+            return false;
+        }
+        m_probeInFlight = true;
+        m_probeTimer.start();
+        qDebug() << "AI熔断器放行探测请求";
+        return true;
+    }
+    return true;
+}
+
+void AICircuitBreaker::recordSuccess()
+{
+    record(true);
+}
+
+void AICircuitBreaker::recordFailure()
+{
+    record(false);
+}
+
+void AICircuitBreaker::record(bool success)
+{
+    m_window.append(success);
+    if (m_window.size() > WINDOW_SIZE) {
+        m_window.removeFirst();
+    }
+
+    if (success) {
+        m_stats.successes++;
+        m_consecutiveFailures = 0;
+    } else {
+        m_stats.failures++;
+        m_consecutiveFailures++;
+    }
+    scheduleFlush();
+
+    if (m_state == HalfOpen) {
+        m_probeInFlight = false;
+        if (success) {
+            // 探测成功，重新开始统计
+            m_window.clear();
+            m_openDurationMs = m_baseOpenDurationMs;
+            setState(Closed);
+        } else {
+            m_openDurationMs = qMin(m_openDurationMs * 2, m_maxOpenDurationMs);
+            open();
+        }
+        return;
+    }
+
+    if (m_state != Closed || success) {
+        return;
+    }
+
+    int failures = m_window.count(false);
+    bool rateExceeded = m_window.size() >= MIN_SAMPLES
+                     && failures * 100 >= FAILURE_RATE_PERCENT * m_window.size();
+    if (rateExceeded || m_consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
+        open();
+    }
+}
+
+void AICircuitBreaker::open()
+{
+    m_openTimer.start();
+    m_stats.opens++;
+    m_stats.lastOpenedAt = QDateTime::currentDateTime();
+    qDebug() << "AI熔断器打开，" << m_openDurationMs / 1000 << "秒内直接使用本地分诊";
+    setState(Open);
+}
+
+void AICircuitBreaker::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    State previous = m_state;
+    m_state = state;
+    qDebug() << "AI熔断器状态:" << stateName(state);
+
+    // 状态切换立即写库，统计页刷新时就能看到
+    DatabaseManager* db = DatabaseManager::instance();
+    if (db->isOpen()) {
+        Stats current = stats();
+        AIBreakerTransition transition;
+        transition.createdAt = QDateTime::currentDateTimeUtc();
+        transition.instanceId = m_instanceId;
+        transition.fromState = stateKey(previous);
+        transition.toState = stateKey(state);
+        transition.failureRate = current.failureRate;
+        transition.consecutiveFailures = current.consecutiveFailures;
+        transition.openDurationMs = state == Open ? m_openDurationMs : 0;
+        db->addAIBreakerTransition(transition);
+        flush();
+    }
+
+    emit stateChanged(state);
+}
+
+void AICircuitBreaker::scheduleFlush()
+{
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void AICircuitBreaker::flush()
+{
+    m_flushTimer->stop();
+
+    DatabaseManager* db = DatabaseManager::instance();
+    if (!db->isOpen()) {
+        return;
+    }
+
+    if (!m_logPruned) {
+        m_logPruned = true;
+        int removed = db->deleteAIBreakerRecordsBefore(QDateTime::currentDateTimeUtc().addDays(-LOG_RETENTION_DAYS));
+        if (removed > 0) {
+            qDebug() << "清理过期AI熔断器记录" << removed << "条";
+        }
+    }
+
+    Stats current = stats();
+    AIBreakerSnapshot snapshot;
+    snapshot.instanceId = m_instanceId;
+    snapshot.startedAt = m_startedAt;
+    snapshot.updatedAt = QDateTime::currentDateTimeUtc();
+    snapshot.state = stateKey(current.state);
+    snapshot.failureRate = current.failureRate;
+    snapshot.windowSamples = current.windowSamples;
+    snapshot.consecutiveFailures = current.consecutiveFailures;
+    if (current.state == Open) {
+        snapshot.reopenAt = snapshot.updatedAt.addMSecs(current.reopenInMs);
+    }
+    snapshot.lastOpenedAt = current.lastOpenedAt;
+    snapshot.opens = current.opens;
+    snapshot.successes = current.successes;
+    snapshot.failures = current.failures;
+    snapshot.shortCircuited = current.shortCircuited;
+    snapshot.retries = current.retries;
+    snapshot.hedges = current.hedges;
+    snapshot.hedgeWins = current.hedgeWins;
+    db->saveAIBreakerSnapshot(snapshot);
+}
+
+void AICircuitBreaker::recordShortCircuit()
+{
+    m_stats.shortCircuited++;
+    scheduleFlush();
+}
+
+void AICircuitBreaker::recordRetry()
+{
+    m_stats.retries++;
+    scheduleFlush();
+}
+
+void AICircuitBreaker::recordHedgeSent()
+{
+    m_stats.hedges++;
+    scheduleFlush();
+}
+
+void AICircuitBreaker::recordHedgeWin()
+{
+    m_stats.hedgeWins++;
+    scheduleFlush();
+}
+
+AICircuitBreaker::State AICircuitBreaker::state() const
+{
+    return m_state;
+}
+
+AICircuitBreaker::Stats AICircuitBreaker::stats() const
+{
+    Stats stats = m_stats;
+    stats.state = m_state;
+    stats.windowSamples = m_window.size();
+    stats.failureRate = m_window.isEmpty() ? 0.0 : double(m_window.count(false)) / m_window.size();
+    stats.consecutiveFailures = m_consecutiveFailures;
+    stats.openDurationMs = m_openDurationMs;
+    if (m_state == Open) {
+        stats.reopenInMs = qMax<qint64>(0, m_openDurationMs - m_openTimer.elapsed());
+    }
+    return stats;
+}
+
+QString AICircuitBreaker::stateName(State state)
+{
+    switch (state) {
+    case Closed:
+        return "正常";
+    case Open:
+        return "熔断中";
+    case HalfOpen:
+        return "探测中";
+    }
+    return QString();
+}
+
+QString AICircuitBreaker::stateKey(State state)
+{
+    switch (state) {
+    case Closed:
+        return "closed";
+    case Open:
+        return "open";
+    case HalfOpen:
+        return "half_open";
+    }
+    return QString();
+}
+
+AICircuitBreaker::State AICircuitBreaker::stateFromKey(const QString& key)
+{
+    if (key == "open") {
+        return Open;
+    }
+    if (key == "half_open") {
+        return HalfOpen;
+    }
+    return Closed;
+}
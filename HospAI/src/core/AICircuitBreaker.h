@@ -0,0 +1,103 @@
+#ifndef AICIRCUITBREAKER_H
+#define AICIRCUITBREAKER_H
+
+#include <QObject>
+#include <QList>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+class QTimer;
+
+// AI服务熔断器：所有 AIApiClient 共用，按最近若干次请求的结果统计失败率。
+// 失败率过高或连续失败时打开，期间请求直接失败，由调用方回退到本地规则分诊；
+// 冷却结束后放行一个探测请求，成功则恢复，失败则加倍冷却时间。
+// 同时汇总重试和对冲请求的计数。状态切换和计数写入 ai_breaker_log / ai_breaker_stats，
+// 管理端统计页从数据库读取，能看到所有患者端进程的情况
+class AICircuitBreaker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Closed,     // 正常放行
+        Open,       // 熔断中，直接失败
+        HalfOpen    // 冷却结束，等待探测请求的结果
+    };
+
+    static constexpr int WINDOW_SIZE = 20;              // 统计失败率的最近请求数
+    static constexpr int MIN_SAMPLES = 8;               // 样本不足时只看连续失败
+    static constexpr int FAILURE_RATE_PERCENT = 50;
+    static constexpr int MAX_CONSECUTIVE_FAILURES = 5;
+    static constexpr int OPEN_DURATION_MS = 30000;
+    static constexpr int MAX_OPEN_DURATION_MS = 5 * 60 * 1000;
+    static constexpr int FLUSH_INTERVAL_MS = 5000;  // 计数变化后最迟多久写库
+    static constexpr int LOG_RETENTION_DAYS = 30;
+
+    struct Stats {
+        State state = Closed;
+        double failureRate = 0.0;    // 最近窗口内
+        int windowSamples = 0;
+        int consecutiveFailures = 0;
+        int successes = 0;
+        int failures = 0;
+        int opens = 0;               // 熔断次数
+        int shortCircuited = 0;      // 熔断期间直接失败的请求
+        int retries = 0;
+        int hedges = 0;              // 发出的对冲请求
+        int hedgeWins = 0;           // 对冲请求先返回的次数
+        QDateTime lastOpenedAt;
+        qint64 reopenInMs = 0;       // 熔断中距离放行探测请求的时间
+        int openDurationMs = 0;      // 当前冷却时间，探测失败时加倍
+    };
+
+    static AICircuitBreaker* instance();
+
+    // 一般通过 instance() 共用；测试时用较短的冷却时间单独构造
+    explicit AICircuitBreaker(int openDurationMs = OPEN_DURATION_MS, int maxOpenDurationMs = MAX_OPEN_DURATION_MS,
+                              QObject *parent = nullptr);
+
+    // 请求真正发出前调用；半开状态下只放行一个探测请求
+    bool allowRequest();
+    void recordSuccess();
+    void recordFailure();
+    void recordShortCircuit();
+    void recordRetry();
+    void recordHedgeSent();
+    void recordHedgeWin();
+
+    State state() const;
+    Stats stats() const;
+    static QString stateName(State state);     // 界面显示用
+    static QString stateKey(State state);      // 写入记录用：closed/open/half_open
+    static State stateFromKey(const QString& key);
+
+signals:
+    void stateChanged(int state);
+
+private:
+    void record(bool success);
+    void setState(State state);
+    void open();
+    // 数据库未打开（命令行工具）时不写
+    void scheduleFlush();
+    void flush();
+
+    static AICircuitBreaker* m_instance;
+
+    State m_state;
+    QList<bool> m_window;          // 最近的请求结果，true 为成功
+    int m_consecutiveFailures;
+    int m_baseOpenDurationMs;
+    int m_maxOpenDurationMs;
+    int m_openDurationMs;
+    QElapsedTimer m_openTimer;
+    bool m_probeInFlight;
+    QElapsedTimer m_probeTimer;
+    Stats m_stats;
+    QString m_instanceId;
+    QDateTime m_startedAt;
+    QTimer* m_flushTimer;
+    bool m_logPruned;
+};
+
+#endif // AICIRCUITBREAKER_H
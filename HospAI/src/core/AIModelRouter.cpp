@@ -0,0 +1,252 @@
+#include "AIModelRouter.h"
+#include "ConversationContextBuilder.h"
+#include "DatabaseManager.h"
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+AIModelRouter* AIModelRouter::m_instance = nullptr;
+
+AIModelRouter* AIModelRouter::instance()
+{
+    if (!m_instance) {
+        m_instance = new AIModelRouter;
+    }
+    return m_instance;
+}
+
+AIModelRouter::AIModelRouter(QObject *parent)
+    : QObject(parent)
+    , m_configs(TIER_COUNT)
+    , m_stats(TIER_COUNT)
+    , m_logPruned(false)
+{
+    // 快速档短回复、低温度、超时短；大模型档保持原来的统一参数。
+    // 模型名为空时跟随 AIApiClient 的配置，部署时用环境变量指定各档的模型
+    TierConfig fast;
+    fast.model = qEnvironmentVariable("HOSPAI_AI_FAST_MODEL");
+    fast.maxTokens = 400;
+    fast.temperature = 0.3;
+    fast.timeoutMs = 8000;
+    m_configs[FastTier] = fast;
+
+    TierConfig large;
+    large.model = qEnvironmentVariable("HOSPAI_AI_LARGE_MODEL");
+    large.maxTokens = 1000;
+    large.temperature = 0.7;
+    large.timeoutMs = 15000;
+    m_configs[LargeTier] = large;
+}
+
+AIModelRouter::Decision AIModelRouter::route(const QString& input, const QString& history,
+                                             Tier requested, bool allowLocal) const
+{
+    return route(input, SymptomMatcher::instance()->match(input), history, requested, allowLocal);
+}
+
+AIModelRouter::Decision AIModelRouter::route(const QString& input, const SymptomMatcher::MatchResult& match,
+                                             const QString& history, Tier requested, bool allowLocal) const
+{
+    Decision decision;
+    decision.inputChars = input.trimmed().size();
+    decision.historyTokens = history.isEmpty() ? 0 : ConversationContextBuilder::estimateTokens(history);
+    decision.matchedCategory = match.bestCategory;
+    decision.matchScore = match.bestScore;
+    decision.confident = match.confident;
+    decision.emergency = match.emergency;
+    decision.urgent = match.urgent;
+
+    bool localPossible = allowLocal && match.confident;
+
+    if (requested != AutoTier) {
+        decision.tier = requested;
+        decision.reason = "调用方指定";
+        if (requested == LocalTier && !localPossible) {
+            decision.tier = FastTier;
+            decision.reason = "本地无法明确回答";
+        }
+        return decision;
+    }
+
+    // 与聊天窗口相同：词典明确匹配（含急症）直接本地回答，提到急症但不明确的交给大模型
+    if (localPossible) {
+        decision.tier = LocalTier;
+        decision.reason = "词典明确匹配";
+    } else if (match.emergency || match.urgent) {
+        decision.tier = LargeTier;
+        decision.reason = "急症或紧急描述";
+    } else if (decision.inputChars >= LARGE_MIN_INPUT_CHARS) {
+        decision.tier = LargeTier;
+        decision.reason = "描述较长";
+    } else if (decision.historyTokens >= LARGE_MIN_HISTORY_TOKENS) {
+        decision.tier = LargeTier;
+        decision.reason = "对话较长";
+    } else {
+        decision.tier = FastTier;
+        decision.reason = match.hasMatch() ? "症状不够明确" : "简短描述";
+    }
+    return decision;
+}
+
+AIModelRouter::TierConfig AIModelRouter::config(Tier tier) const
+{
+    if (tier < 0 || tier >= TIER_COUNT) {
+        return TierConfig();
+    }
+    return m_configs[tier];
+}
+
+void AIModelRouter::setConfig(Tier tier, const TierConfig& config)
+{
+    if (tier < 0 || tier >= TIER_COUNT) {
+        return;
+    }
+    m_configs[tier] = config;
+}
+
+void AIModelRouter::record(const Decision& decision, const Outcome& outcome)
+{
+    if (decision.tier < 0 || decision.tier >= TIER_COUNT) {
+        return;
+    }
+
+    TierStats& stats = m_stats[decision.tier];
+    stats.requests++;
+    if (outcome.success) {
+        stats.successes++;
+    } else {
+        stats.failures++;
+    }
+    if (outcome.fromCache) {
+        stats.cacheHits++;
+    }
+    stats.promptTokens += outcome.promptTokens;
+    stats.completionTokens += outcome.completionTokens;
+    stats.recentLatencies.append(outcome.latencyMs);
+    if (stats.recentLatencies.size() > LATENCY_SAMPLE_LIMIT) {
+        stats.recentLatencies.removeFirst();
+    }
+
+    // 命令行工具不打开数据库，只保留内存中的汇总
+    DatabaseManager* db = DatabaseManager::instance();
+    if (!db->isOpen()) {
+        return;
+    }
+
+    if (!m_logPruned) {
+        m_logPruned = true;
+        int removed = db->deleteAIRoutingRecordsBefore(QDateTime::currentDateTimeUtc().addDays(-LOG_RETENTION_DAYS));
+        if (removed > 0) {
+            qDebug() << "清理过期AI路由记录" << removed << "条";
+        }
+    }
+
+    TierConfig tierConfig = config(decision.tier);
+    AIRoutingRecord record;
+    record.createdAt = QDateTime::currentDateTimeUtc();
+    record.requestType = outcome.requestType;
+    record.tier = tierName(decision.tier);
+    record.model = outcome.model;
+    record.reason = decision.reason;
+    record.inputChars = decision.inputChars;
+    record.historyTokens = decision.historyTokens;
+    record.matchScore = decision.matchScore;
+    record.emergency = decision.emergency;
+    record.maxTokens = tierConfig.maxTokens;
+    record.timeoutMs = tierConfig.timeoutMs;
+    record.success = outcome.success;
+    record.timedOut = outcome.timedOut;
+    record.fromCache = outcome.fromCache;
+    record.latencyMs = outcome.latencyMs;
+    record.firstTokenMs = outcome.firstTokenMs;
+    record.attempts = outcome.attempts;
+    record.promptTokens = outcome.promptTokens;
+    record.completionTokens = outcome.completionTokens;
+    db->addAIRoutingRecord(record);
+
+    qDebug() << "AI路由:" << record.tier << decision.reason << "模型" << outcome.model
+             << "耗时" << outcome.latencyMs << "ms" << (outcome.success ? "成功" : "失败");
+}
+
+AIModelRouter::ChatStep AIModelRouter::classifyChatInput(const QString& input)
+{
+    SymptomMatcher* matcher = SymptomMatcher::instance();
+    ChatStep step;
+    step.match = matcher->match(input);
+    if (step.match.hasMatch() && matcher->category(step.match.bestCategory).action == "transfer") {
+        step.action = TransferChat;
+    } else if (step.match.confident) {
+        step.action = AnswerLocally;
+    }
+    return step;
+}
+
+void AIModelRouter::recordLocalAnswer(const QString& input, const SymptomMatcher::MatchResult& match, qint64 latencyMs)
+{
+    Decision decision = route(input, match, QString(), AutoTier, true);
+    if (decision.tier != LocalTier) {
+        return;
+    }
+
+    Outcome outcome;
+    outcome.requestType = "triage";
+    outcome.success = true;
+    outcome.latencyMs = latencyMs;
+    record(decision, outcome);
+}
+
+AIModelRouter::TierStats AIModelRouter::stats(Tier tier) const
+{
+    if (tier < 0 || tier >= TIER_COUNT) {
+        return TierStats();
+    }
+    return m_stats[tier];
+}
+
+qint64 AIModelRouter::TierStats::medianLatencyMs() const
+{
+    if (recentLatencies.isEmpty()) {
+        return -1;
+    }
+    QList<qint64> sorted = recentLatencies;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[(sorted.size() - 1) / 2];
+}
+
+QString AIModelRouter::tierName(Tier tier)
+{
+    switch (tier) {
+    case LocalTier:
+        return "local";
+    case FastTier:
+        return "fast";
+    case LargeTier:
+        return "large";
+    default:
+        return "auto";
+    }
+}
+
+AIModelRouter::Tier AIModelRouter::tierFromName(const QString& name)
+{
+    for (int tier = LocalTier; tier < TIER_COUNT; ++tier) {
+        if (name == tierName(Tier(tier))) {
+            return Tier(tier);
+        }
+    }
+    return AutoTier;
+}
+
+QString AIModelRouter::tierLabel(Tier tier)
+{
+    switch (tier) {
+    case LocalTier:
+        return "本地规则";
+    case FastTier:
+        return "快速模型";
+    case LargeTier:
+        return "大模型";
+    default:
+        return "自动";
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef AIMODELROUTER_H
+#define AIMODELROUTER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include "SymptomMatcher.h"
+
+// AI请求按复杂度分档：词典能明确回答的走本地规则，简短清楚的描述走快速小模型，
+// 急症、描述或对话较长的走大模型。每个档位有各自的模型、max_tokens、温度和超时。
+// 每次路由的依据和结果写入 ai_routing_log 供统计页显示，内存中另按档位汇总本进程的情况
+class AIModelRouter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Tier {
+        AutoTier = -1,   // 只用于请求参数，表示按复杂度选择
+        LocalTier,
+        FastTier,
+        LargeTier
+    };
+
+    static constexpr int TIER_COUNT = 3;
+    // 超过这些阈值时走大模型
+    static constexpr int LARGE_MIN_INPUT_CHARS = 80;
+    static constexpr int LARGE_MIN_HISTORY_TOKENS = 600;
+    static constexpr int LATENCY_SAMPLE_LIMIT = 200;   // 每档保留的最近耗时样本数
+    static constexpr int LOG_RETENTION_DAYS = 30;
+
+    struct TierConfig {
+        QString model;          // 为空时使用 AIApiClient 当前配置的模型
+        int maxTokens = 0;
+        double temperature = 0.7;
+        int timeoutMs = 0;
+    };
+
+    // 一次路由决定及其依据
+    struct Decision {
+        Tier tier = LargeTier;
+        QString reason;
+        int inputChars = 0;
+        int historyTokens = 0;
+        int matchedCategory = -1;
+        double matchScore = 0.0;
+        bool confident = false;
+        bool emergency = false;
+        bool urgent = false;
+    };
+
+    // 请求结束后的结果，token数为估算值，缓存和本地回答不计
+    struct Outcome {
+        QString requestType;
+        QString model;
+        bool success = false;
+        bool timedOut = false;
+        bool fromCache = false;
+        qint64 latencyMs = 0;       // 含排队，即调用方实际等待的时间
+        qint64 firstTokenMs = -1;
+        int attempts = 0;
+        int promptTokens = 0;
+        int completionTokens = 0;
+    };
+
+    // 聊天时患者每句话的第一步：转人工、按词典本地回答，还是请求AI
+    enum ChatAction {
+        TransferChat,
+        AnswerLocally,
+        AskAI
+    };
+
+    struct ChatStep {
+        ChatAction action = AskAI;
+        SymptomMatcher::MatchResult match;
+    };
+
+    struct TierStats {
+        int requests = 0;
+        int successes = 0;
+        int failures = 0;
+        int cacheHits = 0;
+        qint64 promptTokens = 0;
+        qint64 completionTokens = 0;
+        QList<qint64> recentLatencies;
+
+        qint64 medianLatencyMs() const;
+    };
+
+    static AIModelRouter* instance();
+
+    // allowLocal 为 false 时不走本地档（如症状分析、科室推荐需要完整的AI回复）。
+    // 调用方指定档位时跳过分类；指定本地档但词典没有明确匹配时改走快速模型
+    Decision route(const QString& input, const QString& history, Tier requested, bool allowLocal) const;
+    Decision route(const QString& input, const SymptomMatcher::MatchResult& match,
+                   const QString& history, Tier requested, bool allowLocal) const;
+
+    // 聊天窗口和分诊压测共用，保证压测走的是实际的聊天流程
+    static ChatStep classifyChatInput(const QString& input);
+
+    TierConfig config(Tier tier) const;
+    void setConfig(Tier tier, const TierConfig& config);
+
+    void record(const Decision& decision, const Outcome& outcome);
+    // 聊天窗口不经 AIApiClient 直接本地回答时调用，使路由记录覆盖全部咨询
+    void recordLocalAnswer(const QString& input, const SymptomMatcher::MatchResult& match, qint64 latencyMs);
+
+    TierStats stats(Tier tier) const;
+    static QString tierName(Tier tier);    // 写入记录用：local/fast/large
+    static QString tierLabel(Tier tier);   // 界面显示用
+    static Tier tierFromName(const QString& name);   // 无法识别时为 AutoTier
+
+private:
+    explicit AIModelRouter(QObject *parent = nullptr);
+
+    static AIModelRouter* m_instance;
+
+    QVector<TierConfig> m_configs;
+    QVector<TierStats> m_stats;
+    bool m_logPruned;
+};
+
+#endif // AIMODELROUTER_H
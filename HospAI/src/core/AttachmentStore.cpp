@@ -0,0 +1,188 @@
+#include "AttachmentStore.h"
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QMimeDatabase>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+AttachmentStore* AttachmentStore::m_instance = nullptr;
+
+const QString AttachmentStore::URL_SCHEME = "attachment";
+
+// SHA-256 十六进制长度
+static const int HASH_LENGTH = 64;
+
+AttachmentStore* AttachmentStore::instance()
+{
+    if (!m_instance) {
+        m_instance = new AttachmentStore;
+    }
+    return m_instance;
+}
+
+AttachmentStore::AttachmentStore(QObject *parent)
+    : QObject(parent)
+{
+    m_blobDir = getBlobDir();
+}
+
+QString AttachmentStore::getBlobDir()
+{
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString blobPath = dataPath + "/attachments";
+    QDir dir(blobPath);
+    if (!dir.exists()) {
+        dir.mkpath(blobPath);
+    }
+    return blobPath;
+}
+
+QString AttachmentStore::blobPath(const QString& hash) const
+{
+    // 按前两位分目录，避免单目录文件过多
+    return QString("%1/%2/%3").arg(m_blobDir, hash.left(2), hash);
+}
+
+QString AttachmentStore::storeFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "AttachmentStore: 无法读取文件" << filePath;
+        return QString();
+    }
+
+    QByteArray data = file.readAll();
+    QString mimeType = QMimeDatabase().mimeTypeForFileNameAndData(filePath, data).name();
+
+    return storeData(data, mimeType, QFileInfo(filePath).fileName());
+}
+
+QString AttachmentStore::storeData(const QByteArray& data, const QString& mimeType, const QString& fileName)
+{
+    if (data.isEmpty()) {
+        return QString();
+    }
+
+    QString hash = QString(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+    QString path = blobPath(hash);
+
+    // 内容已存在则直接复用
+    if (!QFileInfo::exists(path)) {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        QSaveFile blob(path);
+        if (!blob.open(QIODevice::WriteOnly) || blob.write(data) != data.size() || !blob.commit()) {
+            qDebug() << "AttachmentStore: 写入附件失败" << path;
+            return QString();
+        }
+    }
+
+    DatabaseManager::instance()->addAttachment(hash, mimeType, fileName, data.size());
+
+    qDebug() << "AttachmentStore: 附件已保存" << hash.left(12) << "大小:" << data.size();
+    return hash;
+}
+
+bool AttachmentStore::contains(const QString& hash) const
+{
+    return hash.length() == HASH_LENGTH && QFileInfo::exists(blobPath(hash));
+}
+
+QByteArray AttachmentStore::loadData(const QString& hash) const
+{
+    if (hash.length() != HASH_LENGTH) {
+        return QByteArray();
+    }
+
+    QFile file(blobPath(hash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "AttachmentStore: 附件不存在" << hash.left(12);
+        return QByteArray();
+    }
+
+    return file.readAll();
+}
+
+QString AttachmentStore::exportToTemp(const QString& hash)
+{
+    if (!contains(hash)) {
+        return QString();
+    }
+
+    AttachmentInfo info = DatabaseManager::instance()->getAttachmentInfo(hash);
+    QString fileName = info.fileName.isEmpty() ? hash : info.fileName;
+
+    QString exportDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation)
+                        + "/HospAI/" + hash.left(12);
+    QDir().mkpath(exportDir);
+
+    QString exportPath = exportDir + "/" + fileName;
+    if (!QFileInfo::exists(exportPath) && !QFile::copy(blobPath(hash), exportPath)) {
+        return QString();
+    }
+
+    return exportPath;
+}
+
+QUrl AttachmentStore::attachmentUrl(const QString& hash)
+{
+    return QUrl(URL_SCHEME + ":" + hash);
+}
+
+QString AttachmentStore::hashFromUrl(const QUrl& url)
+{
+    if (url.scheme() != URL_SCHEME) {
+        return QString();
+    }
+
+    QString hash = url.path();
+    return hash.length() == HASH_LENGTH ? hash : QString();
+}
+
+QStringList AttachmentStore::extractReferences(const QString& html)
+{
+    QStringList hashes;
+    const QString prefix = URL_SCHEME + ":";
+
+    int pos = html.indexOf(prefix);
+    while (pos >= 0) {
+        int start = pos + prefix.length();
+        QString hash = html.mid(start, HASH_LENGTH);
+
+        bool isHex = hash.length() == HASH_LENGTH;
+        for (int i = 0; isHex && i < hash.length(); ++i) {
+            QChar c = hash.at(i);
+            isHex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+        }
+
+        if (isHex && !hashes.contains(hash)) {
+            hashes.append(hash);
+        }
+
+        pos = html.indexOf(prefix, start);
+    }
+
+    return hashes;
+}
+
+int AttachmentStore::collectGarbage(int graceHours)
+{
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-3600LL * graceHours);
+
+    int removed = 0;
+    for (const QString& hash : dbManager->getUnreferencedAttachments(cutoff)) {
+        if (dbManager->deleteAttachment(hash)) {
+            QFile::remove(blobPath(hash));
+            ++removed;
+        }
+    }
+
+    if (removed > 0) {
+        qDebug() << "AttachmentStore: 清理未引用附件" << removed << "个";
+    }
+    return removed;
+}
@@ -0,0 +1,52 @@
+#ifndef ATTACHMENTSTORE_H
+#define ATTACHMENTSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QUrl>
+#include "DatabaseManager.h"
+
+// 附件存储：文件按SHA-256内容哈希保存在本地blob目录，
+// 消息中只保存 "attachment:<hash>" 引用，显示时再按需读取
+class AttachmentStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AttachmentStore* instance();
+
+    static const QString URL_SCHEME;
+
+    // 保存附件，返回内容哈希；相同内容只存一份
+    QString storeFile(const QString& filePath);
+    QString storeData(const QByteArray& data, const QString& mimeType, const QString& fileName = "");
+
+    // 按需读取
+    bool contains(const QString& hash) const;
+    QByteArray loadData(const QString& hash) const;
+    QString blobPath(const QString& hash) const;
+
+    // 导出为带原始文件名的临时副本，便于用系统程序打开
+    QString exportToTemp(const QString& hash);
+
+    // 引用格式
+    static QUrl attachmentUrl(const QString& hash);
+    static QString hashFromUrl(const QUrl& url);
+    static QStringList extractReferences(const QString& html);
+
+    // 清理上传后超过 graceHours 仍未被任何消息引用的附件（发送失败或取消发送），返回删除数量；
+    // 消息不会被删除，被引用过的附件一直保留
+    int collectGarbage(int graceHours = 24);
+
+private:
+    explicit AttachmentStore(QObject *parent = nullptr);
+
+    QString getBlobDir();
+
+    static AttachmentStore* m_instance;
+    QString m_blobDir;
+};
+
+#endif // ATTACHMENTSTORE_H
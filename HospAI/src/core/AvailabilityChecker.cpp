@@ -0,0 +1,130 @@
+#include "AvailabilityChecker.h"
+#include "DatabaseManager.h"
+#include <QDebug>
+#include <utility>
+
+AvailabilityChecker* AvailabilityChecker::m_instance = nullptr;
+
+AvailabilityChecker* AvailabilityChecker::instance()
+{
+    if (!m_instance) {
+        m_instance = new AvailabilityChecker;
+    }
+    return m_instance;
+}
+
+AvailabilityChecker::AvailabilityChecker(QObject *parent)
+    : QObject(parent)
+    , m_filtersReady(false)
+    , m_filtersLoading(false)
+{
+    // 单个后台线程，注册期间复用同一个只读连接；空闲后线程退出，连接随之移除
+    m_threadPool.setMaxThreadCount(1);
+    m_threadPool.setExpiryTimeout(READER_IDLE_TIMEOUT_MS);
+
+    m_usernameTimer.setSingleShot(true);
+    m_usernameTimer.setInterval(DEBOUNCE_MS);
+    connect(&m_usernameTimer, &QTimer::timeout, this, [this]() { runCheck(Username); });
+
+    m_emailTimer.setSingleShot(true);
+    m_emailTimer.setInterval(DEBOUNCE_MS);
+    connect(&m_emailTimer, &QTimer::timeout, this, [this]() { runCheck(Email); });
+
+    connect(DatabaseManager::instance(), &DatabaseManager::userRegistered,
+            this, &AvailabilityChecker::onUserRegistered);
+}
+
+void AvailabilityChecker::prepare()
+{
+    if (m_filtersReady || m_filtersLoading) {
+        return;
+    }
+    m_filtersLoading = true;
+
+    m_threadPool.start([this]() {
+        DatabaseManager* db = DatabaseManager::instance();
+        int userCount = db->getUserCount();
+
+        BloomFilter usernames(userCount);
+        BloomFilter emails(userCount);
+        db->forEachUserIdentity([&usernames, &emails](const QString& username, const QString& email) {
+            usernames.insert(username);
+            if (!email.isEmpty()) {
+                emails.insert(email);
+            }
+        });
+
+        QMetaObject::invokeMethod(this, [this, usernames = std::move(usernames), emails = std::move(emails), userCount]() mutable {
+            m_usernameFilter = std::move(usernames);
+            m_emailFilter = std::move(emails);
+            for (const QString& username : m_registeredUsernames) {
+                m_usernameFilter.insert(username);
+            }
+            for (const QString& email : m_registeredEmails) {
+                m_emailFilter.insert(email);
+            }
+            m_registeredUsernames.clear();
+            m_registeredEmails.clear();
+
+            m_filtersLoading = false;
+            m_filtersReady = true;
+            qDebug() << "AvailabilityChecker: 查重过滤器已就绪，用户数" << userCount;
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AvailabilityChecker::check(Field field, const QString& value)
+{
+    prepare();
+
+    // 重新计时，只检查停顿后的最后一个值
+    if (field == Username) {
+        m_pendingUsername = value;
+        m_usernameTimer.start();
+    } else {
+        m_pendingEmail = value;
+        m_emailTimer.start();
+    }
+}
+
+void AvailabilityChecker::runCheck(Field field)
+{
+    QString value = field == Username ? m_pendingUsername : m_pendingEmail;
+    const BloomFilter& filter = field == Username ? m_usernameFilter : m_emailFilter;
+
+    // 过滤器确定不存在，不用查库
+    if (m_filtersReady && !filter.mightContain(value)) {
+        emit availabilityChecked(field, value, true);
+        return;
+    }
+
+    queryDatabase(field, value);
+}
+
+void AvailabilityChecker::queryDatabase(Field field, const QString& value)
+{
+    m_threadPool.start([this, field, value]() {
+        DatabaseManager* db = DatabaseManager::instance();
+        bool exists = field == Username ? db->isUsernameExists(value) : db->isEmailExists(value);
+
+        QMetaObject::invokeMethod(this, [this, field, value, exists]() {
+            emit availabilityChecked(field, value, !exists);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AvailabilityChecker::onUserRegistered(const QString& username, const QString& email)
+{
+    if (m_filtersLoading) {
+        m_registeredUsernames.append(username);
+        if (!email.isEmpty()) {
+            m_registeredEmails.append(email);
+        }
+        return;
+    }
+
+    m_usernameFilter.insert(username);
+    if (!email.isEmpty()) {
+        m_emailFilter.insert(email);
+    }
+}
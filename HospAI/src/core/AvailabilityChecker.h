@@ -0,0 +1,62 @@
+#ifndef AVAILABILITYCHECKER_H
+#define AVAILABILITYCHECKER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QThreadPool>
+#include "BloomFilter.h"
+
+// 注册时的用户名/邮箱查重：输入停顿后才检查，先查内存中的布隆过滤器，
+// 确定不存在时直接返回可用；只有可能存在时才在后台线程按索引查库确认
+class AvailabilityChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Field {
+        Username,
+        Email
+    };
+
+    static AvailabilityChecker* instance();
+
+    // 输入停顿多久后开始检查
+    static const int DEBOUNCE_MS = 250;
+    static const int READER_IDLE_TIMEOUT_MS = 60000;   // 后台线程空闲多久后退出
+
+    // 提前在后台构建过滤器（打开注册界面时调用）
+    void prepare();
+    // 同一字段只检查最后一次提交的值，结果通过 availabilityChecked 返回
+    void check(Field field, const QString& value);
+
+signals:
+    void availabilityChecked(AvailabilityChecker::Field field, const QString& value, bool available);
+
+private:
+    explicit AvailabilityChecker(QObject *parent = nullptr);
+
+    void runCheck(Field field);
+    void queryDatabase(Field field, const QString& value);
+    void onUserRegistered(const QString& username, const QString& email);
+
+    static AvailabilityChecker* m_instance;
+
+    BloomFilter m_usernameFilter;
+    BloomFilter m_emailFilter;
+    bool m_filtersReady;
+    bool m_filtersLoading;
+    // 过滤器构建期间注册的账号，构建完成后补进去
+    QStringList m_registeredUsernames;
+    QStringList m_registeredEmails;
+
+    QTimer m_usernameTimer;
+    QTimer m_emailTimer;
+    QString m_pendingUsername;
+    QString m_pendingEmail;
+
+    QThreadPool m_threadPool;
+};
+
+#endif // AVAILABILITYCHECKER_H
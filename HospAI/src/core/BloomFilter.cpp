@@ -0,0 +1,52 @@
+#include "BloomFilter.h"
+#include <QHash>
+#include <QtMath>
+
+// 两个固定种子，用双重哈希模拟 k 个哈希函数
+static const size_t HASH_SEED_1 = 0x9E3779B9u;
+static const size_t HASH_SEED_2 = 0x85EBCA6Bu;
+
+BloomFilter::BloomFilter(int expectedCount, double falsePositiveRate)
+    : m_insertedCount(0)
+{
+    // m = -n*ln(p)/(ln2)^2，k = m/n*ln2；至少 64K 位，给新注册留余量
+    double n = qMax(expectedCount, 1024);
+    double bits = -n * qLn(falsePositiveRate) / (M_LN2 * M_LN2);
+    m_bitCount = qMax<quint64>(quint64(qCeil(bits)), 65536);
+    m_hashCount = qBound(1, qRound(double(m_bitCount) / n * M_LN2), 16);
+    m_bits = QVector<quint64>(int((m_bitCount + 63) / 64), 0);
+}
+
+quint64 BloomFilter::bitIndex(size_t h1, size_t h2, int i) const
+{
+    return (quint64(h1) + quint64(i) * quint64(h2)) % m_bitCount;
+}
+
+void BloomFilter::insert(const QString& value)
+{
+    size_t h1 = qHash(value, HASH_SEED_1);
+    size_t h2 = qHash(value, HASH_SEED_2) | 1;
+    for (int i = 0; i < m_hashCount; ++i) {
+        quint64 index = bitIndex(h1, h2, i);
+        m_bits[int(index / 64)] |= (quint64(1) << (index % 64));
+    }
+    ++m_insertedCount;
+}
+
+bool BloomFilter::mightContain(const QString& value) const
+{
+    size_t h1 = qHash(value, HASH_SEED_1);
+    size_t h2 = qHash(value, HASH_SEED_2) | 1;
+    for (int i = 0; i < m_hashCount; ++i) {
+        quint64 index = bitIndex(h1, h2, i);
+        if (!(m_bits.at(int(index / 64)) & (quint64(1) << (index % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BloomFilter::isEmpty() const
+{
+    return m_insertedCount == 0;
+}
@@ -0,0 +1,27 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <QString>
+#include <QVector>
+
+// 布隆过滤器：mightContain 返回 false 时一定不存在，返回 true 时可能存在（需再查库确认）
+class BloomFilter
+{
+public:
+    // 按预计元素数和期望误判率计算位数组大小和哈希次数
+    explicit BloomFilter(int expectedCount = 0, double falsePositiveRate = 0.01);
+
+    void insert(const QString& value);
+    bool mightContain(const QString& value) const;
+    bool isEmpty() const;
+
+private:
+    quint64 bitIndex(size_t h1, size_t h2, int i) const;
+
+    QVector<quint64> m_bits;
+    quint64 m_bitCount;
+    int m_hashCount;
+    int m_insertedCount;
+};
+
+#endif // BLOOMFILTER_H
@@ -0,0 +1,40 @@
+#include "ChatHistoryLoader.h"
+
+ChatHistoryLoader* ChatHistoryLoader::m_instance = nullptr;
+
+ChatHistoryLoader* ChatHistoryLoader::instance()
+{
+    if (!m_instance) {
+        m_instance = new ChatHistoryLoader;
+    }
+    return m_instance;
+}
+
+ChatHistoryLoader::ChatHistoryLoader(QObject *parent)
+    : QObject(parent)
+{
+    // 只用一个线程，连续翻页时复用同一个只读连接，请求按顺序执行。
+    // 空闲一段时间后线程退出，连接随之移除
+    m_threadPool.setMaxThreadCount(1);
+    m_threadPool.setExpiryTimeout(READER_IDLE_TIMEOUT_MS);
+}
+
+QList<ChatMessage> ChatHistoryLoader::loadLatestPage(int sessionId)
+{
+    return DatabaseManager::instance()->getChatMessagesBefore(sessionId, 0, PAGE_SIZE);
+}
+
+void ChatHistoryLoader::loadOlderPage(int sessionId, int beforeMessageId, QObject* context, const PageCallback& callback)
+{
+    QPointer<QObject> guard(context);
+    
+    m_threadPool.start([this, sessionId, beforeMessageId, guard, callback]() {
+        QList<ChatMessage> messages = DatabaseManager::instance()->getChatMessagesBefore(sessionId, beforeMessageId, PAGE_SIZE);
+        
+        QMetaObject::invokeMethod(this, [guard, callback, messages]() {
+            if (guard) {
+                callback(messages);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,39 @@
+#ifndef CHATHISTORYLOADER_H
+#define CHATHISTORYLOADER_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QThreadPool>
+#include <functional>
+#include "DatabaseManager.h"
+
+// 聊天历史分页加载：在单独的读取线程上查询更早的一页消息，
+// 完成后回到主线程回调；回调对象已销毁时结果直接丢弃
+class ChatHistoryLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ChatHistoryLoader* instance();
+
+    // 每页消息条数，首屏和向上翻页都按这个大小读取
+    static const int PAGE_SIZE = 50;
+    static const int READER_IDLE_TIMEOUT_MS = 60000;   // 读取线程空闲多久后退出
+
+    using PageCallback = std::function<void(const QList<ChatMessage>& messages)>;
+
+    // 首屏：同步读取最新一页（有索引，耗时与会话总长度无关）
+    QList<ChatMessage> loadLatestPage(int sessionId);
+    // 向上翻页：异步读取 beforeMessageId 之前的一页
+    void loadOlderPage(int sessionId, int beforeMessageId, QObject* context, const PageCallback& callback);
+
+private:
+    explicit ChatHistoryLoader(QObject *parent = nullptr);
+
+    static ChatHistoryLoader* m_instance;
+
+    QThreadPool m_threadPool;
+};
+
+#endif // CHATHISTORYLOADER_H
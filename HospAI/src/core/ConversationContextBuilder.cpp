@@ -0,0 +1,279 @@
+#include "ConversationContextBuilder.h"
+#include "SymptomMatcher.h"
+#include <QRegularExpression>
+#include <algorithm>
+
+// 助手回复往往很长，原文窗口内只保留开头部分
+static const int MAX_ASSISTANT_CHARS = 150;
+// 摘要最多占预算的一半
+static const int SUMMARY_BUDGET_DIVISOR = 2;
+
+ConversationContextBuilder::ConversationContextBuilder()
+    : m_factCount(0)
+    , m_tokenBudget(DEFAULT_TOKEN_BUDGET)
+    , m_recentTurnLimit(DEFAULT_RECENT_TURNS)
+    , m_cachedSummaryFacts(-1)
+    , m_lastBuildTokens(0)
+{
+}
+
+void ConversationContextBuilder::addTurn(Speaker speaker, const QString& text)
+{
+    Turn turn;
+    turn.speaker = speaker;
+    turn.text = text.trimmed();
+    if (turn.text.isEmpty()) {
+        return;
+    }
+    turn.tokens = estimateTokens(formatTurn(turn, speaker == Assistant ? MAX_ASSISTANT_CHARS : -1));
+
+    // 要点在加入时提取一次并追加到各类摘要片段，之后拼装时不再重新扫描历史
+    m_turnFactStarts.append(m_factCount);
+    collectFacts(turn);
+    m_turns.append(turn);
+}
+
+void ConversationContextBuilder::clear()
+{
+    m_turns.clear();
+    m_turnFactStarts.clear();
+    m_kindSummaries.clear();
+    m_factKeys.clear();
+    m_factCount = 0;
+    m_cachedSummaryFacts = -1;
+    m_cachedSummary.clear();
+    m_lastBuildTokens = 0;
+}
+
+int ConversationContextBuilder::turnCount() const
+{
+    return m_turns.size();
+}
+
+void ConversationContextBuilder::setTokenBudget(int tokens)
+{
+    m_tokenBudget = qMax(0, tokens);
+}
+
+int ConversationContextBuilder::tokenBudget() const
+{
+    return m_tokenBudget;
+}
+
+void ConversationContextBuilder::setRecentTurnLimit(int turns)
+{
+    m_recentTurnLimit = qMax(0, turns);
+}
+
+int ConversationContextBuilder::estimateTokens(const QString& text)
+{
+    int tokens = 0;
+    int otherChars = 0;
+    for (const QChar& ch : text) {
+        if (ch.unicode() >= 0x2E80) {
+            // 汉字和全角符号
+            tokens++;
+        } else if (!ch.isSpace()) {
+            otherChars++;
+        }
+    }
+    return tokens + (otherChars + 3) / 4;
+}
+
+QString ConversationContextBuilder::tailWithinTokens(const QString& text, int maxTokens)
+{
+    int tokens = 0;
+    int otherChars = 0;
+    int start = text.size();
+    while (start > 0) {
+        QChar ch = text.at(start - 1);
+        int nextTokens = tokens;
+        int nextOtherChars = otherChars;
+        if (ch.unicode() >= 0x2E80) {
+            nextTokens++;
+        } else if (!ch.isSpace()) {
+            nextOtherChars++;
+        }
+        if (nextTokens + (nextOtherChars + 3) / 4 > maxTokens) {
+            break;
+        }
+        tokens = nextTokens;
+        otherChars = nextOtherChars;
+        --start;
+    }
+    return text.mid(start);
+}
+
+int ConversationContextBuilder::lastBuildTokens() const
+{
+    return m_lastBuildTokens;
+}
+
+void ConversationContextBuilder::collectFacts(const Turn& turn)
+{
+    if (turn.speaker == Assistant) {
+        static const QRegularExpression departmentPattern(
+            QStringLiteral("(?:建议|推荐)[^。\\n]{0,8}?([\\x{4e00}-\\x{9fa5}]{1,5}科)"));
+        QRegularExpressionMatchIterator it = departmentPattern.globalMatch(turn.text);
+        while (it.hasNext()) {
+            addFact("已建议科室", it.next().captured(1));
+        }
+        return;
+    }
+
+    // 症状词条复用分诊词典
+    SymptomMatcher* matcher = SymptomMatcher::instance();
+    SymptomMatcher::MatchResult match = matcher->match(turn.text);
+    for (const SymptomMatcher::TermMatch& termMatch : match.matches) {
+        const SymptomMatcher::Category& category = matcher->category(termMatch.category);
+        if (category.emergency || !category.department.isEmpty()) {
+            addFact("症状", matcher->termText(termMatch.term));
+        }
+    }
+
+    static const QRegularExpression temperaturePattern(
+        QStringLiteral("(\\d{2}(?:\\.\\d)?)\\s*(?:度|℃|°C)"));
+    static const QRegularExpression pressurePattern(
+        QStringLiteral("(\\d{2,3}\\s*/\\s*\\d{2,3})"));
+    static const QRegularExpression durationPattern(
+        QStringLiteral("((?:\\d+|[一二两三四五六七八九十半几]+)\\s*(?:个)?(?:小时|天|周|星期|个月|年))"));
+    static const QRegularExpression agePattern(
+        QStringLiteral("(\\d{1,3})\\s*(?:岁|周岁)"));
+
+    QRegularExpressionMatchIterator it = temperaturePattern.globalMatch(turn.text);
+    while (it.hasNext()) {
+        addFact("体温", it.next().captured(1) + "度");
+    }
+    it = pressurePattern.globalMatch(turn.text);
+    while (it.hasNext()) {
+        addFact("血压", it.next().captured(1).remove(' '));
+    }
+    it = durationPattern.globalMatch(turn.text);
+    while (it.hasNext()) {
+        addFact("持续时间", it.next().captured(1).remove(' '));
+    }
+    it = agePattern.globalMatch(turn.text);
+    while (it.hasNext()) {
+        addFact("年龄", it.next().captured(1) + "岁");
+    }
+}
+
+void ConversationContextBuilder::addFact(const QString& kind, const QString& value)
+{
+    if (value.isEmpty()) {
+        return;
+    }
+    QString key = kind + '\n' + value;
+    if (m_factKeys.contains(key)) {
+        return;
+    }
+    m_factKeys.insert(key);
+
+    // 追加到该类的片段末尾，记下追加后的长度，取前缀时按要点编号截取
+    auto it = std::find_if(m_kindSummaries.begin(), m_kindSummaries.end(), [&kind](const KindSummary& summary) {
+        return summary.kind == kind;
+    });
+    if (it == m_kindSummaries.end()) {
+        KindSummary summary;
+        summary.kind = kind;
+        summary.text = kind + "：";
+        m_kindSummaries.append(summary);
+        it = m_kindSummaries.end() - 1;
+    } else {
+        it->text += "、";
+    }
+    it->text += value;
+    it->factIndices.append(m_factCount);
+    it->textLengths.append(it->text.size());
+    m_factCount++;
+}
+
+QString ConversationContextBuilder::summaryBefore(int firstIncludedTurn) const
+{
+    // 窗口之前的要点是编号小于 factCount 的前缀
+    int factCount = firstIncludedTurn < m_turnFactStarts.size() ? m_turnFactStarts[firstIncludedTurn] : m_factCount;
+    if (factCount == m_cachedSummaryFacts) {
+        return m_cachedSummary;
+    }
+
+    // 各类按首次出现的顺序排列，某类的首个要点不在前缀内时后面的类也不在
+    QStringList parts;
+    for (const KindSummary& summary : m_kindSummaries) {
+        int values = int(std::lower_bound(summary.factIndices.begin(), summary.factIndices.end(), factCount)
+                         - summary.factIndices.begin());
+        if (values == 0) {
+            break;
+        }
+        parts.append(summary.text.left(summary.textLengths[values - 1]));
+    }
+
+    m_cachedSummaryFacts = factCount;
+    m_cachedSummary = parts.isEmpty() ? QString() : "早前对话要点：" + parts.join("；") + "\n";
+    return m_cachedSummary;
+}
+
+QString ConversationContextBuilder::summary() const
+{
+    return summaryBefore(m_turns.size());
+}
+
+QString ConversationContextBuilder::formatTurn(const Turn& turn, int maxChars)
+{
+    QString text = turn.text;
+    if (maxChars > 0 && text.size() > maxChars) {
+        text = text.left(maxChars) + "…";
+    }
+    return (turn.speaker == Patient ? "患者：" : "AI助手：") + text + "\n";
+}
+
+QString ConversationContextBuilder::build(int excludeLastTurns) const
+{
+    return build(m_tokenBudget, excludeLastTurns);
+}
+
+QString ConversationContextBuilder::build(int tokenBudget, int excludeLastTurns) const
+{
+    int end = qMax(0, m_turns.size() - qMax(0, excludeLastTurns));
+    int summaryLimit = tokenBudget / SUMMARY_BUDGET_DIVISOR;
+
+    // 从最新一轮往前加入原文，每多一轮就重新核算摘要加原文是否仍在预算内
+    int first = end;
+    int turnTokens = 0;
+    QString bestSummary = summaryBefore(end);
+    while (first > 0 && end - first < m_recentTurnLimit) {
+        int candidate = first - 1;
+        int candidateTokens = turnTokens + m_turns[candidate].tokens;
+        QString candidateSummary = summaryBefore(candidate);
+        int summaryTokens = qMin(estimateTokens(candidateSummary), summaryLimit);
+        if (candidateTokens + summaryTokens > tokenBudget) {
+            break;
+        }
+        first = candidate;
+        turnTokens = candidateTokens;
+        bestSummary = candidateSummary;
+    }
+
+    // 摘要超出上限时截断，汉字约一字一token
+    if (estimateTokens(bestSummary) > summaryLimit) {
+        bestSummary = bestSummary.left(summaryLimit) + "…\n";
+    }
+
+    QString context = bestSummary;
+    for (int i = first; i < end; ++i) {
+        const Turn& turn = m_turns[i];
+        context += formatTurn(turn, turn.speaker == Assistant ? MAX_ASSISTANT_CHARS : -1);
+    }
+
+    // 最新一轮本身就超出预算时用剩余预算保留它的结尾部分，说话人前缀不截掉
+    if (first == end && end > 0) {
+        const Turn& turn = m_turns[end - 1];
+        QString prefix = (turn.speaker == Patient ? "患者：" : "AI助手：") + QString("…");
+        int remaining = tokenBudget - estimateTokens(bestSummary) - estimateTokens(prefix);
+        if (remaining > 0) {
+            context += prefix + tailWithinTokens(turn.text, remaining) + "\n";
+        }
+    }
+
+    m_lastBuildTokens = estimateTokens(context);
+    return context;
+}
@@ -0,0 +1,83 @@
+#ifndef CONVERSATIONCONTEXTBUILDER_H
+#define CONVERSATIONCONTEXTBUILDER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QSet>
+
+// 对话上下文构建：按token预算拼装发给AI的历史。
+// 最近几轮原文保留，更早的轮次增量折叠进摘要，摘要只保留症状、体温、
+// 持续时间、年龄、已建议科室等临床要点，长对话的提示词大小保持稳定
+class ConversationContextBuilder
+{
+public:
+    enum Speaker {
+        Patient,
+        Assistant
+    };
+
+    static constexpr int DEFAULT_TOKEN_BUDGET = 600;
+    static constexpr int DEFAULT_RECENT_TURNS = 6;
+
+    ConversationContextBuilder();
+
+    void addTurn(Speaker speaker, const QString& text);
+    void clear();
+    int turnCount() const;
+
+    void setTokenBudget(int tokens);
+    int tokenBudget() const;
+    // 原文最多保留的轮数，更早的轮次只以要点形式进入摘要
+    void setRecentTurnLimit(int turns);
+
+    // 在预算内拼装上下文；excludeLastTurns 用于跳过已单独放进提示词的当前提问
+    QString build(int excludeLastTurns = 0) const;
+    QString build(int tokenBudget, int excludeLastTurns) const;
+    // 全部要点的摘要
+    QString summary() const;
+
+    // 粗略估算：汉字约1个token，其余字符约4个一个token
+    static int estimateTokens(const QString& text);
+    // 最近一次 build 的估算token数
+    int lastBuildTokens() const;
+
+private:
+    struct Turn {
+        Speaker speaker;
+        QString text;
+        int tokens;
+    };
+
+    // 一类临床要点的摘要片段（如 "症状：头痛、发烧"），要点按首次出现的顺序追加。
+    // 要点按轮次先后编号，窗口之前的摘要就是编号小于某个值的要点，
+    // 每类取片段的前缀即可，不必重新扫描全部要点
+    struct KindSummary {
+        QString kind;
+        QString text;
+        QList<int> factIndices;  // 每个值的要点编号
+        QList<int> textLengths;  // 追加每个值之后 text 的长度
+    };
+
+    void collectFacts(const Turn& turn);
+    void addFact(const QString& kind, const QString& value);
+    QString summaryBefore(int firstIncludedTurn) const;
+    static QString formatTurn(const Turn& turn, int maxChars);
+    // 按 estimateTokens 的算法从结尾往前保留不超过 maxTokens 的部分
+    static QString tailWithinTokens(const QString& text, int maxTokens);
+
+    QList<Turn> m_turns;
+    QList<int> m_turnFactStarts;   // 每轮加入时已有的要点数
+    QList<KindSummary> m_kindSummaries;
+    QSet<QString> m_factKeys;      // 去重用：类别 + 值
+    int m_factCount;
+    int m_tokenBudget;
+    int m_recentTurnLimit;
+
+    // 按要点数缓存最近一次拼出的摘要，窗口移动但没有跨过新要点时直接复用
+    mutable int m_cachedSummaryFacts;
+    mutable QString m_cachedSummary;
+    mutable int m_lastBuildTokens;
+};
+
+#endif // CONVERSATIONCONTEXTBUILDER_H
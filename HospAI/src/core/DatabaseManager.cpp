@@ -3,6 +3,9 @@
 #include <QDir>
 #include <QDebug>
 #include <QSqlRecord>
+#include <QThread>
+#include "StringPool.h"
+#include "StartupProfiler.h"
 
 DatabaseManager* DatabaseManager::m_instance = nullptr;
 
@@ -30,16 +33,27 @@ bool DatabaseManager::initDatabase()
     QString dbPath = getDbPath();
     
     // 创建数据库连接
-    m_database = QSqlDatabase::addDatabase("QSQLITE");
-    m_database.setDatabaseName(dbPath);
+    bool opened = false;
+    {
+        StartupProfiler::Scope phase("DatabaseManager::open");
+        m_database = QSqlDatabase::addDatabase("QSQLITE");
+        m_database.setDatabaseName(dbPath);
+        opened = m_database.open();
+    }
     
-    if (!m_database.open()) {
+    if (!opened) {
         qDebug() << "数据库打开失败:" << m_database.lastError().text();
         return false;
     }
     
     // 创建表
-    if (!createTables()) {
+    bool tablesReady = false;
+    {
+        StartupProfiler::Scope phase("DatabaseManager::createTables");
+        tablesReady = createTables();
+    }
+    
+    if (!tablesReady) {
         qDebug() << "创建数据表失败";
         return false;
     }
@@ -55,6 +69,38 @@ void DatabaseManager::closeDatabase()
     }
 }
 
+bool DatabaseManager::isOpen() const
+{
+    return m_database.isOpen();
+}
+
+QSqlDatabase DatabaseManager::connectionForCurrentThread()
+{
+    // QSqlDatabase 连接不能跨线程使用，后台线程各自打开一个只读连接
+    if (QThread::currentThread() == thread()) {
+        return m_database;
+    }
+    
+    QString connectionName = QString("hospai_reader_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()));
+    if (QSqlDatabase::contains(connectionName)) {
+        return QSqlDatabase::database(connectionName);
+    }
+    
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    database.setDatabaseName(getDbPath());
+    database.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!database.open()) {
+        qDebug() << "后台数据库连接打开失败:" << database.lastError().text();
+    }
+    
+    // 线程池线程空闲退出时在该线程内移除连接，否则每个用过的线程都会留下一个打开的连接
+    QThread* currentThread = QThread::currentThread();
+    connect(currentThread, &QThread::finished, currentThread, [connectionName]() {
+        QSqlDatabase::removeDatabase(connectionName);
+    }, Qt::DirectConnection);
+    return database;
+}
+
 QString DatabaseManager::getDbPath()
 {
     QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
@@ -113,6 +159,9 @@ bool DatabaseManager::createTables()
         return false;
     }
     
+    // 会话列表按最后消息时间增量刷新
+    query.exec("CREATE INDEX IF NOT EXISTS idx_chat_sessions_last_message ON chat_sessions(last_message_at)");
+    
     // 创建聊天消息表
     QString createMessagesTable = R"(
         CREATE TABLE IF NOT EXISTS chat_messages (
@@ -135,6 +184,9 @@ bool DatabaseManager::createTables()
         return false;
     }
     
+    // 聊天记录按会话分页倒序读取
+    query.exec("CREATE INDEX IF NOT EXISTS idx_chat_messages_session ON chat_messages(session_id, id)");
+    
     // 在用户表中添加在线状态字段（如果不存在）
     query.exec("ALTER TABLE users ADD COLUMN is_online INTEGER DEFAULT 0");
     
@@ -199,6 +251,140 @@ bool DatabaseManager::createTables()
     query.exec("ALTER TABLE chat_sessions ADD COLUMN ended_at DATETIME");
     query.exec("ALTER TABLE chat_sessions ADD COLUMN duration INTEGER DEFAULT 0");
     
+    // 扩展消息表字段：结构化富文本信封
+    query.exec("ALTER TABLE chat_messages ADD COLUMN content_version INTEGER DEFAULT 0");
+    query.exec("ALTER TABLE chat_messages ADD COLUMN html_content TEXT");
+    query.exec("ALTER TABLE chat_messages ADD COLUMN attachments TEXT");
+    
+    // 创建附件表（内容寻址）；消息不会被删除，referenced 一旦置位就不再清除
+    QString createAttachmentsTable = R"(
+        CREATE TABLE IF NOT EXISTS attachments (
+            hash CHAR(64) PRIMARY KEY,
+            mime_type VARCHAR(100),
+            file_name VARCHAR(255),
+            size INTEGER DEFAULT 0,
+            referenced INTEGER DEFAULT 0,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )";
+    
+    if (!query.exec(createAttachmentsTable)) {
+        qDebug() << "创建附件表失败:" << query.lastError().text();
+    }
+    
+    // 创建AI回复缓存表（时间为UTC秒）
+    QString createAICacheTable = R"(
+        CREATE TABLE IF NOT EXISTS ai_response_cache (
+            cache_key CHAR(64) PRIMARY KEY,
+            response TEXT NOT NULL,
+            created_at INTEGER NOT NULL,
+            last_hit_at INTEGER NOT NULL,
+            hit_count INTEGER DEFAULT 0
+        )
+    )";
+    
+    if (!query.exec(createAICacheTable)) {
+        qDebug() << "创建AI回复缓存表失败:" << query.lastError().text();
+    }
+    
+    // 创建AI模型路由记录表（时间为UTC秒）
+    QString createAIRoutingTable = R"(
+        CREATE TABLE IF NOT EXISTS ai_routing_log (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_at INTEGER NOT NULL,
+            request_type VARCHAR(20),
+            tier VARCHAR(10) NOT NULL,
+            model VARCHAR(100),
+            reason VARCHAR(100),
+            input_chars INTEGER DEFAULT 0,
+            history_tokens INTEGER DEFAULT 0,
+            match_score REAL DEFAULT 0,
+            emergency INTEGER DEFAULT 0,
+            max_tokens INTEGER DEFAULT 0,
+            timeout_ms INTEGER DEFAULT 0,
+            success INTEGER DEFAULT 0,
+            timed_out INTEGER DEFAULT 0,
+            from_cache INTEGER DEFAULT 0,
+            latency_ms INTEGER DEFAULT 0,
+            first_token_ms INTEGER DEFAULT -1,
+            attempts INTEGER DEFAULT 0,
+            prompt_tokens INTEGER DEFAULT 0,
+            completion_tokens INTEGER DEFAULT 0
+        )
+    )";
+    
+    if (!query.exec(createAIRoutingTable)) {
+        qDebug() << "创建AI路由记录表失败:" << query.lastError().text();
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS idx_ai_routing_log_created ON ai_routing_log(created_at)");
+    
+    // 创建AI回复缓存统计表（每个进程一行）
+    QString createAICacheStatsTable = R"(
+        CREATE TABLE IF NOT EXISTS ai_cache_stats (
+            instance_id VARCHAR(40) PRIMARY KEY,
+            started_at INTEGER NOT NULL,
+            updated_at INTEGER NOT NULL,
+            lookups INTEGER DEFAULT 0,
+            hits INTEGER DEFAULT 0,
+            bypassed INTEGER DEFAULT 0,
+            stores INTEGER DEFAULT 0,
+            evictions INTEGER DEFAULT 0,
+            miss_latency_ms INTEGER DEFAULT 0,
+            miss_latency_samples INTEGER DEFAULT 0,
+            hit_latency_ms INTEGER DEFAULT 0
+        )
+    )";
+    
+    if (!query.exec(createAICacheStatsTable)) {
+        qDebug() << "创建AI回复缓存统计表失败:" << query.lastError().text();
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS idx_ai_cache_stats_updated ON ai_cache_stats(updated_at)");
+    
+    // 创建AI熔断器快照表（每个进程一行）和状态切换记录表
+    QString createAIBreakerStatsTable = R"(
+        CREATE TABLE IF NOT EXISTS ai_breaker_stats (
+            instance_id VARCHAR(40) PRIMARY KEY,
+            started_at INTEGER NOT NULL,
+            updated_at INTEGER NOT NULL,
+            state VARCHAR(10) NOT NULL,
+            failure_rate REAL DEFAULT 0,
+            window_samples INTEGER DEFAULT 0,
+            consecutive_failures INTEGER DEFAULT 0,
+            reopen_at INTEGER DEFAULT 0,
+            last_opened_at INTEGER DEFAULT 0,
+            opens INTEGER DEFAULT 0,
+            successes INTEGER DEFAULT 0,
+            failures INTEGER DEFAULT 0,
+            short_circuited INTEGER DEFAULT 0,
+            retries INTEGER DEFAULT 0,
+            hedges INTEGER DEFAULT 0,
+            hedge_wins INTEGER DEFAULT 0
+        )
+    )";
+    
+    if (!query.exec(createAIBreakerStatsTable)) {
+        qDebug() << "创建AI熔断器统计表失败:" << query.lastError().text();
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS idx_ai_breaker_stats_updated ON ai_breaker_stats(updated_at)");
+    
+    QString createAIBreakerLogTable = R"(
+        CREATE TABLE IF NOT EXISTS ai_breaker_log (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_at INTEGER NOT NULL,
+            instance_id VARCHAR(40),
+            from_state VARCHAR(10),
+            to_state VARCHAR(10) NOT NULL,
+            failure_rate REAL DEFAULT 0,
+            consecutive_failures INTEGER DEFAULT 0,
+            open_duration_ms INTEGER DEFAULT 0
+        )
+    )";
+    
+    if (!query.exec(createAIBreakerLogTable)) {
+        qDebug() << "创建AI熔断器记录表失败:" << query.lastError().text();
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS idx_ai_breaker_log_created ON ai_breaker_log(created_at)");
+    
     // 创建默认测试账户（如果不存在）
     // 患者端测试账号
     if (!isUsernameExists("p123")) {
@@ -250,6 +436,7 @@ bool DatabaseManager::registerUser(const QString& username, const QString& passw
         return false;
     }
     
+    emit userRegistered(username, email);
     return true;
 }
 
@@ -283,7 +470,7 @@ bool DatabaseManager::loginUser(const QString& username, const QString& password
         userInfo.username = query.value("username").toString();
         userInfo.email = query.value("email").toString();
         userInfo.phone = query.value("phone").toString();
-        userInfo.role = query.value("role").toString();
+        userInfo.role = userRoleFromName(query.value("role").toString());
         userInfo.realName = query.value("real_name").toString();
         userInfo.createdAt = query.value("created_at").toDateTime();
         userInfo.lastLogin = query.value("last_login").toDateTime();
@@ -435,12 +622,12 @@ bool DatabaseManager::updateLastLogin(int userId)
 int DatabaseManager::createChatSession(int patientId, int staffId)
 {
     UserInfo patient = getUserInfo(patientId);
-    QString patientName = patient.realName.isEmpty() ? patient.username : patient.realName;
+    QString patientName = patient.displayName();
     
     QString staffName = "";
     if (staffId > 0) {
         UserInfo staff = getUserInfo(staffId);
-        staffName = staff.realName.isEmpty() ? staff.username : staff.realName;
+        staffName = staff.displayName();
     }
     
     QSqlQuery query(m_database);
@@ -465,8 +652,7 @@ int DatabaseManager::createChatSession(int patientId, int staffId)
         sendMessage(sessionId, 0, systemMsg, 1); // 系统消息
         
         // 发送信号
-        ChatSession session = getChatSession(sessionId);
-        emit sessionCreated(session);
+        emit sessionCreated(SharedChatSession(getChatSession(sessionId)));
         
         return sessionId;
     }
@@ -477,7 +663,7 @@ int DatabaseManager::createChatSession(int patientId, int staffId)
 bool DatabaseManager::updateChatSession(int sessionId, int staffId)
 {
     UserInfo staff = getUserInfo(staffId);
-    QString staffName = staff.realName.isEmpty() ? staff.username : staff.realName;
+    QString staffName = staff.displayName();
     
     QSqlQuery query(m_database);
     query.prepare(R"(
@@ -495,8 +681,7 @@ bool DatabaseManager::updateChatSession(int sessionId, int staffId)
         sendMessage(sessionId, 0, QString("客服 %1 已接入对话").arg(staffName), 1);
         
         // 发送信号
-        ChatSession session = getChatSession(sessionId);
-        emit sessionUpdated(session);
+        emit sessionUpdated(SharedChatSession(getChatSession(sessionId)));
         
         return true;
     }
@@ -520,8 +705,7 @@ bool DatabaseManager::closeChatSession(int sessionId)
         sendMessage(sessionId, 0, "对话已结束，感谢您的咨询！", 1);
         
         // 发送信号
-        ChatSession session = getChatSession(sessionId);
-        emit sessionUpdated(session);
+        emit sessionUpdated(SharedChatSession(getChatSession(sessionId)));
         
         return true;
     }
@@ -548,8 +732,8 @@ QList<ChatSession> DatabaseManager::getActiveSessions()
             session.id = query.value("id").toInt();
             session.patientId = query.value("patient_id").toInt();
             session.staffId = query.value("staff_id").toInt();
-            session.patientName = query.value("patient_name").toString();
-            session.staffName = query.value("staff_name").toString();
+            session.patientName = StringPool::instance()->intern(query.value("patient_name").toString());
+            session.staffName = StringPool::instance()->intern(query.value("staff_name").toString());
             session.createdAt = query.value("created_at").toDateTime();
             session.lastMessageAt = query.value("last_message_at").toDateTime();
             session.status = query.value("status").toInt();
@@ -562,6 +746,65 @@ QList<ChatSession> DatabaseManager::getActiveSessions()
     return sessions;
 }
 
+QList<ChatSession> DatabaseManager::getSessionsChangedSince(const QString& since, QString* watermark)
+{
+    QList<ChatSession> sessions;
+    
+    // 会话的接入、结束和新消息都会更新 last_message_at，可作为变更水位
+    QSqlQuery query(m_database);
+    if (since.isEmpty()) {
+        query.prepare(R"(
+            SELECT id, patient_id, staff_id, patient_name, staff_name, 
+                   created_at, last_message_at, status, last_message,
+                   CAST(last_message_at AS TEXT) AS change_mark
+            FROM chat_sessions 
+            WHERE status > 0
+            ORDER BY last_message_at DESC
+        )");
+    } else {
+        // 时间戳精度为秒，用 >= 保证同一秒内的更新不会漏掉
+        query.prepare(R"(
+            SELECT id, patient_id, staff_id, patient_name, staff_name, 
+                   created_at, last_message_at, status, last_message,
+                   CAST(last_message_at AS TEXT) AS change_mark
+            FROM chat_sessions 
+            WHERE last_message_at >= ?
+            ORDER BY last_message_at DESC
+        )");
+        query.addBindValue(since);
+    }
+    
+    QString maxMark = since;
+    if (query.exec()) {
+        while (query.next()) {
+            ChatSession session;
+            session.id = query.value("id").toInt();
+            session.patientId = query.value("patient_id").toInt();
+            session.staffId = query.value("staff_id").toInt();
+            session.patientName = StringPool::instance()->intern(query.value("patient_name").toString());
+            session.staffName = StringPool::instance()->intern(query.value("staff_name").toString());
+            session.createdAt = query.value("created_at").toDateTime();
+            session.lastMessageAt = query.value("last_message_at").toDateTime();
+            session.status = query.value("status").toInt();
+            session.lastMessage = query.value("last_message").toString();
+            
+            QString changeMark = query.value("change_mark").toString();
+            if (changeMark > maxMark) {
+                maxMark = changeMark;
+            }
+            
+            sessions.append(session);
+        }
+    } else {
+        qDebug() << "增量获取会话失败:" << query.lastError().text();
+    }
+    
+    if (watermark) {
+        *watermark = maxMark;
+    }
+    return sessions;
+}
+
 QList<ChatSession> DatabaseManager::getPatientSessions(int patientId)
 {
     QList<ChatSession> sessions;
@@ -583,8 +826,8 @@ QList<ChatSession> DatabaseManager::getPatientSessions(int patientId)
             session.id = query.value("id").toInt();
             session.patientId = query.value("patient_id").toInt();
             session.staffId = query.value("staff_id").toInt();
-            session.patientName = query.value("patient_name").toString();
-            session.staffName = query.value("staff_name").toString();
+            session.patientName = StringPool::instance()->intern(query.value("patient_name").toString());
+            session.staffName = StringPool::instance()->intern(query.value("staff_name").toString());
             session.createdAt = query.value("created_at").toDateTime();
             session.lastMessageAt = query.value("last_message_at").toDateTime();
             session.status = query.value("status").toInt();
@@ -618,8 +861,8 @@ QList<ChatSession> DatabaseManager::getStaffSessions(int staffId)
             session.id = query.value("id").toInt();
             session.patientId = query.value("patient_id").toInt();
             session.staffId = query.value("staff_id").toInt();
-            session.patientName = query.value("patient_name").toString();
-            session.staffName = query.value("staff_name").toString();
+            session.patientName = StringPool::instance()->intern(query.value("patient_name").toString());
+            session.staffName = StringPool::instance()->intern(query.value("staff_name").toString());
             session.createdAt = query.value("created_at").toDateTime();
             session.lastMessageAt = query.value("last_message_at").toDateTime();
             session.status = query.value("status").toInt();
@@ -650,8 +893,8 @@ ChatSession DatabaseManager::getChatSession(int sessionId)
         session.id = query.value("id").toInt();
         session.patientId = query.value("patient_id").toInt();
         session.staffId = query.value("staff_id").toInt();
-        session.patientName = query.value("patient_name").toString();
-        session.staffName = query.value("staff_name").toString();
+        session.patientName = StringPool::instance()->intern(query.value("patient_name").toString());
+        session.staffName = StringPool::instance()->intern(query.value("staff_name").toString());
         session.createdAt = query.value("created_at").toDateTime();
         session.lastMessageAt = query.value("last_message_at").toDateTime();
         session.status = query.value("status").toInt();
@@ -666,11 +909,11 @@ ChatSession DatabaseManager::getChatSession(int sessionId)
 int DatabaseManager::sendMessage(int sessionId, int senderId, const QString& content, int messageType)
 {
     QString senderName = "系统";
-    QString senderRole = "system";
+    UserRole senderRole = UserRole::System;
     
     if (senderId > 0) {
         UserInfo sender = getUserInfo(senderId);
-        senderName = sender.realName.isEmpty() ? sender.username : sender.realName;
+        senderName = sender.displayName();
         senderRole = sender.role;
     }
     
@@ -683,7 +926,7 @@ int DatabaseManager::sendMessage(int sessionId, int senderId, const QString& con
     query.addBindValue(sessionId);
     query.addBindValue(senderId);
     query.addBindValue(senderName);
-    query.addBindValue(senderRole);
+    query.addBindValue(userRoleName(senderRole));
     query.addBindValue(content);
     query.addBindValue(messageType);
     
@@ -713,7 +956,8 @@ int DatabaseManager::sendMessage(int sessionId, int senderId, const QString& con
         message.messageType = messageType;
         message.isRead = 0;
         
-        emit newMessageReceived(message);
+        // 只在这里转换一次，各接收者和聊天记录模型共用同一份
+        emit newMessageReceived(SharedRichChatMessage(RichChatMessage::fromChatMessage(message)));
         
         return messageId;
     }
@@ -721,6 +965,81 @@ int DatabaseManager::sendMessage(int sessionId, int senderId, const QString& con
     return -1;
 }
 
+int DatabaseManager::sendRichMessage(int sessionId, int senderId, const RichMessageEnvelope& envelope, int messageType)
+{
+    QString senderName = "系统";
+    UserRole senderRole = UserRole::System;
+    
+    if (senderId > 0) {
+        UserInfo sender = getUserInfo(senderId);
+        senderName = sender.displayName();
+        senderRole = sender.role;
+    }
+    
+    // content列只保存纯文本，HTML和附件引用分列保存
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        INSERT INTO chat_messages (session_id, sender_id, sender_name, sender_role, content, message_type,
+                                   content_version, html_content, attachments)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(sessionId);
+    query.addBindValue(senderId);
+    query.addBindValue(senderName);
+    query.addBindValue(userRoleName(senderRole));
+    query.addBindValue(envelope.content);
+    query.addBindValue(messageType);
+    query.addBindValue(RichMessageEnvelope::CURRENT_VERSION);
+    query.addBindValue(envelope.htmlContent);
+    query.addBindValue(envelope.attachments.join(','));
+    
+    if (query.exec()) {
+        int messageId = query.lastInsertId().toInt();
+        
+        // 会话列表只显示纯文本摘要
+        QSqlQuery updateQuery(m_database);
+        updateQuery.prepare(R"(
+            UPDATE chat_sessions 
+            SET last_message_at = CURRENT_TIMESTAMP, last_message = ?
+            WHERE id = ?
+        )");
+        updateQuery.addBindValue(envelope.content);
+        updateQuery.addBindValue(sessionId);
+        updateQuery.exec();
+        
+        // 被消息引用过的附件不再参与清理
+        QSqlQuery attachmentQuery(m_database);
+        attachmentQuery.prepare("UPDATE attachments SET referenced = 1 WHERE hash = ? AND referenced = 0");
+        for (const QString& hash : envelope.attachments) {
+            attachmentQuery.bindValue(0, hash);
+            attachmentQuery.exec();
+        }
+        
+        ChatMessage message;
+        message.id = messageId;
+        message.sessionId = sessionId;
+        message.senderId = senderId;
+        message.senderName = senderName;
+        message.senderRole = senderRole;
+        message.content = envelope.content;
+        message.timestamp = QDateTime::currentDateTime();
+        message.messageType = messageType;
+        message.isRead = 0;
+        message.contentVersion = RichMessageEnvelope::CURRENT_VERSION;
+        message.htmlContent = envelope.htmlContent;
+        message.attachments = envelope.attachments;
+        
+        // 只在这里转换一次，各接收者和聊天记录模型共用同一份
+        emit newMessageReceived(SharedRichChatMessage(RichChatMessage::fromChatMessage(message)));
+        
+        return messageId;
+    }
+    
+    qDebug() << "富文本消息保存失败:" << query.lastError().text();
+    return -1;
+}
+
 QList<ChatMessage> DatabaseManager::getChatMessages(int sessionId, int limit)
 {
     QList<ChatMessage> messages;
@@ -728,7 +1047,8 @@ QList<ChatMessage> DatabaseManager::getChatMessages(int sessionId, int limit)
     QSqlQuery query(m_database);
     query.prepare(R"(
         SELECT id, session_id, sender_id, sender_name, sender_role, 
-               content, timestamp, message_type, is_read
+               content, timestamp, message_type, is_read,
+               content_version, html_content, attachments
         FROM chat_messages 
         WHERE session_id = ?
         ORDER BY timestamp ASC
@@ -744,12 +1064,15 @@ QList<ChatMessage> DatabaseManager::getChatMessages(int sessionId, int limit)
             message.id = query.value("id").toInt();
             message.sessionId = query.value("session_id").toInt();
             message.senderId = query.value("sender_id").toInt();
-            message.senderName = query.value("sender_name").toString();
-            message.senderRole = query.value("sender_role").toString();
+            message.senderName = StringPool::instance()->intern(query.value("sender_name").toString());
+            message.senderRole = userRoleFromName(query.value("sender_role").toString());
             message.content = query.value("content").toString();
             message.timestamp = query.value("timestamp").toDateTime();
             message.messageType = query.value("message_type").toInt();
             message.isRead = query.value("is_read").toInt();
+            message.contentVersion = query.value("content_version").toInt();
+            message.htmlContent = query.value("html_content").toString();
+            message.attachments = query.value("attachments").toString().split(',', Qt::SkipEmptyParts);
             
             messages.append(message);
         }
@@ -758,6 +1081,107 @@ QList<ChatMessage> DatabaseManager::getChatMessages(int sessionId, int limit)
     return messages;
 }
 
+QList<ChatMessage> DatabaseManager::getChatMessagesAfter(int sessionId, int afterMessageId)
+{
+    QList<ChatMessage> messages;
+    
+    // 用于已缓存会话补齐新消息
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        SELECT id, session_id, sender_id, sender_name, sender_role, 
+               content, timestamp, message_type, is_read,
+               content_version, html_content, attachments
+        FROM chat_messages 
+        WHERE session_id = ? AND id > ?
+        ORDER BY id ASC
+    )");
+    
+    query.addBindValue(sessionId);
+    query.addBindValue(afterMessageId);
+    
+    if (query.exec()) {
+        while (query.next()) {
+            ChatMessage message;
+            message.id = query.value("id").toInt();
+            message.sessionId = query.value("session_id").toInt();
+            message.senderId = query.value("sender_id").toInt();
+            message.senderName = StringPool::instance()->intern(query.value("sender_name").toString());
+            message.senderRole = userRoleFromName(query.value("sender_role").toString());
+            message.content = query.value("content").toString();
+            message.timestamp = query.value("timestamp").toDateTime();
+            message.messageType = query.value("message_type").toInt();
+            message.isRead = query.value("is_read").toInt();
+            message.contentVersion = query.value("content_version").toInt();
+            message.htmlContent = query.value("html_content").toString();
+            message.attachments = query.value("attachments").toString().split(',', Qt::SkipEmptyParts);
+            
+            messages.append(message);
+        }
+    }
+    
+    return messages;
+}
+
+QList<ChatMessage> DatabaseManager::getChatMessagesBefore(int sessionId, int beforeMessageId, int limit)
+{
+    QList<ChatMessage> messages;
+    
+    // 历史分页：取 beforeMessageId 之前最近的一页，beforeMessageId<=0 时取最新一页
+    // 可在后台线程调用，此时使用该线程自己的只读连接。
+    // 两种情况分开写，(? <= 0 OR id < ?) 这类条件会让 SQLite 放弃 id 上的范围查找
+    QSqlQuery query(connectionForCurrentThread());
+    if (beforeMessageId > 0) {
+        query.prepare(R"(
+            SELECT id, session_id, sender_id, sender_name, sender_role, 
+                   content, timestamp, message_type, is_read,
+                   content_version, html_content, attachments
+            FROM chat_messages 
+            WHERE session_id = ? AND id < ?
+            ORDER BY id DESC
+            LIMIT ?
+        )");
+        query.addBindValue(sessionId);
+        query.addBindValue(beforeMessageId);
+    } else {
+        query.prepare(R"(
+            SELECT id, session_id, sender_id, sender_name, sender_role, 
+                   content, timestamp, message_type, is_read,
+                   content_version, html_content, attachments
+            FROM chat_messages 
+            WHERE session_id = ?
+            ORDER BY id DESC
+            LIMIT ?
+        )");
+        query.addBindValue(sessionId);
+    }
+    query.addBindValue(limit);
+    
+    if (query.exec()) {
+        while (query.next()) {
+            ChatMessage message;
+            message.id = query.value("id").toInt();
+            message.sessionId = query.value("session_id").toInt();
+            message.senderId = query.value("sender_id").toInt();
+            message.senderName = StringPool::instance()->intern(query.value("sender_name").toString());
+            message.senderRole = userRoleFromName(query.value("sender_role").toString());
+            message.content = query.value("content").toString();
+            message.timestamp = query.value("timestamp").toDateTime();
+            message.messageType = query.value("message_type").toInt();
+            message.isRead = query.value("is_read").toInt();
+            message.contentVersion = query.value("content_version").toInt();
+            message.htmlContent = query.value("html_content").toString();
+            message.attachments = query.value("attachments").toString().split(',', Qt::SkipEmptyParts);
+            
+            // 倒序读出，按时间正序返回
+            messages.prepend(message);
+        }
+    } else {
+        qDebug() << "读取聊天历史失败:" << query.lastError().text();
+    }
+    
+    return messages;
+}
+
 QList<ChatMessage> DatabaseManager::getUnreadMessages(int userId)
 {
     QList<ChatMessage> messages;
@@ -765,7 +1189,8 @@ QList<ChatMessage> DatabaseManager::getUnreadMessages(int userId)
     QSqlQuery query(m_database);
     query.prepare(R"(
         SELECT m.id, m.session_id, m.sender_id, m.sender_name, m.sender_role, 
-               m.content, m.timestamp, m.message_type, m.is_read
+               m.content, m.timestamp, m.message_type, m.is_read,
+               m.content_version, m.html_content, m.attachments
         FROM chat_messages m
         JOIN chat_sessions s ON m.session_id = s.id
         WHERE (s.patient_id = ? OR s.staff_id = ?) 
@@ -784,12 +1209,15 @@ QList<ChatMessage> DatabaseManager::getUnreadMessages(int userId)
             message.id = query.value("id").toInt();
             message.sessionId = query.value("session_id").toInt();
             message.senderId = query.value("sender_id").toInt();
-            message.senderName = query.value("sender_name").toString();
-            message.senderRole = query.value("sender_role").toString();
+            message.senderName = StringPool::instance()->intern(query.value("sender_name").toString());
+            message.senderRole = userRoleFromName(query.value("sender_role").toString());
             message.content = query.value("content").toString();
             message.timestamp = query.value("timestamp").toDateTime();
             message.messageType = query.value("message_type").toInt();
             message.isRead = query.value("is_read").toInt();
+            message.contentVersion = query.value("content_version").toInt();
+            message.htmlContent = query.value("html_content").toString();
+            message.attachments = query.value("attachments").toString().split(',', Qt::SkipEmptyParts);
             
             messages.append(message);
         }
@@ -859,7 +1287,7 @@ QList<UserInfo> DatabaseManager::getOnlineStaff()
             user.username = query.value("username").toString();
             user.email = query.value("email").toString();
             user.phone = query.value("phone").toString();
-            user.role = query.value("role").toString();
+            user.role = userRoleFromName(query.value("role").toString());
             user.realName = query.value("real_name").toString();
             user.createdAt = query.value("created_at").toDateTime();
             user.lastLogin = query.value("last_login").toDateTime();
@@ -895,7 +1323,7 @@ QList<UserInfo> DatabaseManager::getAllUsers()
             user.username = query.value("username").toString();
             user.email = query.value("email").toString();
             user.phone = query.value("phone").toString();
-            user.role = query.value("role").toString();
+            user.role = userRoleFromName(query.value("role").toString());
             user.realName = query.value("real_name").toString();
             user.createdAt = query.value("created_at").toDateTime();
             user.lastLogin = query.value("last_login").toDateTime();
@@ -904,9 +1332,6 @@ QList<UserInfo> DatabaseManager::getAllUsers()
             
             // 设置新增字段
             user.userId = QString("U%1").arg(user.id, 4, 10, QChar('0'));
-            user.name = user.realName.isEmpty() ? user.username : user.realName;
-            user.lastLoginTime = user.lastLogin;
-            user.isActive = (user.status == 1);
             
             users.append(user);
         }
@@ -937,7 +1362,7 @@ QList<UserInfo> DatabaseManager::getUsersByRole(const QString& role)
             user.username = query.value("username").toString();
             user.email = query.value("email").toString();
             user.phone = query.value("phone").toString();
-            user.role = query.value("role").toString();
+            user.role = userRoleFromName(query.value("role").toString());
             user.realName = query.value("real_name").toString();
             user.createdAt = query.value("created_at").toDateTime();
             user.lastLogin = query.value("last_login").toDateTime();
@@ -946,9 +1371,6 @@ QList<UserInfo> DatabaseManager::getUsersByRole(const QString& role)
             
             // 设置新增字段
             user.userId = QString("U%1").arg(user.id, 4, 10, QChar('0'));
-            user.name = user.realName.isEmpty() ? user.username : user.realName;
-            user.lastLoginTime = user.lastLogin;
-            user.isActive = (user.status == 1);
             
             users.append(user);
         }
@@ -959,7 +1381,8 @@ QList<UserInfo> DatabaseManager::getUsersByRole(const QString& role)
 
 bool DatabaseManager::isUsernameExists(const QString& username)
 {
-    QSqlQuery query(m_database);
+    // 注册界面在后台线程调用，username 列有唯一索引
+    QSqlQuery query(connectionForCurrentThread());
     query.prepare("SELECT COUNT(*) FROM users WHERE username = ?");
     query.addBindValue(username);
     
@@ -974,7 +1397,7 @@ bool DatabaseManager::isEmailExists(const QString& email)
 {
     if (email.isEmpty()) return false;
     
-    QSqlQuery query(m_database);
+    QSqlQuery query(connectionForCurrentThread());
     query.prepare("SELECT COUNT(*) FROM users WHERE email = ?");
     query.addBindValue(email);
     
@@ -985,6 +1408,31 @@ bool DatabaseManager::isEmailExists(const QString& email)
     return false;
 }
 
+int DatabaseManager::getUserCount()
+{
+    QSqlQuery query(connectionForCurrentThread());
+    if (query.exec("SELECT COUNT(*) FROM users") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+void DatabaseManager::forEachUserIdentity(const std::function<void(const QString& username, const QString& email)>& visitor)
+{
+    // 逐行回调，不在内存中保存整张用户表
+    QSqlQuery query(connectionForCurrentThread());
+    query.setForwardOnly(true);
+    
+    if (!query.exec("SELECT username, email FROM users")) {
+        qDebug() << "读取用户名列表失败:" << query.lastError().text();
+        return;
+    }
+    
+    while (query.next()) {
+        visitor(query.value(0).toString(), query.value(1).toString());
+    }
+}
+
 QString DatabaseManager::hashPassword(const QString& password)
 {
     return QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
@@ -1013,7 +1461,7 @@ UserInfo DatabaseManager::getUserInfo(int userId)
         userInfo.username = query.value("username").toString();
         userInfo.email = query.value("email").toString();
         userInfo.phone = query.value("phone").toString();
-        userInfo.role = query.value("role").toString();
+        userInfo.role = userRoleFromName(query.value("role").toString());
         userInfo.realName = query.value("real_name").toString();
         userInfo.createdAt = query.value("created_at").toDateTime();
         userInfo.lastLogin = query.value("last_login").toDateTime();
@@ -1022,9 +1470,6 @@ UserInfo DatabaseManager::getUserInfo(int userId)
         
         // 设置新增字段
         userInfo.userId = QString("U%1").arg(userInfo.id, 4, 10, QChar('0'));
-        userInfo.name = userInfo.realName.isEmpty() ? userInfo.username : userInfo.realName;
-        userInfo.lastLoginTime = userInfo.lastLogin;
-        userInfo.isActive = (userInfo.status == 1);
     }
     
     return userInfo;
@@ -1275,16 +1720,13 @@ UserInfo DatabaseManager::getUserByEmail(const QString& email)
         userInfo.username = query.value("username").toString();
         userInfo.email = query.value("email").toString();
         userInfo.phone = query.value("phone").toString();
-        userInfo.role = query.value("role").toString();
+        userInfo.role = userRoleFromName(query.value("role").toString());
         userInfo.realName = query.value("real_name").toString();
         userInfo.createdAt = query.value("created_at").toDateTime();
         userInfo.lastLogin = query.value("last_login").toDateTime();
         userInfo.status = query.value("status").toInt();
         userInfo.avatarPath = query.value("avatar_path").toString();
-        userInfo.isActive = (userInfo.status == 1);
-        userInfo.name = userInfo.realName.isEmpty() ? userInfo.username : userInfo.realName;
         userInfo.userId = QString::number(userInfo.id);
-        userInfo.lastLoginTime = userInfo.lastLogin;
     }
     
     return userInfo;
@@ -1308,16 +1750,13 @@ UserInfo DatabaseManager::getUserByUsername(const QString& username)
         userInfo.username = query.value("username").toString();
         userInfo.email = query.value("email").toString();
         userInfo.phone = query.value("phone").toString();
-        userInfo.role = query.value("role").toString();
+        userInfo.role = userRoleFromName(query.value("role").toString());
         userInfo.realName = query.value("real_name").toString();
         userInfo.createdAt = query.value("created_at").toDateTime();
         userInfo.lastLogin = query.value("last_login").toDateTime();
         userInfo.status = query.value("status").toInt();
         userInfo.avatarPath = query.value("avatar_path").toString();
-        userInfo.isActive = (userInfo.status == 1);
-        userInfo.name = userInfo.realName.isEmpty() ? userInfo.username : userInfo.realName;
         userInfo.userId = QString::number(userInfo.id);
-        userInfo.lastLoginTime = userInfo.lastLogin;
     }
     
     return userInfo;
@@ -1349,4 +1788,495 @@ bool DatabaseManager::resetPasswordByUsername(const QString& username, const QSt
     }
     
     return false;
-} 
\ No newline at end of file
+}
+
+// ========== 附件管理 ==========
+
+bool DatabaseManager::addAttachment(const QString& hash, const QString& mimeType, const QString& fileName, qint64 size)
+{
+    // 相同内容只登记一次
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        INSERT OR IGNORE INTO attachments (hash, mime_type, file_name, size)
+        VALUES (?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(hash);
+    query.addBindValue(mimeType);
+    query.addBindValue(fileName);
+    query.addBindValue(size);
+    
+    if (!query.exec()) {
+        qDebug() << "登记附件失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+AttachmentInfo DatabaseManager::getAttachmentInfo(const QString& hash)
+{
+    AttachmentInfo info;
+    info.size = 0;
+    info.referenced = false;
+    
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        SELECT hash, mime_type, file_name, size, referenced, created_at
+        FROM attachments 
+        WHERE hash = ?
+    )");
+    
+    query.addBindValue(hash);
+    
+    if (query.exec() && query.next()) {
+        info.hash = query.value("hash").toString();
+        info.mimeType = query.value("mime_type").toString();
+        info.fileName = query.value("file_name").toString();
+        info.size = query.value("size").toLongLong();
+        info.referenced = query.value("referenced").toInt() != 0;
+        info.createdAt = query.value("created_at").toDateTime();
+    }
+    
+    return info;
+}
+
+QStringList DatabaseManager::getUnreferencedAttachments(const QDateTime& before)
+{
+    QStringList hashes;
+    
+    QSqlQuery query(m_database);
+    query.prepare("SELECT hash FROM attachments WHERE referenced = 0 AND created_at < ?");
+    query.addBindValue(before.toUTC().toString("yyyy-MM-dd hh:mm:ss"));
+    
+    if (query.exec()) {
+        while (query.next()) {
+            hashes.append(query.value(0).toString());
+        }
+    }
+    
+    return hashes;
+}
+
+bool DatabaseManager::deleteAttachment(const QString& hash)
+{
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM attachments WHERE hash = ? AND referenced = 0");
+    query.addBindValue(hash);
+    
+    if (query.exec()) {
+        return query.numRowsAffected() > 0;
+    }
+    
+    return false;
+}
+
+// ========== AI回复缓存 ==========
+
+QList<AIResponseCacheEntry> DatabaseManager::getAIResponseCacheEntries(const QDateTime& notBefore)
+{
+    QList<AIResponseCacheEntry> entries;
+    
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        SELECT cache_key, response, created_at, last_hit_at, hit_count
+        FROM ai_response_cache
+        WHERE created_at >= ?
+    )");
+    query.addBindValue(notBefore.toSecsSinceEpoch());
+    
+    if (query.exec()) {
+        while (query.next()) {
+            AIResponseCacheEntry entry;
+            entry.cacheKey = query.value("cache_key").toString();
+            entry.response = query.value("response").toString();
+            entry.createdAt = QDateTime::fromSecsSinceEpoch(query.value("created_at").toLongLong());
+            entry.lastHitAt = QDateTime::fromSecsSinceEpoch(query.value("last_hit_at").toLongLong());
+            entry.hitCount = query.value("hit_count").toInt();
+            entries.append(entry);
+        }
+    } else {
+        qDebug() << "读取AI回复缓存失败:" << query.lastError().text();
+    }
+    
+    return entries;
+}
+
+bool DatabaseManager::saveAIResponseCacheEntry(const AIResponseCacheEntry& entry)
+{
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        INSERT OR REPLACE INTO ai_response_cache (cache_key, response, created_at, last_hit_at, hit_count)
+        VALUES (?, ?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(entry.cacheKey);
+    query.addBindValue(entry.response);
+    query.addBindValue(entry.createdAt.toSecsSinceEpoch());
+    query.addBindValue(entry.lastHitAt.toSecsSinceEpoch());
+    query.addBindValue(entry.hitCount);
+    
+    if (!query.exec()) {
+        qDebug() << "保存AI回复缓存失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+bool DatabaseManager::saveAIResponseCacheEntries(const QList<AIResponseCacheEntry>& entries)
+{
+    if (entries.isEmpty()) {
+        return true;
+    }
+    
+    bool inTransaction = m_database.transaction();
+    bool ok = true;
+    for (const AIResponseCacheEntry& entry : entries) {
+        ok = saveAIResponseCacheEntry(entry) && ok;
+    }
+    if (inTransaction && !m_database.commit()) {
+        qDebug() << "提交AI回复缓存失败:" << m_database.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    
+    return ok;
+}
+
+bool DatabaseManager::deleteAIResponseCacheEntry(const QString& cacheKey)
+{
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM ai_response_cache WHERE cache_key = ?");
+    query.addBindValue(cacheKey);
+    
+    if (query.exec()) {
+        return query.numRowsAffected() > 0;
+    }
+    
+    return false;
+}
+
+int DatabaseManager::deleteAIResponseCacheBefore(const QDateTime& before)
+{
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM ai_response_cache WHERE created_at < ?");
+    query.addBindValue(before.toSecsSinceEpoch());
+    
+    if (query.exec()) {
+        return query.numRowsAffected();
+    }
+    
+    return 0;
+}
+
+bool DatabaseManager::saveAICacheSnapshot(const AICacheSnapshot& snapshot)
+{
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        INSERT OR REPLACE INTO ai_cache_stats (instance_id, started_at, updated_at, lookups, hits, bypassed, stores,
+                                               evictions, miss_latency_ms, miss_latency_samples, hit_latency_ms)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(snapshot.instanceId);
+    query.addBindValue(snapshot.startedAt.toSecsSinceEpoch());
+    query.addBindValue(snapshot.updatedAt.toSecsSinceEpoch());
+    query.addBindValue(snapshot.lookups);
+    query.addBindValue(snapshot.hits);
+    query.addBindValue(snapshot.bypassed);
+    query.addBindValue(snapshot.stores);
+    query.addBindValue(snapshot.evictions);
+    query.addBindValue(snapshot.missLatencyMs);
+    query.addBindValue(snapshot.missLatencySamples);
+    query.addBindValue(snapshot.hitLatencyMs);
+    
+    if (!query.exec()) {
+        qDebug() << "保存AI回复缓存统计失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+QList<AICacheSnapshot> DatabaseManager::getAICacheSnapshots(const QDateTime& updatedSince)
+{
+    QList<AICacheSnapshot> snapshots;
+    
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        SELECT instance_id, started_at, updated_at, lookups, hits, bypassed, stores,
+               evictions, miss_latency_ms, miss_latency_samples, hit_latency_ms
+        FROM ai_cache_stats
+        WHERE updated_at >= ?
+        ORDER BY updated_at DESC
+    )");
+    query.addBindValue(updatedSince.toSecsSinceEpoch());
+    
+    if (!query.exec()) {
+        qDebug() << "查询AI回复缓存统计失败:" << query.lastError().text();
+        return snapshots;
+    }
+    
+    while (query.next()) {
+        AICacheSnapshot snapshot;
+        snapshot.instanceId = query.value(0).toString();
+        snapshot.startedAt = QDateTime::fromSecsSinceEpoch(query.value(1).toLongLong());
+        snapshot.updatedAt = QDateTime::fromSecsSinceEpoch(query.value(2).toLongLong());
+        snapshot.lookups = query.value(3).toLongLong();
+        snapshot.hits = query.value(4).toLongLong();
+        snapshot.bypassed = query.value(5).toLongLong();
+        snapshot.stores = query.value(6).toLongLong();
+        snapshot.evictions = query.value(7).toLongLong();
+        snapshot.missLatencyMs = query.value(8).toLongLong();
+        snapshot.missLatencySamples = query.value(9).toLongLong();
+        snapshot.hitLatencyMs = query.value(10).toLongLong();
+        snapshots.append(snapshot);
+    }
+    
+    return snapshots;
+}
+
+int DatabaseManager::deleteAICacheSnapshotsBefore(const QDateTime& before)
+{
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM ai_cache_stats WHERE updated_at < ?");
+    query.addBindValue(before.toSecsSinceEpoch());
+    
+    if (query.exec()) {
+        return query.numRowsAffected();
+    }
+    
+    return 0;
+}
+
+// ========== AI模型路由记录 ==========
+
+bool DatabaseManager::addAIRoutingRecord(const AIRoutingRecord& record)
+{
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        INSERT INTO ai_routing_log (created_at, request_type, tier, model, reason, input_chars, history_tokens,
+                                    match_score, emergency, max_tokens, timeout_ms, success, timed_out, from_cache,
+                                    latency_ms, first_token_ms, attempts, prompt_tokens, completion_tokens)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(record.createdAt.toSecsSinceEpoch());
+    query.addBindValue(record.requestType);
+    query.addBindValue(record.tier);
+    query.addBindValue(record.model);
+    query.addBindValue(record.reason);
+    query.addBindValue(record.inputChars);
+    query.addBindValue(record.historyTokens);
+    query.addBindValue(record.matchScore);
+    query.addBindValue(record.emergency ? 1 : 0);
+    query.addBindValue(record.maxTokens);
+    query.addBindValue(record.timeoutMs);
+    query.addBindValue(record.success ? 1 : 0);
+    query.addBindValue(record.timedOut ? 1 : 0);
+    query.addBindValue(record.fromCache ? 1 : 0);
+    query.addBindValue(record.latencyMs);
+    query.addBindValue(record.firstTokenMs);
+    query.addBindValue(record.attempts);
+    query.addBindValue(record.promptTokens);
+    query.addBindValue(record.completionTokens);
+    
+    if (!query.exec()) {
+        qDebug() << "保存AI路由记录失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+int DatabaseManager::deleteAIRoutingRecordsBefore(const QDateTime& before)
+{
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM ai_routing_log WHERE created_at < ?");
+    query.addBindValue(before.toSecsSinceEpoch());
+    
+    if (query.exec()) {
+        return query.numRowsAffected();
+    }
+    
+    return 0;
+}
+
+QList<AIRoutingTierSummary> DatabaseManager::getAIRoutingSummary(const QDateTime& since)
+{
+    QList<AIRoutingTierSummary> summaries;
+    
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        SELECT tier, COUNT(*), SUM(success), SUM(from_cache)
+        FROM ai_routing_log
+        WHERE created_at >= ?
+        GROUP BY tier
+    )");
+    query.addBindValue(since.toSecsSinceEpoch());
+    
+    if (!query.exec()) {
+        qDebug() << "查询AI路由汇总失败:" << query.lastError().text();
+        return summaries;
+    }
+    
+    while (query.next()) {
+        AIRoutingTierSummary summary;
+        summary.tier = query.value(0).toString();
+        summary.requests = query.value(1).toInt();
+        summary.successes = query.value(2).toInt();
+        summary.cacheHits = query.value(3).toInt();
+        summaries.append(summary);
+    }
+    
+    // 中位耗时：按耗时排序后取中间一行
+    QSqlQuery medianQuery(m_database);
+    medianQuery.prepare(R"(
+        SELECT latency_ms FROM ai_routing_log
+        WHERE created_at >= ? AND tier = ?
+        ORDER BY latency_ms
+        LIMIT 1 OFFSET ?
+    )");
+    for (AIRoutingTierSummary& summary : summaries) {
+        medianQuery.addBindValue(since.toSecsSinceEpoch());
+        medianQuery.addBindValue(summary.tier);
+        medianQuery.addBindValue((summary.requests - 1) / 2);
+        if (medianQuery.exec() && medianQuery.next()) {
+            summary.medianLatencyMs = medianQuery.value(0).toLongLong();
+        }
+    }
+    
+    return summaries;
+}
+
+// ========== AI熔断器记录 ==========
+
+bool DatabaseManager::saveAIBreakerSnapshot(const AIBreakerSnapshot& snapshot)
+{
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        INSERT OR REPLACE INTO ai_breaker_stats (instance_id, started_at, updated_at, state, failure_rate,
+                                                 window_samples, consecutive_failures, reopen_at, last_opened_at,
+                                                 opens, successes, failures, short_circuited, retries, hedges, hedge_wins)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(snapshot.instanceId);
+    query.addBindValue(snapshot.startedAt.toSecsSinceEpoch());
+    query.addBindValue(snapshot.updatedAt.toSecsSinceEpoch());
+    query.addBindValue(snapshot.state);
+    query.addBindValue(snapshot.failureRate);
+    query.addBindValue(snapshot.windowSamples);
+    query.addBindValue(snapshot.consecutiveFailures);
+    query.addBindValue(snapshot.reopenAt.isValid() ? snapshot.reopenAt.toSecsSinceEpoch() : 0);
+    query.addBindValue(snapshot.lastOpenedAt.isValid() ? snapshot.lastOpenedAt.toSecsSinceEpoch() : 0);
+    query.addBindValue(snapshot.opens);
+    query.addBindValue(snapshot.successes);
+    query.addBindValue(snapshot.failures);
+    query.addBindValue(snapshot.shortCircuited);
+    query.addBindValue(snapshot.retries);
+    query.addBindValue(snapshot.hedges);
+    query.addBindValue(snapshot.hedgeWins);
+    
+    if (!query.exec()) {
+        qDebug() << "保存AI熔断器统计失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+bool DatabaseManager::addAIBreakerTransition(const AIBreakerTransition& transition)
+{
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        INSERT INTO ai_breaker_log (created_at, instance_id, from_state, to_state, failure_rate,
+                                    consecutive_failures, open_duration_ms)
+        VALUES (?, ?, ?, ?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(transition.createdAt.toSecsSinceEpoch());
+    query.addBindValue(transition.instanceId);
+    query.addBindValue(transition.fromState);
+    query.addBindValue(transition.toState);
+    query.addBindValue(transition.failureRate);
+    query.addBindValue(transition.consecutiveFailures);
+    query.addBindValue(transition.openDurationMs);
+    
+    if (!query.exec()) {
+        qDebug() << "保存AI熔断器记录失败:" << query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+QList<AIBreakerSnapshot> DatabaseManager::getAIBreakerSnapshots(const QDateTime& updatedSince)
+{
+    QList<AIBreakerSnapshot> snapshots;
+    
+    QSqlQuery query(m_database);
+    query.prepare(R"(
+        SELECT instance_id, started_at, updated_at, state, failure_rate, window_samples, consecutive_failures,
+               reopen_at, last_opened_at, opens, successes, failures, short_circuited, retries, hedges, hedge_wins
+        FROM ai_breaker_stats
+        WHERE updated_at >= ?
+        ORDER BY updated_at DESC
+    )");
+    query.addBindValue(updatedSince.toSecsSinceEpoch());
+    
+    if (!query.exec()) {
+        qDebug() << "查询AI熔断器统计失败:" << query.lastError().text();
+        return snapshots;
+    }
+    
+    while (query.next()) {
+        AIBreakerSnapshot snapshot;
+        snapshot.instanceId = query.value(0).toString();
+        snapshot.startedAt = QDateTime::fromSecsSinceEpoch(query.value(1).toLongLong());
+        snapshot.updatedAt = QDateTime::fromSecsSinceEpoch(query.value(2).toLongLong());
+        snapshot.state = query.value(3).toString();
+        snapshot.failureRate = query.value(4).toDouble();
+        snapshot.windowSamples = query.value(5).toInt();
+        snapshot.consecutiveFailures = query.value(6).toInt();
+        qint64 reopenAt = query.value(7).toLongLong();
+        if (reopenAt > 0) {
+            snapshot.reopenAt = QDateTime::fromSecsSinceEpoch(reopenAt);
+        }
+        qint64 lastOpenedAt = query.value(8).toLongLong();
+        if (lastOpenedAt > 0) {
+            snapshot.lastOpenedAt = QDateTime::fromSecsSinceEpoch(lastOpenedAt);
+        }
+        snapshot.opens = query.value(9).toInt();
+        snapshot.successes = query.value(10).toInt();
+        snapshot.failures = query.value(11).toInt();
+        snapshot.shortCircuited = query.value(12).toInt();
+        snapshot.retries = query.value(13).toInt();
+        snapshot.hedges = query.value(14).toInt();
+        snapshot.hedgeWins = query.value(15).toInt();
+        snapshots.append(snapshot);
+    }
+    
+    return snapshots;
+}
+
+int DatabaseManager::deleteAIBreakerRecordsBefore(const QDateTime& before)
+{
+    QSqlQuery query(m_database);
+    int removed = 0;
+    
+    query.prepare("DELETE FROM ai_breaker_log WHERE created_at < ?");
+    query.addBindValue(before.toSecsSinceEpoch());
+    if (query.exec()) {
+        removed += query.numRowsAffected();
+    }
+    
+    query.prepare("DELETE FROM ai_breaker_stats WHERE updated_at < ?");
+    query.addBindValue(before.toSecsSinceEpoch());
+    if (query.exec()) {
+        removed += query.numRowsAffected();
+    }
+    
+    return removed;
+}
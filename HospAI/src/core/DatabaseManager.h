@@ -8,22 +8,29 @@
 #include <QString>
 #include <QDateTime>
 #include <QCryptographicHash>
+#include <functional>
+#include "RichMessageTypes.h"
+#include "SharedValue.h"
+#include "UserRole.h"
 
 struct UserInfo {
-    int id;
+    int id = 0;
+    int status = 0;
+    UserRole role = UserRole::Patient;
     QString userId;      // 用户ID字符串
     QString username;
     QString email;
     QString phone;
-    QString role;
     QString realName;
-    QString name;        // 显示名称，通常等于realName
+    QString avatarPath;
     QDateTime createdAt;
     QDateTime lastLogin;
-    QDateTime lastLoginTime; // 别名，指向lastLogin
-    int status;
-    bool isActive;       // 是否活跃，从status转换而来
-    QString avatarPath;
+    
+    // 显示名称：有真实姓名时用真实姓名
+    QString displayName() const { return realName.isEmpty() ? username : realName; }
+    // 是否活跃，由status得出
+    bool isActive() const { return status == 1; }
+    QString roleName() const { return userRoleName(role); }
 };
 
 // 聊天会话信息
@@ -39,17 +46,23 @@ struct ChatSession {
     QString lastMessage;
 };
 
+// 只读共享会话，用于信号分发和会话列表
+using SharedChatSession = SharedValue<ChatSession>;
+
 // 聊天消息信息
 struct ChatMessage {
     int id;
     int sessionId;
     int senderId;
     QString senderName;
-    QString senderRole;
+    UserRole senderRole = UserRole::Invalid;   // 系统消息为 UserRole::System
     QString content;
     QDateTime timestamp;
     int messageType; // 0-普通消息, 1-系统消息, 2-图片, 3-文件
     int isRead; // 0-未读, 1-已读
+    int contentVersion = 0; // 0-纯文本/旧版标记格式, >=1-结构化富文本信封
+    QString htmlContent;    // 富文本HTML片段
+    QStringList attachments; // 附件哈希列表
 };
 
 // 会话评价信息
@@ -76,6 +89,103 @@ struct QuickReply {
     QDateTime updatedAt;
 };
 
+// 附件信息（按内容SHA-256寻址）
+struct AttachmentInfo {
+    QString hash;        // SHA-256十六进制
+    QString mimeType;
+    QString fileName;    // 首次上传时的原始文件名
+    qint64 size;
+    bool referenced;     // 是否有消息引用过（发送消息时置位）
+    QDateTime createdAt;
+};
+
+// AI回复缓存条目（键为规范化提示词的SHA-256）
+struct AIResponseCacheEntry {
+    QString cacheKey;
+    QString response;    // AI完整回复文本
+    QDateTime createdAt;
+    QDateTime lastHitAt;
+    int hitCount = 0;
+};
+
+// AI回复缓存统计快照：每个进程一行，记录启动以来的累计计数
+struct AICacheSnapshot {
+    QString instanceId;      // 进程启动时生成
+    QDateTime startedAt;
+    QDateTime updatedAt;
+    qint64 lookups = 0;
+    qint64 hits = 0;
+    qint64 bypassed = 0;
+    qint64 stores = 0;
+    qint64 evictions = 0;
+    qint64 missLatencyMs = 0;
+    qint64 missLatencySamples = 0;
+    qint64 hitLatencyMs = 0;
+};
+
+// AI模型路由记录：一次请求选择的档位、依据和结果
+struct AIRoutingRecord {
+    QDateTime createdAt;
+    QString requestType;     // triage/symptom/department
+    QString tier;            // local/fast/large
+    QString model;
+    QString reason;
+    int inputChars = 0;
+    int historyTokens = 0;
+    double matchScore = 0.0;
+    bool emergency = false;
+    int maxTokens = 0;
+    int timeoutMs = 0;
+    bool success = false;
+    bool timedOut = false;
+    bool fromCache = false;
+    qint64 latencyMs = 0;
+    qint64 firstTokenMs = -1;
+    int attempts = 0;
+    int promptTokens = 0;    // 估算值
+    int completionTokens = 0;
+};
+
+// 一个档位在一段时间内的路由汇总
+struct AIRoutingTierSummary {
+    QString tier;            // local/fast/large
+    int requests = 0;
+    int successes = 0;
+    int cacheHits = 0;
+    qint64 medianLatencyMs = -1;
+};
+
+// AI熔断器快照：每个进程一行，记录当前状态和启动以来的累计计数
+struct AIBreakerSnapshot {
+    QString instanceId;      // 进程启动时生成
+    QDateTime startedAt;
+    QDateTime updatedAt;
+    QString state;           // closed/open/half_open
+    double failureRate = 0.0;
+    int windowSamples = 0;
+    int consecutiveFailures = 0;
+    QDateTime reopenAt;      // 熔断中放行探测请求的时间
+    QDateTime lastOpenedAt;
+    int opens = 0;
+    int successes = 0;
+    int failures = 0;
+    int shortCircuited = 0;
+    int retries = 0;
+    int hedges = 0;
+    int hedgeWins = 0;
+};
+
+// AI熔断器状态切换记录
+struct AIBreakerTransition {
+    QDateTime createdAt;
+    QString instanceId;
+    QString fromState;
+    QString toState;
+    double failureRate = 0.0;
+    int consecutiveFailures = 0;
+    int openDurationMs = 0;  // 切换到熔断时的冷却时间
+};
+
 class DatabaseManager : public QObject
 {
     Q_OBJECT
@@ -86,6 +196,8 @@ public:
     // 数据库初始化
     bool initDatabase();
     void closeDatabase();
+    // 命令行工具不打开数据库，写统计记录前先检查
+    bool isOpen() const;
     
     // 用户管理
     bool registerUser(const QString& username, const QString& password, 
@@ -95,6 +207,9 @@ public:
     bool updateLastLogin(int userId);
     bool isUsernameExists(const QString& username);
     bool isEmailExists(const QString& email);
+    // 用于构建注册查重的过滤器，可在后台线程调用
+    int getUserCount();
+    void forEachUserIdentity(const std::function<void(const QString& username, const QString& email)>& visitor);
     
     // 密码处理
     QString hashPassword(const QString& password);
@@ -116,13 +231,19 @@ public:
     bool updateChatSession(int sessionId, int staffId);
     bool closeChatSession(int sessionId);
     QList<ChatSession> getActiveSessions();
+    // 增量获取：since 为空时返回全部未结束会话，否则返回 last_message_at >= since 的会话（含已结束）
+    // watermark 返回本次结果中最大的 last_message_at，供下次调用
+    QList<ChatSession> getSessionsChangedSince(const QString& since, QString* watermark = nullptr);
     QList<ChatSession> getPatientSessions(int patientId);
     QList<ChatSession> getStaffSessions(int staffId);
     ChatSession getChatSession(int sessionId);
     
     // 聊天消息管理
     int sendMessage(int sessionId, int senderId, const QString& content, int messageType = 0);
+    int sendRichMessage(int sessionId, int senderId, const RichMessageEnvelope& envelope, int messageType = 0);
     QList<ChatMessage> getChatMessages(int sessionId, int limit = 50);
+    QList<ChatMessage> getChatMessagesAfter(int sessionId, int afterMessageId);
+    QList<ChatMessage> getChatMessagesBefore(int sessionId, int beforeMessageId, int limit);
     QList<ChatMessage> getUnreadMessages(int userId);
     bool markMessageAsRead(int messageId);
     bool markSessionAsRead(int sessionId, int userId);
@@ -151,13 +272,44 @@ public:
     bool updateQuickReply(int id, const QString& title, const QString& content, const QString& category, int sortOrder);
     bool deleteQuickReply(int id);
     bool toggleQuickReplyStatus(int id);
+    
+    // 附件管理
+    bool addAttachment(const QString& hash, const QString& mimeType, const QString& fileName, qint64 size);
+    AttachmentInfo getAttachmentInfo(const QString& hash);
+    QStringList getUnreferencedAttachments(const QDateTime& before);
+    bool deleteAttachment(const QString& hash);
+    
+    // AI回复缓存
+    QList<AIResponseCacheEntry> getAIResponseCacheEntries(const QDateTime& notBefore);
+    bool saveAIResponseCacheEntry(const AIResponseCacheEntry& entry);
+    // 在一个事务中批量保存
+    bool saveAIResponseCacheEntries(const QList<AIResponseCacheEntry>& entries);
+    bool deleteAIResponseCacheEntry(const QString& cacheKey);
+    int deleteAIResponseCacheBefore(const QDateTime& before);
+    bool saveAICacheSnapshot(const AICacheSnapshot& snapshot);
+    QList<AICacheSnapshot> getAICacheSnapshots(const QDateTime& updatedSince);
+    int deleteAICacheSnapshotsBefore(const QDateTime& before);
+    
+    // AI模型路由记录
+    bool addAIRoutingRecord(const AIRoutingRecord& record);
+    int deleteAIRoutingRecordsBefore(const QDateTime& before);
+    // 按档位汇总 since 之后的记录，没有记录的档位不返回
+    QList<AIRoutingTierSummary> getAIRoutingSummary(const QDateTime& since);
+    
+    // AI熔断器状态与计数
+    bool saveAIBreakerSnapshot(const AIBreakerSnapshot& snapshot);
+    bool addAIBreakerTransition(const AIBreakerTransition& transition);
+    // 按更新时间从新到旧
+    QList<AIBreakerSnapshot> getAIBreakerSnapshots(const QDateTime& updatedSince);
+    int deleteAIBreakerRecordsBefore(const QDateTime& before);
 
 signals:
     // 聊天相关信号
-    void newMessageReceived(const ChatMessage& message);
-    void sessionCreated(const ChatSession& session);
-    void sessionUpdated(const ChatSession& session);
+    void newMessageReceived(const SharedRichChatMessage& message);
+    void sessionCreated(const SharedChatSession& session);
+    void sessionUpdated(const SharedChatSession& session);
     void userOnlineStatusChanged(int userId, bool isOnline);
+    void userRegistered(const QString& username, const QString& email);
 
 private:
     explicit DatabaseManager(QObject *parent = nullptr);
@@ -165,6 +317,7 @@ private:
     
     bool createTables();
     QString getDbPath();
+    QSqlDatabase connectionForCurrentThread();
     
     static DatabaseManager* m_instance;
     QSqlDatabase m_database;
@@ -0,0 +1,249 @@
+#include "ImagePipeline.h"
+#include "AttachmentStore.h"
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QColor>
+#include <QThread>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+ImagePipeline* ImagePipeline::m_instance = nullptr;
+
+const QSize ImagePipeline::BUBBLE_SIZE(300, 300);
+
+ImagePipeline* ImagePipeline::instance()
+{
+    if (!m_instance) {
+        m_instance = new ImagePipeline;
+    }
+    return m_instance;
+}
+
+ImagePipeline::ImagePipeline(QObject *parent)
+    : QObject(parent)
+    , m_diskCacheLimit(64LL * 1024 * 1024)
+{
+    // 解码线程不宜过多，避免与界面线程争抢CPU
+    m_threadPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+    
+    // 默认内存缓存32MB
+    m_memoryCache.setMaxCost(32 * 1024);
+    
+    m_diskCacheDir = getDiskCacheDir();
+    
+    // 启动时在后台整理一次磁盘缓存
+    m_threadPool.start([this]() { trimDiskCache(); });
+}
+
+QString ImagePipeline::getDiskCacheDir()
+{
+    QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    QDir dir(cachePath);
+    if (!dir.exists()) {
+        dir.mkpath(cachePath);
+    }
+    return cachePath;
+}
+
+void ImagePipeline::setMemoryCacheLimit(int kilobytes)
+{
+    m_memoryCache.setMaxCost(kilobytes);
+}
+
+void ImagePipeline::setDiskCacheLimit(qint64 bytes)
+{
+    m_diskCacheLimit = bytes;
+}
+
+QString ImagePipeline::cacheKey(const QString& hash, const QSize& maxSize)
+{
+    return QString("%1_%2x%3").arg(hash).arg(maxSize.width()).arg(maxSize.height());
+}
+
+QSize ImagePipeline::fitSize(const QSize& imageSize, const QSize& maxSize)
+{
+    if (!imageSize.isValid()) {
+        return maxSize;
+    }
+    if (imageSize.width() <= maxSize.width() && imageSize.height() <= maxSize.height()) {
+        return imageSize;
+    }
+    return imageSize.scaled(maxSize, Qt::KeepAspectRatio);
+}
+
+QImage ImagePipeline::placeholder(const QSize& size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor("#E5E5EA"));
+    return image;
+}
+
+QSize ImagePipeline::scaledSize(const QString& hash, const QSize& maxSize)
+{
+    QImageReader reader(AttachmentStore::instance()->blobPath(hash));
+    return fitSize(reader.size(), maxSize);
+}
+
+QImage ImagePipeline::thumbnail(const QString& hash, const QSize& maxSize)
+{
+    QString key = cacheKey(hash, maxSize);
+    
+    if (QImage* cached = m_memoryCache.object(key)) {
+        return *cached;
+    }
+    
+    if (!m_pending.contains(key)) {
+        startDecode(hash, maxSize, QByteArray());
+    }
+    
+    return QImage();
+}
+
+QImage ImagePipeline::attachToDocument(QTextDocument* document, const QUrl& url, const QString& hash,
+                                       const QSize& maxSize)
+{
+    QImage cached = thumbnail(hash, maxSize);
+    if (!cached.isNull()) {
+        return cached;
+    }
+    
+    return waitInDocument(document, url, hash, maxSize, scaledSize(hash, maxSize));
+}
+
+QImage ImagePipeline::attachDataToDocument(QTextDocument* document, const QUrl& url, const QByteArray& imageData,
+                                           const QSize& maxSize)
+{
+    QString hash = QString(QCryptographicHash::hash(imageData, QCryptographicHash::Sha256).toHex());
+    QString key = cacheKey(hash, maxSize);
+    
+    if (QImage* cached = m_memoryCache.object(key)) {
+        return *cached;
+    }
+    
+    if (!m_pending.contains(key)) {
+        startDecode(hash, maxSize, imageData);
+    }
+    
+    // 只读取头部得到占位尺寸
+    QBuffer buffer;
+    buffer.setData(imageData);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    
+    return waitInDocument(document, url, hash, maxSize, fitSize(reader.size(), maxSize));
+}
+
+QImage ImagePipeline::waitInDocument(QTextDocument* document, const QUrl& url, const QString& hash,
+                                     const QSize& maxSize, const QSize& placeholderSize)
+{
+    if (document) {
+        DocumentWaiter waiter;
+        waiter.document = document;
+        waiter.url = url;
+        m_waiters[cacheKey(hash, maxSize)].append(waiter);
+    }
+    
+    return placeholder(placeholderSize);
+}
+
+void ImagePipeline::startDecode(const QString& hash, const QSize& maxSize, const QByteArray& imageData)
+{
+    QString key = cacheKey(hash, maxSize);
+    m_pending.insert(key);
+    
+    QString blobPath = imageData.isEmpty() ? AttachmentStore::instance()->blobPath(hash) : QString();
+    QString thumbPath = m_diskCacheDir + "/" + key + ".png";
+    
+    m_threadPool.start([this, hash, maxSize, imageData, blobPath, thumbPath]() {
+        QImage image;
+        
+        // 磁盘缓存命中，刷新修改时间作为LRU访问时间
+        if (QFileInfo::exists(thumbPath) && image.load(thumbPath)) {
+            QFile thumbFile(thumbPath);
+            if (thumbFile.open(QIODevice::ReadWrite)) {
+                thumbFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            }
+        }
+        
+        if (image.isNull()) {
+            QBuffer buffer;
+            QImageReader reader;
+            if (imageData.isEmpty()) {
+                reader.setFileName(blobPath);
+            } else {
+                buffer.setData(imageData);
+                buffer.open(QIODevice::ReadOnly);
+                reader.setDevice(&buffer);
+            }
+            reader.setAutoTransform(true);
+            
+            // 解码时直接缩放，避免先解出整张原图
+            QSize fullSize = reader.size();
+            if (fullSize.isValid()) {
+                reader.setScaledSize(fitSize(fullSize, maxSize));
+            }
+            image = reader.read();
+            
+            if (!image.isNull() && image.save(thumbPath, "PNG")) {
+                if (m_writesSinceTrim.fetchAndAddRelaxed(1) >= 50) {
+                    m_writesSinceTrim.storeRelaxed(0);
+                    trimDiskCache();
+                }
+            }
+        }
+        
+        QMetaObject::invokeMethod(this, [this, hash, maxSize, image]() {
+            finishDecode(hash, maxSize, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImagePipeline::finishDecode(const QString& hash, const QSize& maxSize, const QImage& image)
+{
+    QString key = cacheKey(hash, maxSize);
+    m_pending.remove(key);
+    QList<DocumentWaiter> waiters = m_waiters.take(key);
+    
+    if (image.isNull()) {
+        qDebug() << "ImagePipeline: 图片解码失败" << hash.left(12);
+        return;
+    }
+    
+    m_memoryCache.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    
+    // 用真实缩略图替换占位图并触发重新布局
+    for (const DocumentWaiter& waiter : waiters) {
+        if (waiter.document) {
+            waiter.document->addResource(QTextDocument::ImageResource, waiter.url, image);
+            waiter.document->markContentsDirty(0, waiter.document->characterCount());
+        }
+    }
+    
+    emit thumbnailReady(hash, maxSize, image);
+}
+
+void ImagePipeline::trimDiskCache()
+{
+    QDir dir(m_diskCacheDir);
+    // 按修改时间从旧到新
+    QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    
+    qint64 totalSize = 0;
+    for (const QFileInfo& info : files) {
+        totalSize += info.size();
+    }
+    
+    for (const QFileInfo& info : files) {
+        if (totalSize <= m_diskCacheLimit) {
+            break;
+        }
+        if (QFile::remove(info.absoluteFilePath())) {
+            totalSize -= info.size();
+        }
+    }
+}
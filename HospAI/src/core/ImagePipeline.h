@@ -0,0 +1,77 @@
+#ifndef IMAGEPIPELINE_H
+#define IMAGEPIPELINE_H
+
+#include <QObject>
+#include <QImage>
+#include <QSize>
+#include <QUrl>
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QPointer>
+#include <QThreadPool>
+#include <QTextDocument>
+#include <QAtomicInt>
+
+// 聊天图片处理管线：在线程池中用 QImageReader::setScaledSize 解码缩略图，
+// 按内容哈希做内存+磁盘两级LRU缓存；界面先显示占位图，缩略图就绪后再替换
+class ImagePipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ImagePipeline* instance();
+
+    // 聊天气泡中图片的最大显示尺寸
+    static const QSize BUBBLE_SIZE;
+
+    // 内存命中时直接返回；否则返回空图像并在后台解码，完成后发出 thumbnailReady
+    QImage thumbnail(const QString& hash, const QSize& maxSize = BUBBLE_SIZE);
+
+    // 返回可立即显示的图像（缓存缩略图或占位图），缩略图就绪后自动替换进文档并重新布局
+    QImage attachToDocument(QTextDocument* document, const QUrl& url, const QString& hash,
+                            const QSize& maxSize = BUBBLE_SIZE);
+    // 同上，用于旧消息中内嵌的 data: 图片
+    QImage attachDataToDocument(QTextDocument* document, const QUrl& url, const QByteArray& imageData,
+                                const QSize& maxSize = BUBBLE_SIZE);
+
+    // 只读取文件头得到缩放后的尺寸
+    QSize scaledSize(const QString& hash, const QSize& maxSize = BUBBLE_SIZE);
+    static QSize fitSize(const QSize& imageSize, const QSize& maxSize);
+    static QImage placeholder(const QSize& size);
+
+    void setMemoryCacheLimit(int kilobytes);
+    void setDiskCacheLimit(qint64 bytes);
+
+signals:
+    void thumbnailReady(const QString& hash, const QSize& maxSize, const QImage& image);
+
+private:
+    explicit ImagePipeline(QObject *parent = nullptr);
+
+    struct DocumentWaiter {
+        QPointer<QTextDocument> document;
+        QUrl url;
+    };
+
+    static QString cacheKey(const QString& hash, const QSize& maxSize);
+    void startDecode(const QString& hash, const QSize& maxSize, const QByteArray& imageData);
+    void finishDecode(const QString& hash, const QSize& maxSize, const QImage& image);
+    QImage waitInDocument(QTextDocument* document, const QUrl& url, const QString& hash,
+                          const QSize& maxSize, const QSize& placeholderSize);
+    void trimDiskCache();
+    QString getDiskCacheDir();
+
+    static ImagePipeline* m_instance;
+
+    QThreadPool m_threadPool;
+    QCache<QString, QImage> m_memoryCache;     // 代价单位：KB
+    QHash<QString, QList<DocumentWaiter>> m_waiters;
+    QSet<QString> m_pending;
+    QString m_diskCacheDir;
+    qint64 m_diskCacheLimit;
+    QAtomicInt m_writesSinceTrim;
+};
+
+#endif // IMAGEPIPELINE_H
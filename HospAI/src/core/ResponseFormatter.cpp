@@ -0,0 +1,135 @@
+#include "ResponseFormatter.h"
+
+ResponseFormatter* ResponseFormatter::m_instance = nullptr;
+
+ResponseFormatter* ResponseFormatter::instance()
+{
+    if (!m_instance) {
+        m_instance = new ResponseFormatter;
+    }
+    return m_instance;
+}
+
+ResponseFormatter::ResponseFormatter()
+{
+    // 高亮规则按原先的替换顺序排列，span 的嵌套顺序与之一致
+    addHighlightRule("⚠️", "紧急", "color: #FF3B30; font-weight: bold;");
+    addHighlightRule("🌡️", "", "color: #FF9500;");
+    addHighlightRule("🧠", "", "color: #5856D6;");
+    addHighlightRule("🫁", "", "color: #34C759;");
+    addHighlightRule("🏥", "", "color: #007AFF;");
+    addHighlightRule("📱", "", "color: #5AC8FA;");
+
+    // 科室标签：如 "内科："、"急诊医："
+    for (QChar c : QString("内外妇儿急皮眼耳口中")) {
+        m_departmentHeads.insert(c);
+    }
+    m_departmentSuffixes.insert(QChar(u'科'));
+    m_departmentSuffixes.insert(QChar(u'医'));
+    m_departmentOpenTag = "<span style='font-weight: bold; color: #007AFF;'>";
+}
+
+void ResponseFormatter::addHighlightRule(const QString& marker, const QString& requiredKeyword, const QString& style)
+{
+    HighlightRule rule;
+    rule.marker = marker;
+    rule.requiredKeyword = requiredKeyword;
+    rule.openTag = QString("<span style='%1'>").arg(style);
+
+    m_rulesByFirstChar[marker.at(0)].append(m_highlightRules.size());
+    m_highlightRules.append(rule);
+}
+
+int ResponseFormatter::matchHighlightRule(QStringView text, int pos, const QList<bool>& opened,
+                                         const QList<int>& lastKeywordPos) const
+{
+    auto it = m_rulesByFirstChar.constFind(text.at(pos));
+    if (it == m_rulesByFirstChar.constEnd()) {
+        return -1;
+    }
+
+    for (int index : it.value()) {
+        const HighlightRule& rule = m_highlightRules.at(index);
+        if (opened.at(index) || !text.mid(pos).startsWith(rule.marker)) {
+            continue;
+        }
+        // 关键词须出现在标记之后，换行不影响（原正则匹配时换行已是 <br>）
+        if (!rule.requiredKeyword.isEmpty() && lastKeywordPos.at(index) < pos + rule.marker.length()) {
+            continue;
+        }
+        return index;
+    }
+    return -1;
+}
+
+int ResponseFormatter::matchDepartmentLabel(QStringView text, int pos) const
+{
+    if (!m_departmentHeads.contains(text.at(pos))) {
+        return -1;
+    }
+
+    int end = pos + 1;
+    while (end < text.size() && m_departmentSuffixes.contains(text.at(end))) {
+        ++end;
+    }
+
+    if (end < text.size() && text.at(end) == QChar(u'：')) {
+        return end + 1;
+    }
+    return -1;
+}
+
+QString ResponseFormatter::toHtml(const QString& plainText) const
+{
+    QStringView text(plainText);
+
+    QString html;
+    html.reserve(plainText.size() + plainText.size() / 2 + 64);
+
+    // 每条规则只在标记首次出现处生效一次
+    QList<bool> opened(m_highlightRules.size(), false);
+    QList<int> lastKeywordPos(m_highlightRules.size(), -1);
+    for (int i = 0; i < m_highlightRules.size(); ++i) {
+        const QString& keyword = m_highlightRules.at(i).requiredKeyword;
+        if (!keyword.isEmpty()) {
+            lastKeywordPos[i] = plainText.lastIndexOf(keyword);
+        }
+    }
+    int openSpans = 0;
+
+    int pos = 0;
+    while (pos < text.size()) {
+        QChar c = text.at(pos);
+        if (c == QLatin1Char('\n')) {
+            html += "<br>";
+            ++pos;
+            continue;
+        }
+
+        int rule = matchHighlightRule(text, pos, opened, lastKeywordPos);
+        if (rule >= 0) {
+            html += m_highlightRules.at(rule).openTag;
+            opened[rule] = true;
+            ++openSpans;
+        }
+
+        int labelEnd = matchDepartmentLabel(text, pos);
+        if (labelEnd > pos) {
+            html += m_departmentOpenTag;
+            html += text.mid(pos, labelEnd - pos);
+            html += "</span>";
+            pos = labelEnd;
+            continue;
+        }
+
+        html += c;
+        ++pos;
+    }
+
+    // 高亮 span 都延伸到回复末尾
+    for (int i = 0; i < openSpans; ++i) {
+        html += "</span>";
+    }
+
+    return html;
+}
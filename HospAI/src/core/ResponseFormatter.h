@@ -0,0 +1,44 @@
+#ifndef RESPONSEFORMATTER_H
+#define RESPONSEFORMATTER_H
+
+#include <QString>
+#include <QStringView>
+#include <QList>
+#include <QHash>
+#include <QSet>
+
+// AI回复格式化：规则在构造时一次性编译，格式化时只扫描一遍文本，
+// 同时完成换行转换、标记高亮（紧急提示、表情前缀）和科室标签加粗。
+// 输出与原先逐条正则替换的结果逐字一致，由 tests/ 下的金样例固定
+class ResponseFormatter
+{
+public:
+    static ResponseFormatter* instance();
+
+    QString toHtml(const QString& plainText) const;
+
+private:
+    ResponseFormatter();
+
+    // 从标记首次出现处一直高亮到回复末尾。原实现先把换行换成 <br> 再用 [^\n]* 匹配，
+    // 所以高亮并不止于行尾，多个标记的 span 依次嵌套，末尾统一闭合
+    struct HighlightRule {
+        QString marker;
+        QString requiredKeyword;   // 非空时，标记之后必须出现该关键词
+        QString openTag;
+    };
+
+    void addHighlightRule(const QString& marker, const QString& requiredKeyword, const QString& style);
+    int matchHighlightRule(QStringView text, int pos, const QList<bool>& opened, const QList<int>& lastKeywordPos) const;
+    int matchDepartmentLabel(QStringView text, int pos) const;
+
+    static ResponseFormatter* m_instance;
+
+    QList<HighlightRule> m_highlightRules;
+    QHash<QChar, QList<int>> m_rulesByFirstChar;   // 按标记首字符索引规则
+    QSet<QChar> m_departmentHeads;
+    QSet<QChar> m_departmentSuffixes;
+    QString m_departmentOpenTag;
+};
+
+#endif // RESPONSEFORMATTER_H
@@ -0,0 +1,108 @@
+#include "RichMessageTypes.h"
+#include "AttachmentStore.h"
+#include "DatabaseManager.h"
+
+// 旧版消息格式：[RICH_TEXT]纯文本[/RICH_TEXT][HTML]完整HTML[/HTML]
+static const QString LEGACY_TEXT_BEGIN = "[RICH_TEXT]";
+static const QString LEGACY_TEXT_END = "[/RICH_TEXT]";
+static const QString LEGACY_HTML_BEGIN = "[HTML]";
+static const QString LEGACY_HTML_END = "[/HTML]";
+
+RichMessageEnvelope RichMessageEnvelope::fromEditor(const QString& plainText, const QString& documentHtml)
+{
+    RichMessageEnvelope envelope;
+    envelope.content = plainText;
+    envelope.htmlContent = extractBody(documentHtml);
+    envelope.attachments = AttachmentStore::extractReferences(envelope.htmlContent);
+    envelope.contentType = envelope.attachments.isEmpty() ? RichContentType::RichText : RichContentType::Mixed;
+    return envelope;
+}
+
+RichMessageEnvelope RichMessageEnvelope::fromStorage(int version, const QString& content,
+                                                     const QString& htmlContent, const QStringList& attachments)
+{
+    RichMessageEnvelope envelope;
+    envelope.version = version;
+    envelope.content = content;
+
+    if (version >= 1) {
+        // 结构化存储，字段直接可用
+        envelope.htmlContent = htmlContent;
+        envelope.attachments = attachments;
+        if (htmlContent.isEmpty()) {
+            envelope.contentType = RichContentType::Text;
+        } else {
+            envelope.contentType = attachments.isEmpty() ? RichContentType::RichText : RichContentType::Mixed;
+        }
+        return envelope;
+    }
+
+    // 旧数据：标记总在开头和结尾，按位置截取即可
+    int textEnd = content.startsWith(LEGACY_TEXT_BEGIN) ? content.indexOf(LEGACY_TEXT_END, LEGACY_TEXT_BEGIN.length()) : -1;
+    int htmlStart = textEnd + LEGACY_TEXT_END.length();
+
+    if (textEnd < 0 || content.mid(htmlStart, LEGACY_HTML_BEGIN.length()) != LEGACY_HTML_BEGIN) {
+        envelope.htmlContent = content;
+        envelope.contentType = RichContentType::Text;
+        return envelope;
+    }
+
+    htmlStart += LEGACY_HTML_BEGIN.length();
+    int htmlLength = content.length() - htmlStart;
+    if (content.endsWith(LEGACY_HTML_END)) {
+        htmlLength -= LEGACY_HTML_END.length();
+    }
+
+    envelope.content = content.mid(LEGACY_TEXT_BEGIN.length(), textEnd - LEGACY_TEXT_BEGIN.length());
+    envelope.htmlContent = extractBody(content.mid(htmlStart, htmlLength));
+    envelope.contentType = envelope.htmlContent.contains("<img") ? RichContentType::Mixed : RichContentType::RichText;
+    return envelope;
+}
+
+bool RichMessageEnvelope::isRichStorage(int version, const QString& content)
+{
+    if (version >= 1) {
+        return true;
+    }
+    return content.startsWith(LEGACY_TEXT_BEGIN);
+}
+
+QString RichMessageEnvelope::extractBody(const QString& documentHtml)
+{
+    // QTextEdit::toHtml() 导出的是完整文档，只保留<body>内部
+    if (!documentHtml.startsWith("<!DOCTYPE")) {
+        return documentHtml;
+    }
+
+    int bodyStart = documentHtml.indexOf("<body");
+    int contentStart = bodyStart >= 0 ? documentHtml.indexOf('>', bodyStart) : -1;
+    int bodyEnd = documentHtml.lastIndexOf("</body>");
+
+    if (contentStart < 0 || bodyEnd <= contentStart) {
+        return documentHtml;
+    }
+
+    return documentHtml.mid(contentStart + 1, bodyEnd - contentStart - 1);
+}
+
+RichChatMessage RichChatMessage::fromChatMessage(const ChatMessage& message)
+{
+    RichChatMessage richMessage;
+
+    if (RichMessageEnvelope::isRichStorage(message.contentVersion, message.content)) {
+        static_cast<RichMessageEnvelope&>(richMessage) = RichMessageEnvelope::fromStorage(
+            message.contentVersion, message.content, message.htmlContent, message.attachments);
+    } else {
+        richMessage.content = message.content;
+    }
+
+    richMessage.id = message.id;
+    richMessage.sessionId = message.sessionId;
+    richMessage.senderId = message.senderId;
+    richMessage.senderName = message.senderName;
+    richMessage.senderRole = message.senderRole;
+    richMessage.timestamp = message.timestamp;
+    richMessage.messageType = message.messageType;
+    richMessage.isRead = message.isRead;
+    return richMessage;
+}
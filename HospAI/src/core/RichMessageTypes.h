@@ -6,6 +6,8 @@
 #include <QStringList>
 #include <QMap>
 #include <QVariant>
+#include "SharedValue.h"
+#include "UserRole.h"
 
 // 富文本消息内容类型
 enum class RichContentType {
@@ -24,33 +26,61 @@ enum class MessageType {
     QuickReply      // 快捷回复
 };
 
+// 富文本消息信封：版本化的结构化内容，纯文本、HTML和附件引用分字段保存，
+// 由 RichMessage 与 RichChatMessage 共用
+struct RichMessageEnvelope {
+    static const int CURRENT_VERSION = 1;
+    
+    int version = CURRENT_VERSION;
+    QString content;        // 纯文本内容
+    QString htmlContent;    // HTML片段（只含<body>内部）
+    RichContentType contentType = RichContentType::Text;
+    QStringList attachments;  // 附件哈希列表
+    
+    bool isRich() const {
+        return contentType == RichContentType::RichText || contentType == RichContentType::Mixed;
+    }
+    
+    // 由编辑器导出的纯文本和完整HTML构造（只在发送时处理一次）
+    static RichMessageEnvelope fromEditor(const QString& plainText, const QString& documentHtml);
+    
+    // 由数据库字段还原；version为0的旧数据按 [RICH_TEXT]/[HTML] 标记格式读取
+    static RichMessageEnvelope fromStorage(int version, const QString& content,
+                                           const QString& htmlContent, const QStringList& attachments);
+    
+    // 是否为富文本消息（只检查版本号和前缀，不扫描全文）
+    static bool isRichStorage(int version, const QString& content);
+    
+    static QString extractBody(const QString& documentHtml);
+};
+
 // 富文本消息结构体（患者端使用）
-struct RichMessage {
-    QString content;        // 文本内容
-    QString htmlContent;    // HTML格式内容
+struct RichMessage : RichMessageEnvelope {
     MessageType type;
-    RichContentType contentType;
     QDateTime timestamp;
     QString sessionId;
-    QStringList attachments;  // 附件路径列表
     QMap<QString, QVariant> metadata; // 元数据（如字体、颜色等）
 };
 
+struct ChatMessage;
+
 // 富文本聊天消息结构体（客服端使用）
-struct RichChatMessage {
+struct RichChatMessage : RichMessageEnvelope {
     int id;
     int sessionId;
     int senderId;
     QString senderName;
-    QString senderRole;
-    QString content;        // 纯文本内容
-    QString htmlContent;    // HTML格式内容
-    RichContentType contentType;
+    UserRole senderRole = UserRole::Invalid;
     QDateTime timestamp;
     int messageType;
     int isRead;
-    QStringList attachments;  // 附件路径列表
     QMap<QString, QVariant> metadata; // 元数据
+    
+    // 由数据库消息转换：结构化信封直接取字段，旧版标记格式按位置截取，普通消息保持纯文本
+    static RichChatMessage fromChatMessage(const ChatMessage& message);
 };
 
+// 只读共享消息：新消息信号和聊天记录模型之间只传递句柄
+using SharedRichChatMessage = SharedValue<RichChatMessage>;
+
 #endif // RICHMESSAGETYPES_H 
\ No newline at end of file
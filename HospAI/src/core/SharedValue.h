@@ -0,0 +1,43 @@
+#ifndef SHAREDVALUE_H
+#define SHAREDVALUE_H
+
+#include <QSharedData>
+#include <QExplicitlySharedDataPointer>
+#include <utility>
+
+// 不可变的共享值：构造后只读，复制和跨信号分发只增加一次引用计数，
+// 不再逐个复制结构体里的 QString/QStringList/QMap 成员
+template <typename T>
+class SharedValue
+{
+public:
+    SharedValue() : d(emptyData()) {}
+    SharedValue(const T& value) : d(new Data(value)) {}
+    SharedValue(T&& value) : d(new Data(std::move(value))) {}
+
+    const T& operator*() const { return d->value; }
+    const T* operator->() const { return &d->value; }
+    const T& value() const { return d->value; }
+
+    // 两个句柄是否指向同一份数据
+    bool isSharedWith(const SharedValue& other) const { return d == other.d; }
+
+private:
+    struct Data : QSharedData {
+        Data() = default;
+        explicit Data(const T& v) : value(v) {}
+        explicit Data(T&& v) : value(std::move(v)) {}
+        const T value{};
+    };
+
+    // 默认构造共用一份空数据，不分配
+    static const QExplicitlySharedDataPointer<const Data>& emptyData()
+    {
+        static const QExplicitlySharedDataPointer<const Data> empty(new Data);
+        return empty;
+    }
+
+    QExplicitlySharedDataPointer<const Data> d;
+};
+
+#endif // SHAREDVALUE_H
@@ -0,0 +1,231 @@
+#include "StartupProfiler.h"
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QHash>
+#include <QThread>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+StartupProfiler* StartupProfiler::m_instance = nullptr;
+
+static const char* TRACE_FLAG = "--startup-trace";
+static const char* BUDGET_FLAG = "--startup-budget=";
+static const QString DEFAULT_TRACE_PATH = "startup-trace.json";
+
+// 当前线程上打开的阶段层数，用于汇总表缩进
+static thread_local int s_depth = 0;
+
+StartupProfiler::Scope::Scope(const QString& name)
+    : m_startUs(-1)
+    , m_depth(0)
+{
+    StartupProfiler* profiler = StartupProfiler::instance();
+    if (!profiler->isEnabled()) {
+        return;
+    }
+
+    m_name = name;
+    m_depth = s_depth++;
+    m_startUs = profiler->nowUs();
+}
+
+StartupProfiler::Scope::~Scope()
+{
+    if (m_startUs < 0) {
+        return;
+    }
+
+    StartupProfiler* profiler = StartupProfiler::instance();
+    --s_depth;
+    profiler->record(m_name, m_startUs, profiler->nowUs() - m_startUs, m_depth);
+}
+
+StartupProfiler* StartupProfiler::instance()
+{
+    if (!m_instance) {
+        m_instance = new StartupProfiler;
+    }
+    return m_instance;
+}
+
+StartupProfiler::StartupProfiler()
+    : m_enabled(false)
+    , m_budgetMs(0)
+{
+    // 第一次使用时开始计时，main 开头调用即覆盖 QApplication 的创建
+    m_clock.start();
+}
+
+void StartupProfiler::configureFromArguments(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        QString argument = QString::fromLocal8Bit(argv[i]);
+
+        if (argument == TRACE_FLAG) {
+            m_tracePath = DEFAULT_TRACE_PATH;
+            m_enabled = true;
+        } else if (argument.startsWith(QString(TRACE_FLAG) + "=")) {
+            m_tracePath = argument.mid(qstrlen(TRACE_FLAG) + 1);
+            if (m_tracePath.isEmpty()) {
+                m_tracePath = DEFAULT_TRACE_PATH;
+            }
+            m_enabled = true;
+        } else if (argument.startsWith(BUDGET_FLAG)) {
+            m_budgetMs = argument.mid(qstrlen(BUDGET_FLAG)).toLongLong();
+        }
+    }
+}
+
+QString StartupProfiler::tracePath() const
+{
+    return m_tracePath;
+}
+
+qint64 StartupProfiler::budgetMs() const
+{
+    return m_budgetMs;
+}
+
+qint64 StartupProfiler::nowUs() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
+
+qint64 StartupProfiler::elapsedMs() const
+{
+    return m_clock.elapsed();
+}
+
+void StartupProfiler::mark(const QString& name)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    record(name, nowUs(), -1, s_depth);
+}
+
+void StartupProfiler::record(const QString& name, qint64 startUs, qint64 durationUs, int depth)
+{
+    Event event;
+    event.name = name;
+    event.startUs = startUs;
+    event.durationUs = durationUs;
+    event.depth = depth;
+    event.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    QMutexLocker locker(&m_mutex);
+    m_events.append(event);
+}
+
+bool StartupProfiler::writeChromeTrace(const QString& path) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 线程句柄映射为从 1 开始的小整数，主线程为 1
+    QHash<quintptr, int> threadIds;
+    QJsonArray traceEvents;
+    qint64 pid = QCoreApplication::applicationPid();
+
+    for (const Event& event : m_events) {
+        if (!threadIds.contains(event.threadId)) {
+            threadIds.insert(event.threadId, threadIds.size() + 1);
+        }
+
+        QJsonObject object;
+        object["name"] = event.name;
+        object["cat"] = "startup";
+        object["ts"] = event.startUs;
+        object["pid"] = pid;
+        object["tid"] = threadIds.value(event.threadId);
+        if (event.durationUs >= 0) {
+            object["ph"] = "X";
+            object["dur"] = event.durationUs;
+        } else {
+            object["ph"] = "i";
+            object["s"] = "g";
+        }
+        traceEvents.append(object);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入启动 trace 文件:" << path << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+QString StartupProfiler::summaryTable() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 阶段按开始时间排列，嵌套阶段缩进显示；占比相对于启动总耗时
+    QList<Event> events = m_events;
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.startUs < b.startUs;
+    });
+
+    qint64 totalUs = qMax<qint64>(1, nowUs());
+    QString table = QString("%1  %2  %3  %4\n")
+                    .arg("阶段", -40)
+                    .arg("开始(ms)", 10)
+                    .arg("耗时(ms)", 10)
+                    .arg("占比", 7);
+
+    for (const Event& event : events) {
+        QString name = QString(event.depth * 2, ' ') + event.name;
+        if (event.durationUs < 0) {
+            table += QString("%1  %2  %3  %4\n")
+                     .arg("* " + name, -40)
+                     .arg(event.startUs / 1000.0, 10, 'f', 1)
+                     .arg("-", 10)
+                     .arg("-", 7);
+            continue;
+        }
+        table += QString("%1  %2  %3  %4%\n")
+                 .arg(name, -40)
+                 .arg(event.startUs / 1000.0, 10, 'f', 1)
+                 .arg(event.durationUs / 1000.0, 10, 'f', 1)
+                 .arg(100.0 * event.durationUs / totalUs, 6, 'f', 1);
+    }
+
+    table += QString("%1  %2  %3\n")
+             .arg("启动总耗时", -40)
+             .arg("", 10)
+             .arg(totalUs / 1000.0, 10, 'f', 1);
+    return table;
+}
+
+int StartupProfiler::finish()
+{
+    if (!isEnabled()) {
+        return 0;
+    }
+
+    qint64 totalMs = elapsedMs();
+    mark("startup complete");
+
+    int exitCode = 0;
+    if (!writeChromeTrace(m_tracePath)) {
+        exitCode = 3;
+    } else {
+        qInfo().noquote() << "启动 trace 已写入:" << m_tracePath;
+    }
+
+    qInfo().noquote() << "\n" + summaryTable();
+
+    if (m_budgetMs > 0 && totalMs > m_budgetMs) {
+        qWarning().noquote() << QString("启动耗时 %1 ms 超出预算 %2 ms").arg(totalMs).arg(m_budgetMs);
+        exitCode = 2;
+    }
+    return exitCode;
+}
@@ -0,0 +1,78 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+
+// 启动阶段计时：用 Scope 包住 main、数据库初始化和窗口构造中的各个阶段，
+// --startup-trace 模式下导出 Chrome trace JSON（chrome://tracing、Perfetto 可打开）并打印汇总表。
+// 未启用时 Scope 只检查一次开关，不取时间
+class StartupProfiler
+{
+public:
+    // 作用域计时，析构时记录一个完整阶段；同一线程内可嵌套
+    class Scope
+    {
+    public:
+        explicit Scope(const QString& name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        QString m_name;
+        qint64 m_startUs;
+        int m_depth;
+    };
+
+    static StartupProfiler* instance();
+
+    // 在 QApplication 创建之前调用，识别 --startup-trace[=文件] 和 --startup-budget=毫秒
+    void configureFromArguments(int argc, char* argv[]);
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    QString tracePath() const;
+    // 启动总耗时预算，0 表示不检查
+    qint64 budgetMs() const;
+
+    // 记录一个瞬时事件，例如首帧绘制完成
+    void mark(const QString& name);
+    // 从进程开始计时到现在的毫秒数
+    qint64 elapsedMs() const;
+
+    bool writeChromeTrace(const QString& path) const;
+    QString summaryTable() const;
+
+    // 写出 trace、打印汇总并按预算返回进程退出码：0 通过，2 超出预算，3 写文件失败
+    int finish();
+
+private:
+    StartupProfiler();
+
+    struct Event {
+        QString name;
+        qint64 startUs;
+        qint64 durationUs;  // 瞬时事件为 -1
+        int depth;
+        quintptr threadId;
+    };
+
+    void record(const QString& name, qint64 startUs, qint64 durationUs, int depth);
+    qint64 nowUs() const;
+
+    static StartupProfiler* m_instance;
+
+    std::atomic<bool> m_enabled;
+    QElapsedTimer m_clock;
+    QString m_tracePath;
+    qint64 m_budgetMs;
+
+    mutable QMutex m_mutex;
+    QList<Event> m_events;
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,54 @@
+#include "StringPool.h"
+#include <QMutexLocker>
+
+StringPool* StringPool::m_instance = nullptr;
+
+// 超过这个长度的字符串基本不会重复，不进入池
+static const int MAX_INTERN_LENGTH = 64;
+
+StringPool* StringPool::instance()
+{
+    if (!m_instance) {
+        m_instance = new StringPool;
+    }
+    return m_instance;
+}
+
+QString StringPool::intern(const QString& value)
+{
+    if (value.isEmpty() || value.size() > MAX_INTERN_LENGTH) {
+        return value;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_current.constFind(value);
+    if (it != m_current.constEnd()) {
+        return *it;
+    }
+
+    QString pooled = value;
+    auto previous = m_previous.constFind(value);
+    if (previous != m_previous.constEnd()) {
+        pooled = *previous;
+    }
+
+    if (m_current.size() >= MAX_SIZE / 2) {
+        m_previous.swap(m_current);
+        m_current.clear();
+    }
+    m_current.insert(pooled);
+    return pooled;
+}
+
+int StringPool::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current.size() + m_previous.size();
+}
+
+void StringPool::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_current.clear();
+    m_previous.clear();
+}
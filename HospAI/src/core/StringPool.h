@@ -0,0 +1,33 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QSet>
+#include <QMutex>
+
+// 字符串驻留池：重复出现的短字符串（发送者姓名、会话双方姓名等）只保留一份数据，
+// 返回的 QString 与池中共享同一缓冲区。可在后台线程调用。
+// 池的大小有上限：分新旧两代，新一代满一半容量时整体降为旧一代、原来的旧一代丢弃，
+// 仍在使用的字符串会在下次命中时回到新一代。丢弃的只是池中的引用，已返回的字符串不受影响
+class StringPool
+{
+public:
+    static StringPool* instance();
+
+    static const int MAX_SIZE = 8192;   // 两代合计的最大条目数
+
+    QString intern(const QString& value);
+    int size() const;
+    void clear();
+
+private:
+    StringPool() = default;
+
+    static StringPool* m_instance;
+
+    mutable QMutex m_mutex;
+    QSet<QString> m_current;
+    QSet<QString> m_previous;
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,284 @@
+#include "SymptomMatcher.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStandardPaths>
+#include <QQueue>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+
+SymptomMatcher* SymptomMatcher::m_instance = nullptr;
+
+const QString SymptomMatcher::BUILTIN_LEXICON_PATH = ":/data/triage_lexicon.json";
+const QString SymptomMatcher::LEXICON_FILE_NAME = "triage_lexicon.json";
+
+SymptomMatcher* SymptomMatcher::instance()
+{
+    if (!m_instance) {
+        m_instance = new SymptomMatcher;
+        m_instance->loadDefaultLexicon();
+    }
+    return m_instance;
+}
+
+SymptomMatcher::SymptomMatcher(QObject *parent)
+    : QObject(parent)
+    , m_minScore(3.0)
+    , m_marginRatio(2.0)
+    , m_loaded(false)
+{
+    m_nodes.append(Node());
+}
+
+void SymptomMatcher::loadDefaultLexicon()
+{
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString overridePath = dataPath + "/" + LEXICON_FILE_NAME;
+    if (QFile::exists(overridePath) && loadLexicon(overridePath)) {
+        return;
+    }
+    loadLexicon(BUILTIN_LEXICON_PATH);
+}
+
+bool SymptomMatcher::loadLexicon(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "SymptomMatcher: 无法读取词典" << path;
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (doc.isNull()) {
+        qDebug() << "SymptomMatcher: 词典格式错误" << path << parseError.errorString();
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    QList<Category> categories;
+    QList<Term> terms;
+
+    const QJsonArray categoryArray = root["categories"].toArray();
+    for (const QJsonValue& categoryValue : categoryArray) {
+        QJsonObject categoryObj = categoryValue.toObject();
+
+        Category category;
+        category.id = categoryObj["id"].toString();
+        category.department = categoryObj["department"].toString();
+        category.reason = categoryObj["reason"].toString();
+        category.response = categoryObj["response"].toString();
+        category.action = categoryObj["action"].toString();
+        category.emergency = categoryObj["emergency"].toBool();
+
+        const QJsonArray termArray = categoryObj["terms"].toArray();
+        for (const QJsonValue& termValue : termArray) {
+            QJsonObject termObj = termValue.toObject();
+
+            Term term;
+            term.text = normalize(termObj["term"].toString());
+            term.category = categories.size();
+            term.weight = termObj["weight"].toDouble(1.0);
+            term.urgent = termObj["urgent"].toBool();
+            if (!term.text.isEmpty()) {
+                terms.append(term);
+            }
+        }
+
+        categories.append(category);
+    }
+
+    m_categories = categories;
+    m_terms = terms;
+    m_minScore = root["minScore"].toDouble(3.0);
+    m_marginRatio = root["marginRatio"].toDouble(2.0);
+    build();
+    m_loaded = true;
+
+    qDebug() << "SymptomMatcher: 已加载词典" << path << "类别" << m_categories.size() << "词条" << m_terms.size();
+    return true;
+}
+
+void SymptomMatcher::build()
+{
+    m_nodes.clear();
+    m_nodes.append(Node());
+
+    // 建立字典树
+    for (int termIndex = 0; termIndex < m_terms.size(); ++termIndex) {
+        int state = 0;
+        for (const QChar& ch : m_terms[termIndex].text) {
+            int next = m_nodes[state].next.value(ch, -1);
+            if (next < 0) {
+                next = m_nodes.size();
+                m_nodes[state].next.insert(ch, next);
+                m_nodes.append(Node());
+            }
+            state = next;
+        }
+        m_nodes[state].outputs.append(termIndex);
+    }
+
+    // 按层遍历计算失败指针，并把失败链上的输出合并进来，匹配时不必再沿链查找
+    QQueue<int> queue;
+    for (int child : std::as_const(m_nodes[0].next)) {
+        m_nodes[child].fail = 0;
+        queue.enqueue(child);
+    }
+
+    while (!queue.isEmpty()) {
+        int state = queue.dequeue();
+        for (auto it = m_nodes[state].next.constBegin(); it != m_nodes[state].next.constEnd(); ++it) {
+            QChar ch = it.key();
+            int child = it.value();
+
+            int fallback = m_nodes[state].fail;
+            while (fallback > 0 && !m_nodes[fallback].next.contains(ch)) {
+                fallback = m_nodes[fallback].fail;
+            }
+            m_nodes[child].fail = m_nodes[fallback].next.value(ch, 0);
+            m_nodes[child].outputs += m_nodes[m_nodes[child].fail].outputs;
+
+            queue.enqueue(child);
+        }
+    }
+}
+
+QString SymptomMatcher::normalize(const QString& text)
+{
+    // 全角字符折叠为半角，忽略大小写
+    return text.normalized(QString::NormalizationForm_KC).toCaseFolded();
+}
+
+SymptomMatcher::MatchResult SymptomMatcher::match(const QString& text) const
+{
+    MatchResult result;
+    result.scores.fill(0.0, m_categories.size());
+    if (m_terms.isEmpty()) {
+        return result;
+    }
+
+    // 单次扫描收集全部命中
+    QString input = normalize(text);
+    QList<TermMatch> candidates;
+    int state = 0;
+    for (int i = 0; i < input.size(); ++i) {
+        QChar ch = input.at(i);
+        while (state > 0 && !m_nodes[state].next.contains(ch)) {
+            state = m_nodes[state].fail;
+        }
+        state = m_nodes[state].next.value(ch, 0);
+
+        for (int termIndex : m_nodes[state].outputs) {
+            const Term& term = m_terms[termIndex];
+            TermMatch candidate;
+            candidate.category = term.category;
+            candidate.term = termIndex;
+            candidate.length = term.text.size();
+            candidate.position = i - candidate.length + 1;
+            candidate.weight = term.weight;
+            candidates.append(candidate);
+        }
+    }
+
+    // 重叠时取最左最长的词条，"呼吸困难"不再额外计入"呼吸"
+    std::sort(candidates.begin(), candidates.end(), [](const TermMatch& a, const TermMatch& b) {
+        if (a.position != b.position) {
+            return a.position < b.position;
+        }
+        return a.length > b.length;
+    });
+
+    QSet<int> countedTerms;
+    int coveredUntil = 0;
+    for (const TermMatch& candidate : std::as_const(candidates)) {
+        if (candidate.position < coveredUntil) {
+            continue;
+        }
+        coveredUntil = candidate.position + candidate.length;
+        result.matches.append(candidate);
+
+        // 同一词条重复出现只计一次分
+        if (!countedTerms.contains(candidate.term)) {
+            countedTerms.insert(candidate.term);
+            result.scores[candidate.category] += candidate.weight;
+        }
+        if (m_categories[candidate.category].emergency) {
+            result.emergency = true;
+        }
+        if (m_terms[candidate.term].urgent) {
+            result.urgent = true;
+        }
+    }
+
+    for (int i = 0; i < result.scores.size(); ++i) {
+        double score = result.scores[i];
+        if (score <= 0.0) {
+            continue;
+        }
+        if (score > result.bestScore) {
+            result.runnerUpScore = result.bestScore;
+            result.bestScore = score;
+            result.bestCategory = i;
+        } else if (score > result.runnerUpScore) {
+            result.runnerUpScore = score;
+        }
+    }
+
+    // 急症得分达标时优先于其他类别
+    for (int i = 0; i < m_categories.size(); ++i) {
+        if (m_categories[i].emergency && result.scores[i] >= m_minScore) {
+            result.bestCategory = i;
+            result.confident = true;
+            return result;
+        }
+    }
+
+    // 提到急症词但不够明确时交给AI判断
+    result.confident = !result.emergency
+                    && result.bestCategory >= 0
+                    && result.bestScore >= m_minScore
+                    && result.bestScore >= m_marginRatio * result.runnerUpScore;
+    return result;
+}
+
+const SymptomMatcher::Category& SymptomMatcher::category(int index) const
+{
+    static const Category empty;
+    if (index < 0 || index >= m_categories.size()) {
+        return empty;
+    }
+    return m_categories[index];
+}
+
+QString SymptomMatcher::emergencyLevel(const MatchResult& result) const
+{
+    const Category& best = category(result.bestCategory);
+    if (best.emergency && result.confident) {
+        return "critical";
+    }
+    if (result.emergency || result.urgent) {
+        return "high";
+    }
+    return best.department.isEmpty() ? "low" : "medium";
+}
+
+QString SymptomMatcher::termText(int termIndex) const
+{
+    if (termIndex < 0 || termIndex >= m_terms.size()) {
+        return QString();
+    }
+    return m_terms[termIndex].text;
+}
+
+int SymptomMatcher::categoryCount() const
+{
+    return m_categories.size();
+}
+
+bool SymptomMatcher::isLoaded() const
+{
+    return m_loaded;
+}
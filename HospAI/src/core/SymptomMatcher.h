@@ -0,0 +1,94 @@
+#ifndef SYMPTOMMATCHER_H
+#define SYMPTOMMATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+
+// 症状词典匹配：词典从JSON加载并编译成 Aho–Corasick 自动机，
+// 一次扫描输入得到所有词条命中和各类别的加权得分。
+// 得分足够高且明显领先时可以直接本地回复，否则交给AI分诊
+class SymptomMatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SymptomMatcher* instance();
+
+    // 内置词典；数据目录下存在同名文件时优先使用，便于不重新编译就调整词条
+    static const QString BUILTIN_LEXICON_PATH;
+    static const QString LEXICON_FILE_NAME;
+
+    struct Category {
+        QString id;
+        QString department;    // 推荐科室，可为空
+        QString reason;        // 推荐理由
+        QString response;      // 本地回复内容
+        QString action;        // 特殊动作，如 "transfer" 转人工
+        bool emergency = false;
+    };
+
+    struct TermMatch {
+        int category = -1;
+        int term = -1;
+        int position = 0;      // 在规范化文本中的起始位置
+        int length = 0;
+        double weight = 0.0;
+    };
+
+    struct MatchResult {
+        QList<TermMatch> matches;
+        QVector<double> scores;     // 按类别下标
+        int bestCategory = -1;
+        double bestScore = 0.0;
+        double runnerUpScore = 0.0;
+        bool emergency = false;     // 命中任意急症词条
+        bool urgent = false;        // 命中需要尽快就医的修饰词（如高烧）
+        bool confident = false;     // 可以不经AI直接回复
+
+        bool hasMatch() const { return bestCategory >= 0; }
+    };
+
+    bool loadLexicon(const QString& path);
+    bool isLoaded() const;
+
+    MatchResult match(const QString& text) const;
+    const Category& category(int index) const;
+    // 本地分诊的紧急程度，取值与AI结果一致（low/medium/high/critical）
+    QString emergencyLevel(const MatchResult& result) const;
+    QString termText(int termIndex) const;
+    int categoryCount() const;
+
+private:
+    explicit SymptomMatcher(QObject *parent = nullptr);
+
+    struct Term {
+        QString text;
+        int category;
+        double weight;
+        bool urgent;
+    };
+
+    struct Node {
+        QHash<QChar, int> next;
+        int fail = 0;
+        QList<int> outputs;    // 以该节点结尾的词条，含失败链上的
+    };
+
+    void loadDefaultLexicon();
+    void build();
+    static QString normalize(const QString& text);
+
+    static SymptomMatcher* m_instance;
+
+    QList<Category> m_categories;
+    QList<Term> m_terms;
+    QVector<Node> m_nodes;
+    double m_minScore;
+    double m_marginRatio;
+    bool m_loaded;
+};
+
+#endif // SYMPTOMMATCHER_H
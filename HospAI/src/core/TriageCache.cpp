@@ -0,0 +1,296 @@
+#include "TriageCache.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QTimer>
+#include <QUuid>
+#include <QDebug>
+
+TriageCache* TriageCache::m_instance = nullptr;
+
+TriageCache* TriageCache::instance()
+{
+    if (!m_instance) {
+        m_instance = new TriageCache;
+    }
+    return m_instance;
+}
+
+TriageCache::TriageCache(QObject *parent)
+    : QObject(parent)
+    , m_loaded(false)
+    , m_ttlSecs(DEFAULT_TTL_SECS)
+    , m_maxEntries(DEFAULT_MAX_ENTRIES)
+    , m_flushTimer(new QTimer(this))
+    , m_instanceId(QUuid::createUuid().toString(QUuid::WithoutBraces))
+    , m_startedAt(QDateTime::currentDateTimeUtc())
+    , m_statsPruned(false)
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &TriageCache::flush);
+
+    // 退出前写入还没落库的条目和计数
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            if (m_flushTimer->isActive()) {
+                flush();
+            }
+        });
+    }
+}
+
+double TriageCache::Stats::hitRatio() const
+{
+    return lookups > 0 ? double(hits) / double(lookups) : 0.0;
+}
+
+qint64 TriageCache::Stats::estimatedSavedMs() const
+{
+    if (missLatencySamples == 0) {
+        return 0;
+    }
+    qint64 averageMissMs = missLatencyMs / qint64(missLatencySamples);
+    return qMax<qint64>(0, averageMissMs * qint64(hits) - hitLatencyMs);
+}
+
+TriageCache::Stats TriageCache::Stats::fromSnapshot(const AICacheSnapshot& snapshot)
+{
+    Stats stats;
+    stats.lookups = quint64(snapshot.lookups);
+    stats.hits = quint64(snapshot.hits);
+    stats.bypassed = quint64(snapshot.bypassed);
+    stats.stores = quint64(snapshot.stores);
+    stats.evictions = quint64(snapshot.evictions);
+    stats.missLatencyMs = snapshot.missLatencyMs;
+    stats.missLatencySamples = quint64(snapshot.missLatencySamples);
+    stats.hitLatencyMs = snapshot.hitLatencyMs;
+    return stats;
+}
+
+QString TriageCache::normalizeText(const QString& text)
+{
+    // NFKC 把全角字母、数字和标点折叠成半角
+    QString folded = text.normalized(QString::NormalizationForm_KC).toCaseFolded();
+
+    QString normalized;
+    normalized.reserve(folded.size());
+    for (const QChar& ch : folded) {
+        if (ch.isSpace() || ch.isPunct() || ch.isSymbol()) {
+            continue;
+        }
+        normalized.append(ch);
+    }
+    return normalized;
+}
+
+QString TriageCache::makeKey(const QString& requestType, const QString& model,
+                             const QString& prompt, const QString& history)
+{
+    QByteArray historyHash = QCryptographicHash::hash(normalizeText(history).toUtf8(),
+                                                      QCryptographicHash::Sha256).toHex();
+
+    QByteArray material = requestType.toUtf8() + '\n' + model.toUtf8() + '\n'
+                        + normalizeText(prompt).toUtf8() + '\n' + historyHash;
+    return QString::fromLatin1(QCryptographicHash::hash(material, QCryptographicHash::Sha256).toHex());
+}
+
+void TriageCache::ensureLoaded()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    // 启动后首次使用时载入，顺带清掉已过期的条目
+    QDateTime cutoff = QDateTime::currentDateTimeUtc().addSecs(-m_ttlSecs);
+    DatabaseManager* db = DatabaseManager::instance();
+    int expired = db->deleteAIResponseCacheBefore(cutoff);
+
+    const QList<AIResponseCacheEntry> entries = db->getAIResponseCacheEntries(cutoff);
+    for (const AIResponseCacheEntry& entry : entries) {
+        m_entries.insert(entry.cacheKey, entry);
+    }
+    evictOverflow();
+
+    qDebug() << "AI回复缓存已载入" << m_entries.size() << "条，清理过期" << expired << "条";
+}
+
+bool TriageCache::isExpired(const AIResponseCacheEntry& entry, const QDateTime& now) const
+{
+    return entry.createdAt.secsTo(now) > m_ttlSecs;
+}
+
+bool TriageCache::lookup(const QString& key, QString* response)
+{
+    ensureLoaded();
+    m_stats.lookups++;
+    scheduleFlush();
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    if (isExpired(it.value(), now)) {
+        removeEntry(key);
+        return false;
+    }
+
+    // 命中路径上不写库，只记下改动
+    it->lastHitAt = now;
+    it->hitCount++;
+    markDirty(key);
+
+    m_stats.hits++;
+    if (response) {
+        *response = it->response;
+    }
+    return true;
+}
+
+void TriageCache::store(const QString& key, const QString& response, qint64 networkLatencyMs)
+{
+    ensureLoaded();
+
+    m_stats.missLatencyMs += networkLatencyMs;
+    m_stats.missLatencySamples++;
+    scheduleFlush();
+
+    if (key.isEmpty() || response.trimmed().isEmpty()) {
+        return;
+    }
+
+    AIResponseCacheEntry entry;
+    entry.cacheKey = key;
+    entry.response = response;
+    entry.createdAt = QDateTime::currentDateTimeUtc();
+    entry.lastHitAt = entry.createdAt;
+    entry.hitCount = 0;
+
+    m_entries.insert(key, entry);
+    markDirty(key);
+    m_stats.stores++;
+
+    evictOverflow();
+}
+
+void TriageCache::recordBypass()
+{
+    m_stats.bypassed++;
+    scheduleFlush();
+}
+
+void TriageCache::recordHitLatency(qint64 elapsedMs)
+{
+    m_stats.hitLatencyMs += elapsedMs;
+    scheduleFlush();
+}
+
+void TriageCache::evictOverflow()
+{
+    // 超出上限时淘汰最久未命中的条目
+    while (m_entries.size() > m_maxEntries) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->lastHitAt < oldest->lastHitAt) {
+                oldest = it;
+            }
+        }
+        QString oldestKey = oldest.key();
+        removeEntry(oldestKey);
+        m_stats.evictions++;
+    }
+}
+
+void TriageCache::removeEntry(const QString& key)
+{
+    m_entries.remove(key);
+    m_dirtyKeys.remove(key);
+    DatabaseManager::instance()->deleteAIResponseCacheEntry(key);
+}
+
+void TriageCache::markDirty(const QString& key)
+{
+    m_dirtyKeys.insert(key);
+    scheduleFlush();
+}
+
+void TriageCache::scheduleFlush()
+{
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void TriageCache::flush()
+{
+    m_flushTimer->stop();
+
+    QList<AIResponseCacheEntry> entries;
+    entries.reserve(m_dirtyKeys.size());
+    for (const QString& key : std::as_const(m_dirtyKeys)) {
+        auto it = m_entries.constFind(key);
+        if (it != m_entries.constEnd()) {
+            entries.append(it.value());
+        }
+    }
+    m_dirtyKeys.clear();
+
+    DatabaseManager* db = DatabaseManager::instance();
+    if (!db->isOpen()) {
+        return;
+    }
+    db->saveAIResponseCacheEntries(entries);
+
+    if (!m_statsPruned) {
+        m_statsPruned = true;
+        db->deleteAICacheSnapshotsBefore(QDateTime::currentDateTimeUtc().addDays(-STATS_RETENTION_DAYS));
+    }
+
+    AICacheSnapshot snapshot;
+    snapshot.instanceId = m_instanceId;
+    snapshot.startedAt = m_startedAt;
+    snapshot.updatedAt = QDateTime::currentDateTimeUtc();
+    snapshot.lookups = qint64(m_stats.lookups);
+    snapshot.hits = qint64(m_stats.hits);
+    snapshot.bypassed = qint64(m_stats.bypassed);
+    snapshot.stores = qint64(m_stats.stores);
+    snapshot.evictions = qint64(m_stats.evictions);
+    snapshot.missLatencyMs = m_stats.missLatencyMs;
+    snapshot.missLatencySamples = qint64(m_stats.missLatencySamples);
+    snapshot.hitLatencyMs = m_stats.hitLatencyMs;
+    db->saveAICacheSnapshot(snapshot);
+}
+
+void TriageCache::setTimeToLive(int seconds)
+{
+    m_ttlSecs = qMax(0, seconds);
+}
+
+void TriageCache::setMaxEntries(int maxEntries)
+{
+    m_maxEntries = qMax(0, maxEntries);
+    if (m_loaded) {
+        evictOverflow();
+    }
+}
+
+void TriageCache::clear()
+{
+    ensureLoaded();
+    const QList<QString> keys = m_entries.keys();
+    for (const QString& key : keys) {
+        removeEntry(key);
+    }
+}
+
+TriageCache::Stats TriageCache::stats() const
+{
+    return m_stats;
+}
+
+int TriageCache::size() const
+{
+    return m_entries.size();
+}
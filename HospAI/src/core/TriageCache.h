@@ -0,0 +1,90 @@
+#ifndef TRIAGECACHE_H
+#define TRIAGECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
+#include "DatabaseManager.h"
+
+class QTimer;
+
+// AI回复缓存：键由请求类型、模型、规范化后的提问和对话历史哈希组成，
+// 条目带有效期和数量上限，写入SQLite后重启仍可命中。
+// 新条目和命中时间先记在内存中，定时批量写库，退出前再写一次。
+// 命中率等计数同样按进程写入 ai_cache_stats，管理端统计页汇总各进程
+class TriageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TriageCache* instance();
+
+    static constexpr int DEFAULT_TTL_SECS = 24 * 3600;
+    static constexpr int DEFAULT_MAX_ENTRIES = 500;
+    static constexpr int FLUSH_INTERVAL_MS = 5000;  // 有改动后最迟多久写库
+    static constexpr int STATS_RETENTION_DAYS = 30;
+
+    struct Stats {
+        quint64 lookups = 0;
+        quint64 hits = 0;
+        quint64 bypassed = 0;       // 急症等不走缓存的请求
+        quint64 stores = 0;
+        quint64 evictions = 0;
+        qint64 missLatencyMs = 0;   // 未命中时网络请求的累计耗时
+        quint64 missLatencySamples = 0;
+        qint64 hitLatencyMs = 0;    // 命中时的累计耗时
+
+        double hitRatio() const;
+        // 按未命中的平均耗时估算命中节省的时间
+        qint64 estimatedSavedMs() const;
+
+        // 由数据库中的快照还原，统计页汇总各进程时用
+        static Stats fromSnapshot(const AICacheSnapshot& snapshot);
+    };
+
+    // 折叠全角/半角、大小写、空白和标点，使措辞相近的提问得到同一个键
+    static QString normalizeText(const QString& text);
+    static QString makeKey(const QString& requestType, const QString& model,
+                           const QString& prompt, const QString& history);
+
+    bool lookup(const QString& key, QString* response);
+    void store(const QString& key, const QString& response, qint64 networkLatencyMs);
+    void recordBypass();
+    void recordHitLatency(qint64 elapsedMs);
+
+    void setTimeToLive(int seconds);
+    void setMaxEntries(int maxEntries);
+    void clear();
+
+    Stats stats() const;
+    int size() const;
+
+private:
+    explicit TriageCache(QObject *parent = nullptr);
+
+    void ensureLoaded();
+    bool isExpired(const AIResponseCacheEntry& entry, const QDateTime& now) const;
+    void evictOverflow();
+    void removeEntry(const QString& key);
+    void markDirty(const QString& key);
+    void scheduleFlush();
+    // 数据库未打开（命令行工具）时不写
+    void flush();
+
+    static TriageCache* m_instance;
+
+    QHash<QString, AIResponseCacheEntry> m_entries;
+    bool m_loaded;
+    int m_ttlSecs;
+    int m_maxEntries;
+    Stats m_stats;
+    QSet<QString> m_dirtyKeys;     // 内存中有改动、尚未写库的条目
+    QTimer* m_flushTimer;
+    QString m_instanceId;
+    QDateTime m_startedAt;
+    bool m_statsPruned;
+};
+
+#endif // TRIAGECACHE_H
@@ -1,12 +1,54 @@
 #ifndef USERROLE_H
 #define USERROLE_H
 
+#include <QString>
+#include <QDebug>
+
 enum class UserRole {
+    Invalid = -1,   // 无法识别的角色名，不授予任何权限
     Patient = 0,    // 患者
     Staff = 1,      // 客服
-    Admin = 2       // 管理员
+    Admin = 2,      // 管理员
+    System = 3      // 系统消息的发送者，不对应登录账号
 };
 
+// 数据库和界面中使用的角色名称
+inline QString userRoleName(UserRole role)
+{
+    switch (role) {
+        case UserRole::Staff:
+            return QStringLiteral("客服");
+        case UserRole::Admin:
+            return QStringLiteral("管理员");
+        case UserRole::Patient:
+            return QStringLiteral("患者");
+        case UserRole::System:
+            return QStringLiteral("system");
+        case UserRole::Invalid:
+        default:
+            return QStringLiteral("未知");
+    }
+}
+
+// 无法识别的名称返回 Invalid 并告警，不再默认当作患者
+inline UserRole userRoleFromName(const QString& name)
+{
+    if (name == QStringLiteral("患者")) {
+        return UserRole::Patient;
+    }
+    if (name == QStringLiteral("客服")) {
+        return UserRole::Staff;
+    }
+    if (name == QStringLiteral("管理员")) {
+        return UserRole::Admin;
+    }
+    if (name == QStringLiteral("system")) {
+        return UserRole::System;
+    }
+    qWarning() << "无法识别的用户角色:" << name;
+    return UserRole::Invalid;
+}
+
 enum class MenuAction {
     // 患者菜单
     PatientChat = 100,
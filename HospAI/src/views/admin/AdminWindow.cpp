@@ -23,7 +23,6 @@ AdminWindow::AdminWindow(QWidget *parent)
     , m_actSystemInfo(nullptr)
 {
     setWindowTitle("医院智慧客服系统 - 管理端");
-    createWidgets();
     setupToolBar();
 }
 
@@ -39,38 +38,62 @@ void AdminWindow::setupMenu()
 
 void AdminWindow::setupFunctionWidgets()
 {
-    // 添加功能页面到堆叠widget
-    addFunctionWidget(m_userManageWidget, "用户管理");
-    addFunctionWidget(m_systemStatsWidget, "数据统计");
-    addFunctionWidget(m_systemConfigWidget, "系统设置");
-    addFunctionWidget(m_auditLogWidget, "审计日志");
-    addFunctionWidget(m_staffRatingWidget, "评价管理");
+    // 按菜单顺序注册页面，切换到页面时才创建，空闲时预取下一个
+    registerPage("用户管理", [this]() {
+        m_userManageWidget = new UserManageWidget(this);
+        if (m_dbManager) {
+            m_userManageWidget->setDatabaseManager(m_dbManager);
+        }
+        return m_userManageWidget;
+    });
+    registerPage("数据统计", [this]() {
+        m_systemStatsWidget = new SystemStatsWidget(this);
+        if (m_dbManager) {
+            m_systemStatsWidget->setDatabaseManager(m_dbManager);
+        }
+        return m_systemStatsWidget;
+    });
+    registerPage("评价管理", [this]() {
+        m_staffRatingWidget = new StaffRatingWidget(this);
+        if (m_dbManager) {
+            m_staffRatingWidget->setDatabaseManager(m_dbManager);
+        }
+        return m_staffRatingWidget;
+    });
+    registerPage("系统设置", [this]() {
+        m_systemConfigWidget = new SystemConfigWidget(this);
+        return m_systemConfigWidget;
+    });
+    // 审计日志没有菜单入口，不预取
+    registerPage("审计日志", [this]() {
+        m_auditLogWidget = new AuditLogWidget(this);
+        if (m_dbManager) {
+            m_auditLogWidget->setDatabaseManager(m_dbManager);
+        }
+        return m_auditLogWidget;
+    }, false);
     
     // 默认显示用户管理页面
     setCurrentWidget("用户管理");
 }
 
-void AdminWindow::createWidgets()
-{
-    m_userManageWidget = new UserManageWidget(this);
-    m_systemStatsWidget = new SystemStatsWidget(this);
-    m_systemConfigWidget = new SystemConfigWidget(this);
-    m_auditLogWidget = new AuditLogWidget(this);
-    m_staffRatingWidget = new StaffRatingWidget(this);
-}
-
 void AdminWindow::setDatabaseManager(DatabaseManager* dbManager)
 {
     m_dbManager = dbManager;
     
-    // 设置各个组件的数据库管理器
+    // 已创建的页面立即更新，其余页面创建时再设置
     if (m_userManageWidget) {
         m_userManageWidget->setDatabaseManager(dbManager);
     }
+    if (m_systemStatsWidget) {
+        m_systemStatsWidget->setDatabaseManager(dbManager);
+    }
     if (m_staffRatingWidget) {
         m_staffRatingWidget->setDatabaseManager(dbManager);
     }
-    // 其他组件也可以根据需要设置数据库管理器
+    if (m_auditLogWidget) {
+        m_auditLogWidget->setDatabaseManager(dbManager);
+    }
 }
 
 void AdminWindow::setupToolBar()
@@ -35,11 +35,10 @@ private slots:
     void onSystemInfoClicked();
 
 private:
-    void createWidgets();
     void setupToolBar();
 
 private:
-    // 功能组件
+    // 功能组件，首次访问对应页面时才创建
     UserManageWidget* m_userManageWidget;
     SystemStatsWidget* m_systemStatsWidget;
     SystemConfigWidget* m_systemConfigWidget;
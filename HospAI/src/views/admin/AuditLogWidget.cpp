@@ -14,6 +14,7 @@ AuditLogWidget::AuditLogWidget(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
     , m_dbManager(nullptr)
+    , m_logsDirty(false)
     , m_searchGroup(nullptr)
     , m_searchEdit(nullptr)
     , m_logType(nullptr)
@@ -45,10 +46,31 @@ AuditLogWidget::AuditLogWidget(QWidget *parent)
 void AuditLogWidget::setDatabaseManager(DatabaseManager* dbManager)
 {
     m_dbManager = dbManager;
-    // 设置数据库管理器后立即加载数据
-    loadOperationLogs();
-    loadChatLogs();
-    loadSystemLogs();
+    // 只加载当前选项卡，其余选项卡切换时再加载；页面不可见时推迟到首次显示
+    if (isVisible()) {
+        loadCurrentLogs();
+    } else {
+        m_logsDirty = true;
+    }
+}
+
+void AuditLogWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    
+    if (m_logsDirty) {
+        m_logsDirty = false;
+        loadCurrentLogs();
+    }
+}
+
+void AuditLogWidget::loadCurrentLogs()
+{
+    switch (m_tabWidget->currentIndex()) {
+    case 0: loadOperationLogs(); break;
+    case 1: loadChatLogs(); break;
+    case 2: loadSystemLogs(); break;
+    }
 }
 
 void AuditLogWidget::setupUI()
@@ -550,12 +572,7 @@ void AuditLogWidget::onExportLogs()
 
 void AuditLogWidget::onRefreshLogs()
 {
-    int currentTab = m_tabWidget->currentIndex();
-    switch (currentTab) {
-    case 0: loadOperationLogs(); break;
-    case 1: loadChatLogs(); break;
-    case 2: loadSystemLogs(); break;
-    }
+    loadCurrentLogs();
     
     QMessageBox::information(this, "刷新", "日志已刷新！");
 }
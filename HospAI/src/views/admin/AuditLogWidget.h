@@ -24,6 +24,10 @@ public:
     explicit AuditLogWidget(QWidget *parent = nullptr);
     void setDatabaseManager(DatabaseManager* dbManager);
 
+protected:
+    // 首次显示时才加载当前选项卡的日志
+    void showEvent(QShowEvent* event) override;
+
 private slots:
     void onSearchLogs();
     void onClearLogs();
@@ -40,11 +44,13 @@ private:
     void loadOperationLogs();
     void loadChatLogs();
     void loadSystemLogs();
+    void loadCurrentLogs();
     void showLogDetails(const QString& details);
 
 private:
     QVBoxLayout* m_mainLayout;
     DatabaseManager* m_dbManager;
+    bool m_logsDirty;
     
     // 搜索筛选区域
     QGroupBox* m_searchGroup;
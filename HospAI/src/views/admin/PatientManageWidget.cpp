@@ -526,7 +526,7 @@ UserInfo PatientEditDialog::getPatientInfo() const
     info.email = m_emailEdit->text().trimmed();
     info.phone = m_phoneEdit->text().trimmed();
     info.status = m_statusCombo->currentData().toInt();
-    info.role = "患者";
+    info.role = UserRole::Patient;
     
     return info;
 }
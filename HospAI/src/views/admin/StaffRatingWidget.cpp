@@ -13,6 +13,7 @@ StaffRatingWidget::StaffRatingWidget(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
     , m_dbManager(nullptr)
+    , m_ratingsDirty(false)
 {
     setupUI();
 }
@@ -20,8 +21,22 @@ StaffRatingWidget::StaffRatingWidget(QWidget *parent)
 void StaffRatingWidget::setDatabaseManager(DatabaseManager* dbManager)
 {
     m_dbManager = dbManager;
-    // 延迟加载数据，确保界面完全初始化后再执行
-    QTimer::singleShot(0, this, &StaffRatingWidget::loadRatings);
+    // 页面可见时延迟加载数据，确保界面完全初始化后再执行；否则等到首次显示
+    if (isVisible()) {
+        QTimer::singleShot(0, this, &StaffRatingWidget::loadRatings);
+    } else {
+        m_ratingsDirty = true;
+    }
+}
+
+void StaffRatingWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    
+    if (m_ratingsDirty) {
+        m_ratingsDirty = false;
+        QTimer::singleShot(0, this, &StaffRatingWidget::loadRatings);
+    }
 }
 
 void StaffRatingWidget::setupUI()
@@ -245,8 +260,8 @@ void StaffRatingWidget::loadRatings()
         QList<UserInfo> patients, staffs;
         
         for (const UserInfo& user : users) {
-            if (user.role == "患者") patients.append(user);
-            else if (user.role == "客服") staffs.append(user);
+            if (user.role == UserRole::Patient) patients.append(user);
+            else if (user.role == UserRole::Staff) staffs.append(user);
         }
         
         if (!patients.isEmpty() && !staffs.isEmpty()) {
@@ -28,6 +28,10 @@ public:
     explicit StaffRatingWidget(QWidget *parent = nullptr);
     void setDatabaseManager(DatabaseManager* dbManager);
 
+protected:
+    // 首次显示时才加载评价数据
+    void showEvent(QShowEvent* event) override;
+
 private slots:
     void onRefreshRatings();
     void onSearchRatings();
@@ -93,6 +97,7 @@ private:
     
     // 数据
     DatabaseManager* m_dbManager;
+    bool m_ratingsDirty;
     QList<SessionRating> m_ratings;
     QMap<int, UserInfo> m_staffMap; // 客服信息缓存
 };
@@ -1,5 +1,8 @@
 #include "SystemStatsWidget.h"
 #include "../common/UIStyleManager.h"
+#include "../../core/AICircuitBreaker.h"
+#include "../../core/AIModelRouter.h"
+#include "../../core/TriageCache.h"
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QTextStream>
@@ -7,11 +10,17 @@
 #include <QRandomGenerator>
 #include <QTimer>
 #include <QHeaderView>
+#include <QHash>
+
+// AI服务状态汇总最近这么久内有活动的进程
+static const int AI_STATS_WINDOW_HOURS = 24;
 
 SystemStatsWidget::SystemStatsWidget(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
     , m_dbManager(nullptr)
+    , m_updateTimer(nullptr)
+    , m_statsDirty(false)
 {
     setupUI();
 }
@@ -19,9 +28,32 @@ SystemStatsWidget::SystemStatsWidget(QWidget *parent)
 void SystemStatsWidget::setDatabaseManager(DatabaseManager* dbManager)
 {
     m_dbManager = dbManager;
-    // 设置数据库管理器后立即更新统计数据
+    // 页面可见时立即更新统计数据，否则等到首次显示
+    if (isVisible()) {
+        updateOverviewStats();
+        updateUserStats();
+    } else {
+        m_statsDirty = true;
+    }
+}
+
+void SystemStatsWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    
+    if (m_statsDirty) {
+        m_statsDirty = false;
+        updateUserStats();
+    }
     updateOverviewStats();
-    updateUserStats();
+    updateSystemStats();
+    m_updateTimer->start();
+}
+
+void SystemStatsWidget::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    m_updateTimer->stop();
 }
 
 void SystemStatsWidget::setupUI()
@@ -83,10 +115,11 @@ void SystemStatsWidget::setupUI()
     
     m_mainLayout->addWidget(m_tabWidget);
     
-    // 定时更新
-    QTimer* updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &SystemStatsWidget::updateOverviewStats);
-    updateTimer->start(5000); // 每5秒更新一次
+    // 定时更新，只在页面显示期间运行
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setInterval(5000); // 每5秒更新一次
+    connect(m_updateTimer, &QTimer::timeout, this, &SystemStatsWidget::updateOverviewStats);
+    connect(m_updateTimer, &QTimer::timeout, this, &SystemStatsWidget::updateSystemStats);
 }
 
 void SystemStatsWidget::setupOverviewTab()
@@ -252,8 +285,44 @@ void SystemStatsWidget::setupSystemStatsTab()
     resourceLayout->addWidget(dbLabel, 3, 0);
     resourceLayout->addWidget(dbValue, 3, 1);
     
+    // AI服务状态：熔断器、重试、对冲、模型路由与回复缓存
+    m_aiServiceGroup = new QGroupBox("AI服务状态", this);
+    UIStyleManager::applyGroupBoxStyle(m_aiServiceGroup);
+    QGridLayout* aiLayout = new QGridLayout(m_aiServiceGroup);
+    
+    m_aiBreakerState = new QLabel(this);
+    m_aiFailureRate = new QLabel(this);
+    m_aiShortCircuited = new QLabel(this);
+    m_aiRetries = new QLabel(this);
+    m_aiHedges = new QLabel(this);
+    m_aiRouting = new QLabel(this);
+    m_aiCache = new QLabel(this);
+    
+    aiLayout->addWidget(new QLabel("熔断器:", this), 0, 0);
+    aiLayout->addWidget(m_aiBreakerState, 0, 1);
+    aiLayout->addWidget(new QLabel("近期失败率:", this), 1, 0);
+    aiLayout->addWidget(m_aiFailureRate, 1, 1);
+    aiLayout->addWidget(new QLabel("熔断/直接失败:", this), 2, 0);
+    aiLayout->addWidget(m_aiShortCircuited, 2, 1);
+    aiLayout->addWidget(new QLabel("重试次数:", this), 3, 0);
+    aiLayout->addWidget(m_aiRetries, 3, 1);
+    aiLayout->addWidget(new QLabel("对冲请求:", this), 4, 0);
+    aiLayout->addWidget(m_aiHedges, 4, 1);
+    aiLayout->addWidget(new QLabel("模型路由:", this), 5, 0);
+    aiLayout->addWidget(m_aiRouting, 5, 1);
+    aiLayout->addWidget(new QLabel("回复缓存:", this), 6, 0);
+    aiLayout->addWidget(m_aiCache, 6, 1);
+    
+    // 本进程的熔断器状态变化时立即刷新（切换记录已同步写库）
+    connect(AICircuitBreaker::instance(), &AICircuitBreaker::stateChanged, this, [this]() {
+        if (isVisible()) {
+            updateSystemStats();
+        }
+    });
+    
     m_systemStatsLayout->addWidget(m_performanceChart);
     m_systemStatsLayout->addWidget(m_resourceGroup);
+    m_systemStatsLayout->addWidget(m_aiServiceGroup);
 }
 
 void SystemStatsWidget::setupReportsTab()
@@ -321,7 +390,7 @@ void SystemStatsWidget::updateOverviewStats()
     QDateTime sevenDaysAgo = QDateTime::currentDateTime().addDays(-7);
     int activeUsers = 0;
     for (const UserInfo& user : allUsers) {
-        if (user.lastLoginTime.isValid() && user.lastLoginTime > sevenDaysAgo) {
+        if (user.lastLogin.isValid() && user.lastLogin > sevenDaysAgo) {
             activeUsers++;
         }
     }
@@ -359,9 +428,9 @@ void SystemStatsWidget::updateUserStats()
     QDateTime sevenDaysAgo = QDateTime::currentDateTime().addDays(-7);
     
     for (const UserInfo& user : allUsers) {
-        roleCounts[user.role]++;
-        if (user.lastLoginTime.isValid() && user.lastLoginTime > sevenDaysAgo) {
-            activeRoleCounts[user.role]++;
+        roleCounts[user.roleName()]++;
+        if (user.lastLogin.isValid() && user.lastLogin > sevenDaysAgo) {
+            activeRoleCounts[user.roleName()]++;
         }
     }
     
@@ -405,6 +474,97 @@ void SystemStatsWidget::updateUserStats()
 void SystemStatsWidget::updateSystemStats()
 {
     // 更新系统性能数据
+    if (!m_dbManager) {
+        return;
+    }
+    
+    // 熔断器状态和计数来自数据库：状态取最近更新的进程，计数为各进程之和
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<AIBreakerSnapshot> snapshots = m_dbManager->getAIBreakerSnapshots(now.addSecs(-AI_STATS_WINDOW_HOURS * 3600));
+    
+    AIBreakerSnapshot total;
+    for (const AIBreakerSnapshot& snapshot : snapshots) {
+        total.opens += snapshot.opens;
+        total.successes += snapshot.successes;
+        total.failures += snapshot.failures;
+        total.shortCircuited += snapshot.shortCircuited;
+        total.retries += snapshot.retries;
+        total.hedges += snapshot.hedges;
+        total.hedgeWins += snapshot.hedgeWins;
+        if (snapshot.lastOpenedAt.isValid()
+            && (!total.lastOpenedAt.isValid() || snapshot.lastOpenedAt > total.lastOpenedAt)) {
+            total.lastOpenedAt = snapshot.lastOpenedAt;
+        }
+    }
+    
+    if (snapshots.isEmpty()) {
+        m_aiBreakerState->setText(QString("<b>无记录</b>（最近 %1 小时）").arg(AI_STATS_WINDOW_HOURS));
+        m_aiFailureRate->setText("-");
+    } else {
+        const AIBreakerSnapshot& latest = snapshots.first();
+        AICircuitBreaker::State breakerState = AICircuitBreaker::stateFromKey(latest.state);
+        QString state = AICircuitBreaker::stateName(breakerState);
+        QString color = breakerState == AICircuitBreaker::Closed ? "#28a745"
+                      : breakerState == AICircuitBreaker::Open ? "#dc3545" : "#fd7e14";
+        if (breakerState == AICircuitBreaker::Open && latest.reopenAt.isValid()) {
+            state += QString("（%1 秒后探测）").arg(qMax<qint64>(0, now.secsTo(latest.reopenAt)));
+        }
+        m_aiBreakerState->setText(QString("<b style='color:%1'>%2</b>（%3 个进程，最近更新 %4）")
+                                  .arg(color, state)
+                                  .arg(snapshots.size())
+                                  .arg(latest.updatedAt.toLocalTime().toString("MM-dd hh:mm:ss")));
+        m_aiFailureRate->setText(QString("<b>%1%</b>（最近 %2 次，连续失败 %3 次）")
+                                 .arg(latest.failureRate * 100, 0, 'f', 1)
+                                 .arg(latest.windowSamples)
+                                 .arg(latest.consecutiveFailures));
+    }
+    
+    QString lastOpened = total.lastOpenedAt.isValid() ? total.lastOpenedAt.toLocalTime().toString("MM-dd hh:mm:ss") : "无";
+    m_aiShortCircuited->setText(QString("<b>%1</b> 次熔断 / <b>%2</b> 个请求直接转本地分诊（最近熔断: %3）")
+                                .arg(total.opens)
+                                .arg(total.shortCircuited)
+                                .arg(lastOpened));
+    m_aiRetries->setText(QString("<b>%1</b>（成功 %2 / 失败 %3）")
+                         .arg(total.retries)
+                         .arg(total.successes)
+                         .arg(total.failures));
+    m_aiHedges->setText(QString("<b>%1</b>（先于原请求返回 %2）")
+                        .arg(total.hedges)
+                        .arg(total.hedgeWins));
+    
+    // 各档位的请求数和中位耗时（含排队），来自 ai_routing_log
+    QHash<QString, AIRoutingTierSummary> tierSummaries;
+    for (const AIRoutingTierSummary& summary : m_dbManager->getAIRoutingSummary(now.addSecs(-AI_STATS_WINDOW_HOURS * 3600))) {
+        tierSummaries.insert(summary.tier, summary);
+    }
+    
+    QStringList routing;
+    for (int tier = AIModelRouter::LocalTier; tier <= AIModelRouter::LargeTier; ++tier) {
+        AIRoutingTierSummary summary = tierSummaries.value(AIModelRouter::tierName(AIModelRouter::Tier(tier)));
+        routing.append(QString("%1 <b>%2</b>（中位 %3）")
+                       .arg(AIModelRouter::tierLabel(AIModelRouter::Tier(tier)))
+                       .arg(summary.requests)
+                       .arg(summary.medianLatencyMs >= 0 ? QString("%1 ms").arg(summary.medianLatencyMs) : QString("-")));
+    }
+    m_aiRouting->setText(routing.join(" / ") + QString("（最近 %1 小时）").arg(AI_STATS_WINDOW_HOURS));
+    
+    // 回复缓存命中率和估计节省的等待时间，各进程的计数相加
+    TriageCache::Stats cache;
+    for (const AICacheSnapshot& snapshot : m_dbManager->getAICacheSnapshots(now.addSecs(-AI_STATS_WINDOW_HOURS * 3600))) {
+        TriageCache::Stats stats = TriageCache::Stats::fromSnapshot(snapshot);
+        cache.lookups += stats.lookups;
+        cache.hits += stats.hits;
+        cache.bypassed += stats.bypassed;
+        cache.missLatencyMs += stats.missLatencyMs;
+        cache.missLatencySamples += stats.missLatencySamples;
+        cache.hitLatencyMs += stats.hitLatencyMs;
+    }
+    m_aiCache->setText(QString("命中率 <b>%1%</b>（查询 %2 次，命中 %3 次，急症绕过 %4 次，估计节省 %5 秒）")
+                       .arg(cache.hitRatio() * 100, 0, 'f', 1)
+                       .arg(cache.lookups)
+                       .arg(cache.hits)
+                       .arg(cache.bypassed)
+                       .arg(cache.estimatedSavedMs() / 1000.0, 0, 'f', 1));
 }
 
 void SystemStatsWidget::createCharts()
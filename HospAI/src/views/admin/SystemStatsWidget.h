@@ -13,6 +13,7 @@
 #include <QProgressBar>
 #include <QTabWidget>
 #include <QTableWidget>
+#include <QTimer>
 #include "../../core/DatabaseManager.h"
 // 暂时移除Charts依赖，使用简单组件替代
 // #include <QtCharts/QChartView>
@@ -34,6 +35,11 @@ public:
     explicit SystemStatsWidget(QWidget *parent = nullptr);
     void setDatabaseManager(DatabaseManager* dbManager);
 
+protected:
+    // 页面隐藏时暂停定时刷新，重新显示时补一次更新
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
 private slots:
     void onDateRangeChanged();
     void onRefreshStats();
@@ -54,6 +60,8 @@ private:
 private:
     QVBoxLayout* m_mainLayout;
     DatabaseManager* m_dbManager;
+    QTimer* m_updateTimer;
+    bool m_statsDirty;
     
     // 日期范围选择
     QGroupBox* m_dateGroup;
@@ -86,6 +94,14 @@ private:
     QVBoxLayout* m_systemStatsLayout;
     QLabel* m_performanceChart;  // 暂时替换为QLabel
     QGroupBox* m_resourceGroup;
+    QGroupBox* m_aiServiceGroup;
+    QLabel* m_aiBreakerState;
+    QLabel* m_aiFailureRate;
+    QLabel* m_aiShortCircuited;
+    QLabel* m_aiRetries;
+    QLabel* m_aiHedges;
+    QLabel* m_aiRouting;
+    QLabel* m_aiCache;
     
     // 报表选项卡
     QWidget* m_reportsTab;
@@ -188,7 +188,7 @@ void UserManageWidget::loadUsers()
     int activeCount = 0;
     for (int i = 0; i < users.size(); ++i) {
         const UserInfo& user = users[i];
-        QString roleName = user.role;  // 直接使用字符串role
+        QString roleName = user.roleName();
         
         QString status = (user.status == 1) ? "活跃" : "禁用";
         if (user.status == 1) activeCount++;
@@ -0,0 +1,77 @@
+#include "AttachmentTextBrowser.h"
+#include "../../core/AttachmentStore.h"
+#include "../../core/ImagePipeline.h"
+#include <QTextDocument>
+#include <QDesktopServices>
+#include <QDebug>
+
+AttachmentTextBrowser::AttachmentTextBrowser(QWidget *parent)
+    : QTextBrowser(parent)
+{
+    // 链接由本类处理，避免浏览器尝试把附件当作页面打开
+    setOpenLinks(false);
+    setOpenExternalLinks(false);
+    
+    connect(this, &QTextBrowser::anchorClicked, this, &AttachmentTextBrowser::onAnchorClicked);
+}
+
+QVariant AttachmentTextBrowser::loadResource(int type, const QUrl& name)
+{
+    QVariant resource = loadAttachmentResource(document(), type, name);
+    if (resource.isValid()) {
+        return resource;
+    }
+    return QTextBrowser::loadResource(type, name);
+}
+
+QVariant AttachmentTextBrowser::loadAttachmentResource(QTextDocument* document, int type, const QUrl& name)
+{
+    // 图片先返回占位图，由图片管线在后台解码缩略图后替换
+    if (type == QTextDocument::ImageResource && name.scheme() == "data") {
+        QString dataUrl = name.path();
+        int commaIndex = dataUrl.indexOf(',');
+        if (dataUrl.startsWith("image/") && commaIndex > 0) {
+            QByteArray imageData = QByteArray::fromBase64(dataUrl.mid(commaIndex + 1).toLatin1());
+            return ImagePipeline::instance()->attachDataToDocument(document, name, imageData);
+        }
+        return QVariant();
+    }
+    
+    QString hash = AttachmentStore::hashFromUrl(name);
+    if (hash.isEmpty()) {
+        return QVariant();
+    }
+    
+    if (type == QTextDocument::ImageResource) {
+        return ImagePipeline::instance()->attachToDocument(document, name, hash);
+    }
+    
+    // 只有在文档布局真正需要时才读取附件内容，结果由QTextDocument缓存
+    QByteArray data = AttachmentStore::instance()->loadData(hash);
+    if (data.isEmpty()) {
+        return QVariant();
+    }
+    
+    return data;
+}
+
+void AttachmentTextBrowser::onAnchorClicked(const QUrl& link)
+{
+    openAttachmentLink(link);
+}
+
+bool AttachmentTextBrowser::openAttachmentLink(const QUrl& link)
+{
+    QString hash = AttachmentStore::hashFromUrl(link);
+    if (hash.isEmpty()) {
+        return false;
+    }
+    
+    QString exportPath = AttachmentStore::instance()->exportToTemp(hash);
+    if (exportPath.isEmpty()) {
+        qDebug() << "AttachmentTextBrowser: 附件无法打开" << hash.left(12);
+        return false;
+    }
+    
+    return QDesktopServices::openUrl(QUrl::fromLocalFile(exportPath));
+}
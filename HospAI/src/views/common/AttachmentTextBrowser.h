@@ -0,0 +1,28 @@
+#ifndef ATTACHMENTTEXTBROWSER_H
+#define ATTACHMENTTEXTBROWSER_H
+
+#include <QTextBrowser>
+#include <QUrl>
+#include <QVariant>
+#include <QTextDocument>
+
+// 显示富文本消息的浏览器：遇到 attachment:<hash> 引用时才从附件存储读取
+class AttachmentTextBrowser : public QTextBrowser
+{
+    Q_OBJECT
+
+public:
+    explicit AttachmentTextBrowser(QWidget *parent = nullptr);
+
+    QVariant loadResource(int type, const QUrl& name) override;
+
+    // 供自绘文档共用：解析 attachment:/data: 资源，非附件资源返回无效值
+    static QVariant loadAttachmentResource(QTextDocument* document, int type, const QUrl& name);
+    // 打开附件链接，非附件链接返回 false
+    static bool openAttachmentLink(const QUrl& link);
+
+private slots:
+    void onAnchorClicked(const QUrl& link);
+};
+
+#endif // ATTACHMENTTEXTBROWSER_H
@@ -1,8 +1,14 @@
 #include "BaseWindow.h"
 #include "SideMenuWidget.h"
 #include "TitleBarWidget.h"
+#include "UIStyleManager.h"
+#include "../../core/StartupProfiler.h"
 #include <QApplication>
-#include <QTimer>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// 切换页面后空闲这么久再提前创建下一个页面
+static const int PREFETCH_IDLE_MS = 1500;
 
 BaseWindow::BaseWindow(UserRole role, QWidget *parent)
     : QMainWindow(parent)
@@ -12,6 +18,8 @@ BaseWindow::BaseWindow(UserRole role, QWidget *parent)
     , m_sideMenu(nullptr)
     , m_titleBar(nullptr)
     , m_stackedWidget(nullptr)
+    , m_currentPage(-1)
+    , m_prefetchTimer(nullptr)
 {
     setupUI();
     setupLayout();
@@ -73,6 +81,12 @@ void BaseWindow::setupUI()
     // 设置比例
     m_mainLayout->setStretch(0, 0);  // 侧边栏固定宽度
     m_mainLayout->setStretch(1, 1);  // 内容区域自适应
+    
+    // 空闲预取定时器，每次切换页面后重新计时
+    m_prefetchTimer = new QTimer(this);
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(PREFETCH_IDLE_MS);
+    connect(m_prefetchTimer, &QTimer::timeout, this, &BaseWindow::prefetchNextPage);
 }
 
 void BaseWindow::setupLayout()
@@ -83,92 +97,100 @@ void BaseWindow::setupLayout()
 void BaseWindow::addFunctionWidget(QWidget* widget, const QString& name)
 {
     if (widget && !name.isEmpty()) {
-        m_functionWidgets.append(widget);
-        m_widgetNames.append(name);
+        PageEntry entry;
+        entry.name = name;
+        entry.widget = widget;
+        m_pages.append(entry);
         m_stackedWidget->addWidget(widget);
     }
 }
 
-void BaseWindow::setCurrentWidget(int index)
+void BaseWindow::registerPage(const QString& name, const PageFactory& factory, bool prefetch)
+{
+    if (factory && !name.isEmpty()) {
+        PageEntry entry;
+        entry.name = name;
+        entry.factory = factory;
+        entry.prefetch = prefetch;
+        m_pages.append(entry);
+    }
+}
+
+QWidget* BaseWindow::ensurePage(int index)
 {
-    if (index >= 0 && index < m_stackedWidget->count()) {
-        m_stackedWidget->setCurrentIndex(index);
+    PageEntry& entry = m_pages[index];
+    if (!entry.widget && entry.factory) {
+        StartupProfiler::Scope phase("BaseWindow::page " + entry.name);
+        QElapsedTimer timer;
+        timer.start();
         
-        // 更新标题栏
-        if (index < m_widgetNames.size()) {
-            m_titleBar->setTitle(m_widgetNames[index]);
+        // 加入堆叠widget后非当前页面保持隐藏，页面自身的数据加载推迟到首次显示
+        entry.widget = entry.factory();
+        if (entry.widget) {
+            m_stackedWidget->addWidget(entry.widget);
         }
+        qDebug() << "创建功能页面:" << entry.name << "耗时" << timer.elapsed() << "ms";
     }
+    return entry.widget;
 }
 
-void BaseWindow::setCurrentWidget(const QString& name)
+void BaseWindow::setCurrentWidget(int index)
 {
-    int index = m_widgetNames.indexOf(name);
-    if (index >= 0) {
-        setCurrentWidget(index);
+    if (index < 0 || index >= m_pages.size()) {
+        return;
+    }
+    
+    QWidget* widget = ensurePage(index);
+    if (!widget) {
+        return;
     }
+    
+    m_currentPage = index;
+    m_stackedWidget->setCurrentWidget(widget);
+    
+    // 更新标题栏
+    m_titleBar->setTitle(m_pages[index].name);
+    
+    schedulePrefetch();
 }
 
-void BaseWindow::applyModernStyle()
+void BaseWindow::setCurrentWidget(const QString& name)
 {
-    // 应用现代化样式
-    setStyleSheet(R"(
-        QMainWindow {
-            background-color: #f5f5f5;
-        }
-        
-        QWidget {
-            font-family: "SF Pro Display", "Microsoft YaHei", sans-serif;
-            font-size: 14px;
-        }
-        
-        QPushButton {
-            background-color: #007AFF;
-            color: white;
-            border: none;
-            border-radius: 6px;
-            padding: 8px 16px;
-            font-weight: 500;
-        }
-        
-        QPushButton:hover {
-            background-color: #0056CC;
+    for (int index = 0; index < m_pages.size(); ++index) {
+        if (m_pages[index].name == name) {
+            setCurrentWidget(index);
+            return;
         }
-        
-        QPushButton:pressed {
-            background-color: #004499;
-        }
-        
-        QPushButton:disabled {
-            background-color: #C7C7CC;
-        }
-        
-        QListWidget {
-            background-color: white;
-            border: 1px solid #E5E5EA;
-            border-radius: 8px;
-            outline: none;
-        }
-        
-        QListWidget::item {
-            padding: 12px;
-            border-bottom: 1px solid #E5E5EA;
-        }
-        
-        QListWidget::item:selected {
-            background-color: #007AFF;
-            color: white;
-        }
-        
-        QListWidget::item:hover {
-            background-color: #F2F2F7;
-        }
-        
-        QStackedWidget {
-            background-color: white;
-            border-radius: 8px;
+    }
+}
+
+void BaseWindow::schedulePrefetch()
+{
+    m_prefetchTimer->start();
+}
+
+void BaseWindow::prefetchNextPage()
+{
+    // 用户仍在操作时顺延，等真正空闲再创建
+    if (QApplication::mouseButtons() != Qt::NoButton || QApplication::activePopupWidget()) {
+        m_prefetchTimer->start();
+        return;
+    }
+    
+    // 菜单顺序中当前页面之后的第一个未创建页面最可能被访问
+    for (int offset = 1; offset < m_pages.size(); ++offset) {
+        int index = (m_currentPage + offset) % m_pages.size();
+        if (m_pages[index].prefetch && !m_pages[index].widget) {
+            ensurePage(index);
+            return;
         }
-    )");
+    }
+}
+
+void BaseWindow::applyModernStyle()
+{
+    // 应用现代化样式（规则登记在 UIStyleManager 的应用样式表中，不再逐个窗口解析）
+    UIStyleManager::setVariant(this, "roleWindow");
 }
 
 void BaseWindow::onLogoutClicked()
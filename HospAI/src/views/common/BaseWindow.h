@@ -10,6 +10,8 @@
 #include <QLabel>
 #include <QListWidget>
 #include <QListWidgetItem>
+#include <QTimer>
+#include <functional>
 #include "../../core/UserRole.h"
 
 class SideMenuWidget;
@@ -24,8 +26,13 @@ public:
     virtual ~BaseWindow();
 
 protected:
+    // 页面工厂：首次切换到该页面时才调用
+    using PageFactory = std::function<QWidget*()>;
+    
     // 添加功能页面到中央区域
     void addFunctionWidget(QWidget* widget, const QString& name);
+    // 注册按需创建的功能页面，prefetch 为 true 时允许在空闲时提前创建
+    void registerPage(const QString& name, const PageFactory& factory, bool prefetch = true);
     
     // 设置当前显示的页面
     void setCurrentWidget(int index);
@@ -48,6 +55,9 @@ protected slots:
 private:
     void setupUI();
     void setupLayout();
+    QWidget* ensurePage(int index);
+    void schedulePrefetch();
+    void prefetchNextPage();
 
 protected:
     UserRole m_userRole;
@@ -60,9 +70,16 @@ protected:
     TitleBarWidget* m_titleBar;
     QStackedWidget* m_stackedWidget;
     
-    // 功能页面管理
-    QList<QWidget*> m_functionWidgets;
-    QStringList m_widgetNames;
+    // 功能页面管理，未创建的页面 widget 为 nullptr
+    struct PageEntry {
+        QString name;
+        PageFactory factory;
+        QWidget* widget = nullptr;
+        bool prefetch = false;
+    };
+    QList<PageEntry> m_pages;
+    int m_currentPage;
+    QTimer* m_prefetchTimer;
 
 signals:
     void logoutRequested();
@@ -0,0 +1,306 @@
+#include "ChatBubbleDelegate.h"
+#include "AttachmentTextBrowser.h"
+#include "../../core/ImagePipeline.h"
+#include <QAbstractTextDocumentLayout>
+#include <QPersistentModelIndex>
+#include <QApplication>
+#include <QFontMetrics>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QtMath>
+
+// 气泡布局参数，与原先控件版气泡的边距一致
+static const int ROW_SPACING = 10;
+static const int SIDE_MARGIN = 10;
+static const int PADDING_H = 12;
+static const int PADDING_V = 8;
+static const int HEADER_SPACING = 4;
+static const int MIN_CONTENT_WIDTH = 40;
+
+// 委托绘制用的文档：附件图片和 data: 图片走图片管线
+class TranscriptDocument : public QTextDocument
+{
+public:
+    using QTextDocument::QTextDocument;
+
+protected:
+    QVariant loadResource(int type, const QUrl& name) override
+    {
+        QVariant resource = AttachmentTextBrowser::loadAttachmentResource(this, type, name);
+        if (resource.isValid()) {
+            return resource;
+        }
+        return QTextDocument::loadResource(type, name);
+    }
+};
+
+ChatBubbleDelegate::ChatBubbleDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_currentUserId(-1)
+    , m_viewportWidth(400)
+{
+    m_headerFont = QApplication::font();
+    m_headerFont.setPixelSize(11);
+}
+
+void ChatBubbleDelegate::setCurrentUserId(int userId)
+{
+    m_currentUserId = userId;
+}
+
+void ChatBubbleDelegate::setViewportWidth(int width)
+{
+    m_viewportWidth = qMax(width, 2 * (SIDE_MARGIN + PADDING_H) + MIN_CONTENT_WIDTH);
+}
+
+ChatBubbleDelegate::BubbleKind ChatBubbleDelegate::bubbleKind(const RichChatMessage& message) const
+{
+    if (message.senderId == m_currentUserId) {
+        return OwnBubble;
+    }
+    if (message.messageType == 1) {
+        return SystemBubble;
+    }
+    return PeerBubble;
+}
+
+ChatBubbleDelegate::BubbleStyle ChatBubbleDelegate::bubbleStyle(const RichChatMessage& message) const
+{
+    BubbleStyle style;
+    style.font = QApplication::font();
+    bool isRich = message.isRich();
+
+    switch (bubbleKind(message)) {
+        case OwnBubble:
+            // 自己的消息 - 右对齐，蓝色
+            style.background = QColor("#007AFF");
+            style.text = Qt::white;
+            style.header = QColor(255, 255, 255, 204);
+            style.font.setPixelSize(14);
+            style.maxWidth = isRich ? 400 : 300;
+            break;
+        case SystemBubble:
+            // 系统消息 - 居中，灰色
+            style.background = QColor("#F2F2F7");
+            style.text = QColor("#8E8E93");
+            style.header = QColor("#8E8E93");
+            style.font.setPixelSize(13);
+            style.maxWidth = isRich ? 300 : 250;
+            break;
+        case PeerBubble:
+            // 对方的消息 - 左对齐，灰色
+            style.background = QColor("#E5E5EA");
+            style.text = Qt::black;
+            style.header = QColor("#8E8E93");
+            style.font.setPixelSize(14);
+            style.maxWidth = isRich ? 400 : 300;
+            break;
+    }
+
+    return style;
+}
+
+int ChatBubbleDelegate::contentWidth(const BubbleStyle& style) const
+{
+    int bubbleWidth = qMin(style.maxWidth, m_viewportWidth - 2 * SIDE_MARGIN);
+    return qMax(bubbleWidth - 2 * PADDING_H, MIN_CONTENT_WIDTH);
+}
+
+QTextDocument* ChatBubbleDelegate::layoutDocument(const ChatTranscriptModel* model, int row) const
+{
+    const RichChatMessage& message = model->messageAt(row);
+    BubbleStyle style = bubbleStyle(message);
+
+    QTextDocument* document = model->cachedDocument(row);
+    if (!document) {
+        document = new TranscriptDocument;
+        document->setDocumentMargin(0);
+        document->setDefaultFont(style.font);
+        if (message.isRich()) {
+            document->setHtml(message.htmlContent);
+        } else {
+            document->setPlainText(message.content);
+        }
+        model->cacheDocument(row, document);
+    }
+
+    int width = contentWidth(style);
+    if (qRound(document->textWidth()) != width) {
+        document->setTextWidth(width);
+    }
+    return document;
+}
+
+ChatBubbleDelegate::BubbleGeometry ChatBubbleDelegate::bubbleGeometry(const QRect& rowRect, const RichChatMessage& message,
+                                                                      QTextDocument* document) const
+{
+    BubbleStyle style = bubbleStyle(message);
+    QFontMetrics headerMetrics(m_headerFont);
+
+    int maxContentWidth = contentWidth(style);
+    int textWidth = qMin(maxContentWidth, qCeil(document->idealWidth()));
+    int headerWidth = headerMetrics.horizontalAdvance(headerText(message));
+    int innerWidth = qMin(maxContentWidth, qMax(textWidth, headerWidth));
+    int contentHeight = qCeil(document->size().height());
+
+    int bubbleWidth = innerWidth + 2 * PADDING_H;
+    int bubbleHeight = 2 * PADDING_V + headerMetrics.height() + HEADER_SPACING + contentHeight;
+    int top = rowRect.top() + ROW_SPACING / 2;
+
+    int left = rowRect.left() + SIDE_MARGIN;
+    if (bubbleKind(message) == OwnBubble) {
+        left = rowRect.left() + m_viewportWidth - SIDE_MARGIN - bubbleWidth;
+    } else if (bubbleKind(message) == SystemBubble) {
+        left = rowRect.left() + (m_viewportWidth - bubbleWidth) / 2;
+    }
+
+    BubbleGeometry geometry;
+    geometry.bubble = QRect(left, top, bubbleWidth, bubbleHeight);
+    geometry.header = QRect(left + PADDING_H, top + PADDING_V, innerWidth, headerMetrics.height());
+    geometry.content = QRect(left + PADDING_H, geometry.header.bottom() + 1 + HEADER_SPACING,
+                             innerWidth, contentHeight);
+    return geometry;
+}
+
+int ChatBubbleDelegate::estimateHeight(const RichChatMessage& message) const
+{
+    BubbleStyle style = bubbleStyle(message);
+    int width = contentWidth(style);
+    QFontMetrics metrics(style.font);
+
+    // 按段落宽度估算折行数，不创建文档
+    int lines = 0;
+    const QStringList paragraphs = message.content.split('\n');
+    for (const QString& paragraph : paragraphs) {
+        lines += qMax(1, (metrics.horizontalAdvance(paragraph) + width - 1) / width);
+    }
+
+    int contentHeight = lines * metrics.lineSpacing();
+    // 附件按气泡图片尺寸的一半估算，绘制后会修正
+    contentHeight += message.attachments.size() * ImagePipeline::BUBBLE_SIZE.height() / 2;
+
+    return 2 * PADDING_V + QFontMetrics(m_headerFont).height() + HEADER_SPACING + contentHeight + ROW_SPACING;
+}
+
+QSize ChatBubbleDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const ChatTranscriptModel* model = qobject_cast<const ChatTranscriptModel*>(index.model());
+    if (!model) {
+        return QStyledItemDelegate::sizeHint(option, index);
+    }
+
+    int row = index.row();
+    int height = model->cachedHeight(row, m_viewportWidth);
+    if (height < 0) {
+        height = estimateHeight(model->messageAt(row));
+        model->setCachedHeight(row, m_viewportWidth, height, false);
+    }
+
+    return QSize(m_viewportWidth, height);
+}
+
+void ChatBubbleDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const ChatTranscriptModel* model = qobject_cast<const ChatTranscriptModel*>(index.model());
+    if (!model) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    int row = index.row();
+    const RichChatMessage& message = model->messageAt(row);
+    BubbleStyle style = bubbleStyle(message);
+    QTextDocument* document = layoutDocument(model, row);
+    BubbleGeometry geometry = bubbleGeometry(option.rect, message, document);
+
+    // 第一次真正排版后用实际高度替换估算值
+    int height = geometry.bubble.height() + ROW_SPACING;
+    bool exact = false;
+    int cachedHeight = model->cachedHeight(row, m_viewportWidth, &exact);
+    if (!exact || cachedHeight != height) {
+        model->setCachedHeight(row, m_viewportWidth, height, true);
+        if (cachedHeight != height) {
+            ChatBubbleDelegate* self = const_cast<ChatBubbleDelegate*>(this);
+            QPersistentModelIndex persistentIndex(index);
+            QMetaObject::invokeMethod(self, [self, persistentIndex]() {
+                if (persistentIndex.isValid()) {
+                    emit self->sizeHintChanged(persistentIndex);
+                }
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    // 气泡背景
+    qreal radius = qMin(18.0, geometry.bubble.height() / 2.0);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(style.background);
+    painter->drawRoundedRect(QRectF(geometry.bubble), radius, radius);
+
+    // 发送者名称和时间
+    painter->setFont(m_headerFont);
+    painter->setPen(style.header);
+    painter->drawText(geometry.header, Qt::AlignLeft | Qt::AlignVCenter, headerText(message));
+
+    // 消息内容
+    painter->translate(geometry.content.topLeft());
+    QAbstractTextDocumentLayout::PaintContext context;
+    context.palette = option.palette;
+    context.palette.setColor(QPalette::Text, style.text);
+    context.clip = QRectF(0, 0, geometry.content.width(), geometry.content.height());
+    document->documentLayout()->draw(painter, context);
+
+    painter->restore();
+}
+
+bool ChatBubbleDelegate::editorEvent(QEvent* event, QAbstractItemModel* model,
+                                     const QStyleOptionViewItem& option, const QModelIndex& index)
+{
+    const ChatTranscriptModel* transcript = qobject_cast<const ChatTranscriptModel*>(model);
+    if (!transcript || event->type() != QEvent::MouseButtonRelease) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+    if (mouseEvent->button() != Qt::LeftButton) {
+        return false;
+    }
+
+    // 点击附件链接时导出并用系统程序打开
+    QTextDocument* document = layoutDocument(transcript, index.row());
+    BubbleGeometry geometry = bubbleGeometry(option.rect, transcript->messageAt(index.row()), document);
+    QPoint position = mouseEvent->position().toPoint();
+    if (!geometry.content.contains(position)) {
+        return false;
+    }
+
+    QString anchor = document->documentLayout()->anchorAt(position - geometry.content.topLeft());
+    if (anchor.isEmpty()) {
+        return false;
+    }
+
+    return AttachmentTextBrowser::openAttachmentLink(QUrl(anchor));
+}
+
+QString ChatBubbleDelegate::headerText(const RichChatMessage& message)
+{
+    return QString("%1  %2").arg(message.senderName).arg(formatTime(message.timestamp));
+}
+
+QString ChatBubbleDelegate::formatTime(const QDateTime& time)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 secs = time.secsTo(now);
+
+    if (secs < 60) {
+        return "刚刚";
+    } else if (secs < 3600) {
+        return QString("%1分钟前").arg(secs / 60);
+    } else if (time.date() == now.date()) {
+        return time.toString("hh:mm");
+    } else {
+        return time.toString("MM-dd hh:mm");
+    }
+}
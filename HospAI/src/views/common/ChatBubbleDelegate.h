@@ -0,0 +1,65 @@
+#ifndef CHATBUBBLEDELEGATE_H
+#define CHATBUBBLEDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QTextDocument>
+#include <QFont>
+#include <QColor>
+#include "ChatTranscriptModel.h"
+
+// 聊天气泡委托：直接绘制气泡，不为每条消息创建控件。
+// 未显示过的行只按文本长度估算高度，绘制时才排版并修正为真实高度
+class ChatBubbleDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit ChatBubbleDelegate(QObject *parent = nullptr);
+
+    void setCurrentUserId(int userId);
+    void setViewportWidth(int width);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+protected:
+    bool editorEvent(QEvent* event, QAbstractItemModel* model,
+                     const QStyleOptionViewItem& option, const QModelIndex& index) override;
+
+private:
+    enum BubbleKind {
+        OwnBubble,
+        SystemBubble,
+        PeerBubble
+    };
+
+    struct BubbleStyle {
+        QColor background;
+        QColor text;
+        QColor header;
+        QFont font;
+        int maxWidth;
+    };
+
+    struct BubbleGeometry {
+        QRect bubble;
+        QRect header;
+        QRect content;
+    };
+
+    BubbleKind bubbleKind(const RichChatMessage& message) const;
+    BubbleStyle bubbleStyle(const RichChatMessage& message) const;
+    QTextDocument* layoutDocument(const ChatTranscriptModel* model, int row) const;
+    BubbleGeometry bubbleGeometry(const QRect& rowRect, const RichChatMessage& message,
+                                  QTextDocument* document) const;
+    int estimateHeight(const RichChatMessage& message) const;
+    int contentWidth(const BubbleStyle& style) const;
+    static QString headerText(const RichChatMessage& message);
+    static QString formatTime(const QDateTime& time);
+
+    int m_currentUserId;
+    int m_viewportWidth;
+    QFont m_headerFont;
+};
+
+#endif // CHATBUBBLEDELEGATE_H
@@ -0,0 +1,335 @@
+#include "ChatTranscriptModel.h"
+#include "UpdateScheduler.h"
+
+// 同时保留排版结果的文档数，足够覆盖几屏消息
+static const int DOCUMENT_CACHE_SIZE = 200;
+
+ChatTranscriptModel::ChatTranscriptModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_nextRowKey(1)
+    , m_historySessionId(0)
+    , m_hasMoreHistory(false)
+    , m_historyTicket(0)
+    , m_pendingHistoryTicket(0)
+    , m_savedScrollValue(0)
+    , m_savedFollowTail(true)
+{
+    m_documents.setMaxCost(DOCUMENT_CACHE_SIZE);
+}
+
+int ChatTranscriptModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_messages.size();
+}
+
+QVariant ChatTranscriptModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_messages.size()) {
+        return QVariant();
+    }
+
+    const RichChatMessage& message = *m_messages.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            return message.content;
+        case MessageIdRole:
+            return message.id;
+        case SenderIdRole:
+            return message.senderId;
+        case SenderNameRole:
+            return message.senderName;
+        case TimestampRole:
+            return message.timestamp;
+        case MessageTypeRole:
+            return message.messageType;
+        case HtmlContentRole:
+            return message.htmlContent;
+        default:
+            return QVariant();
+    }
+}
+
+void ChatTranscriptModel::setMessages(const QList<ChatMessage>& messages)
+{
+    beginResetModel();
+    m_messages.clear();
+    m_queuedMessages.clear();
+    m_messages.reserve(messages.size());
+    for (const ChatMessage& message : messages) {
+        m_messages.append(SharedRichChatMessage(RichChatMessage::fromChatMessage(message)));
+    }
+    resetRowLayouts();
+    m_pendingHistoryTicket = 0;
+    endResetModel();
+}
+
+void ChatTranscriptModel::appendMessage(const ChatMessage& message)
+{
+    appendRichMessage(RichChatMessage::fromChatMessage(message));
+}
+
+void ChatTranscriptModel::appendRichMessage(const SharedRichChatMessage& message)
+{
+    // 保证与排队中的消息顺序一致
+    flushQueuedMessages();
+    insertAtEnd(QList<SharedRichChatMessage>() << message);
+}
+
+void ChatTranscriptModel::appendMessages(const QList<ChatMessage>& messages)
+{
+    flushQueuedMessages();
+
+    QList<SharedRichChatMessage> richMessages;
+    richMessages.reserve(messages.size());
+    for (const ChatMessage& message : messages) {
+        richMessages.append(SharedRichChatMessage(RichChatMessage::fromChatMessage(message)));
+    }
+    insertAtEnd(richMessages);
+}
+
+void ChatTranscriptModel::queueMessage(const ChatMessage& message)
+{
+    queueRichMessage(RichChatMessage::fromChatMessage(message));
+}
+
+void ChatTranscriptModel::queueRichMessage(const SharedRichChatMessage& message)
+{
+    m_queuedMessages.append(message);
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::TranscriptInsert, [this]() {
+        flushQueuedMessages();
+    });
+}
+
+void ChatTranscriptModel::flushQueuedMessages()
+{
+    if (m_queuedMessages.isEmpty()) {
+        return;
+    }
+    QList<SharedRichChatMessage> messages;
+    messages.swap(m_queuedMessages);
+    insertAtEnd(messages);
+}
+
+void ChatTranscriptModel::insertAtEnd(const QList<SharedRichChatMessage>& messages)
+{
+    if (messages.isEmpty()) {
+        return;
+    }
+
+    int first = m_messages.size();
+    beginInsertRows(QModelIndex(), first, first + messages.size() - 1);
+    m_messages.append(messages);
+    for (int i = 0; i < messages.size(); ++i) {
+        m_rowLayouts.append(newRowLayout());
+    }
+    endInsertRows();
+}
+
+void ChatTranscriptModel::clear()
+{
+    beginResetModel();
+    m_messages.clear();
+    m_queuedMessages.clear();
+    m_rowLayouts.clear();
+    m_documents.clear();
+    m_historySessionId = 0;
+    m_hasMoreHistory = false;
+    m_pendingHistoryTicket = 0;
+    endResetModel();
+}
+
+void ChatTranscriptModel::setHistorySource(int sessionId, bool hasMoreHistory)
+{
+    m_historySessionId = sessionId;
+    m_hasMoreHistory = hasMoreHistory;
+}
+
+int ChatTranscriptModel::historySessionId() const
+{
+    return m_historySessionId;
+}
+
+bool ChatTranscriptModel::hasMoreHistory() const
+{
+    return m_historySessionId > 0 && m_hasMoreHistory;
+}
+
+int ChatTranscriptModel::beginHistoryLoad()
+{
+    m_pendingHistoryTicket = ++m_historyTicket;
+    return m_pendingHistoryTicket;
+}
+
+bool ChatTranscriptModel::finishHistoryLoad(int ticket)
+{
+    if (ticket != m_pendingHistoryTicket) {
+        return false;
+    }
+    m_pendingHistoryTicket = 0;
+    return true;
+}
+
+bool ChatTranscriptModel::isLoadingHistory() const
+{
+    return m_pendingHistoryTicket != 0;
+}
+
+void ChatTranscriptModel::prependMessages(const QList<ChatMessage>& messages, bool hasMoreHistory)
+{
+    m_hasMoreHistory = hasMoreHistory;
+    if (messages.isEmpty()) {
+        return;
+    }
+
+    QList<SharedRichChatMessage> page;
+    QList<RowLayout> layouts;
+    page.reserve(messages.size());
+    layouts.reserve(messages.size());
+    for (const ChatMessage& message : messages) {
+        page.append(SharedRichChatMessage(RichChatMessage::fromChatMessage(message)));
+        layouts.append(newRowLayout());
+    }
+
+    beginInsertRows(QModelIndex(), 0, page.size() - 1);
+    m_messages = page + m_messages;
+    m_rowLayouts = layouts + m_rowLayouts;
+    endInsertRows();
+}
+
+void ChatTranscriptModel::removeOldest(int count)
+{
+    count = qMin(count, m_messages.size());
+    if (count <= 0) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    for (int row = 0; row < count; ++row) {
+        m_documents.remove(m_rowLayouts.at(row).key);
+    }
+    m_messages.remove(0, count);
+    m_rowLayouts.remove(0, count);
+    endRemoveRows();
+
+    m_hasMoreHistory = true;
+}
+
+const RichChatMessage& ChatTranscriptModel::messageAt(int row) const
+{
+    return *m_messages.at(row);
+}
+
+int ChatTranscriptModel::firstMessageId() const
+{
+    for (const SharedRichChatMessage& message : m_messages) {
+        if (message->id > 0) {
+            return message->id;
+        }
+    }
+    return 0;
+}
+
+int ChatTranscriptModel::lastMessageId() const
+{
+    for (int i = m_queuedMessages.size() - 1; i >= 0; --i) {
+        if (m_queuedMessages.at(i)->id > 0) {
+            return m_queuedMessages.at(i)->id;
+        }
+    }
+    for (int row = m_messages.size() - 1; row >= 0; --row) {
+        if (m_messages.at(row)->id > 0) {
+            return m_messages.at(row)->id;
+        }
+    }
+    return 0;
+}
+
+int ChatTranscriptModel::cachedHeight(int row, int width, bool* exact) const
+{
+    if (row < 0 || row >= m_rowLayouts.size() || m_rowLayouts.at(row).width != width) {
+        return -1;
+    }
+    if (exact) {
+        *exact = m_rowLayouts.at(row).exact;
+    }
+    return m_rowLayouts.at(row).height;
+}
+
+void ChatTranscriptModel::setCachedHeight(int row, int width, int height, bool exact) const
+{
+    if (row < 0 || row >= m_rowLayouts.size()) {
+        return;
+    }
+    m_rowLayouts[row].width = width;
+    m_rowLayouts[row].height = height;
+    m_rowLayouts[row].exact = exact;
+}
+
+QTextDocument* ChatTranscriptModel::cachedDocument(int row) const
+{
+    return m_documents.object(rowKey(row));
+}
+
+void ChatTranscriptModel::cacheDocument(int row, QTextDocument* document) const
+{
+    m_documents.insert(rowKey(row), document);
+}
+
+void ChatTranscriptModel::clearLayoutCache()
+{
+    resetRowLayouts();
+}
+
+quint64 ChatTranscriptModel::rowKey(int row) const
+{
+    if (row < 0 || row >= m_rowLayouts.size()) {
+        return 0;
+    }
+    return m_rowLayouts.at(row).key;
+}
+
+int ChatTranscriptModel::rowOfKey(quint64 key) const
+{
+    for (int row = 0; row < m_rowLayouts.size(); ++row) {
+        if (m_rowLayouts.at(row).key == key) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+ChatTranscriptModel::RowLayout ChatTranscriptModel::newRowLayout()
+{
+    RowLayout layout;
+    layout.key = m_nextRowKey++;
+    return layout;
+}
+
+void ChatTranscriptModel::resetRowLayouts()
+{
+    m_rowLayouts.clear();
+    m_rowLayouts.reserve(m_messages.size());
+    for (int row = 0; row < m_messages.size(); ++row) {
+        m_rowLayouts.append(newRowLayout());
+    }
+    m_documents.clear();
+}
+
+void ChatTranscriptModel::saveViewState(int scrollValue, bool followTail)
+{
+    m_savedScrollValue = scrollValue;
+    m_savedFollowTail = followTail;
+}
+
+int ChatTranscriptModel::savedScrollValue() const
+{
+    return m_savedScrollValue;
+}
+
+bool ChatTranscriptModel::savedFollowTail() const
+{
+    return m_savedFollowTail;
+}
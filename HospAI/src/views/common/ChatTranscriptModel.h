@@ -0,0 +1,103 @@
+#ifndef CHATTRANSCRIPTMODEL_H
+#define CHATTRANSCRIPTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QCache>
+#include <QTextDocument>
+#include "../../core/DatabaseManager.h"
+#include "../../core/RichMessageTypes.h"
+
+// 聊天记录模型：统一保存为只读共享的 RichChatMessage，并为每行缓存排版结果
+// （行高和已排版的文档），由 ChatBubbleDelegate 按需绘制
+class ChatTranscriptModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        MessageIdRole = Qt::UserRole + 1,
+        SenderIdRole,
+        SenderNameRole,
+        TimestampRole,
+        MessageTypeRole,
+        HtmlContentRole
+    };
+
+    explicit ChatTranscriptModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void setMessages(const QList<ChatMessage>& messages);
+    void appendMessage(const ChatMessage& message);
+    // 直接保存共享句柄，不再复制消息
+    void appendRichMessage(const SharedRichChatMessage& message);
+    void appendMessages(const QList<ChatMessage>& messages);
+    // 先放入队列，下一帧一次性插入（突发的大量消息只触发一次排版）
+    void queueMessage(const ChatMessage& message);
+    void queueRichMessage(const SharedRichChatMessage& message);
+    void flushQueuedMessages();
+    void clear();
+
+    // 历史分页：记录所属会话以及是否还有更早的消息可加载
+    void setHistorySource(int sessionId, bool hasMoreHistory);
+    int historySessionId() const;
+    bool hasMoreHistory() const;
+    // 翻页请求编号，模型重置后旧请求的结果作废
+    int beginHistoryLoad();
+    bool finishHistoryLoad(int ticket);
+    bool isLoadingHistory() const;
+    // 在顶部插入更早的一页；淘汰最旧的若干行（之后可重新加载）
+    void prependMessages(const QList<ChatMessage>& messages, bool hasMoreHistory);
+    void removeOldest(int count);
+
+    const RichChatMessage& messageAt(int row) const;
+    // 最小/最大的已入库消息ID（本地临时消息ID为0，不计入；最大ID包含排队中的消息）
+    int firstMessageId() const;
+    int lastMessageId() const;
+    // 行插入删除后不变的行标识，用于恢复滚动锚点
+    quint64 rowKey(int row) const;
+    int rowOfKey(quint64 key) const;
+
+    // 排版缓存：行高按宽度失效，文档只保留最近绘制过的若干行
+    // 未实际排版的行只有估算高度，exact 为 false
+    int cachedHeight(int row, int width, bool* exact = nullptr) const;
+    void setCachedHeight(int row, int width, int height, bool exact) const;
+    QTextDocument* cachedDocument(int row) const;
+    void cacheDocument(int row, QTextDocument* document) const;
+    void clearLayoutCache();
+
+    // 切换模型时由视图保存/恢复滚动状态
+    void saveViewState(int scrollValue, bool followTail);
+    int savedScrollValue() const;
+    bool savedFollowTail() const;
+
+private:
+    struct RowLayout {
+        quint64 key = 0;
+        int width = -1;
+        int height = -1;
+        bool exact = false;
+    };
+
+    RowLayout newRowLayout();
+    void resetRowLayouts();
+
+    void insertAtEnd(const QList<SharedRichChatMessage>& messages);
+
+    QList<SharedRichChatMessage> m_messages;
+    QList<SharedRichChatMessage> m_queuedMessages;
+    mutable QList<RowLayout> m_rowLayouts;
+    // 按行标识缓存，顶部插入或淘汰行后仍然有效
+    mutable QCache<quint64, QTextDocument> m_documents;
+    quint64 m_nextRowKey;
+    int m_historySessionId;
+    bool m_hasMoreHistory;
+    int m_historyTicket;
+    int m_pendingHistoryTicket;
+    int m_savedScrollValue;
+    bool m_savedFollowTail;
+};
+
+#endif // CHATTRANSCRIPTMODEL_H
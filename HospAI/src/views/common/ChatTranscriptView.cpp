@@ -0,0 +1,181 @@
+#include "ChatTranscriptView.h"
+#include "UIStyleManager.h"
+#include "../../core/ImagePipeline.h"
+#include "../../core/ChatHistoryLoader.h"
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QItemSelectionModel>
+#include <QPointer>
+
+// 距顶部小于该距离时开始加载更早的一页
+static const int HISTORY_PREFETCH_DISTANCE = 600;
+// 回到底部后，已加载行数超过上限时淘汰最旧的部分，只保留最近两页
+static const int MAX_LOADED_ROWS = 8 * ChatHistoryLoader::PAGE_SIZE;
+static const int KEEP_LOADED_ROWS = 2 * ChatHistoryLoader::PAGE_SIZE;
+
+ChatTranscriptView::ChatTranscriptView(QWidget *parent)
+    : QListView(parent)
+    , m_defaultModel(new ChatTranscriptModel(this))
+    , m_model(m_defaultModel)
+    , m_delegate(new ChatBubbleDelegate(this))
+    , m_followTail(true)
+    , m_restoringAnchor(false)
+{
+    setModel(m_model);
+    setItemDelegate(m_delegate);
+
+    setSelectionMode(QAbstractItemView::NoSelection);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setFocusPolicy(Qt::NoFocus);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setResizeMode(QListView::Adjust);
+    setUniformItemSizes(false);
+
+    setStyleSheet(QString(
+        "QListView {"
+        "    background-color: %1;"
+        "    border: 1px solid %2;"
+        "    border-radius: 6px;"
+        "}"
+    ).arg(UIStyleManager::colors.surface).arg(UIStyleManager::colors.border));
+
+    // 停留在底部时，新消息或估算高度被修正后保持在底部
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        m_followTail = value >= verticalScrollBar()->maximum() - 4;
+        loadOlderHistoryIfNeeded();
+        if (m_followTail && m_model->rowCount() > MAX_LOADED_ROWS) {
+            // 不在滚动信号中直接删行
+            QMetaObject::invokeMethod(this, &ChatTranscriptView::evictFarHistory, Qt::QueuedConnection);
+        }
+    });
+    connect(verticalScrollBar(), &QScrollBar::rangeChanged, this, [this](int, int maximum) {
+        if (m_followTail) {
+            verticalScrollBar()->setValue(maximum);
+        }
+        // 内容不足一屏时不会产生滚动，在这里补一次检查
+        loadOlderHistoryIfNeeded();
+    });
+
+    // 缩略图解码完成后重绘可见区域
+    connect(ImagePipeline::instance(), &ImagePipeline::thumbnailReady, viewport(), [this]() {
+        viewport()->update();
+    });
+
+    m_delegate->setViewportWidth(viewport()->width());
+}
+
+ChatTranscriptModel* ChatTranscriptView::transcriptModel() const
+{
+    return m_model;
+}
+
+void ChatTranscriptView::setTranscriptModel(ChatTranscriptModel* model)
+{
+    if (!model) {
+        model = m_defaultModel;
+    }
+    if (model == m_model) {
+        return;
+    }
+    
+    if (m_followTail) {
+        evictFarHistory();
+    }
+    m_model->saveViewState(verticalScrollBar()->value(), m_followTail);
+    
+    // 模型自带行高和文档缓存，切换后无需重新排版
+    m_model = model;
+    m_followTail = m_model->savedFollowTail();
+    QItemSelectionModel* oldSelectionModel = selectionModel();
+    setModel(m_model);
+    delete oldSelectionModel;
+    
+    doItemsLayout();
+    if (m_followTail) {
+        scrollToBottom();
+    } else {
+        verticalScrollBar()->setValue(m_model->savedScrollValue());
+    }
+    loadOlderHistoryIfNeeded();
+}
+
+void ChatTranscriptView::setCurrentUserId(int userId)
+{
+    m_delegate->setCurrentUserId(userId);
+
+    // 气泡方向和宽度随用户变化，需要重新排版
+    m_model->clearLayoutCache();
+    scheduleDelayedItemsLayout();
+}
+
+bool ChatTranscriptView::viewportEvent(QEvent* event)
+{
+    // 滚动条出现或消失也会改变视口宽度，在这里统一更新
+    if (event->type() == QEvent::Resize) {
+        QResizeEvent* resizeEvent = static_cast<QResizeEvent*>(event);
+        if (resizeEvent->size().width() != resizeEvent->oldSize().width()) {
+            m_delegate->setViewportWidth(resizeEvent->size().width());
+            scheduleDelayedItemsLayout();
+        }
+    }
+    return QListView::viewportEvent(event);
+}
+
+void ChatTranscriptView::loadOlderHistoryIfNeeded()
+{
+    if (m_restoringAnchor || !m_model->hasMoreHistory() || m_model->isLoadingHistory()
+        || verticalScrollBar()->value() > HISTORY_PREFETCH_DISTANCE) {
+        return;
+    }
+
+    QPointer<ChatTranscriptModel> model(m_model);
+    int ticket = m_model->beginHistoryLoad();
+
+    ChatHistoryLoader::instance()->loadOlderPage(m_model->historySessionId(), m_model->firstMessageId(), this,
+        [this, model, ticket](const QList<ChatMessage>& messages) {
+            // 模型已销毁或期间被重置时丢弃结果
+            if (!model || !model->finishHistoryLoad(ticket)) {
+                return;
+            }
+
+            bool hasMoreHistory = messages.size() >= ChatHistoryLoader::PAGE_SIZE;
+            if (model == m_model) {
+                prependHistoryPage(messages, hasMoreHistory);
+            } else {
+                model->prependMessages(messages, hasMoreHistory);
+            }
+        });
+}
+
+void ChatTranscriptView::prependHistoryPage(const QList<ChatMessage>& messages, bool hasMoreHistory)
+{
+    // 记录视口顶部的行及其偏移，插入后把它放回原位
+    QModelIndex anchor = indexAt(QPoint(0, 0));
+    quint64 anchorKey = m_model->rowKey(anchor.row());
+    int anchorOffset = anchor.isValid() ? visualRect(anchor).top() : 0;
+
+    m_restoringAnchor = true;
+    m_model->prependMessages(messages, hasMoreHistory);
+    doItemsLayout();
+
+    int anchorRow = m_model->rowOfKey(anchorKey);
+    if (!m_followTail && anchorRow >= 0) {
+        QRect anchorRect = visualRect(m_model->index(anchorRow));
+        verticalScrollBar()->setValue(verticalScrollBar()->value() + anchorRect.top() - anchorOffset);
+    }
+    m_restoringAnchor = false;
+
+    // 新的一页仍未填满视口时继续加载
+    loadOlderHistoryIfNeeded();
+}
+
+void ChatTranscriptView::evictFarHistory()
+{
+    // 只在停留于底部时淘汰，被淘汰的行都在视口上方很远处；没有历史来源的记录不能重新加载，不淘汰
+    if (!m_followTail || m_model->historySessionId() <= 0 || m_model->rowCount() <= MAX_LOADED_ROWS) {
+        return;
+    }
+    m_model->removeOldest(m_model->rowCount() - KEEP_LOADED_ROWS);
+}
@@ -0,0 +1,37 @@
+#ifndef CHATTRANSCRIPTVIEW_H
+#define CHATTRANSCRIPTVIEW_H
+
+#include <QListView>
+#include "ChatTranscriptModel.h"
+#include "ChatBubbleDelegate.h"
+
+// 聊天记录视图：只绘制可见行，停留在底部时新消息到达自动跟随；
+// 滚动到接近顶部时在后台加载更早的一页，并保持当前可见内容不跳动
+class ChatTranscriptView : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit ChatTranscriptView(QWidget *parent = nullptr);
+
+    ChatTranscriptModel* transcriptModel() const;
+    // 切换显示的模型（传 nullptr 恢复为内置空模型），滚动位置随模型保存
+    void setTranscriptModel(ChatTranscriptModel* model);
+    void setCurrentUserId(int userId);
+
+protected:
+    bool viewportEvent(QEvent* event) override;
+
+private:
+    void loadOlderHistoryIfNeeded();
+    void prependHistoryPage(const QList<ChatMessage>& messages, bool hasMoreHistory);
+    void evictFarHistory();
+
+    ChatTranscriptModel* m_defaultModel;
+    ChatTranscriptModel* m_model;
+    ChatBubbleDelegate* m_delegate;
+    bool m_followTail;
+    bool m_restoringAnchor;
+};
+
+#endif // CHATTRANSCRIPTVIEW_H
@@ -0,0 +1,55 @@
+#include "HospitalStyle.h"
+#include <QPushButton>
+
+HospitalStyle::HospitalStyle(QStyle *baseStyle)
+    : QProxyStyle(baseStyle)
+    , m_colors(UIStyleManager::colors)
+{
+}
+
+void HospitalStyle::setColorScheme(const UIStyleManager::ColorScheme &colors)
+{
+    m_colors = colors;
+}
+
+QPalette HospitalStyle::standardPalette() const
+{
+    QPalette palette = QProxyStyle::standardPalette();
+
+    palette.setColor(QPalette::Window, QColor(m_colors.background));
+    palette.setColor(QPalette::WindowText, QColor(m_colors.text));
+    palette.setColor(QPalette::Base, QColor(m_colors.surface));
+    palette.setColor(QPalette::AlternateBase, QColor(m_colors.hover));
+    palette.setColor(QPalette::Text, QColor(m_colors.text));
+    palette.setColor(QPalette::Button, QColor(m_colors.surface));
+    palette.setColor(QPalette::ButtonText, QColor(m_colors.text));
+    palette.setColor(QPalette::Highlight, QColor(m_colors.primary));
+    palette.setColor(QPalette::HighlightedText, Qt::white);
+    palette.setColor(QPalette::Link, QColor(m_colors.primary));
+    palette.setColor(QPalette::Mid, QColor(m_colors.border));
+    palette.setColor(QPalette::PlaceholderText, QColor(m_colors.textSecondary));
+    palette.setColor(QPalette::ToolTipBase, QColor(m_colors.text));
+    palette.setColor(QPalette::ToolTipText, QColor(m_colors.surface));
+
+    // 禁用状态统一使用次要文字色
+    palette.setColor(QPalette::Disabled, QPalette::WindowText, QColor(m_colors.textSecondary));
+    palette.setColor(QPalette::Disabled, QPalette::Text, QColor(m_colors.textSecondary));
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, QColor(m_colors.textSecondary));
+
+    return palette;
+}
+
+void HospitalStyle::polish(QPalette &palette)
+{
+    palette = standardPalette();
+}
+
+void HospitalStyle::polish(QWidget *widget)
+{
+    QProxyStyle::polish(widget);
+
+    // 带变体的按钮统一使用手型光标，不再由每个调用点设置
+    if (qobject_cast<QPushButton*>(widget) && widget->property(UIStyleManager::VARIANT_PROPERTY).isValid()) {
+        widget->setCursor(Qt::PointingHandCursor);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef HOSPITALSTYLE_H
+#define HOSPITALSTYLE_H
+
+#include <QProxyStyle>
+#include <QPalette>
+#include "UIStyleManager.h"
+
+// 应用级代理样式：按当前主题生成调色板，并为带样式变体的控件设置
+// 样式表无法表达的属性；控件外观本身由全局样式表的变体选择器决定
+class HospitalStyle : public QProxyStyle
+{
+    Q_OBJECT
+
+public:
+    explicit HospitalStyle(QStyle *baseStyle = nullptr);
+
+    void setColorScheme(const UIStyleManager::ColorScheme &colors);
+
+    QPalette standardPalette() const override;
+    void polish(QPalette &palette) override;
+    void polish(QWidget *widget) override;
+    using QProxyStyle::polish;
+
+private:
+    UIStyleManager::ColorScheme m_colors;
+};
+
+#endif // HOSPITALSTYLE_H
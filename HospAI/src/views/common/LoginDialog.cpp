@@ -2,6 +2,7 @@
 #include "ui_LoginDialog.h"
 #include "RegisterDialog.h"
 #include "ForgotPasswordDialog.h"
+#include "../../core/StartupProfiler.h"
 #include <QMessageBox>
 #include <QKeyEvent>
 #include <QTimer>
@@ -12,6 +13,7 @@ LoginDialog::LoginDialog(QWidget *parent)
     , ui(new Ui::LoginDialog)
     , m_loginSuccess(false)
 {
+    StartupProfiler::Scope phase("LoginDialog");
     ui->setupUi(this);
     
     setWindowFlags(Qt::Dialog | Qt::WindowCloseButtonHint);
@@ -114,7 +116,7 @@ void LoginDialog::onLoginClicked()
     if (db->loginUser(username, password, m_currentUser)) {
         // 验证角色
         QString selectedRole = ui->roleCombo->currentData().toString();
-        if (m_currentUser.role != selectedRole) {
+        if (m_currentUser.role != userRoleFromName(selectedRole)) {
             showMessage("登录身份与账户角色不匹配！", true);
             return;
         }
@@ -16,6 +16,11 @@ RegisterDialog::RegisterDialog(QWidget *parent)
     setupUI();
     setupStyles();
     
+    // 查重在输入停顿后异步进行，打开界面时就开始准备过滤器
+    AvailabilityChecker* checker = AvailabilityChecker::instance();
+    connect(checker, &AvailabilityChecker::availabilityChecked, this, &RegisterDialog::onAvailabilityChecked);
+    checker->prepare();
+    
     // 设置默认焦点
     m_usernameEdit->setFocus();
 }
@@ -442,15 +447,10 @@ void RegisterDialog::onUsernameChanged()
             m_usernameHint->setText("只能包含字母、数字、下划线");
             m_usernameHint->setStyleSheet("color: #dc3545;");
         } else {
-            // 检查用户名是否已存在
-            DatabaseManager* db = DatabaseManager::instance();
-            if (db->isUsernameExists(username)) {
-                m_usernameHint->setText("用户名已存在");
-                m_usernameHint->setStyleSheet("color: #dc3545;");
-            } else {
-                m_usernameHint->setText("✓ 用户名可用");
-                m_usernameHint->setStyleSheet("color: #28a745;");
-            }
+            // 检查用户名是否已存在，结果在 onAvailabilityChecked 中显示
+            m_usernameHint->setText("正在检查用户名...");
+            m_usernameHint->setStyleSheet("color: #6c757d;");
+            AvailabilityChecker::instance()->check(AvailabilityChecker::Username, username);
         }
     }
     
@@ -495,15 +495,10 @@ void RegisterDialog::onEmailChanged()
             m_emailHint->setText("邮箱格式不正确");
             m_emailHint->setStyleSheet("color: #dc3545;");
         } else {
-            // 检查邮箱是否已存在
-            DatabaseManager* db = DatabaseManager::instance();
-            if (db->isEmailExists(email)) {
-                m_emailHint->setText("邮箱已被注册");
-                m_emailHint->setStyleSheet("color: #dc3545;");
-            } else {
-                m_emailHint->setText("✓ 邮箱可用");
-                m_emailHint->setStyleSheet("color: #28a745;");
-            }
+            // 检查邮箱是否已存在，结果在 onAvailabilityChecked 中显示
+            m_emailHint->setText("正在检查邮箱...");
+            m_emailHint->setStyleSheet("color: #6c757d;");
+            AvailabilityChecker::instance()->check(AvailabilityChecker::Email, email);
         }
     }
     
@@ -515,6 +510,34 @@ void RegisterDialog::onRoleChanged()
     clearMessage();
 }
 
+void RegisterDialog::onAvailabilityChecked(AvailabilityChecker::Field field, const QString& value, bool available)
+{
+    // 结果返回前输入已经变化的，忽略
+    if (field == AvailabilityChecker::Username) {
+        if (value != m_usernameEdit->text().trimmed()) {
+            return;
+        }
+        if (available) {
+            m_usernameHint->setText("✓ 用户名可用");
+            m_usernameHint->setStyleSheet("color: #28a745;");
+        } else {
+            m_usernameHint->setText("用户名已存在");
+            m_usernameHint->setStyleSheet("color: #dc3545;");
+        }
+    } else {
+        if (value != m_emailEdit->text().trimmed()) {
+            return;
+        }
+        if (available) {
+            m_emailHint->setText("✓ 邮箱可用");
+            m_emailHint->setStyleSheet("color: #28a745;");
+        } else {
+            m_emailHint->setText("邮箱已被注册");
+            m_emailHint->setStyleSheet("color: #dc3545;");
+        }
+    }
+}
+
 void RegisterDialog::updatePasswordStrength()
 {
     QString password = m_passwordEdit->text();
@@ -14,6 +14,7 @@
 #include <QProgressBar>
 #include <QTimer>
 #include "../../core/DatabaseManager.h"
+#include "../../core/AvailabilityChecker.h"
 
 class RegisterDialog : public QDialog
 {
@@ -36,6 +37,7 @@ private slots:
     void onConfirmPasswordChanged();
     void onEmailChanged();
     void onRoleChanged();
+    void onAvailabilityChecked(AvailabilityChecker::Field field, const QString& value, bool available);
 
 private:
     void setupUI();
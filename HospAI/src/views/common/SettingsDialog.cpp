@@ -193,6 +193,9 @@ void SettingsDialog::saveSettings()
     
     // 同步设置
     m_settings->sync();
+    
+    // 只替换一份预生成的全局样式表，主题未变化时不重新polish
+    UIStyleManager::setTheme(ui->themeCombo->currentText());
 }
 
 void SettingsDialog::onThemeChanged()
@@ -105,6 +105,8 @@ void SideMenuWidget::setupUI()
     case UserRole::Admin:
         setupAdminMenu();
         break;
+    default:
+        break;
     }
     
     // 添加弹性空间
@@ -1,4 +1,6 @@
 #include "UIStyleManager.h"
+#include "HospitalStyle.h"
+#include "../../core/StartupProfiler.h"
 #include <QApplication>
 #include <QFont>
 #include <QFontDatabase>
@@ -7,10 +9,364 @@
 #include <QGridLayout>
 #include <QScreen>
 #include <QSysInfo>
+#include <QSettings>
+#include <QStyleHints>
+#include <QElapsedTimer>
+#include <QPointer>
 #include <QDebug>
 
 // 静态成员初始化
 UIStyleManager::ColorScheme UIStyleManager::colors;
+const char *UIStyleManager::VARIANT_PROPERTY = "hospVariant";
+QString UIStyleManager::s_theme;
+QHash<QString, QString> UIStyleManager::s_styleSheetCache;
+QHash<QString, QHash<QString, QString>> UIStyleManager::s_variantSheets;
+bool UIStyleManager::s_perWidgetStyleSheets = false;
+
+static const QString DEFAULT_THEME = "浅色主题";
+static const QStringList BUTTON_VARIANTS = {"primary", "secondary", "success", "warning", "error"};
+static const QStringList LABEL_VARIANTS = {"title", "subtitle", "caption", "success", "warning", "error"};
+
+// 聊天页和角色窗口原先在构造时逐个 setStyleSheet 的固定样式（不随主题变化），
+// 按 类型/变体/上下文 登记，规则文本保持原样，由 scopeToVariant 改写后并入应用样式表
+struct FixedVariant {
+    const char *typeName;
+    const char *variant;
+    const char *context;
+    const char *rules;
+};
+
+static const char *CHAT_CONTEXT = "ChatWidget";
+// 聊天区对所有子控件设了白色背景，区内的气泡等需要同样的上下文才能压过它
+static const char *CHAT_AREA_CONTEXT = "ChatWidget QScrollArea[hospVariant=\"chatArea\"]";
+
+static const FixedVariant FIXED_VARIANTS[] = {
+    // 角色窗口的规则原先设在窗口上，会压过应用样式表；放在最前面，同等优先级时聊天页的规则仍然在后生效
+    {"QMainWindow", "roleWindow", "", R"(
+        QMainWindow {
+            background-color: #f5f5f5;
+        }
+        
+        QWidget {
+            font-family: "SF Pro Display", "Microsoft YaHei", sans-serif;
+            font-size: 14px;
+        }
+        
+        QPushButton {
+            background-color: #007AFF;
+            color: white;
+            border: none;
+            border-radius: 6px;
+            padding: 8px 16px;
+            font-weight: 500;
+        }
+        
+        QPushButton:hover {
+            background-color: #0056CC;
+        }
+        
+        QPushButton:pressed {
+            background-color: #004499;
+        }
+        
+        QPushButton:disabled {
+            background-color: #C7C7CC;
+        }
+        
+        QListWidget {
+            background-color: white;
+            border: 1px solid #E5E5EA;
+            border-radius: 8px;
+            outline: none;
+        }
+        
+        QListWidget::item {
+            padding: 12px;
+            border-bottom: 1px solid #E5E5EA;
+        }
+        
+        QListWidget::item:selected {
+            background-color: #007AFF;
+            color: white;
+        }
+        
+        QListWidget::item:hover {
+            background-color: #F2F2F7;
+        }
+        
+        QStackedWidget {
+            background-color: white;
+            border-radius: 8px;
+        }
+    )"},
+    {"ChatWidget", "chat", "", R"(
+        ChatWidget {
+            background-color: #F8F9FA;
+        }
+    )"},
+    {"QPushButton", "chatTool", CHAT_CONTEXT, R"(
+        QPushButton {
+            background-color: white;
+            border: 1px solid #D1D1D6;
+            border-radius: 6px;
+            padding: 8px 16px;
+            font-size: 13px;
+            color: #1D1D1F;
+        }
+        QPushButton:hover {
+            background-color: #F2F2F7;
+            border-color: #007AFF;
+        }
+        QPushButton:checked {
+            background-color: #007AFF;
+            color: white;
+        }
+    )"},
+    {"QLabel", "chatStatus", CHAT_CONTEXT, R"(
+        QLabel {
+            font-size: 16px;
+            font-weight: bold;
+            color: #1D1D1F;
+            padding: 8px;
+        }
+    )"},
+    {"QToolBar", "chatRichToolbar", CHAT_CONTEXT, R"(
+        QToolBar {
+            background-color: #F2F2F7;
+            border: 1px solid #D1D1D6;
+            border-radius: 8px;
+            padding: 5px;
+            spacing: 5px;
+        }
+        QToolButton {
+            background-color: white;
+            border: 1px solid #D1D1D6;
+            border-radius: 4px;
+            padding: 4px 8px;
+            font-weight: bold;
+            min-width: 24px;
+            min-height: 24px;
+        }
+        QToolButton:hover {
+            background-color: #E5E5EA;
+        }
+        QToolButton:checked {
+            background-color: #007AFF;
+            color: white;
+        }
+        QFontComboBox, QSpinBox {
+            border: 1px solid #D1D1D6;
+            border-radius: 4px;
+            padding: 2px 4px;
+            background-color: white;
+        }
+    )"},
+    {"QScrollArea", "chatArea", CHAT_CONTEXT, R"(
+        QScrollArea {
+            background-color: white;
+            border: 1px solid #E5E5EA;
+            border-radius: 12px;
+        }
+        QScrollArea QWidget {
+            background-color: white;
+        }
+        QScrollBar:vertical {
+            background-color: #F2F2F7;
+            width: 8px;
+            border-radius: 4px;
+        }
+        QScrollBar::handle:vertical {
+            background-color: #C7C7CC;
+            border-radius: 4px;
+            min-height: 20px;
+        }
+        QScrollBar::handle:vertical:hover {
+            background-color: #A8A8AF;
+        }
+    )"},
+    {"QGroupBox", "chatQuickGroup", CHAT_CONTEXT, R"(
+        QGroupBox {
+            font-weight: bold;
+            font-size: 14px;
+            color: #1D1D1F;
+            border: 1px solid #E5E5EA;
+            border-radius: 8px;
+            margin-top: 8px;
+            padding-top: 8px;
+        }
+        QGroupBox::title {
+            subcontrol-origin: margin;
+            left: 10px;
+            padding: 0 8px 0 8px;
+        }
+    )"},
+    {"QPushButton", "chatQuick", CHAT_CONTEXT, R"(
+        QPushButton {
+            background-color: white;
+            border: 1px solid #D1D1D6;
+            border-radius: 8px;
+            padding: 10px 15px;
+            font-size: 13px;
+            color: #1D1D1F;
+            text-align: left;
+        }
+        QPushButton:hover {
+            background-color: #F2F8FF;
+            border-color: #007AFF;
+        }
+        QPushButton:pressed {
+            background-color: #E3F2FD;
+        }
+    )"},
+    {"QTextEdit", "chatInput", CHAT_CONTEXT, R"(
+        QTextEdit {
+            border: 1px solid #D1D1D6;
+            border-radius: 8px;
+            padding: 8px 12px;
+            font-size: 14px;
+            background-color: white;
+        }
+        QTextEdit:focus {
+            border-color: #007AFF;
+        }
+    )"},
+    {"QPushButton", "chatSend", CHAT_CONTEXT, R"(
+        QPushButton {
+            background-color: #007AFF;
+            color: white;
+            border: none;
+            border-radius: 8px;
+            font-size: 14px;
+            font-weight: bold;
+        }
+        QPushButton:hover {
+            background-color: #0056CC;
+        }
+        QPushButton:pressed {
+            background-color: #004499;
+        }
+        QPushButton:disabled {
+            background-color: #C7C7CC;
+        }
+    )"},
+    {"QPushButton", "chatIcon", CHAT_CONTEXT, R"(
+        QPushButton {
+            background-color: #F2F2F7;
+            border: 1px solid #D1D1D6;
+            border-radius: 8px;
+            font-size: 16px;
+        }
+        QPushButton:hover {
+            background-color: #E5E5EA;
+        }
+    )"},
+    {"QLabel", "chatNoticeTitle", CHAT_CONTEXT, R"(
+        QLabel {
+            font-size: 14px;
+            color: #1D1D1F;
+            font-weight: bold;
+            padding: 5px;
+        }
+    )"},
+    {"QLabel", "chatNoticeDetail", CHAT_CONTEXT, R"(
+        QLabel {
+            font-size: 13px;
+            color: #666666;
+            padding: 5px 10px;
+            line-height: 1.4;
+        }
+    )"},
+    {"QPushButton", "chatAction", CHAT_CONTEXT, R"(
+        QPushButton {
+            background-color: #34C759;
+            color: white;
+            border: none;
+            border-radius: 8px;
+            padding: 10px 20px;
+            font-size: 14px;
+            font-weight: bold;
+        }
+        QPushButton:hover {
+            background-color: #30A855;
+        }
+    )"},
+    {"QPushButton", "chatTransfer", CHAT_CONTEXT, R"(
+        QPushButton {
+            background-color: #FF9500;
+            color: white;
+            border: none;
+            border-radius: 8px;
+            padding: 10px 20px;
+            font-size: 14px;
+            font-weight: bold;
+        }
+        QPushButton:hover {
+            background-color: #E6860E;
+        }
+    )"},
+    {"QLabel", "chatTime", CHAT_AREA_CONTEXT, R"(
+        QLabel {
+            color: #8E8E93;
+            font-size: 11px;
+        }
+    )"},
+    {"QLabel", "chatAvatar", CHAT_AREA_CONTEXT, R"(
+        QLabel {
+            background-color: #34C759;
+            border-radius: 16px;
+            font-size: 16px;
+        }
+    )"},
+    {"QLabel", "chatBubbleUser", CHAT_AREA_CONTEXT, R"(
+        QLabel {
+            background-color: #007AFF;
+            color: white;
+            border-radius: 12px;
+            padding: 12px 16px;
+            margin-left: 60px;
+            font-size: 14px;
+            line-height: 1.4;
+        }
+    )"},
+    {"QLabel", "chatBubbleBot", CHAT_AREA_CONTEXT, R"(
+        QLabel {
+            background-color: #F2F2F7;
+            color: #1D1D1F;
+            border-radius: 12px;
+            padding: 12px 16px;
+            margin-right: 60px;
+            font-size: 14px;
+            line-height: 1.4;
+        }
+    )"},
+    {"QTextBrowser", "chatBubbleUser", CHAT_AREA_CONTEXT, R"(
+        QTextBrowser {
+            background-color: #007AFF;
+            color: white;
+            border-radius: 12px;
+            padding: 12px 16px;
+            margin-left: 60px;
+            font-size: 14px;
+            line-height: 1.4;
+            border: none;
+        }
+    )"},
+    {"QTextBrowser", "chatBubbleBot", CHAT_AREA_CONTEXT, R"(
+        QTextBrowser {
+            background-color: #F2F2F7;
+            color: #1D1D1F;
+            border-radius: 12px;
+            padding: 12px 16px;
+            margin-right: 60px;
+            font-size: 14px;
+            line-height: 1.4;
+            border: none;
+        }
+    )"},
+};
+
+// 应用级代理样式，由 QApplication 持有
+static QPointer<HospitalStyle> s_hospitalStyle;
 
 UIStyleManager::UIStyleManager(QObject *parent)
     : QObject(parent)
@@ -25,7 +381,197 @@ void UIStyleManager::applyGlobalStyleSheet(QApplication *app)
 {
     setupFonts();
     optimizeForHighDPI(app);
-    app->setStyleSheet(getGlobalStyleSheet());
+    
+    // 代理样式提供主题调色板，样式表在其之上生效
+    s_hospitalStyle = new HospitalStyle;
+    app->setStyle(s_hospitalStyle);
+    
+    QSettings settings("HospAI", "Settings");
+    setTheme(settings.value("general/theme", DEFAULT_THEME).toString());
+}
+
+void UIStyleManager::setTheme(const QString &themeName)
+{
+    QString theme = resolveTheme(themeName);
+    if (theme == s_theme) {
+        return;
+    }
+    
+    StartupProfiler::Scope phase("UIStyleManager::setTheme");
+    QElapsedTimer timer;
+    timer.start();
+    
+    s_theme = theme;
+    colors = schemeForTheme(theme);
+    
+    // 每个主题的样式表只生成一次；控件不再持有各自的样式表，切换时只解析这一份
+    if (!s_styleSheetCache.contains(theme)) {
+        s_styleSheetCache.insert(theme, getGlobalStyleSheet() + getVariantStyleSheet());
+    }
+    
+    if (s_hospitalStyle) {
+        s_hospitalStyle->setColorScheme(colors);
+        QApplication::setPalette(s_hospitalStyle->standardPalette());
+    }
+    qApp->setStyleSheet(s_styleSheetCache.value(theme));
+    
+    qDebug() << "主题已切换为:" << theme << "耗时" << timer.elapsed() << "ms";
+}
+
+QString UIStyleManager::currentTheme()
+{
+    return s_theme;
+}
+
+QString UIStyleManager::resolveTheme(const QString &themeName)
+{
+    if (themeName == "深色主题" || themeName == "护眼主题") {
+        return themeName;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    if (themeName == "跟随系统" && QGuiApplication::styleHints()->colorScheme() == Qt::ColorScheme::Dark) {
+        return "深色主题";
+    }
+#endif
+    return DEFAULT_THEME;
+}
+
+UIStyleManager::ColorScheme UIStyleManager::schemeForTheme(const QString &theme)
+{
+    ColorScheme scheme;
+    
+    if (theme == "深色主题") {
+        scheme.primary = "#0A84FF";
+        scheme.primaryDark = "#0066CC";
+        scheme.secondary = "#8E8E93";
+        scheme.background = "#1E1E1E";
+        scheme.surface = "#2B2B2B";
+        scheme.text = "#F2F2F2";
+        scheme.textSecondary = "#A0A0A0";
+        scheme.success = "#30D158";
+        scheme.warning = "#FFD60A";
+        scheme.error = "#FF453A";
+        scheme.border = "#3F3F46";
+        scheme.shadow = "rgba(0, 0, 0, 0.4)";
+        scheme.hover = "#3A3A3C";
+        scheme.accent = "#64D2FF";
+    } else if (theme == "护眼主题") {
+        scheme.primary = "#5B8C5A";
+        scheme.primaryDark = "#46704A";
+        scheme.secondary = "#7A8B7A";
+        scheme.background = "#F5F5DC";
+        scheme.surface = "#FAFAF0";
+        scheme.text = "#2F4F4F";
+        scheme.textSecondary = "#6B7B6B";
+        scheme.warning = "#D9A400";
+        scheme.error = "#C0392B";
+        scheme.border = "#D3D3C0";
+        scheme.shadow = "rgba(0, 0, 0, 0.08)";
+        scheme.hover = "#EEEEDA";
+        scheme.accent = "#5F9EA0";
+    }
+    
+    return scheme;
+}
+
+void UIStyleManager::setVariant(QWidget *widget, const QString &variant)
+{
+    if (!widget || widget->property(VARIANT_PROPERTY).toString() == variant) {
+        return;
+    }
+    
+    widget->setProperty(VARIANT_PROPERTY, variant);
+    
+    if (s_perWidgetStyleSheets) {
+        // 按类继承链查找登记的原始样式表，例如 QTextBrowser 找不到时再找 QTextEdit
+        const QHash<QString, QString> sheets = s_variantSheets.value(s_theme);
+        for (const QMetaObject *meta = widget->metaObject(); meta; meta = meta->superClass()) {
+            QString key = QString("%1/%2").arg(meta->className(), variant);
+            if (sheets.contains(key)) {
+                widget->setStyleSheet(sheets.value(key));
+                return;
+            }
+        }
+    }
+    
+    // 属性选择器不会自动重新匹配，已polish的控件只重新polish自身
+    if (widget->testAttribute(Qt::WA_WState_Polished)) {
+        widget->style()->unpolish(widget);
+        widget->style()->polish(widget);
+        widget->update();
+    }
+}
+
+void UIStyleManager::setPerWidgetStyleSheets(bool enabled)
+{
+    s_perWidgetStyleSheets = enabled;
+}
+
+QString UIStyleManager::scopeToVariant(const QString &styleSheet, const QString &typeName, const QString &variant,
+                                       const QString &context)
+{
+    // 以控件类型开头的选择器收窄为带变体属性的选择器，例如 QPushButton:hover -> QPushButton[hospVariant="primary"]:hover；
+    // 其他选择器原本作用于该控件的子控件，改写为后代选择器，例如 QToolButton -> QToolBar[hospVariant="x"] QToolButton
+    QString scopedType = QString("%1[%2=\"%3\"]").arg(typeName, VARIANT_PROPERTY, variant);
+    if (!context.isEmpty()) {
+        scopedType = context + " " + scopedType;
+    }
+    
+    QString scoped;
+    const QStringList rules = styleSheet.split('}', Qt::SkipEmptyParts);
+    for (const QString &rule : rules) {
+        int open = rule.indexOf('{');
+        if (open < 0) {
+            continue;
+        }
+        
+        QStringList selectors;
+        for (const QString &rawSelector : rule.left(open).split(',')) {
+            QString selector = rawSelector.trimmed();
+            QChar next = selector.size() > typeName.size() ? selector.at(typeName.size()) : QChar(' ');
+            if (selector.startsWith(typeName) && !next.isLetterOrNumber() && next != '_') {
+                selectors.append(scopedType + selector.mid(typeName.size()));
+            } else {
+                selectors.append(scopedType + " " + selector);
+            }
+        }
+        scoped += selectors.join(", ") + " {" + rule.mid(open + 1) + "}\n";
+    }
+    return scoped;
+}
+
+void UIStyleManager::addVariant(QString &styleSheet, const QString &typeName, const QString &variant,
+                                const QString &rules, const QString &context)
+{
+    styleSheet += scopeToVariant(rules, typeName, variant, context);
+    s_variantSheets[s_theme].insert(QString("%1/%2").arg(typeName, variant), rules);
+}
+
+QString UIStyleManager::getVariantStyleSheet()
+{
+    QString styleSheet;
+    
+    for (const QString &variant : BUTTON_VARIANTS) {
+        addVariant(styleSheet, "QPushButton", variant, getButtonStyleSheet(variant));
+    }
+    addVariant(styleSheet, "QPushButton", "default", getButtonStyleSheet("default"));
+    
+    for (const QString &variant : LABEL_VARIANTS) {
+        addVariant(styleSheet, "QLabel", variant, getLabelStyleSheet(variant));
+    }
+    addVariant(styleSheet, "QLabel", "normal", getLabelStyleSheet("normal"));
+    
+    addVariant(styleSheet, "QFrame", "card", getFrameStyleSheet());
+    addVariant(styleSheet, "QGroupBox", "default", getGroupBoxStyleSheet());
+    addVariant(styleSheet, "QLineEdit", "default", getLineEditStyleSheet());
+    addVariant(styleSheet, "QTextEdit", "default", getTextEditStyleSheet());
+    addVariant(styleSheet, "QScrollArea", "default", getScrollAreaStyleSheet());
+    
+    for (const FixedVariant &fixed : FIXED_VARIANTS) {
+        addVariant(styleSheet, fixed.typeName, fixed.variant, fixed.rules, fixed.context);
+    }
+    
+    return styleSheet;
 }
 
 void UIStyleManager::optimizeForHighDPI(QApplication *app)
@@ -340,9 +886,9 @@ void UIStyleManager::applyButtonStyle(QPushButton *button, const QString &varian
 {
     if (!button) return;
     
-    button->setStyleSheet(getButtonStyleSheet(variant));
+    // 手型光标由 HospitalStyle 在 polish 时设置
+    setVariant(button, BUTTON_VARIANTS.contains(variant) ? variant : QString("default"));
     button->setMinimumHeight(36);
-    button->setCursor(Qt::PointingHandCursor);
 }
 
 QString UIStyleManager::getButtonStyleSheet(const QString &variant)
@@ -452,7 +998,7 @@ void UIStyleManager::applyLabelStyle(QLabel *label, const QString &variant)
 {
     if (!label) return;
     
-    label->setStyleSheet(getLabelStyleSheet(variant));
+    setVariant(label, LABEL_VARIANTS.contains(variant) ? variant : QString("normal"));
 }
 
 QString UIStyleManager::getLabelStyleSheet(const QString &variant)
@@ -529,7 +1075,7 @@ void UIStyleManager::applyFrameStyle(QFrame *frame, bool withShadow)
 {
     if (!frame) return;
     
-    frame->setStyleSheet(getFrameStyleSheet());
+    setVariant(frame, "card");
     frame->setFrameStyle(QFrame::Box | QFrame::Plain);
     frame->setLineWidth(0);
     
@@ -555,7 +1101,7 @@ void UIStyleManager::applyGroupBoxStyle(QGroupBox *groupBox)
 {
     if (!groupBox) return;
     
-    groupBox->setStyleSheet(getGroupBoxStyleSheet());
+    setVariant(groupBox, "default");
 }
 
 QString UIStyleManager::getGroupBoxStyleSheet()
@@ -585,7 +1131,7 @@ void UIStyleManager::applyLineEditStyle(QLineEdit *lineEdit)
 {
     if (!lineEdit) return;
     
-    lineEdit->setStyleSheet(getLineEditStyleSheet());
+    setVariant(lineEdit, "default");
 }
 
 QString UIStyleManager::getLineEditStyleSheet()
@@ -616,7 +1162,7 @@ void UIStyleManager::applyTextEditStyle(QTextEdit *textEdit)
 {
     if (!textEdit) return;
     
-    textEdit->setStyleSheet(getTextEditStyleSheet());
+    setVariant(textEdit, "default");
 }
 
 QString UIStyleManager::getTextEditStyleSheet()
@@ -642,7 +1188,7 @@ void UIStyleManager::applyScrollAreaStyle(QScrollArea *scrollArea)
 {
     if (!scrollArea) return;
     
-    scrollArea->setStyleSheet(getScrollAreaStyleSheet());
+    setVariant(scrollArea, "default");
 }
 
 QString UIStyleManager::getScrollAreaStyleSheet()
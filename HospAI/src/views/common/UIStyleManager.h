@@ -14,6 +14,7 @@
 #include <QScrollArea>
 #include <QApplication>
 #include <QScreen>
+#include <QHash>
 
 class UIStyleManager : public QObject
 {
@@ -23,9 +24,23 @@ public:
     explicit UIStyleManager(QObject *parent = nullptr);
     ~UIStyleManager();
 
-    // 应用全局样式表
+    // 应用全局样式表：样式表文本按主题生成一次，控件变体通过动态属性选择器匹配
     static void applyGlobalStyleSheet(QApplication *app);
     
+    // 切换主题（浅色主题/深色主题/护眼主题/跟随系统），主题未变化时不做任何事
+    static void setTheme(const QString &themeName);
+    static QString currentTheme();
+    
+    // 控件样式变体对应的动态属性名
+    static const char *VARIANT_PROPERTY;
+    
+    // 设置控件的样式变体，已polish的控件只重新polish自身。
+    // 除 apply*Style 的通用变体外，聊天页（chat*）和角色窗口（roleWindow）的固定样式也按变体登记
+    static void setVariant(QWidget *widget, const QString &variant);
+    
+    // 基准测试用：变体同时以控件自身样式表的形式设置，即原先逐个 setStyleSheet 的做法
+    static void setPerWidgetStyleSheets(bool enabled);
+    
     // 跨平台DPI优化
     static void optimizeForHighDPI(QApplication *app);
     
@@ -68,8 +83,18 @@ public:
     static void setupFonts();
 
 private:
+    static QString resolveTheme(const QString &themeName);
+    static ColorScheme schemeForTheme(const QString &theme);
+    // 把控件自身的样式表改写为应用级规则：每个选择器限定到带变体属性的控件及其子控件，
+    // context 为所在的祖先选择器（用于压过上下文中的后代规则）
+    static QString scopeToVariant(const QString &styleSheet, const QString &typeName, const QString &variant,
+                                  const QString &context = QString());
+    static void addVariant(QString &styleSheet, const QString &typeName, const QString &variant,
+                           const QString &rules, const QString &context = QString());
+    
     // 获取样式表字符串
     static QString getGlobalStyleSheet();
+    static QString getVariantStyleSheet();
     static QString getButtonStyleSheet(const QString &variant);
     static QString getLabelStyleSheet(const QString &variant);
     static QString getFrameStyleSheet();
@@ -77,6 +102,12 @@ private:
     static QString getLineEditStyleSheet();
     static QString getTextEditStyleSheet();
     static QString getScrollAreaStyleSheet();
+    
+    static QString s_theme;
+    static QHash<QString, QString> s_styleSheetCache;
+    // 主题 -> "类型/变体" -> 未限定的原始样式表，仅在逐控件模式下使用
+    static QHash<QString, QHash<QString, QString>> s_variantSheets;
+    static bool s_perWidgetStyleSheets;
 };
 
 #endif // UISTYLEMANAGER_H 
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "UpdateScheduler.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QtMath>
+
+UpdateScheduler* UpdateScheduler::m_instance = nullptr;
+
+UpdateScheduler* UpdateScheduler::instance()
+{
+    if (!m_instance) {
+        m_instance = new UpdateScheduler;
+    }
+    return m_instance;
+}
+
+UpdateScheduler::UpdateScheduler(QObject *parent)
+    : QObject(parent)
+    , m_frameInterval(16)
+    , m_coalescedCount(0)
+    , m_flushCount(0)
+{
+    // 帧间隔按主屏刷新率计算，取不到时按60Hz
+    QScreen* screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 1.0) {
+        m_frameInterval = qMax(1, qFloor(1000.0 / screen->refreshRate()));
+    }
+
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &UpdateScheduler::flushFrame);
+}
+
+void UpdateScheduler::schedule(QObject* owner, int kind, const std::function<void()>& task)
+{
+    for (PendingUpdate& update : m_pending) {
+        if (update.owner == owner && update.kind == kind) {
+            update.task = task;
+            ++m_coalescedCount;
+            return;
+        }
+    }
+
+    PendingUpdate update;
+    update.owner = owner;
+    update.kind = kind;
+    update.task = task;
+    m_pending.append(update);
+
+    if (!m_frameTimer.isActive()) {
+        // 距上次刷新不足一帧时等到下一帧
+        int elapsed = m_sinceLastFlush.isValid() ? int(m_sinceLastFlush.elapsed()) : m_frameInterval;
+        m_frameTimer.start(qMax(0, m_frameInterval - elapsed));
+    }
+}
+
+void UpdateScheduler::flush(QObject* owner)
+{
+    QList<PendingUpdate> updates;
+    for (int i = m_pending.size() - 1; i >= 0; --i) {
+        if (m_pending.at(i).owner == owner) {
+            updates.prepend(m_pending.takeAt(i));
+        }
+    }
+    runUpdates(updates);
+}
+
+void UpdateScheduler::flushFrame()
+{
+    // 执行期间提交的新更新留到下一帧
+    QList<PendingUpdate> updates;
+    updates.swap(m_pending);
+    m_sinceLastFlush.start();
+    ++m_flushCount;
+    runUpdates(updates);
+}
+
+void UpdateScheduler::runUpdates(const QList<PendingUpdate>& updates)
+{
+    for (const PendingUpdate& update : updates) {
+        // 提交者已销毁时丢弃
+        if (update.owner) {
+            update.task();
+        }
+    }
+}
+
+quint64 UpdateScheduler::coalescedCount() const
+{
+    return m_coalescedCount;
+}
+
+quint64 UpdateScheduler::flushCount() const
+{
+    return m_flushCount;
+}
@@ -0,0 +1,58 @@
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+
+// 界面更新调度：把消息插入、滚动到底部、角标刷新等更新合并到下一帧统一执行，
+// 每帧最多刷新一次；同一对象同一类更新在一帧内重复提交只执行一次
+class UpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum UpdateKind {
+        TranscriptInsert,
+        ScrollToBottom,
+        SessionBadges,
+        StreamingText
+    };
+
+    static UpdateScheduler* instance();
+
+    // 按首次提交的顺序执行；重复提交替换任务内容并计入合并次数
+    void schedule(QObject* owner, int kind, const std::function<void()>& task);
+    // 立即执行该对象所有待处理的更新
+    void flush(QObject* owner);
+
+    // 被合并掉的提交次数与实际刷新次数
+    quint64 coalescedCount() const;
+    quint64 flushCount() const;
+
+private:
+    explicit UpdateScheduler(QObject *parent = nullptr);
+
+    struct PendingUpdate {
+        QPointer<QObject> owner;
+        int kind;
+        std::function<void()> task;
+    };
+
+    void flushFrame();
+    static void runUpdates(const QList<PendingUpdate>& updates);
+
+    static UpdateScheduler* m_instance;
+
+    QList<PendingUpdate> m_pending;
+    QTimer m_frameTimer;
+    QElapsedTimer m_sinceLastFlush;
+    int m_frameInterval;
+    quint64 m_coalescedCount;
+    quint64 m_flushCount;
+};
+
+#endif // UPDATESCHEDULER_H
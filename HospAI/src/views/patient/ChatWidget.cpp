@@ -1,4 +1,8 @@
 #include "ChatWidget.h"
+#include "../../core/ResponseFormatter.h"
+#include "../../core/AIModelRouter.h"
+#include "../common/UpdateScheduler.h"
+#include "../common/UIStyleManager.h"
 #include <QGroupBox>
 #include <QScrollBar>
 #include <QApplication>
@@ -20,6 +24,9 @@
 #include <QTextImageFormat>
 #include <QRandomGenerator>
 
+// 转人工时交给客服的上下文预算，比发给AI的宽松
+static const int TRANSFER_CONTEXT_TOKENS = 1500;
+
 ChatWidget::ChatWidget(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
@@ -53,6 +60,8 @@ ChatWidget::ChatWidget(QWidget *parent)
     , m_messageCount(0)
     , m_dbManager(nullptr)
     , m_aiApiClient(new AIApiClient(this))
+    , m_streamingRequestId(0)
+    , m_aiWarmedUp(false)
 {
     initDatabase();
     setupUI();
@@ -61,24 +70,17 @@ ChatWidget::ChatWidget(QWidget *parent)
     m_currentSessionId = generateSessionId();
     m_isInitialized = true;
     
-    // 连接AI API客户端信号
-    connect(m_aiApiClient, &AIApiClient::triageResponseReceived,
-            this, &ChatWidget::onAITriageResponse);
-    connect(m_aiApiClient, &AIApiClient::apiError,
-            this, &ChatWidget::onAIApiError);
-    connect(m_aiApiClient, &AIApiClient::requestStarted, [this]() {
-        m_isAITyping = true;
-        m_statusLabel->setText("智能分诊助手正在分析中...");
-        m_btnSend->setEnabled(false);
-    });
-    connect(m_aiApiClient, &AIApiClient::requestFinished, [this]() {
-        m_isAITyping = false;
-        m_statusLabel->setText("智能分诊助手");
-        m_btnSend->setEnabled(true);
+    // 流式分诊：回复逐段追加到同一个气泡
+    connect(m_aiApiClient, &AIApiClient::partialTextReceived, this, &ChatWidget::onAIPartialText);
+    connect(m_aiApiClient, &AIApiClient::firstTokenReceived, this, [this](quint64 requestId, qint64 elapsedMs) {
+        if (requestId == m_streamingRequestId) {
+            m_statusLabel->setText("智能分诊助手正在回复...");
+            qDebug() << "分诊首字延迟:" << elapsedMs << "ms";
+        }
     });
     
-    // 发送欢迎消息
-    QTimer::singleShot(500, [this]() {
+    // 发送欢迎消息（窗口先于定时器销毁时不再触发）
+    QTimer::singleShot(500, this, [this]() {
         AIMessage welcomeMsg;
         welcomeMsg.content = "👋 您好！我是AI智能导诊助手，可以帮助您：\n\n"
                             "🏥 科室推荐和医生介绍\n"
@@ -101,6 +103,17 @@ ChatWidget::~ChatWidget()
     }
 }
 
+void ChatWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    
+    // 患者看到分诊页时先和AI服务完成握手，首个提问不再等待建连
+    if (!m_aiWarmedUp) {
+        m_aiWarmedUp = true;
+        m_aiApiClient->warmUp();
+    }
+}
+
 void ChatWidget::setDatabaseManager(DatabaseManager* dbManager)
 {
     m_dbManager = dbManager;
@@ -126,11 +139,7 @@ void ChatWidget::setupUI()
     setupInputArea();
     
     // 应用整体样式
-    setStyleSheet(R"(
-        ChatWidget {
-            background-color: #F8F9FA;
-        }
-    )");
+    UIStyleManager::setVariant(this, "chat");
 }
 
 void ChatWidget::setupToolBar()
@@ -147,38 +156,12 @@ void ChatWidget::setupToolBar()
     m_statusLabel = new QLabel("AI智能导诊");
     m_statusLabel->setAlignment(Qt::AlignCenter);
     
-    QString buttonStyle = R"(
-        QPushButton {
-            background-color: white;
-            border: 1px solid #D1D1D6;
-            border-radius: 6px;
-            padding: 8px 16px;
-            font-size: 13px;
-            color: #1D1D1F;
-        }
-        QPushButton:hover {
-            background-color: #F2F2F7;
-            border-color: #007AFF;
-        }
-        QPushButton:checked {
-            background-color: #007AFF;
-            color: white;
-        }
-    )";
-    
-    m_btnClearChat->setStyleSheet(buttonStyle);
-    m_btnSaveChat->setStyleSheet(buttonStyle);
-    m_btnSettings->setStyleSheet(buttonStyle);
-    m_btnToggleRichMode->setStyleSheet(buttonStyle);
-    
-    m_statusLabel->setStyleSheet(R"(
-        QLabel {
-            font-size: 16px;
-            font-weight: bold;
-            color: #1D1D1F;
-            padding: 8px;
-        }
-    )");
+    UIStyleManager::setVariant(m_btnClearChat, "chatTool");
+    UIStyleManager::setVariant(m_btnSaveChat, "chatTool");
+    UIStyleManager::setVariant(m_btnSettings, "chatTool");
+    UIStyleManager::setVariant(m_btnToggleRichMode, "chatTool");
+    
+    UIStyleManager::setVariant(m_statusLabel, "chatStatus");
     
     connect(m_btnClearChat, &QPushButton::clicked, this, &ChatWidget::onClearChatClicked);
     connect(m_btnSaveChat, &QPushButton::clicked, this, &ChatWidget::onSaveChatClicked);
@@ -267,37 +250,7 @@ void ChatWidget::setupRichTextToolbar()
     m_richTextToolbar->insertSeparator(m_actionBold);
     
     // 设置工具栏样式
-    m_richTextToolbar->setStyleSheet(R"(
-        QToolBar {
-            background-color: #F2F2F7;
-            border: 1px solid #D1D1D6;
-            border-radius: 8px;
-            padding: 5px;
-            spacing: 5px;
-        }
-        QToolButton {
-            background-color: white;
-            border: 1px solid #D1D1D6;
-            border-radius: 4px;
-            padding: 4px 8px;
-            font-weight: bold;
-            min-width: 24px;
-            min-height: 24px;
-        }
-        QToolButton:hover {
-            background-color: #E5E5EA;
-        }
-        QToolButton:checked {
-            background-color: #007AFF;
-            color: white;
-        }
-        QFontComboBox, QSpinBox {
-            border: 1px solid #D1D1D6;
-            border-radius: 4px;
-            padding: 2px 4px;
-            background-color: white;
-        }
-    )");
+    UIStyleManager::setVariant(m_richTextToolbar, "chatRichToolbar");
     
     m_richTextToolbar->hide(); // 初始隐藏，只在富文本模式下显示
     m_mainLayout->addWidget(m_richTextToolbar);
@@ -320,29 +273,7 @@ void ChatWidget::setupChatArea()
     m_chatScrollArea->setWidget(m_chatContainer);
     m_chatScrollArea->setMinimumHeight(400);
     
-    m_chatScrollArea->setStyleSheet(R"(
-        QScrollArea {
-            background-color: white;
-            border: 1px solid #E5E5EA;
-            border-radius: 12px;
-        }
-        QScrollArea QWidget {
-            background-color: white;
-        }
-        QScrollBar:vertical {
-            background-color: #F2F2F7;
-            width: 8px;
-            border-radius: 4px;
-        }
-        QScrollBar::handle:vertical {
-            background-color: #C7C7CC;
-            border-radius: 4px;
-            min-height: 20px;
-        }
-        QScrollBar::handle:vertical:hover {
-            background-color: #A8A8AF;
-        }
-    )");
+    UIStyleManager::setVariant(m_chatScrollArea, "chatArea");
     
     m_mainLayout->addWidget(m_chatScrollArea);
 }
@@ -351,22 +282,7 @@ void ChatWidget::setupQuickButtonsArea()
 {
     // 快捷按钮区域
     m_quickButtonsGroup = new QGroupBox("快捷咨询");
-    m_quickButtonsGroup->setStyleSheet(R"(
-        QGroupBox {
-            font-weight: bold;
-            font-size: 14px;
-            color: #1D1D1F;
-            border: 1px solid #E5E5EA;
-            border-radius: 8px;
-            margin-top: 8px;
-            padding-top: 8px;
-        }
-        QGroupBox::title {
-            subcontrol-origin: margin;
-            left: 10px;
-            padding: 0 8px 0 8px;
-        }
-    )");
+    UIStyleManager::setVariant(m_quickButtonsGroup, "chatQuickGroup");
     
     m_quickButtonsLayout = new QGridLayout(m_quickButtonsGroup);
     m_quickButtonsLayout->setSpacing(8);
@@ -413,56 +329,11 @@ void ChatWidget::setupInputArea()
     m_btnVoice->setFixedSize(36, 36);
     m_btnEmoji->setFixedSize(36, 36);
     
-    QString inputStyle = R"(
-        QTextEdit {
-            border: 1px solid #D1D1D6;
-            border-radius: 8px;
-            padding: 8px 12px;
-            font-size: 14px;
-            background-color: white;
-        }
-        QTextEdit:focus {
-            border-color: #007AFF;
-        }
-    )";
-    
-    QString sendButtonStyle = R"(
-        QPushButton {
-            background-color: #007AFF;
-            color: white;
-            border: none;
-            border-radius: 8px;
-            font-size: 14px;
-            font-weight: bold;
-        }
-        QPushButton:hover {
-            background-color: #0056CC;
-        }
-        QPushButton:pressed {
-            background-color: #004499;
-        }
-        QPushButton:disabled {
-            background-color: #C7C7CC;
-        }
-    )";
-    
-    QString iconButtonStyle = R"(
-        QPushButton {
-            background-color: #F2F2F7;
-            border: 1px solid #D1D1D6;
-            border-radius: 8px;
-            font-size: 16px;
-        }
-        QPushButton:hover {
-            background-color: #E5E5EA;
-        }
-    )";
-    
-    m_messageInput->setStyleSheet(inputStyle);
-    m_richMessageInput->setStyleSheet(inputStyle);
-    m_btnSend->setStyleSheet(sendButtonStyle);
-    m_btnVoice->setStyleSheet(iconButtonStyle);
-    m_btnEmoji->setStyleSheet(iconButtonStyle);
+    UIStyleManager::setVariant(m_messageInput, "chatInput");
+    UIStyleManager::setVariant(m_richMessageInput, "chatInput");
+    UIStyleManager::setVariant(m_btnSend, "chatSend");
+    UIStyleManager::setVariant(m_btnVoice, "chatIcon");
+    UIStyleManager::setVariant(m_btnEmoji, "chatIcon");
     
     connect(m_messageInput, &QTextEdit::textChanged, this, &ChatWidget::onInputTextChanged);
     connect(m_richMessageInput, &QTextEdit::textChanged, this, &ChatWidget::onInputTextChanged);
@@ -532,24 +403,7 @@ void ChatWidget::setupQuickButtons()
 void ChatWidget::addQuickButton(const QString& text, const QString& responseTemplate)
 {
     QPushButton* button = new QPushButton(text);
-    button->setStyleSheet(R"(
-        QPushButton {
-            background-color: white;
-            border: 1px solid #D1D1D6;
-            border-radius: 8px;
-            padding: 10px 15px;
-            font-size: 13px;
-            color: #1D1D1F;
-            text-align: left;
-        }
-        QPushButton:hover {
-            background-color: #F2F8FF;
-            border-color: #007AFF;
-        }
-        QPushButton:pressed {
-            background-color: #E3F2FD;
-        }
-    )");
+    UIStyleManager::setVariant(button, "chatQuick");
     
     button->setProperty("responseTemplate", responseTemplate);
     m_quickButtonGroup->addButton(button);
@@ -596,15 +450,8 @@ void ChatWidget::onTransferToHuman()
     systemMsg.sessionId = m_currentSessionId;
     addMessage(systemMsg);
     
-    // 发出转人工信号，包含当前对话上下文
-    QString context = "";
-    for (const AIMessage& msg : m_chatHistory) {
-        if (msg.type == MessageType::User) {
-            context += "患者：" + msg.content + "\n";
-        } else if (msg.type == MessageType::Robot) {
-            context += "AI助手：" + msg.content + "\n";
-        }
-    }
+    // 发出转人工信号，包含要点摘要和最近的对话
+    QString context = m_contextBuilder.build(TRANSFER_CONTEXT_TOKENS, 0);
     
     qDebug() << "发射转人工信号，上下文长度:" << context.length();
     emit requestHumanService(m_userId, m_userName, context);
@@ -622,40 +469,13 @@ void ChatWidget::addTransferOption()
     transferLayout->setSpacing(10);
     
     QLabel* infoLabel = new QLabel("已为您转接人工客服服务：");
-    infoLabel->setStyleSheet(R"(
-        QLabel {
-            font-size: 14px;
-            color: #1D1D1F;
-            font-weight: bold;
-            padding: 5px;
-        }
-    )");
+    UIStyleManager::setVariant(infoLabel, "chatNoticeTitle");
     
     QLabel* detailLabel = new QLabel("• 请切换到\"客服咨询\"选项卡继续对话\n• 您的对话记录已同步给客服\n• 如需重新使用AI分诊，请点击下方按钮");
-    detailLabel->setStyleSheet(R"(
-        QLabel {
-            font-size: 13px;
-            color: #666666;
-            padding: 5px 10px;
-            line-height: 1.4;
-        }
-    )");
+    UIStyleManager::setVariant(detailLabel, "chatNoticeDetail");
     
     QPushButton* backToAIButton = new QPushButton("🤖 返回AI分诊");
-    backToAIButton->setStyleSheet(R"(
-        QPushButton {
-            background-color: #34C759;
-            color: white;
-            border: none;
-            border-radius: 8px;
-            padding: 10px 20px;
-            font-size: 14px;
-            font-weight: bold;
-        }
-        QPushButton:hover {
-            background-color: #30A855;
-        }
-    )");
+    UIStyleManager::setVariant(backToAIButton, "chatAction");
     
     connect(backToAIButton, &QPushButton::clicked, [this]() {
         clearInteractionComponents();
@@ -694,28 +514,92 @@ void ChatWidget::onSendMessage()
     m_messageInput->clear();
     m_currentContext = text;
     
-    // 检查是否直接触发转人工关键词
-    QString lowerText = text.toLower();
-    if (lowerText.contains("转人工") || lowerText.contains("换人工") || lowerText.contains("要人工") || 
-        lowerText.contains("人工客服") || lowerText.contains("真人客服") || lowerText.contains("联系客服")) {
+    // 词典一次扫描：转人工直接处理，明确的症状本地回复，只有含糊的描述才请求AI
+    AIModelRouter::ChatStep step = AIModelRouter::classifyChatInput(text);
+    if (step.action == AIModelRouter::TransferChat) {
         QTimer::singleShot(500, this, &ChatWidget::onTransferToHuman);
         return;
     }
+    if (step.action == AIModelRouter::AnswerLocally) {
+        QElapsedTimer localTimer;
+        localTimer.start();
+        answerLocally(step.match);
+        // 本地回答同样计入模型路由记录，便于与AI档位对比
+        AIModelRouter::instance()->recordLocalAnswer(text, step.match, localTimer.elapsed());
+        return;
+    }
     
-    // 构建对话历史
-    QString conversationHistory;
-    int recentMsgCount = qMin(5, m_chatHistory.size()); // 只取最近5条消息作为上下文
-    for (int i = m_chatHistory.size() - recentMsgCount; i < m_chatHistory.size(); i++) {
-        const AIMessage& msg = m_chatHistory[i];
-        if (msg.type == MessageType::User) {
-            conversationHistory += "患者：" + msg.content + "\n";
-        } else if (msg.type == MessageType::Robot) {
-            conversationHistory += "AI助手：" + msg.content + "\n";
-        }
+    // 在token预算内构建对话历史，当前提问单独放进提示词
+    QString conversationHistory = m_contextBuilder.build(1);
+    qDebug() << "分诊上下文约" << m_contextBuilder.lastBuildTokens() << "tokens，共"
+             << m_contextBuilder.turnCount() << "轮";
+    
+    // 使用真实的AI API进行分诊，结果只回调给本窗口
+    m_isAITyping = true;
+    m_statusLabel->setText("智能分诊助手正在分析中...");
+    m_btnSend->setEnabled(false);
+    
+    AIApiClient::RequestOptions options;
+    options.cancelToken = m_aiCancelToken;
+    options.stream = true;
+    // 患者在等，首token迟迟不到时再发一份；熔断时请求直接失败，由 onAIApiError 给出本地分诊建议
+    options.hedge = true;
+    m_streamingText.clear();
+    m_streamingRequestId = m_aiApiClient->sendTriageRequest(text, conversationHistory, this,
+        [this](const AIApiClient::Response& response) {
+            m_streamingRequestId = 0;
+            m_isAITyping = false;
+            m_statusLabel->setText("智能分诊助手");
+            m_btnSend->setEnabled(!m_messageInput->toPlainText().trimmed().isEmpty());
+            
+            qDebug() << "分诊请求完成 - 首字" << response.firstTokenMs << "ms, 总耗时" << response.latencyMs << "ms";
+            
+            if (response.success) {
+                onAITriageResponse(response.result);
+            } else {
+                discardStreamingBubble();
+                if (!response.cancelled) {
+                    onAIApiError(response.error);
+                }
+            }
+        }, options);
+}
+
+void ChatWidget::onAIPartialText(quint64 requestId, const QString& delta)
+{
+    if (requestId != m_streamingRequestId) {
+        return;
     }
     
-    // 使用真实的AI API进行分诊
-    m_aiApiClient->sendTriageRequest(text, conversationHistory);
+    m_streamingText += delta;
+    if (!m_streamingBubble) {
+        AIMessage aiMsg;
+        aiMsg.content = m_streamingText;
+        aiMsg.type = MessageType::Robot;
+        aiMsg.timestamp = QDateTime::currentDateTime();
+        aiMsg.sessionId = m_currentSessionId;
+        m_streamingBubble = displayMessage(aiMsg);
+        return;
+    }
+    
+    // 同一帧内到达的多段文本只重排一次
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::StreamingText, [this]() {
+        if (m_streamingBubble) {
+            m_streamingBubble->setText(m_streamingText);
+        }
+    });
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::ScrollToBottom, [this]() {
+        scrollToBottom();
+    });
+}
+
+void ChatWidget::discardStreamingBubble()
+{
+    if (m_streamingBubble) {
+        m_streamingBubble->parentWidget()->deleteLater();
+    }
+    m_streamingBubble = nullptr;
+    m_streamingText.clear();
 }
 
 void ChatWidget::onAIResponseReady()
@@ -744,48 +628,17 @@ void ChatWidget::onAIResponseReady()
 
 QString ChatWidget::generateAIResponse(const QString& userInput)
 {
-    // AI分诊逻辑
-    QString input = userInput.toLower();
-    
-    // 检查紧急情况
-    QStringList emergencyKeywords = {"胸痛", "呼吸困难", "昏迷", "大出血", "中毒", "外伤"};
-    for (const QString& keyword : emergencyKeywords) {
-        if (input.contains(keyword)) {
-            return "⚠️ 根据您描述的症状，建议您立即前往急诊科就诊！\n\n这种情况可能比较紧急，请不要延误。\n\n急诊科位置：医院1楼\n急诊电话：120";
+    // 本地分诊：按词典匹配结果选择回复
+    SymptomMatcher::MatchResult match = SymptomMatcher::instance()->match(userInput);
+    if (match.hasMatch()) {
+        const SymptomMatcher::Category& category = SymptomMatcher::instance()->category(match.bestCategory);
+        if (category.action == "transfer") {
+            // 直接触发转人工
+            QTimer::singleShot(500, this, &ChatWidget::onTransferToHuman);
+        }
+        if (!category.response.isEmpty()) {
+            return category.response;
         }
-    }
-    
-    // 发热相关
-    if (input.contains("发烧") || input.contains("发热") || input.contains("体温")) {
-        return "根据您的发热症状，我需要了解更多信息：\n\n• 体温多少度？\n• 持续多长时间了？\n• 是否伴随其他症状？\n\n一般情况下：\n🌡️ 38.5°C以下：建议物理降温\n🌡️ 38.5°C以上：建议内科就诊\n🚨 持续高热：建议急诊科\n\n如需更详细的诊断，建议点击下方转人工客服。";
-    }
-    
-    // 头痛相关
-    if (input.contains("头疼") || input.contains("头痛") || input.contains("头晕")) {
-        return "关于头痛症状，我来帮您分析：\n\n请问：\n• 疼痛程度如何？\n• 是否伴随恶心呕吐？\n• 最近有没有外伤？\n\n建议科室：\n🧠 神经内科：偏头痛、神经性头痛\n👁️ 眼科：视力相关头痛\n🏥 内科：感冒引起的头痛\n\n如需专业医生诊断，可转接人工客服。";
-    }
-    
-    // 咳嗽相关
-    if (input.contains("咳嗽") || input.contains("咳痰")) {
-        return "咳嗽症状分析：\n\n请描述：\n• 干咳还是有痰？\n• 持续时间？\n• 是否伴随发热？\n\n推荐科室：\n🫁 呼吸内科：持续咳嗽、咳痰\n👶 儿科：小儿咳嗽\n🏥 内科：一般性咳嗽\n\n需要详细诊断建议转人工客服。";
-    }
-    
-    // 转人工相关 - 直接触发转人工
-    if (input.contains("转人工") || input.contains("换人工") || input.contains("要人工") || 
-        input.contains("人工客服") || input.contains("真人客服") || input.contains("联系客服")) {
-        // 直接触发转人工
-        QTimer::singleShot(500, this, &ChatWidget::onTransferToHuman);
-        return "好的，正在为您转接人工客服，请稍候...";
-    }
-    
-    // 一般人工咨询提示
-    if (input.contains("人工") || input.contains("客服") || input.contains("医生")) {
-        return "我可以为您转接人工客服：\n\n🏥 人工客服可以提供：\n• 专业医疗咨询\n• 详细症状分析\n• 预约挂号协助\n• 医院相关服务\n\n💬 输入\"转人工\"可直接转接\n📱 或点击下方\"转人工客服\"按钮";
-    }
-    
-    // 预约相关
-    if (input.contains("预约") || input.contains("挂号")) {
-        return "关于预约挂号：\n\n📱 预约方式：\n• 微信公众号预约\n• 手机APP预约\n• 现场挂号\n• 电话预约：400-123-4567\n\n⏰ 预约时间：\n• 普通门诊：提前3天\n• 专家门诊：提前7天\n\n需要预约协助？建议转接人工客服。";
     }
     
     // 默认响应
@@ -795,8 +648,18 @@ QString ChatWidget::generateAIResponse(const QString& userInput)
 // 实现其他必要的方法
 void ChatWidget::addMessage(const AIMessage& message)
 {
-    m_chatHistory.append(message);
     displayMessage(message);
+    appendToHistory(message);
+}
+
+void ChatWidget::appendToHistory(const AIMessage& message)
+{
+    m_chatHistory.append(message);
+    if (message.type == MessageType::User) {
+        m_contextBuilder.addTurn(ConversationContextBuilder::Patient, message.content);
+    } else if (message.type == MessageType::Robot) {
+        m_contextBuilder.addTurn(ConversationContextBuilder::Assistant, message.content);
+    }
     m_messageCount++;
     
     // 自动保存每10条消息
@@ -805,7 +668,7 @@ void ChatWidget::addMessage(const AIMessage& message)
     }
 }
 
-void ChatWidget::displayMessage(const AIMessage& message)
+QLabel* ChatWidget::displayMessage(const AIMessage& message)
 {
     QWidget* messageWidget = new QWidget;
     QHBoxLayout* messageLayout = new QHBoxLayout(messageWidget);
@@ -820,22 +683,11 @@ void ChatWidget::displayMessage(const AIMessage& message)
     
     // 时间戳
     QLabel* timeLabel = new QLabel(formatTimestamp(message.timestamp));
-    timeLabel->setStyleSheet("color: #8E8E93; font-size: 11px;");
+    UIStyleManager::setVariant(timeLabel, "chatTime");
     
-    QString bubbleStyle;
     if (message.type == MessageType::User) {
         // 用户消息 - 右对齐，蓝色
-        bubbleStyle = R"(
-            QLabel {
-                background-color: #007AFF;
-                color: white;
-                border-radius: 12px;
-                padding: 12px 16px;
-                margin-left: 60px;
-                font-size: 14px;
-                line-height: 1.4;
-            }
-        )";
+        UIStyleManager::setVariant(bubbleLabel, "chatBubbleUser");
         messageLayout->addStretch();
         
         QVBoxLayout* rightLayout = new QVBoxLayout;
@@ -847,29 +699,13 @@ void ChatWidget::displayMessage(const AIMessage& message)
         
     } else {
         // 机器人消息 - 左对齐，灰色
-        bubbleStyle = R"(
-            QLabel {
-                background-color: #F2F2F7;
-                color: #1D1D1F;
-                border-radius: 12px;
-                padding: 12px 16px;
-                margin-right: 60px;
-                font-size: 14px;
-                line-height: 1.4;
-            }
-        )";
+        UIStyleManager::setVariant(bubbleLabel, "chatBubbleBot");
         
         // 添加机器人头像
         QLabel* avatarLabel = new QLabel("🤖");
         avatarLabel->setFixedSize(32, 32);
         avatarLabel->setAlignment(Qt::AlignCenter);
-        avatarLabel->setStyleSheet(R"(
-            QLabel {
-                background-color: #34C759;
-                border-radius: 16px;
-                font-size: 16px;
-            }
-        )");
+        UIStyleManager::setVariant(avatarLabel, "chatAvatar");
         
         QVBoxLayout* leftLayout = new QVBoxLayout;
         leftLayout->addWidget(bubbleLabel);
@@ -881,15 +717,17 @@ void ChatWidget::displayMessage(const AIMessage& message)
         messageLayout->addStretch();
     }
     
-    bubbleLabel->setStyleSheet(bubbleStyle);
-    
     // 移除最后的弹性空间，添加新消息，再添加弹性空间
     m_chatLayout->removeItem(m_chatLayout->itemAt(m_chatLayout->count() - 1));
     m_chatLayout->addWidget(messageWidget);
     m_chatLayout->addStretch();
     
-    // 滚动到底部
-    QTimer::singleShot(100, this, &ChatWidget::scrollToBottom);
+    // 滚动到底部，同一帧内的多条消息只滚动一次
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::ScrollToBottom, [this]() {
+        scrollToBottom();
+    });
+    
+    return bubbleLabel;
 }
 
 void ChatWidget::scrollToBottom()
@@ -899,31 +737,49 @@ void ChatWidget::scrollToBottom()
 }
 
 TriageAdvice ChatWidget::analyzeSymptoms(const QString& userInput)
+{
+    return adviceFromMatch(SymptomMatcher::instance()->match(userInput));
+}
+
+TriageAdvice ChatWidget::adviceFromMatch(const SymptomMatcher::MatchResult& match)
 {
     TriageAdvice advice;
-    QString input = userInput.toLower();
-    
-    // 简单的症状分析逻辑
-    if (input.contains("发烧") || input.contains("发热")) {
-        advice.department = "内科";
-        advice.reason = "发热症状通常需要内科医生评估";
-        advice.needAppointment = true;
-        advice.needEmergency = input.contains("高烧") || input.contains("39");
-    }
-    else if (input.contains("咳嗽") || input.contains("呼吸")) {
-        advice.department = "呼吸内科";
-        advice.reason = "呼吸道症状建议看呼吸内科";
-        advice.needAppointment = true;
-    }
-    else if (input.contains("头痛") || input.contains("头晕")) {
-        advice.department = "神经内科";
-        advice.reason = "头部不适建议神经内科检查";
-        advice.needAppointment = true;
+    advice.needAppointment = false;
+    advice.needEmergency = false;
+    
+    if (!match.hasMatch()) {
+        return advice;
     }
     
+    const SymptomMatcher::Category& category = SymptomMatcher::instance()->category(match.bestCategory);
+    advice.department = category.department;
+    advice.reason = category.reason;
+    advice.needAppointment = !category.department.isEmpty();
+    advice.needEmergency = category.emergency || match.urgent;
+    
     return advice;
 }
 
+void ChatWidget::answerLocally(const SymptomMatcher::MatchResult& match)
+{
+    const SymptomMatcher::Category& category = SymptomMatcher::instance()->category(match.bestCategory);
+    qDebug() << "本地分诊命中:" << category.id << "得分" << match.bestScore << "次高" << match.runnerUpScore;
+    
+    AIMessage aiMsg;
+    aiMsg.content = category.response;
+    aiMsg.type = MessageType::Robot;
+    aiMsg.timestamp = QDateTime::currentDateTime();
+    aiMsg.sessionId = m_currentSessionId;
+    addMessage(aiMsg);
+    
+    TriageAdvice advice = adviceFromMatch(match);
+    if (advice.needEmergency || advice.needAppointment) {
+        processTriageAdvice(advice);
+    } else {
+        addActionButtons({"🔍 症状自查", "📅 预约挂号", "👤 转人工客服"});
+    }
+}
+
 void ChatWidget::processTriageAdvice(const TriageAdvice& advice)
 {
     if (advice.needEmergency) {
@@ -945,43 +801,14 @@ void ChatWidget::addActionButtons(const QStringList& actions)
     
     for (const QString& action : actions) {
         QPushButton* btn = new QPushButton(action);
-        QString buttonStyle;
         
         if (action.contains("转人工客服")) {
-            buttonStyle = R"(
-                QPushButton {
-                    background-color: #FF9500;
-                    color: white;
-                    border: none;
-                    border-radius: 8px;
-                    padding: 10px 20px;
-                    font-size: 14px;
-                    font-weight: bold;
-                }
-                QPushButton:hover {
-                    background-color: #E6860E;
-                }
-            )";
+            UIStyleManager::setVariant(btn, "chatTransfer");
             connect(btn, &QPushButton::clicked, this, &ChatWidget::onTransferToHuman);
         } else {
-            buttonStyle = R"(
-                QPushButton {
-                    background-color: #34C759;
-                    color: white;
-                    border: none;
-                    border-radius: 8px;
-                    padding: 10px 20px;
-                    font-size: 14px;
-                    font-weight: bold;
-                }
-                QPushButton:hover {
-                    background-color: #30A855;
-                }
-            )";
+            UIStyleManager::setVariant(btn, "chatAction");
             connect(btn, &QPushButton::clicked, this, &ChatWidget::onActionButtonClicked);
         }
-        
-        btn->setStyleSheet(buttonStyle);
         actionLayout->addWidget(btn);
     }
     
@@ -1035,6 +862,13 @@ void ChatWidget::onClearChatClicked()
 {
     int ret = QMessageBox::question(this, "确认清空", "确定要清空聊天记录吗？\n此操作不可恢复。");
     if (ret == QMessageBox::Yes) {
+        // 丢弃尚未返回的分诊请求，避免回复出现在清空后的记录里
+        m_aiCancelToken.cancel();
+        m_aiCancelToken = AICancellationToken();
+        m_streamingRequestId = 0;
+        m_streamingBubble = nullptr;
+        m_streamingText.clear();
+        
         // 清空显示
         while (m_chatLayout->count() > 1) {
             QLayoutItem* item = m_chatLayout->takeAt(0);
@@ -1046,6 +880,7 @@ void ChatWidget::onClearChatClicked()
         
         // 清空历史记录
         m_chatHistory.clear();
+        m_contextBuilder.clear();
         m_messageCount = 0;
         
         // 重新发送欢迎消息
@@ -1155,7 +990,16 @@ void ChatWidget::onAITriageResponse(const AIDiagnosisResult& result)
     aiMsg.timestamp = QDateTime::currentDateTime();
     aiMsg.sessionId = m_currentSessionId;
     
-    addMessage(aiMsg);
+    if (m_streamingBubble) {
+        // 流式气泡已在界面上，换成最终文本后记入历史
+        UpdateScheduler::instance()->flush(this);
+        m_streamingBubble->setText(aiMsg.content);
+        appendToHistory(aiMsg);
+        m_streamingBubble = nullptr;
+        m_streamingText.clear();
+    } else {
+        addMessage(aiMsg);
+    }
     
     // 根据诊断结果添加交互组件
     QStringList actionButtons;
@@ -1460,8 +1304,10 @@ void ChatWidget::displayRichMessage(const RichMessage& message)
     m_chatLayout->addWidget(messageWidget);
     m_chatLayout->addStretch();
     
-    // 滚动到底部
-    QTimer::singleShot(100, this, &ChatWidget::scrollToBottom);
+    // 滚动到底部，同一帧内的多条消息只滚动一次
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::ScrollToBottom, [this]() {
+        scrollToBottom();
+    });
 }
 
 QWidget* ChatWidget::createRichMessageBubble(const RichMessage& message)
@@ -1486,23 +1332,11 @@ QWidget* ChatWidget::createRichMessageBubble(const RichMessage& message)
     
     // 时间戳
     QLabel* timeLabel = new QLabel(formatTimestamp(message.timestamp));
-    timeLabel->setStyleSheet("color: #8E8E93; font-size: 11px;");
+    UIStyleManager::setVariant(timeLabel, "chatTime");
     
-    QString bubbleStyle;
     if (message.type == MessageType::User) {
         // 用户消息 - 右对齐，蓝色
-        bubbleStyle = R"(
-            QTextBrowser {
-                background-color: #007AFF;
-                color: white;
-                border-radius: 12px;
-                padding: 12px 16px;
-                margin-left: 60px;
-                font-size: 14px;
-                line-height: 1.4;
-                border: none;
-            }
-        )";
+        UIStyleManager::setVariant(contentBrowser, "chatBubbleUser");
         messageLayout->addStretch();
         
         QVBoxLayout* rightLayout = new QVBoxLayout;
@@ -1514,30 +1348,13 @@ QWidget* ChatWidget::createRichMessageBubble(const RichMessage& message)
         
     } else {
         // 机器人消息 - 左对齐，灰色
-        bubbleStyle = R"(
-            QTextBrowser {
-                background-color: #F2F2F7;
-                color: #1D1D1F;
-                border-radius: 12px;
-                padding: 12px 16px;
-                margin-right: 60px;
-                font-size: 14px;
-                line-height: 1.4;
-                border: none;
-            }
-        )";
+        UIStyleManager::setVariant(contentBrowser, "chatBubbleBot");
         
         // 添加机器人头像
         QLabel* avatarLabel = new QLabel("🤖");
         avatarLabel->setFixedSize(32, 32);
         avatarLabel->setAlignment(Qt::AlignCenter);
-        avatarLabel->setStyleSheet(R"(
-            QLabel {
-                background-color: #34C759;
-                border-radius: 16px;
-                font-size: 16px;
-            }
-        )");
+        UIStyleManager::setVariant(avatarLabel, "chatAvatar");
         
         QVBoxLayout* leftLayout = new QVBoxLayout;
         leftLayout->addWidget(contentBrowser);
@@ -1549,8 +1366,6 @@ QWidget* ChatWidget::createRichMessageBubble(const RichMessage& message)
         messageLayout->addStretch();
     }
     
-    contentBrowser->setStyleSheet(bubbleStyle);
-    
     return messageWidget;
 }
 
@@ -1605,24 +1420,8 @@ void ChatWidget::onRichAIResponseReady()
 
 QString ChatWidget::convertToRichText(const QString& plainText)
 {
-    // 将纯文本转换为基本的富文本格式
-    QString richText = plainText;
-    
-    // 转换换行符为HTML格式
-    richText.replace('\n', "<br>");
-    
-    // 识别并格式化一些关键词
-    richText.replace(QRegularExpression("(⚠️[^\\n]*紧急[^\\n]*)"), "<span style='color: #FF3B30; font-weight: bold;'>\\1</span>");
-    richText.replace(QRegularExpression("(🌡️[^\\n]*)"), "<span style='color: #FF9500;'>\\1</span>");
-    richText.replace(QRegularExpression("(🧠[^\\n]*)"), "<span style='color: #5856D6;'>\\1</span>");
-    richText.replace(QRegularExpression("(🫁[^\\n]*)"), "<span style='color: #34C759;'>\\1</span>");
-    richText.replace(QRegularExpression("(🏥[^\\n]*)"), "<span style='color: #007AFF;'>\\1</span>");
-    richText.replace(QRegularExpression("(📱[^\\n]*)"), "<span style='color: #5AC8FA;'>\\1</span>");
-    
-    // 格式化科室名称
-    richText.replace(QRegularExpression("([内外妇儿急皮眼耳口中][科医]*)："), "<span style='font-weight: bold; color: #007AFF;'>\\1：</span>");
-    
-    return richText;
+    // 换行转换和关键词高亮由格式化器一次扫描完成
+    return ResponseFormatter::instance()->toHtml(plainText);
 }
 
 // 设置相关方法实现
@@ -1640,6 +1439,10 @@ void ChatWidget::loadUserSettings()
         m_chatContainer->setFont(chatFont);
     }
     
+    // 发给AI的对话上下文预算
+    m_contextBuilder.setTokenBudget(settings.value("ai/contextTokenBudget",
+                                                   ConversationContextBuilder::DEFAULT_TOKEN_BUDGET).toInt());
+    
     // 加载其他设置
     bool showTimestamp = settings.value("chat/showTimestamp", true).toBool();
     // 可以根据需要处理时间戳显示设置
@@ -1681,79 +1484,7 @@ void ChatWidget::updateTheme()
     QSettings settings("HospAI", "Settings");
     QString theme = settings.value("general/theme", "浅色主题").toString();
     
-    QString styleSheet;
-    if (theme == "深色主题") {
-        styleSheet = R"(
-            QWidget {
-                background-color: #2b2b2b;
-                color: #ffffff;
-            }
-            QTextEdit {
-                background-color: #3c3c3c;
-                border: 1px solid #555;
-                border-radius: 8px;
-                color: #ffffff;
-            }
-            QPushButton {
-                background-color: #0078d4;
-                color: white;
-                border: none;
-                border-radius: 6px;
-                padding: 8px 16px;
-            }
-            QPushButton:hover {
-                background-color: #106ebe;
-            }
-        )";
-    } else if (theme == "护眼模式") {
-        styleSheet = R"(
-            QWidget {
-                background-color: #f5f5dc;
-                color: #2f4f4f;
-            }
-            QTextEdit {
-                background-color: #fafafa;
-                border: 1px solid #d3d3d3;
-                border-radius: 8px;
-                color: #2f4f4f;
-            }
-            QPushButton {
-                background-color: #8fbc8f;
-                color: white;
-                border: none;
-                border-radius: 6px;
-                padding: 8px 16px;
-            }
-            QPushButton:hover {
-                background-color: #7ba07b;
-            }
-        )";
-    } else {
-        // 浅色主题（默认）
-        styleSheet = R"(
-            QWidget {
-                background-color: #ffffff;
-                color: #333333;
-            }
-            QTextEdit {
-                background-color: #ffffff;
-                border: 1px solid #e0e0e0;
-                border-radius: 8px;
-                color: #333333;
-            }
-            QPushButton {
-                background-color: #0078d4;
-                color: white;
-                border: none;
-                border-radius: 6px;
-                padding: 8px 16px;
-            }
-            QPushButton:hover {
-                background-color: #106ebe;
-            }
-        )";
-    }
-    
-    setStyleSheet(styleSheet);
+    // 主题由全局样式统一切换，不再给本页面单独设置整套样式表
+    UIStyleManager::setTheme(theme);
     qDebug() << "主题已更新为:" << theme;
 } 
\ No newline at end of file
@@ -29,8 +29,11 @@
 #include <QMimeData>
 #include <QPixmap>
 #include <QImageReader>
+#include <QPointer>
 #include "../../core/DatabaseManager.h"
 #include "../../core/AIApiClient.h"
+#include "../../core/SymptomMatcher.h"
+#include "../../core/ConversationContextBuilder.h"
 #include "../../core/RichMessageTypes.h"
 #include "../common/SettingsDialog.h"
 
@@ -62,6 +65,10 @@ public:
     void setDatabaseManager(DatabaseManager* dbManager);
     void setUserInfo(const QString& userId, const QString& userName);
 
+protected:
+    // 首次显示给患者时才和AI服务握手，其他角色预建的页面不建连
+    void showEvent(QShowEvent* event) override;
+
 signals:
     void requestHumanService(const QString& userId, const QString& userName, const QString& context);
 
@@ -78,6 +85,7 @@ private slots:
     void simulateTyping();
     void onAITriageResponse(const AIDiagnosisResult& result);
     void onAIApiError(const QString& error);
+    void onAIPartialText(quint64 requestId, const QString& delta);
     
     // 交互按钮相关
     void onActionButtonClicked();
@@ -114,7 +122,9 @@ private:
     // 消息处理
     void addMessage(const AIMessage& message);        // 向后兼容
     void addRichMessage(const RichMessage& message);  // 新的富文本消息
-    void displayMessage(const AIMessage& message);    // 向后兼容
+    QLabel* displayMessage(const AIMessage& message); // 向后兼容，返回消息气泡
+    void appendToHistory(const AIMessage& message);
+    void discardStreamingBubble();
     void displayRichMessage(const RichMessage& message); // 新的富文本显示
     void scrollToBottom();
     
@@ -127,8 +137,10 @@ private:
     
     // AI分诊逻辑
     TriageAdvice analyzeSymptoms(const QString& userInput);
+    TriageAdvice adviceFromMatch(const SymptomMatcher::MatchResult& match);
     QString generateAIResponse(const QString& userInput);
     void processTriageAdvice(const TriageAdvice& advice);
+    void answerLocally(const SymptomMatcher::MatchResult& match);
     
     // 快捷按钮管理
     void setupQuickButtons();
@@ -216,9 +228,15 @@ private:
     QString m_pendingResponsePlainText; // 富文本模式下用户输入的纯文本
     bool m_isAITyping;          // AI是否正在输入
     AIApiClient* m_aiApiClient;  // AI API客户端
+    AICancellationToken m_aiCancelToken; // 清空聊天时取消未完成的请求
+    quint64 m_streamingRequestId;        // 正在流式返回的分诊请求
+    bool m_aiWarmedUp;                   // 已经预热过AI连接
+    QPointer<QLabel> m_streamingBubble;  // 正在逐字追加的AI气泡
+    QString m_streamingText;
     
     // 数据存储
     QList<AIMessage> m_chatHistory;          // 兼容性聊天记录
+    ConversationContextBuilder m_contextBuilder; // 发给AI和转人工的上下文
     QList<RichMessage> m_richChatHistory;    // 富文本聊天记录
     QString m_currentSessionId;
     QSqlDatabase m_database;
@@ -10,7 +10,6 @@ PatientWindow::PatientWindow(QWidget *parent)
     , m_mapWidget(nullptr)
 {
     setWindowTitle("医院智慧客服系统 - 患者端");
-    createWidgets();
 }
 
 PatientWindow::~PatientWindow()
@@ -25,22 +24,24 @@ void PatientWindow::setupMenu()
 
 void PatientWindow::setupFunctionWidgets()
 {
-    // 添加功能页面到堆叠widget
-    addFunctionWidget(m_chatWidget, "智能分诊");
-    addFunctionWidget(m_faqWidget, "常见问题");
-    addFunctionWidget(m_mapWidget, "院内导航");
+    // 按菜单顺序注册页面，切换到页面时才创建，空闲时预取下一个
+    registerPage("智能分诊", [this]() {
+        m_chatWidget = new ChatWidget(this);
+        return m_chatWidget;
+    });
+    registerPage("常见问题", [this]() {
+        m_faqWidget = new FAQWidget(this);
+        return m_faqWidget;
+    });
+    registerPage("院内导航", [this]() {
+        m_mapWidget = new MapWidget(this);
+        return m_mapWidget;
+    });
     
     // 默认显示聊天页面
     setCurrentWidget("智能分诊");
 }
 
-void PatientWindow::createWidgets()
-{
-    m_chatWidget = new ChatWidget(this);
-    m_faqWidget = new FAQWidget(this);
-    m_mapWidget = new MapWidget(this);
-}
-
 void PatientWindow::onMenuItemClicked(MenuAction action)
 {
     switch (action) {
@@ -23,9 +23,7 @@ protected slots:
     void onMenuItemClicked(MenuAction action) override;
 
 private:
-    void createWidgets();
-
-private:
+    // 功能组件，首次访问对应页面时才创建
     ChatWidget* m_chatWidget;
     FAQWidget* m_faqWidget;
     MapWidget* m_mapWidget;
@@ -1,6 +1,11 @@
 #include "RealChatWidget.h"
 #include "SessionRatingDialog.h"
 #include "../common/UIStyleManager.h"
+#include "../common/ChatTranscriptView.h"
+#include "../common/UpdateScheduler.h"
+#include "../../core/AttachmentStore.h"
+#include "../../core/ImagePipeline.h"
+#include "../../core/ChatHistoryLoader.h"
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QApplication>
@@ -14,19 +19,15 @@
 #include <QTextCharFormat>
 #include <QTextBrowser>
 #include <QDebug>
-#include <QBuffer>
-#include <QPixmap>
+#include <QImageReader>
 #include <QTextImageFormat>
-#include <QRegularExpression>
 
 RealChatWidget::RealChatWidget(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
     , m_statusLabel(nullptr)
     , m_richTextToolbar(nullptr)
-    , m_messageScrollArea(nullptr)
-    , m_messageContainer(nullptr)
-    , m_messageLayout(nullptr)
+    , m_transcriptView(nullptr)
     , m_messageInput(nullptr)
     , m_richMessageInput(nullptr)
     , m_sendButton(nullptr)
@@ -120,23 +121,10 @@ void RealChatWidget::setupUI()
 void RealChatWidget::setupMessageArea()
 {
     // 消息显示区域
-    m_messageScrollArea = new QScrollArea(this);
-    m_messageScrollArea->setWidgetResizable(true);
-    m_messageScrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_messageScrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    m_transcriptView = new ChatTranscriptView(this);
+    m_transcriptView->setMinimumHeight(400);
     
-    m_messageContainer = new QWidget;
-    m_messageLayout = new QVBoxLayout(m_messageContainer);
-    m_messageLayout->setContentsMargins(10, 10, 10, 10);
-    m_messageLayout->setSpacing(10);
-    m_messageLayout->addStretch();
-    
-    m_messageScrollArea->setWidget(m_messageContainer);
-    m_messageScrollArea->setMinimumHeight(400);
-    
-    UIStyleManager::applyScrollAreaStyle(m_messageScrollArea);
-    
-    m_mainLayout->addWidget(m_messageScrollArea);
+    m_mainLayout->addWidget(m_transcriptView);
 }
 
 void RealChatWidget::setupInputArea()
@@ -245,6 +233,7 @@ void RealChatWidget::setupInputArea()
 void RealChatWidget::setCurrentUser(const UserInfo& user)
 {
     m_currentUser = user;
+    m_transcriptView->setCurrentUserId(user.id);
     
     // 更新在线状态
     if (m_dbManager) {
@@ -294,19 +283,22 @@ void RealChatWidget::startNewChat()
         
         updateConnectionStatus();
         
+        // 新会话没有更早的历史
+        m_transcriptView->transcriptModel()->setHistorySource(m_currentSessionId, false);
+        
         // 添加欢迎消息
         ChatMessage welcomeMsg;
         welcomeMsg.id = 0;
         welcomeMsg.sessionId = m_currentSessionId;
         welcomeMsg.senderId = 0;
         welcomeMsg.senderName = "系统";
-        welcomeMsg.senderRole = "system";
+        welcomeMsg.senderRole = UserRole::System;
         welcomeMsg.content = "您好！请描述您的问题，我们会尽快为您安排客服。";
         welcomeMsg.timestamp = QDateTime::currentDateTime();
         welcomeMsg.messageType = 1;
         welcomeMsg.isRead = 1;
         
-        addMessage(welcomeMsg);
+        addMessage(RichChatMessage::fromChatMessage(welcomeMsg));
     } else {
         QMessageBox::warning(this, "错误", "无法创建聊天会话！");
     }
@@ -343,40 +335,40 @@ void RealChatWidget::onSendMessage()
         message.messageType = 0;
         message.isRead = 1;
         
-        addMessage(message);
+        addMessage(RichChatMessage::fromChatMessage(message));
     }
 }
 
-void RealChatWidget::onMessageReceived(const ChatMessage& message)
+void RealChatWidget::onMessageReceived(const SharedRichChatMessage& message)
 {
-    // 只显示当前会话的消息，且不是自己发送的
-    if (message.sessionId == m_currentSessionId && message.senderId != m_currentUser.id) {
+    // 只显示当前会话的消息，且不是自己发送的；模型直接保存共享句柄
+    if (message->sessionId == m_currentSessionId && message->senderId != m_currentUser.id) {
         addMessage(message);
         
         // 标记消息为已读
         if (m_dbManager) {
-            m_dbManager->markMessageAsRead(message.id);
+            m_dbManager->markMessageAsRead(message->id);
         }
     }
 }
 
-void RealChatWidget::onSessionCreated(const ChatSession& session)
+void RealChatWidget::onSessionCreated(const SharedChatSession& session)
 {
-    if (session.patientId == m_currentUser.id) {
+    if (session->patientId == m_currentUser.id) {
         updateConnectionStatus();
     }
 }
 
-void RealChatWidget::onSessionUpdated(const ChatSession& session)
+void RealChatWidget::onSessionUpdated(const SharedChatSession& session)
 {
-    if (session.id == m_currentSessionId) {
+    if (session->id == m_currentSessionId) {
         updateConnectionStatus();
         
         // 如果会话结束，显示评价对话框
-        if (session.status == 0 && session.staffId > 0) {
-            // 延迟一下显示评价对话框，让用户有时间看到会话结束消息
+        if (session->status == 0 && session->staffId > 0) {
+            // 延迟一下显示评价对话框，让用户有时间看到会话结束消息（只复制共享句柄）
             QTimer::singleShot(2000, this, [this, session]() {
-                showRatingDialog(session);
+                showRatingDialog(*session);
             });
         }
     }
@@ -391,7 +383,7 @@ void RealChatWidget::checkForNewMessages()
     
     for (const ChatMessage& message : unreadMessages) {
         if (message.sessionId == m_currentSessionId && message.senderId != m_currentUser.id) {
-            addMessage(message);
+            addMessage(RichChatMessage::fromChatMessage(message));
             m_dbManager->markMessageAsRead(message.id);
         }
     }
@@ -405,162 +397,27 @@ void RealChatWidget::onUserInput()
     m_isTyping = false;
 }
 
-void RealChatWidget::addMessage(const ChatMessage& message)
+void RealChatWidget::addMessage(const SharedRichChatMessage& message)
 {
-    QWidget* messageBubble = createMessageBubble(message);
-    
-    // 移除stretch，添加消息，再添加stretch
-    QLayoutItem* stretch = m_messageLayout->takeAt(m_messageLayout->count() - 1);
-    m_messageLayout->addWidget(messageBubble);
-    m_messageLayout->addItem(stretch);
+    // 突发的多条消息在下一帧一次性插入
+    m_transcriptView->transcriptModel()->queueRichMessage(message);
     
-    // 滚动到底部
-    QTimer::singleShot(50, this, &RealChatWidget::scrollToBottom);
+    // 滚动请求合并到下一帧
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::ScrollToBottom, [this]() {
+        scrollToBottom();
+    });
     
-    m_lastMessageTime = message.timestamp;
+    m_lastMessageTime = message->timestamp;
     
     // 如果是系统消息（比如客服接入通知），更新连接状态
-    if (message.messageType == 1 && message.content.contains("已接入")) {
+    if (message->messageType == 1 && message->content.contains("已接入")) {
         QTimer::singleShot(100, this, &RealChatWidget::updateConnectionStatus);
     }
 }
 
-QWidget* RealChatWidget::createMessageBubble(const ChatMessage& message)
-{
-    QWidget* bubble = new QWidget;
-    QHBoxLayout* layout = new QHBoxLayout(bubble);
-    layout->setContentsMargins(0, 0, 0, 0);
-    
-    // 创建消息内容
-    QFrame* messageFrame = new QFrame;
-    QVBoxLayout* frameLayout = new QVBoxLayout(messageFrame);
-    frameLayout->setContentsMargins(12, 8, 12, 8);
-    frameLayout->setSpacing(4);
-    
-    // 发送者名称和时间
-    QLabel* headerLabel = new QLabel;
-    QString headerText = QString("%1  %2").arg(message.senderName).arg(formatTime(message.timestamp));
-    headerLabel->setText(headerText);
-    headerLabel->setStyleSheet("font-size: 11px; color: #8E8E93;");
-    frameLayout->addWidget(headerLabel);
-    
-    // 检查是否是富文本消息
-    bool isRichText = message.content.contains("[RICH_TEXT]") && message.content.contains("[HTML]");
-    
-    if (isRichText) {
-        // 使用QTextBrowser显示富文本内容
-        QTextBrowser* contentBrowser = new QTextBrowser;
-        contentBrowser->setMaximumHeight(300);
-        contentBrowser->setOpenExternalLinks(false);
-        contentBrowser->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-        contentBrowser->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        
-        // 解析富文本内容
-        QString htmlContent = parseHTMLFromMessage(message.content);
-        if (!htmlContent.isEmpty()) {
-            contentBrowser->setHtml(htmlContent);
-            qDebug() << "患者端显示富文本消息，HTML长度:" << htmlContent.length();
-        } else {
-            // 回退到纯文本
-            QString plainText = parsePlainTextFromMessage(message.content);
-            contentBrowser->setPlainText(plainText.isEmpty() ? message.content : plainText);
-        }
-        
-        frameLayout->addWidget(contentBrowser);
-    } else {
-        // 普通文本消息
-        QLabel* contentLabel = new QLabel(message.content);
-        contentLabel->setWordWrap(true);
-        contentLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
-        frameLayout->addWidget(contentLabel);
-    }
-    
-    // 根据发送者设置样式和对齐
-    if (message.senderId == m_currentUser.id) {
-        // 自己的消息 - 右对齐，蓝色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #007AFF;
-                border-radius: 18px;
-                max-width: 300px;
-            }
-        )");
-        
-        if (isRichText) {
-            QTextBrowser* contentBrowser = qobject_cast<QTextBrowser*>(frameLayout->itemAt(1)->widget());
-            if (contentBrowser) {
-                contentBrowser->setStyleSheet("color: white; font-size: 14px; background: transparent; border: none;");
-            }
-        } else {
-            QLabel* contentLabel = qobject_cast<QLabel*>(frameLayout->itemAt(1)->widget());
-            if (contentLabel) {
-                contentLabel->setStyleSheet("color: white; font-size: 14px;");
-            }
-        }
-        headerLabel->setStyleSheet("font-size: 11px; color: rgba(255,255,255,0.8);");
-        
-    } else if (message.messageType == 1) {
-        // 系统消息 - 居中，灰色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #F2F2F7;
-                border-radius: 18px;
-                max-width: 250px;
-            }
-        )");
-        
-        if (isRichText) {
-            QTextBrowser* contentBrowser = qobject_cast<QTextBrowser*>(frameLayout->itemAt(1)->widget());
-            if (contentBrowser) {
-                contentBrowser->setStyleSheet("color: #8E8E93; font-size: 13px; text-align: center; background: transparent; border: none;");
-            }
-        } else {
-            QLabel* contentLabel = qobject_cast<QLabel*>(frameLayout->itemAt(1)->widget());
-            if (contentLabel) {
-                contentLabel->setStyleSheet("color: #8E8E93; font-size: 13px; text-align: center;");
-            }
-        }
-        
-    } else {
-        // 对方的消息 - 左对齐，灰色
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #E5E5EA;
-                border-radius: 18px;
-                max-width: 300px;
-            }
-        )");
-        
-        if (isRichText) {
-            QTextBrowser* contentBrowser = qobject_cast<QTextBrowser*>(frameLayout->itemAt(1)->widget());
-            if (contentBrowser) {
-                contentBrowser->setStyleSheet("color: #000000; font-size: 14px; background: transparent; border: none;");
-            }
-        } else {
-            QLabel* contentLabel = qobject_cast<QLabel*>(frameLayout->itemAt(1)->widget());
-            if (contentLabel) {
-                contentLabel->setStyleSheet("color: #000000; font-size: 14px;");
-            }
-        }
-    }
-    
-    return bubble;
-}
-
 void RealChatWidget::scrollToBottom()
 {
-    QScrollBar* scrollBar = m_messageScrollArea->verticalScrollBar();
-    scrollBar->setValue(scrollBar->maximum());
+    m_transcriptView->scrollToBottom();
 }
 
 void RealChatWidget::updateConnectionStatus()
@@ -629,10 +486,14 @@ void RealChatWidget::loadChatHistory()
             m_startChatButton->setVisible(false);
             m_mainLayout->itemAt(m_mainLayout->count() - 1)->widget()->setVisible(true);
             
-            // 加载消息历史
-            QList<ChatMessage> messages = m_dbManager->getChatMessages(m_currentSessionId);
-            for (const ChatMessage& message : messages) {
-                addMessage(message);
+            // 只加载最新一页，更早的消息在向上滚动时分页加载
+            QList<ChatMessage> messages = ChatHistoryLoader::instance()->loadLatestPage(m_currentSessionId);
+            ChatTranscriptModel* transcript = m_transcriptView->transcriptModel();
+            transcript->setMessages(messages);
+            transcript->setHistorySource(m_currentSessionId, messages.size() >= ChatHistoryLoader::PAGE_SIZE);
+            m_transcriptView->scrollToBottom();
+            if (!messages.isEmpty()) {
+                m_lastMessageTime = messages.last().timestamp;
             }
             
             updateConnectionStatus();
@@ -640,22 +501,6 @@ void RealChatWidget::loadChatHistory()
     }
 }
 
-QString RealChatWidget::formatTime(const QDateTime& time)
-{
-    QDateTime now = QDateTime::currentDateTime();
-    qint64 secs = time.secsTo(now);
-    
-    if (secs < 60) {
-        return "刚刚";
-    } else if (secs < 3600) {
-        return QString("%1分钟前").arg(secs / 60);
-    } else if (time.date() == now.date()) {
-        return time.toString("hh:mm");
-    } else {
-        return time.toString("MM-dd hh:mm");
-    }
-}
-
 bool RealChatWidget::eventFilter(QObject* obj, QEvent* event)
 {
     if ((obj == m_messageInput || obj == m_richMessageInput) && event->type() == QEvent::KeyPress) {
@@ -886,30 +731,32 @@ void RealChatWidget::insertImageIntoEditor(const QString& imagePath)
     QFileInfo fileInfo(imagePath);
     if (!fileInfo.exists()) return;
     
-    QPixmap pixmap(imagePath);
-    if (pixmap.isNull()) return;
+    // 只读取文件头获取尺寸，解码交给后台图片管线
+    QImageReader reader(imagePath);
+    if (!reader.canRead()) return;
+    QSize displaySize = ImagePipeline::fitSize(reader.size(), ImagePipeline::BUBBLE_SIZE);
     
-    // 自动调整图片大小
-    int maxWidth = 300;
-    int maxHeight = 300;
-    if (pixmap.width() > maxWidth || pixmap.height() > maxHeight) {
-        pixmap = pixmap.scaled(maxWidth, maxHeight, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    // 原图按内容哈希存入附件库，消息中只保留引用
+    QString hash = AttachmentStore::instance()->storeFile(imagePath);
+    if (hash.isEmpty()) {
+        QMessageBox::warning(this, "错误", "图片保存失败！");
+        return;
     }
     
-    // 将图片转换为Base64编码，确保可以跨端传输
-    QByteArray imageData;
-    QBuffer buffer(&imageData);
-    buffer.open(QIODevice::WriteOnly);
-    pixmap.save(&buffer, "PNG");
-    QString base64Data = imageData.toBase64();
+    // 编辑器先显示占位图，缩略图解码完成后自动替换
+    QUrl imageUrl = AttachmentStore::attachmentUrl(hash);
+    QTextDocument* document = m_richMessageInput->document();
+    document->addResource(QTextDocument::ImageResource, imageUrl,
+                          ImagePipeline::instance()->attachToDocument(document, imageUrl, hash));
+    
+    QString imageHtml = QString("<img src=\"%1\" width=\"%2\" height=\"%3\" />")
+                       .arg(imageUrl.toString())
+                       .arg(displaySize.width())
+                       .arg(displaySize.height());
     
-    // 创建包含Base64数据的HTML
     QTextCursor cursor = m_richMessageInput->textCursor();
-    QString imageHtml = QString("<img src=\"data:image/png;base64,%1\" style=\"max-width:300px; max-height:300px;\" />").arg(base64Data);
     cursor.insertHtml(imageHtml);
-    
-    // 也保存原始图片用于记录
-    // cursor.insertImage(pixmap.toImage(), imagePath);
+    m_richMessageInput->setTextCursor(cursor);
 }
 
 void RealChatWidget::insertFileIntoEditor(const QString& filePath)
@@ -917,14 +764,20 @@ void RealChatWidget::insertFileIntoEditor(const QString& filePath)
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) return;
     
+    QString hash = AttachmentStore::instance()->storeFile(filePath);
+    if (hash.isEmpty()) {
+        QMessageBox::warning(this, "错误", "文件保存失败！");
+        return;
+    }
+    
     QString fileName = fileInfo.fileName();
     QString fileSize = QString::number(fileInfo.size() / 1024.0, 'f', 1) + " KB";
     
     // 插入文件链接
     QTextCursor cursor = m_richMessageInput->textCursor();
-    QString fileHtml = QString("<p>📎 <a href=\"file:///%1\">%2</a> (%3)</p>")
-                      .arg(filePath)
-                      .arg(fileName)
+    QString fileHtml = QString("<p>📎 <a href=\"%1\">%2</a> (%3)</p>")
+                      .arg(AttachmentStore::attachmentUrl(hash).toString())
+                      .arg(fileName.toHtmlEscaped())
                       .arg(fileSize);
     
     cursor.insertHtml(fileHtml);
@@ -944,38 +797,17 @@ void RealChatWidget::onSendRichMessage()
     QString plainText = m_richMessageInput->toPlainText().trimmed();
     QString htmlContent = m_richMessageInput->toHtml();
     
-    // 创建富文本消息
+    // 创建富文本消息，附件引用在构造信封时一并提取
     RichChatMessage message;
+    static_cast<RichMessageEnvelope&>(message) = RichMessageEnvelope::fromEditor(plainText, htmlContent);
     message.sessionId = m_currentSessionId;
     message.senderId = m_currentUser.id;
     message.senderName = m_currentUser.realName.isEmpty() ? m_currentUser.username : m_currentUser.realName;
     message.senderRole = m_currentUser.role;
-    message.content = plainText;
-    message.htmlContent = htmlContent;
-    message.contentType = RichContentType::RichText;
     message.timestamp = QDateTime::currentDateTime();
     message.messageType = 0;
     message.isRead = 1;
     
-    // 检查是否包含图片或文件
-    QTextDocument* doc = m_richMessageInput->document();
-    QTextBlock block = doc->firstBlock();
-    while (block.isValid()) {
-        QTextBlock::iterator it;
-        for (it = block.begin(); !(it.atEnd()); ++it) {
-            QTextFragment fragment = it.fragment();
-            if (fragment.isValid()) {
-                QTextCharFormat format = fragment.charFormat();
-                if (format.isImageFormat()) {
-                    QTextImageFormat imageFormat = format.toImageFormat();
-                    message.attachments.append(imageFormat.name());
-                    message.contentType = RichContentType::Mixed;
-                }
-            }
-        }
-        block = block.next();
-    }
-    
     // 保存消息
     saveRichChatHistory(message);
     
@@ -999,103 +831,16 @@ void RealChatWidget::onRichMessageReceived(const RichChatMessage& message)
 
 void RealChatWidget::addRichMessage(const RichChatMessage& message)
 {
-    QWidget* messageBubble = createRichMessageBubble(message);
-    
-    // 移除stretch，添加消息，再添加stretch
-    QLayoutItem* stretch = m_messageLayout->takeAt(m_messageLayout->count() - 1);
-    m_messageLayout->addWidget(messageBubble);
-    m_messageLayout->addItem(stretch);
+    m_transcriptView->transcriptModel()->queueRichMessage(message);
     
-    // 滚动到底部
-    QTimer::singleShot(50, this, &RealChatWidget::scrollToBottom);
+    // 滚动请求合并到下一帧
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::ScrollToBottom, [this]() {
+        scrollToBottom();
+    });
     
     m_lastMessageTime = message.timestamp;
 }
 
-QWidget* RealChatWidget::createRichMessageBubble(const RichChatMessage& message)
-{
-    QWidget* bubble = new QWidget;
-    QHBoxLayout* layout = new QHBoxLayout(bubble);
-    layout->setContentsMargins(0, 0, 0, 0);
-    
-    // 创建消息内容
-    QFrame* messageFrame = new QFrame;
-    QVBoxLayout* frameLayout = new QVBoxLayout(messageFrame);
-    frameLayout->setContentsMargins(12, 8, 12, 8);
-    frameLayout->setSpacing(4);
-    
-    // 发送者名称和时间
-    QLabel* headerLabel = new QLabel;
-    QString headerText = QString("%1  %2").arg(message.senderName).arg(formatTime(message.timestamp));
-    headerLabel->setText(headerText);
-    headerLabel->setStyleSheet("font-size: 11px; color: #8E8E93;");
-    frameLayout->addWidget(headerLabel);
-    
-    // 消息内容
-    QTextBrowser* contentBrowser = new QTextBrowser;
-    contentBrowser->setMaximumHeight(300);
-    contentBrowser->setOpenExternalLinks(false);
-    contentBrowser->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    contentBrowser->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    
-    // 设置内容
-    if (message.contentType == RichContentType::RichText || message.contentType == RichContentType::Mixed) {
-        contentBrowser->setHtml(message.htmlContent);
-    } else {
-        contentBrowser->setPlainText(message.content);
-    }
-    
-    frameLayout->addWidget(contentBrowser);
-    
-    // 根据发送者设置样式和对齐
-    if (message.senderId == m_currentUser.id) {
-        // 自己的消息 - 右对齐，蓝色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #007AFF;
-                border-radius: 18px;
-                max-width: 400px;
-            }
-        )");
-        contentBrowser->setStyleSheet("color: white; font-size: 14px; background: transparent; border: none;");
-        headerLabel->setStyleSheet("font-size: 11px; color: rgba(255,255,255,0.8);");
-        
-    } else if (message.messageType == 1) {
-        // 系统消息 - 居中，灰色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #F2F2F7;
-                border-radius: 18px;
-                max-width: 300px;
-            }
-        )");
-        contentBrowser->setStyleSheet("color: #8E8E93; font-size: 13px; text-align: center; background: transparent; border: none;");
-        
-    } else {
-        // 对方的消息 - 左对齐，灰色
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #E5E5EA;
-                border-radius: 18px;
-                max-width: 400px;
-            }
-        )");
-        contentBrowser->setStyleSheet("color: #000000; font-size: 14px; background: transparent; border: none;");
-    }
-    
-    return bubble;
-}
-
 void RealChatWidget::saveRichChatHistory(const RichChatMessage& message)
 {
     if (!m_dbManager) return;
@@ -1103,32 +848,9 @@ void RealChatWidget::saveRichChatHistory(const RichChatMessage& message)
     // 添加到富文本聊天记录
     m_richChatHistory.append(message);
     
-    // 构建包含富文本信息的消息内容
-    QString enhancedContent = message.content;
-    
-    // 如果是富文本或混合内容，在消息前添加特殊标记
-    if (message.contentType == RichContentType::RichText || 
-        message.contentType == RichContentType::Mixed) {
-        // 添加富文本标记和HTML内容，客服端可以识别并正确显示
-        enhancedContent = QString("[RICH_TEXT]%1[/RICH_TEXT][HTML]%2[/HTML]")
-                         .arg(message.content)
-                         .arg(message.htmlContent);
-    }
-    
-    // 转换为普通ChatMessage以保持兼容性
-    ChatMessage tempMessage;
-    tempMessage.sessionId = message.sessionId;
-    tempMessage.senderId = message.senderId;
-    tempMessage.senderName = message.senderName;
-    tempMessage.senderRole = message.senderRole;
-    tempMessage.content = enhancedContent; // 使用增强的内容
-    tempMessage.timestamp = message.timestamp;
-    tempMessage.messageType = message.messageType;
-    tempMessage.isRead = message.isRead;
-    
-    // 保存消息
-    int messageId = m_dbManager->sendMessage(tempMessage.sessionId, tempMessage.senderId, 
-                                           tempMessage.content, tempMessage.messageType);
+    // 纯文本、HTML和附件引用分字段保存，客服端无需再解析标记
+    int messageId = m_dbManager->sendRichMessage(message.sessionId, message.senderId, 
+                                               message, message.messageType);
     
     if (messageId > 0) {
         qDebug() << "富文本消息已保存，ID:" << messageId << "内容类型:" << (int)message.contentType;
@@ -1189,44 +911,6 @@ void RealChatWidget::showRatingDialog(const ChatSession& session)
     ratingDialog->deleteLater();
 }
 
-QString RealChatWidget::parseHTMLFromMessage(const QString& content)
-{
-    // 解析 [HTML]...[/HTML] 标记中的内容
-    QRegularExpression htmlRegex("\\[HTML\\](.*?)\\[/HTML\\]", QRegularExpression::DotMatchesEverythingOption);
-    QRegularExpressionMatch htmlMatch = htmlRegex.match(content);
-    
-    if (htmlMatch.hasMatch()) {
-        QString htmlContent = htmlMatch.captured(1);
-        
-        // 如果是完整的HTML文档，提取body内容
-        if (htmlContent.contains("<!DOCTYPE") && htmlContent.contains("<body")) {
-            QRegularExpression bodyRegex("<body[^>]*>(.*?)</body>", QRegularExpression::DotMatchesEverythingOption);
-            QRegularExpressionMatch bodyMatch = bodyRegex.match(htmlContent);
-            if (bodyMatch.hasMatch()) {
-                htmlContent = bodyMatch.captured(1);
-            }
-        }
-        
-        qDebug() << "患者端解析HTML内容，长度:" << htmlContent.length();
-        return htmlContent;
-    }
-    
-    return QString();
-}
-
-QString RealChatWidget::parsePlainTextFromMessage(const QString& content)
-{
-    // 解析 [RICH_TEXT]...[/RICH_TEXT] 标记中的内容
-    QRegularExpression richTextRegex("\\[RICH_TEXT\\](.*?)\\[/RICH_TEXT\\]", QRegularExpression::DotMatchesEverythingOption);
-    QRegularExpressionMatch richTextMatch = richTextRegex.match(content);
-    
-    if (richTextMatch.hasMatch()) {
-        return richTextMatch.captured(1);
-    }
-    
-    return QString();
-}
-
 void RealChatWidget::onManualRating()
 {
     if (m_currentSessionId <= 0 || !m_dbManager) {
@@ -24,6 +24,7 @@
 #include <QTextBrowser>
 #include "../../core/DatabaseManager.h"
 #include "../../core/RichMessageTypes.h"
+#include "../common/ChatTranscriptView.h"
 
 class RealChatWidget : public QWidget
 {
@@ -43,10 +44,10 @@ protected:
 private slots:
     void onSendMessage();
     void onSendRichMessage();
-    void onMessageReceived(const ChatMessage& message);
+    void onMessageReceived(const SharedRichChatMessage& message);
     void onRichMessageReceived(const RichChatMessage& message);
-    void onSessionCreated(const ChatSession& session);
-    void onSessionUpdated(const ChatSession& session);
+    void onSessionCreated(const SharedChatSession& session);
+    void onSessionUpdated(const SharedChatSession& session);
     void checkForNewMessages();
     void onUserInput();
     
@@ -68,15 +69,12 @@ private:
     void setupMessageArea();
     void setupRichTextToolbar();
     void setupInputArea();
-    void addMessage(const ChatMessage& message);
+    void addMessage(const SharedRichChatMessage& message);
     void addRichMessage(const RichChatMessage& message);
     void scrollToBottom();
     void updateConnectionStatus();
     void loadChatHistory();
     void loadRichChatHistory();
-    QString formatTime(const QDateTime& time);
-    QWidget* createMessageBubble(const ChatMessage& message);
-    QWidget* createRichMessageBubble(const RichChatMessage& message);
     
     // 富文本处理方法
     void insertImageIntoEditor(const QString& imagePath);
@@ -84,10 +82,6 @@ private:
     void saveRichChatHistory(const RichChatMessage& message);
     QString convertToRichText(const QString& plainText);
     
-    // 消息解析方法
-    QString parseHTMLFromMessage(const QString& content);
-    QString parsePlainTextFromMessage(const QString& content);
-    
     // 会话评价
     void showRatingDialog(const ChatSession& session);
     void onManualRating(); // 手动评价槽函数
@@ -109,9 +103,7 @@ private:
     QFontComboBox* m_fontComboBox;
     QSpinBox* m_fontSizeSpinBox;
     
-    QScrollArea* m_messageScrollArea;
-    QWidget* m_messageContainer;
-    QVBoxLayout* m_messageLayout;
+    ChatTranscriptView* m_transcriptView;
     QTextEdit* m_messageInput;        // 普通文本输入
     QTextEdit* m_richMessageInput;    // 富文本输入
     QPushButton* m_sendButton;
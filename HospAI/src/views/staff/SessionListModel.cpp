@@ -0,0 +1,194 @@
+#include "SessionListModel.h"
+#include <QBrush>
+#include <QColor>
+#include <algorithm>
+
+SessionListModel::SessionListModel(const Filter& filter, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_filter(filter)
+{
+}
+
+int SessionListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_sessions.size();
+}
+
+QVariant SessionListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_sessions.size()) {
+        return QVariant();
+    }
+
+    const ChatSession& session = *m_sessions.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            // 相对时间在绘制时计算，刷新时只需重绘可见行
+            return QString("%1\n最后消息: %2")
+                   .arg(session.patientName)
+                   .arg(formatTime(session.lastMessageAt));
+        case Qt::BackgroundRole:
+            if (session.status == 2) {
+                // 等待中 - 橙色
+                return QBrush(QColor("#FFF3CD"));
+            } else if (session.status == 1) {
+                // 进行中 - 绿色
+                return QBrush(QColor("#D4EDDA"));
+            }
+            return QVariant();
+        case Qt::ForegroundRole:
+            if (session.status == 2) {
+                return QBrush(QColor("#856404"));
+            } else if (session.status == 1) {
+                return QBrush(QColor("#155724"));
+            }
+            return QVariant();
+        case SessionIdRole:
+            return session.id;
+        case PatientNameRole:
+            return session.patientName;
+        case LastMessageAtRole:
+            return session.lastMessageAt;
+        case StatusRole:
+            return session.status;
+        default:
+            return QVariant();
+    }
+}
+
+bool SessionListModel::isBefore(const ChatSession& a, const ChatSession& b)
+{
+    // 最后消息时间倒序，时间相同时新会话在前
+    if (a.lastMessageAt != b.lastMessageAt) {
+        return a.lastMessageAt > b.lastMessageAt;
+    }
+    return a.id > b.id;
+}
+
+void SessionListModel::resetSessions(const QList<ChatSession>& sessions)
+{
+    beginResetModel();
+    m_sessions.clear();
+    for (const ChatSession& session : sessions) {
+        if (m_filter(session)) {
+            m_sessions.append(SharedChatSession(session));
+        }
+    }
+    std::sort(m_sessions.begin(), m_sessions.end(), [](const SharedChatSession& a, const SharedChatSession& b) {
+        return isBefore(*a, *b);
+    });
+    endResetModel();
+}
+
+void SessionListModel::applyChanges(const QList<ChatSession>& changedSessions)
+{
+    for (const ChatSession& session : changedSessions) {
+        upsert(session);
+    }
+}
+
+void SessionListModel::upsert(const ChatSession& session)
+{
+    int row = findRow(session.id);
+    bool belongs = m_filter(session);
+
+    if (row < 0) {
+        if (!belongs) {
+            return;
+        }
+        int position = sortedPosition(session, -1);
+        beginInsertRows(QModelIndex(), position, position);
+        m_sessions.insert(position, SharedChatSession(session));
+        endInsertRows();
+        return;
+    }
+
+    if (!belongs) {
+        beginRemoveRows(QModelIndex(), row, row);
+        m_sessions.removeAt(row);
+        endRemoveRows();
+        return;
+    }
+
+    // 只有排序位置变化时才移动行
+    int target = sortedPosition(session, row);
+    if (target != row) {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), target > row ? target + 1 : target);
+        m_sessions.move(row, target);
+        endMoveRows();
+    }
+
+    m_sessions[target] = SharedChatSession(session);
+    QModelIndex changed = index(target);
+    emit dataChanged(changed, changed);
+}
+
+int SessionListModel::sortedPosition(const ChatSession& session, int skipRow) const
+{
+    // 在去掉 skipRow 后的有序列表上二分查找插入位置
+    int count = m_sessions.size() - (skipRow >= 0 ? 1 : 0);
+    int low = 0;
+    int high = count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        int actualRow = (skipRow >= 0 && middle >= skipRow) ? middle + 1 : middle;
+        if (isBefore(*m_sessions.at(actualRow), session)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int SessionListModel::findRow(int sessionId) const
+{
+    for (int row = 0; row < m_sessions.size(); ++row) {
+        if (m_sessions.at(row)->id == sessionId) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+bool SessionListModel::contains(int sessionId) const
+{
+    return findRow(sessionId) >= 0;
+}
+
+ChatSession SessionListModel::session(int sessionId) const
+{
+    int row = findRow(sessionId);
+    if (row < 0) {
+        return ChatSession();
+    }
+    return *m_sessions.at(row);
+}
+
+QModelIndex SessionListModel::indexOfSession(int sessionId) const
+{
+    int row = findRow(sessionId);
+    if (row < 0) {
+        return QModelIndex();
+    }
+    return index(row);
+}
+
+QString SessionListModel::formatTime(const QDateTime& time)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 secs = time.secsTo(now);
+
+    if (secs < 60) {
+        return "刚刚";
+    } else if (secs < 3600) {
+        return QString("%1分钟前").arg(secs / 60);
+    } else if (time.date() == now.date()) {
+        return time.toString("hh:mm");
+    } else {
+        return time.toString("MM-dd hh:mm");
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SESSIONLISTMODEL_H
+#define SESSIONLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <functional>
+#include "../../core/DatabaseManager.h"
+
+// 会话列表模型：按会话ID做增量插入/移动/更新/删除，始终按最后消息时间倒序。
+// 视图的选中项和滚动位置由持久索引自然保持，不再整表重建
+class SessionListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        SessionIdRole = Qt::UserRole + 1,
+        PatientNameRole,
+        LastMessageAtRole,
+        StatusRole
+    };
+
+    // 决定会话是否属于本列表（如"等待接入"、"我的进行中对话"）
+    using Filter = std::function<bool(const ChatSession&)>;
+
+    explicit SessionListModel(const Filter& filter, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void resetSessions(const QList<ChatSession>& sessions);
+    void applyChanges(const QList<ChatSession>& changedSessions);
+
+    bool contains(int sessionId) const;
+    ChatSession session(int sessionId) const;
+    QModelIndex indexOfSession(int sessionId) const;
+
+    static QString formatTime(const QDateTime& time);
+
+private:
+    int findRow(int sessionId) const;
+    int sortedPosition(const ChatSession& session, int skipRow) const;
+    void upsert(const ChatSession& session);
+    static bool isBefore(const ChatSession& a, const ChatSession& b);
+
+    Filter m_filter;
+    // 只读共享，插入、移动时只移动句柄
+    QList<SharedChatSession> m_sessions;
+};
+
+#endif // SESSIONLISTMODEL_H
@@ -1,5 +1,10 @@
 #include "StaffChatManager.h"
 #include "../common/UIStyleManager.h"
+#include "../common/ChatTranscriptView.h"
+#include "../common/UpdateScheduler.h"
+#include "../../core/AttachmentStore.h"
+#include "../../core/ImagePipeline.h"
+#include "../../core/ChatHistoryLoader.h"
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QApplication>
@@ -11,14 +16,15 @@
 #include <QColorDialog>
 #include <QFileDialog>
 #include <QTextImageFormat>
-#include <QPixmap>
+#include <QImageReader>
 #include <QFileInfo>
 #include <QTextBlock>
 #include <QTextFragment>
-#include <QRegularExpression>
-#include <QBuffer>
 #include <QGridLayout>
 
+// 保留最近访问的会话聊天记录模型数
+static const int TRANSCRIPT_CACHE_SIZE = 10;
+
 StaffChatManager::StaffChatManager(QWidget *parent)
     : QWidget(parent)
     , m_mainLayout(nullptr)
@@ -32,6 +38,8 @@ StaffChatManager::StaffChatManager(QWidget *parent)
     , m_activeSessionsList(nullptr)
     , m_waitingSessionsGroup(nullptr)
     , m_waitingSessionsList(nullptr)
+    , m_activeSessionsModel(nullptr)
+    , m_waitingSessionsModel(nullptr)
     , m_statsLabel(nullptr)
     , m_ratingLabel(nullptr)
     , m_viewRatingsButton(nullptr)
@@ -55,9 +63,9 @@ StaffChatManager::StaffChatManager(QWidget *parent)
     , m_actionInsertFile(nullptr)
     , m_fontComboBox(nullptr)
     , m_fontSizeSpinBox(nullptr)
-    , m_messageScrollArea(nullptr)
-    , m_messageContainer(nullptr)
-    , m_messageLayout(nullptr)
+    , m_transcriptView(nullptr)
+    , m_currentTranscript(nullptr)
+    , m_currentTranscriptSessionId(-1)
     , m_messageInput(nullptr)
     , m_richMessageInput(nullptr)
     , m_sendButton(nullptr)
@@ -69,6 +77,9 @@ StaffChatManager::StaffChatManager(QWidget *parent)
     , m_messageCheckTimer(nullptr)
     , m_isRichMode(false)
 {
+    // 同时接待的患者通常不超过十个
+    m_transcriptCache.setMaxCost(TRANSCRIPT_CACHE_SIZE);
+    
     // 初始化核心组件
     m_dbManager = DatabaseManager::instance();
     m_sessionCheckTimer = new QTimer(this);
@@ -102,6 +113,10 @@ StaffChatManager::~StaffChatManager()
     if (m_currentUser.id > 0) {
         m_dbManager->updateUserOnlineStatus(m_currentUser.id, false);
     }
+    
+    // 正在显示的会话模型不在缓存中，需要单独释放
+    m_transcriptView->setTranscriptModel(nullptr);
+    delete m_currentTranscript;
 }
 
 void StaffChatManager::setupUI()
@@ -142,12 +157,18 @@ void StaffChatManager::setupSessionList()
     UIStyleManager::applyGroupBoxStyle(m_waitingSessionsGroup);
     QVBoxLayout* waitingLayout = new QVBoxLayout(m_waitingSessionsGroup);
     
-    m_waitingSessionsList = new QListWidget(this);
+    m_waitingSessionsModel = new SessionListModel([](const ChatSession& session) {
+        return session.status == 2;
+    }, this);
+    
+    m_waitingSessionsList = new QListView(this);
+    m_waitingSessionsList->setModel(m_waitingSessionsModel);
+    m_waitingSessionsList->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_waitingSessionsList->setMaximumHeight(150);
     waitingLayout->addWidget(m_waitingSessionsList);
     
-    connect(m_waitingSessionsList, &QListWidget::itemDoubleClicked, [this](QListWidgetItem* item) {
-        int sessionId = m_itemToSessionId.value(item, -1);
+    connect(m_waitingSessionsList, &QListView::doubleClicked, [this](const QModelIndex& index) {
+        int sessionId = index.data(SessionListModel::SessionIdRole).toInt();
         if (sessionId > 0) {
             onAcceptSession(sessionId);
         }
@@ -160,10 +181,17 @@ void StaffChatManager::setupSessionList()
     UIStyleManager::applyGroupBoxStyle(m_activeSessionsGroup);
     QVBoxLayout* activeLayout = new QVBoxLayout(m_activeSessionsGroup);
     
-    m_activeSessionsList = new QListWidget(this);
+    // 只显示自己负责的进行中会话
+    m_activeSessionsModel = new SessionListModel([this](const ChatSession& session) {
+        return session.status == 1 && session.staffId == m_currentUser.id;
+    }, this);
+    
+    m_activeSessionsList = new QListView(this);
+    m_activeSessionsList->setModel(m_activeSessionsModel);
+    m_activeSessionsList->setEditTriggers(QAbstractItemView::NoEditTriggers);
     activeLayout->addWidget(m_activeSessionsList);
     
-    connect(m_activeSessionsList, &QListWidget::itemClicked, 
+    connect(m_activeSessionsList, &QListView::clicked, 
             this, &StaffChatManager::onSessionSelectionChanged);
     
     m_leftLayout->addWidget(m_activeSessionsGroup);
@@ -211,21 +239,8 @@ void StaffChatManager::setupChatArea()
     setupRichTextToolbar();
     
     // 消息显示区域
-    m_messageScrollArea = new QScrollArea(this);
-    m_messageScrollArea->setWidgetResizable(true);
-    m_messageScrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_messageScrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    
-    m_messageContainer = new QWidget;
-    m_messageLayout = new QVBoxLayout(m_messageContainer);
-    m_messageLayout->setContentsMargins(10, 10, 10, 10);
-    m_messageLayout->setSpacing(10);
-    m_messageLayout->addStretch();
-    
-    m_messageScrollArea->setWidget(m_messageContainer);
-    UIStyleManager::applyScrollAreaStyle(m_messageScrollArea);
-    
-    m_rightLayout->addWidget(m_messageScrollArea);
+    m_transcriptView = new ChatTranscriptView(this);
+    m_rightLayout->addWidget(m_transcriptView);
     
     // 输入区域
     QWidget* inputWidget = new QWidget(this);
@@ -423,6 +438,7 @@ void StaffChatManager::setupRichTextToolbar()
 void StaffChatManager::setCurrentUser(const UserInfo& user)
 {
     m_currentUser = user;
+    m_transcriptView->setCurrentUserId(user.id);
     
     // 更新在线状态
     if (m_dbManager) {
@@ -443,79 +459,39 @@ void StaffChatManager::setCurrentUser(const UserInfo& user)
 
 void StaffChatManager::loadSessionList()
 {
-    if (m_currentUser.id <= 0 || !m_dbManager || !m_activeSessionsList || !m_waitingSessionsList) return;
-    
-    // 清空列表
-    m_activeSessionsList->clear();
-    m_waitingSessionsList->clear();
-    m_itemToSessionId.clear();
-    m_sessions.clear();
-    
-    // 获取活跃会话
-    QList<ChatSession> activeSessions = m_dbManager->getActiveSessions();
+    if (m_currentUser.id <= 0 || !m_dbManager || !m_activeSessionsModel || !m_waitingSessionsModel) return;
     
-    for (const ChatSession& session : activeSessions) {
-        m_sessions[session.id] = session;
-        
-        QListWidgetItem* item = createSessionItem(session);
-        
-        if (session.status == 2) {
-            // 等待中的会话
-            m_waitingSessionsList->addItem(item);
-        } else if (session.status == 1 && session.staffId == m_currentUser.id) {
-            // 自己负责的进行中会话
-            m_activeSessionsList->addItem(item);
-        }
-        
-        m_itemToSessionId[item] = session.id;
-    }
+    // 首次全量加载，之后只按水位增量刷新
+    QList<ChatSession> sessions = m_dbManager->getSessionsChangedSince(QString(), &m_sessionWatermark);
+    m_waitingSessionsModel->resetSessions(sessions);
+    m_activeSessionsModel->resetSessions(sessions);
     
-    // 更新统计信息
-    if (m_waitingSessionsGroup && m_activeSessionsGroup) {
-        int waitingCount = m_waitingSessionsList->count();
-        int activeCount = m_activeSessionsList->count();
-        m_waitingSessionsGroup->setTitle(QString("等待接入 (%1)").arg(waitingCount));
-        m_activeSessionsGroup->setTitle(QString("进行中的对话 (%1)").arg(activeCount));
-    }
+    updateSessionListTitles();
 }
 
-QListWidgetItem* StaffChatManager::createSessionItem(const ChatSession& session)
+void StaffChatManager::updateSessionListTitles()
 {
-    QListWidgetItem* item = new QListWidgetItem;
-    
-    QString text = QString("%1\n最后消息: %2")
-                   .arg(session.patientName)
-                   .arg(formatTime(session.lastMessageAt));
-    
-    item->setText(text);
-    updateSessionItemStyle(item, session);
-    
-    return item;
-}
-
-void StaffChatManager::updateSessionItemStyle(QListWidgetItem* item, const ChatSession& session)
-{
-    if (session.status == 2) {
-        // 等待中 - 橙色
-        item->setBackground(QBrush(QColor("#FFF3CD")));
-        item->setForeground(QBrush(QColor("#856404")));
-    } else if (session.status == 1) {
-        // 进行中 - 绿色
-        item->setBackground(QBrush(QColor("#D4EDDA")));
-        item->setForeground(QBrush(QColor("#155724")));
-    }
+    // 分组标题上的计数每帧最多刷新一次
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::SessionBadges, [this]() {
+        if (m_waitingSessionsGroup && m_activeSessionsGroup) {
+            int waitingCount = m_waitingSessionsModel->rowCount();
+            int activeCount = m_activeSessionsModel->rowCount();
+            m_waitingSessionsGroup->setTitle(QString("等待接入 (%1)").arg(waitingCount));
+            m_activeSessionsGroup->setTitle(QString("进行中的对话 (%1)").arg(activeCount));
+        }
+    });
 }
 
 void StaffChatManager::onSessionSelectionChanged()
 {
-    QListWidgetItem* currentItem = m_activeSessionsList->currentItem();
-    if (!currentItem) return;
+    QModelIndex currentIndex = m_activeSessionsList->currentIndex();
+    if (!currentIndex.isValid()) return;
     
-    int sessionId = m_itemToSessionId.value(currentItem, -1);
+    int sessionId = currentIndex.data(SessionListModel::SessionIdRole).toInt();
     if (sessionId <= 0) return;
     
     m_currentSessionId = sessionId;
-    ChatSession session = m_sessions.value(sessionId);
+    ChatSession session = m_activeSessionsModel->session(sessionId);
     
     // 更新聊天标题
     m_chatTitleLabel->setText(QString("与 %1 的对话").arg(session.patientName));
@@ -535,17 +511,7 @@ void StaffChatManager::onSessionSelectionChanged()
         m_richMessageInput->setEnabled(false);
     }
     
-    // 清空消息区域
-    QLayoutItem* child;
-    while ((child = m_messageLayout->takeAt(0)) != nullptr) {
-        if (child->widget()) {
-            delete child->widget();
-        }
-        delete child;
-    }
-    m_messageLayout->addStretch();
-    
-    // 加载聊天历史
+    // 加载聊天历史（整体替换模型内容）
     loadChatHistory(sessionId);
     
     // 更新客户信息面板
@@ -562,10 +528,98 @@ void StaffChatManager::onSessionSelectionChanged()
 
 void StaffChatManager::loadChatHistory(int sessionId)
 {
-    QList<ChatMessage> messages = m_dbManager->getChatMessages(sessionId);
+    if (sessionId == m_currentTranscriptSessionId && m_currentTranscript) {
+        syncTranscript(m_currentTranscript, sessionId);
+        return;
+    }
     
-    for (const ChatMessage& message : messages) {
-        addMessage(message);
+    // 当前显示的模型放回缓存
+    releaseCurrentTranscript();
+    
+    ChatTranscriptModel* transcript = m_transcriptCache.take(sessionId);
+    if (transcript) {
+        // 缓存命中：只补齐离开期间的新消息，行高和排版结果都保留
+        syncTranscript(transcript, sessionId);
+    } else {
+        transcript = createTranscript(sessionId);
+    }
+    
+    m_currentTranscript = transcript;
+    m_currentTranscriptSessionId = sessionId;
+    m_transcriptView->setTranscriptModel(transcript);
+    
+    // 点击处理完成后再预取相邻会话
+    QTimer::singleShot(0, this, &StaffChatManager::prefetchNeighbourSessions);
+}
+
+ChatTranscriptModel* StaffChatManager::createTranscript(int sessionId)
+{
+    // 只加载最新一页，打开长会话与短会话耗时相同
+    QList<ChatMessage> messages = ChatHistoryLoader::instance()->loadLatestPage(sessionId);
+    ChatTranscriptModel* transcript = new ChatTranscriptModel;
+    transcript->setMessages(messages);
+    transcript->setHistorySource(sessionId, messages.size() >= ChatHistoryLoader::PAGE_SIZE);
+    return transcript;
+}
+
+void StaffChatManager::syncTranscript(ChatTranscriptModel* transcript, int sessionId)
+{
+    // 补齐的消息一次性插入
+    transcript->appendMessages(m_dbManager->getChatMessagesAfter(sessionId, transcript->lastMessageId()));
+}
+
+void StaffChatManager::releaseCurrentTranscript()
+{
+    if (!m_currentTranscript) {
+        return;
+    }
+    
+    m_transcriptView->setTranscriptModel(nullptr);
+    m_transcriptCache.insert(m_currentTranscriptSessionId, m_currentTranscript);
+    m_currentTranscript = nullptr;
+    m_currentTranscriptSessionId = -1;
+}
+
+void StaffChatManager::dropTranscript(int sessionId)
+{
+    if (sessionId == m_currentTranscriptSessionId) {
+        m_transcriptView->setTranscriptModel(nullptr);
+        delete m_currentTranscript;
+        m_currentTranscript = nullptr;
+        m_currentTranscriptSessionId = -1;
+    }
+    m_transcriptCache.remove(sessionId);
+}
+
+void StaffChatManager::prefetchNeighbourSessions()
+{
+    QModelIndex current = m_activeSessionsModel->indexOfSession(m_currentTranscriptSessionId);
+    if (!current.isValid()) {
+        return;
+    }
+    
+    // 数据库连接只能在主线程使用，预取放在事件循环空闲时进行
+    for (int offset : {-1, 1}) {
+        QModelIndex neighbour = current.siblingAtRow(current.row() + offset);
+        if (!neighbour.isValid()) {
+            continue;
+        }
+        
+        int sessionId = neighbour.data(SessionListModel::SessionIdRole).toInt();
+        if (sessionId <= 0 || m_transcriptCache.contains(sessionId)) {
+            continue;
+        }
+        
+        m_transcriptCache.insert(sessionId, createTranscript(sessionId));
+    }
+}
+
+void StaffChatManager::appendToCachedTranscript(const SharedRichChatMessage& message)
+{
+    // 后台会话的新消息直接追加到缓存的模型，切换回来时无需重新加载
+    ChatTranscriptModel* transcript = m_transcriptCache.object(message->sessionId);
+    if (transcript && message->id > transcript->lastMessageId()) {
+        transcript->appendRichMessage(message);
     }
 }
 
@@ -576,13 +630,10 @@ void StaffChatManager::onAcceptSession(int sessionId)
         refreshSessionList();
         
         // 自动选择这个会话
-        for (int i = 0; i < m_activeSessionsList->count(); ++i) {
-            QListWidgetItem* item = m_activeSessionsList->item(i);
-            if (m_itemToSessionId.value(item) == sessionId) {
-                m_activeSessionsList->setCurrentItem(item);
-                onSessionSelectionChanged();
-                break;
-            }
+        QModelIndex index = m_activeSessionsModel->indexOfSession(sessionId);
+        if (index.isValid()) {
+            m_activeSessionsList->setCurrentIndex(index);
+            onSessionSelectionChanged();
         }
     }
 }
@@ -610,15 +661,8 @@ void StaffChatManager::onCloseSession(int sessionId)
                 m_quickReplyGroup->setVisible(false);
             }
             
-            // 清空消息区域
-            QLayoutItem* child;
-            while ((child = m_messageLayout->takeAt(0)) != nullptr) {
-                if (child->widget()) {
-                    delete child->widget();
-                }
-                delete child;
-            }
-            m_messageLayout->addStretch();
+            // 清空消息区域，已结束会话的缓存一并丢弃
+            dropTranscript(sessionId);
             
             // 刷新会话列表
             refreshSessionList();
@@ -651,29 +695,31 @@ void StaffChatManager::onSendMessage()
         message.messageType = 0;
         message.isRead = 1;
         
-        addMessage(message);
+        addMessage(RichChatMessage::fromChatMessage(message));
     }
 }
 
-void StaffChatManager::onMessageReceived(const ChatMessage& message)
+void StaffChatManager::onMessageReceived(const SharedRichChatMessage& message)
 {
-    // 如果是当前会话的消息且不是自己发送的，显示消息
-    if (message.sessionId == m_currentSessionId && message.senderId != m_currentUser.id) {
+    // 如果是当前会话的消息且不是自己发送的，显示消息（模型直接保存共享句柄）
+    if (message->sessionId == m_currentSessionId && message->senderId != m_currentUser.id) {
         addMessage(message);
-        m_dbManager->markMessageAsRead(message.id);
+        m_dbManager->markMessageAsRead(message->id);
+    } else if (message->sessionId != m_currentSessionId) {
+        appendToCachedTranscript(message);
     }
     
     // 刷新会话列表以更新最后消息时间
     refreshSessionList();
 }
 
-void StaffChatManager::onSessionCreated(const ChatSession& session)
+void StaffChatManager::onSessionCreated(const SharedChatSession& session)
 {
     // 新会话创建，刷新列表
     refreshSessionList();
 }
 
-void StaffChatManager::onSessionUpdated(const ChatSession& session)
+void StaffChatManager::onSessionUpdated(const SharedChatSession& session)
 {
     // 会话更新，刷新列表
     refreshSessionList();
@@ -686,157 +732,64 @@ void StaffChatManager::checkForNewSessions()
 
 void StaffChatManager::checkForNewMessages()
 {
-    if (m_currentSessionId <= 0) return;
+    if (m_currentUser.id <= 0 || !m_dbManager) return;
     
     // 获取未读消息
     QList<ChatMessage> unreadMessages = m_dbManager->getUnreadMessages(m_currentUser.id);
     
     for (const ChatMessage& message : unreadMessages) {
         if (message.sessionId == m_currentSessionId && message.senderId != m_currentUser.id) {
-            addMessage(message);
+            addMessage(RichChatMessage::fromChatMessage(message));
             m_dbManager->markMessageAsRead(message.id);
+        } else if (message.sessionId != m_currentSessionId) {
+            // 其他会话保持未读，只更新缓存
+            appendToCachedTranscript(RichChatMessage::fromChatMessage(message));
         }
     }
 }
 
 void StaffChatManager::refreshSessionList()
 {
-    // 保存当前选择
-    int currentSelectedId = m_currentSessionId;
+    if (m_currentUser.id <= 0 || !m_dbManager || !m_activeSessionsModel || !m_waitingSessionsModel) return;
     
-    // 重新加载
-    loadSessionList();
+    if (m_sessionWatermark.isEmpty()) {
+        loadSessionList();
+        return;
+    }
     
-    // 恢复选择
-    if (currentSelectedId > 0) {
-        for (int i = 0; i < m_activeSessionsList->count(); ++i) {
-            QListWidgetItem* item = m_activeSessionsList->item(i);
-            if (m_itemToSessionId.value(item) == currentSelectedId) {
-                m_activeSessionsList->setCurrentItem(item);
-                break;
-            }
+    // 只取上次水位之后变化的会话，按ID增量插入/移动/更新/删除，选中项和滚动位置不受影响
+    QList<ChatSession> changedSessions = m_dbManager->getSessionsChangedSince(m_sessionWatermark, &m_sessionWatermark);
+    m_waitingSessionsModel->applyChanges(changedSessions);
+    m_activeSessionsModel->applyChanges(changedSessions);
+    
+    // 已结束的会话不再保留缓存
+    for (const ChatSession& session : changedSessions) {
+        if (session.status == 0 && session.id != m_currentTranscriptSessionId) {
+            m_transcriptCache.remove(session.id);
         }
     }
-}
-
-void StaffChatManager::addMessage(const ChatMessage& message)
-{
-    QWidget* messageBubble;
-    
-    // 检查是否是富文本消息
-    if (message.content.contains("[RICH_TEXT]") && message.content.contains("[HTML]")) {
-        // 解析富文本消息
-        RichChatMessage richMessage;
-        parseRichTextMessage(message, richMessage);
-        messageBubble = createRichMessageBubble(richMessage);
-    } else {
-        // 普通消息
-        messageBubble = createMessageBubble(message);
-    }
     
-    // 移除stretch，添加消息，再添加stretch
-    QLayoutItem* stretch = m_messageLayout->takeAt(m_messageLayout->count() - 1);
-    m_messageLayout->addWidget(messageBubble);
-    m_messageLayout->addItem(stretch);
+    updateSessionListTitles();
     
-    // 滚动到底部
-    QTimer::singleShot(50, this, &StaffChatManager::scrollToBottom);
+    // "x分钟前"在绘制时计算，重绘可见行即可更新
+    m_waitingSessionsList->viewport()->update();
+    m_activeSessionsList->viewport()->update();
 }
 
-QWidget* StaffChatManager::createMessageBubble(const ChatMessage& message)
+void StaffChatManager::addMessage(const SharedRichChatMessage& message)
 {
-    QWidget* bubble = new QWidget;
-    QHBoxLayout* layout = new QHBoxLayout(bubble);
-    layout->setContentsMargins(0, 0, 0, 0);
-    
-    // 创建消息内容
-    QFrame* messageFrame = new QFrame;
-    QVBoxLayout* frameLayout = new QVBoxLayout(messageFrame);
-    frameLayout->setContentsMargins(12, 8, 12, 8);
-    frameLayout->setSpacing(4);
-    
-    // 发送者名称和时间
-    QLabel* headerLabel = new QLabel;
-    QString headerText = QString("%1  %2").arg(message.senderName).arg(formatTime(message.timestamp));
-    headerLabel->setText(headerText);
-    headerLabel->setStyleSheet("font-size: 11px; color: #8E8E93;");
-    frameLayout->addWidget(headerLabel);
-    
-    // 消息内容
-    QLabel* contentLabel = new QLabel(message.content);
-    contentLabel->setWordWrap(true);
-    contentLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
-    frameLayout->addWidget(contentLabel);
-    
-    // 根据发送者设置样式和对齐
-    if (message.senderId == m_currentUser.id) {
-        // 自己的消息 - 右对齐，蓝色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #007AFF;
-                border-radius: 18px;
-                max-width: 300px;
-            }
-        )");
-        contentLabel->setStyleSheet("color: white; font-size: 14px;");
-        headerLabel->setStyleSheet("font-size: 11px; color: rgba(255,255,255,0.8);");
-        
-    } else if (message.messageType == 1) {
-        // 系统消息 - 居中，灰色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #F2F2F7;
-                border-radius: 18px;
-                max-width: 250px;
-            }
-        )");
-        contentLabel->setStyleSheet("color: #8E8E93; font-size: 13px; text-align: center;");
-        
-    } else {
-        // 对方的消息 - 左对齐，灰色
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #E5E5EA;
-                border-radius: 18px;
-                max-width: 300px;
-            }
-        )");
-        contentLabel->setStyleSheet("color: #000000; font-size: 14px;");
-    }
+    // 突发的多条消息在下一帧一次性插入
+    m_transcriptView->transcriptModel()->queueRichMessage(message);
     
-    return bubble;
+    // 滚动请求合并到下一帧
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::ScrollToBottom, [this]() {
+        scrollToBottom();
+    });
 }
 
 void StaffChatManager::scrollToBottom()
 {
-    QScrollBar* scrollBar = m_messageScrollArea->verticalScrollBar();
-    scrollBar->setValue(scrollBar->maximum());
-}
-
-QString StaffChatManager::formatTime(const QDateTime& time)
-{
-    QDateTime now = QDateTime::currentDateTime();
-    qint64 secs = time.secsTo(now);
-    
-    if (secs < 60) {
-        return "刚刚";
-    } else if (secs < 3600) {
-        return QString("%1分钟前").arg(secs / 60);
-    } else if (time.date() == now.date()) {
-        return time.toString("hh:mm");
-    } else {
-        return time.toString("MM-dd hh:mm");
-    }
+    m_transcriptView->scrollToBottom();
 }
 
 bool StaffChatManager::eventFilter(QObject* obj, QEvent* event)
@@ -1009,35 +962,32 @@ void StaffChatManager::insertImageIntoEditor(const QString& imagePath)
     QFileInfo fileInfo(imagePath);
     if (!fileInfo.exists()) return;
     
-    // 读取图片并调整大小
-    QPixmap pixmap(imagePath);
-    if (pixmap.isNull()) return;
+    // 只读取文件头获取尺寸，解码交给后台图片管线
+    QImageReader reader(imagePath);
+    if (!reader.canRead()) return;
+    QSize displaySize = ImagePipeline::fitSize(reader.size(), ImagePipeline::BUBBLE_SIZE);
     
-    // 限制图片大小为300x300
-    int maxSize = 300;
-    if (pixmap.width() > maxSize || pixmap.height() > maxSize) {
-        pixmap = pixmap.scaled(maxSize, maxSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    // 原图按内容哈希存入附件库，消息中只保留引用
+    QString hash = AttachmentStore::instance()->storeFile(imagePath);
+    if (hash.isEmpty()) {
+        QMessageBox::warning(this, "错误", "图片保存失败！");
+        return;
     }
     
-    // 将图片转换为Base64编码
-    QBuffer buffer;
-    buffer.open(QIODevice::WriteOnly);
-    pixmap.save(&buffer, "PNG");
-    QByteArray imageData = buffer.data();
-    QString base64Data = imageData.toBase64();
+    // 编辑器先显示占位图，缩略图解码完成后自动替换
+    QUrl imageUrl = AttachmentStore::attachmentUrl(hash);
+    QTextDocument* document = m_richMessageInput->document();
+    document->addResource(QTextDocument::ImageResource, imageUrl,
+                          ImagePipeline::instance()->attachToDocument(document, imageUrl, hash));
     
-    // 创建带有Base64数据的HTML图片标签
-    QString imageHtml = QString("<img src=\"data:image/png;base64,%1\" width=\"%2\" height=\"%3\" />")
-                       .arg(base64Data)
-                       .arg(pixmap.width())
-                       .arg(pixmap.height());
+    QString imageHtml = QString("<img src=\"%1\" width=\"%2\" height=\"%3\" />")
+                       .arg(imageUrl.toString())
+                       .arg(displaySize.width())
+                       .arg(displaySize.height());
     
-    // 插入图片HTML
     QTextCursor cursor = m_richMessageInput->textCursor();
     cursor.insertHtml(imageHtml);
     m_richMessageInput->setTextCursor(cursor);
-    
-    qDebug() << "客服端插入图片，Base64长度:" << base64Data.length() << "尺寸:" << pixmap.size();
 }
 
 void StaffChatManager::insertFileIntoEditor(const QString& filePath)
@@ -1045,14 +995,20 @@ void StaffChatManager::insertFileIntoEditor(const QString& filePath)
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) return;
     
+    QString hash = AttachmentStore::instance()->storeFile(filePath);
+    if (hash.isEmpty()) {
+        QMessageBox::warning(this, "错误", "文件保存失败！");
+        return;
+    }
+    
     QString fileName = fileInfo.fileName();
     QString fileSize = QString::number(fileInfo.size() / 1024.0, 'f', 1) + " KB";
     
     // 插入文件链接
     QTextCursor cursor = m_richMessageInput->textCursor();
-    QString fileHtml = QString("<p>📎 <a href=\"file:///%1\">%2</a> (%3)</p>")
-                      .arg(filePath)
-                      .arg(fileName)
+    QString fileHtml = QString("<p>📎 <a href=\"%1\">%2</a> (%3)</p>")
+                      .arg(AttachmentStore::attachmentUrl(hash).toString())
+                      .arg(fileName.toHtmlEscaped())
                       .arg(fileSize);
     
     cursor.insertHtml(fileHtml);
@@ -1073,40 +1029,19 @@ void StaffChatManager::onSendRichMessage()
     QString plainText = m_richMessageInput->toPlainText().trimmed();
     QString htmlContent = m_richMessageInput->toHtml();
     
-    // 创建富文本消息
+    // 创建富文本消息，附件引用在构造信封时一并提取
     RichChatMessage message;
+    static_cast<RichMessageEnvelope&>(message) = RichMessageEnvelope::fromEditor(plainText, htmlContent);
     message.sessionId = m_currentSessionId;
     message.senderId = m_currentUser.id;
     message.senderName = m_currentUser.realName.isEmpty() ? m_currentUser.username : m_currentUser.realName;
     message.senderRole = m_currentUser.role;
-    message.content = plainText;
-    message.htmlContent = htmlContent;
-    message.contentType = RichContentType::RichText;
     message.timestamp = QDateTime::currentDateTime();
     message.messageType = 0;
     message.isRead = 1;
     
-    // 检查是否包含图片或文件
-    QTextDocument* doc = m_richMessageInput->document();
-    QTextBlock block = doc->firstBlock();
-    while (block.isValid()) {
-        QTextBlock::iterator it;
-        for (it = block.begin(); !(it.atEnd()); ++it) {
-            QTextFragment fragment = it.fragment();
-            if (fragment.isValid()) {
-                QTextCharFormat format = fragment.charFormat();
-                if (format.isImageFormat()) {
-                    QTextImageFormat imageFormat = format.toImageFormat();
-                    message.attachments.append(imageFormat.name());
-                    message.contentType = RichContentType::Mixed;
-                }
-            }
-        }
-        block = block.next();
-    }
-    
-    // 保存到数据库
-    saveRichChatHistory(message);
+    // 保存到数据库，记下消息ID以便缓存补齐时不重复
+    message.id = saveRichChatHistory(message);
     
     // 显示消息
     addRichMessage(message);
@@ -1117,128 +1052,26 @@ void StaffChatManager::onSendRichMessage()
 
 void StaffChatManager::addRichMessage(const RichChatMessage& message)
 {
-    QWidget* messageBubble = createRichMessageBubble(message);
+    m_transcriptView->transcriptModel()->queueRichMessage(message);
     
-    // 移除stretch，添加消息，再添加stretch
-    QLayoutItem* stretch = m_messageLayout->takeAt(m_messageLayout->count() - 1);
-    m_messageLayout->addWidget(messageBubble);
-    m_messageLayout->addItem(stretch);
-    
-    // 滚动到底部
-    QTimer::singleShot(50, this, &StaffChatManager::scrollToBottom);
+    // 滚动请求合并到下一帧
+    UpdateScheduler::instance()->schedule(this, UpdateScheduler::ScrollToBottom, [this]() {
+        scrollToBottom();
+    });
 }
 
-QWidget* StaffChatManager::createRichMessageBubble(const RichChatMessage& message)
+int StaffChatManager::saveRichChatHistory(const RichChatMessage& message)
 {
-    QWidget* bubble = new QWidget;
-    QHBoxLayout* layout = new QHBoxLayout(bubble);
-    layout->setContentsMargins(0, 0, 0, 0);
-    
-    // 创建消息内容
-    QFrame* messageFrame = new QFrame;
-    QVBoxLayout* frameLayout = new QVBoxLayout(messageFrame);
-    frameLayout->setContentsMargins(12, 8, 12, 8);
-    frameLayout->setSpacing(4);
-    
-    // 发送者名称和时间
-    QLabel* headerLabel = new QLabel;
-    QString headerText = QString("%1  %2").arg(message.senderName).arg(formatTime(message.timestamp));
-    headerLabel->setText(headerText);
-    headerLabel->setStyleSheet("font-size: 11px; color: #8E8E93;");
-    frameLayout->addWidget(headerLabel);
-    
-    // 消息内容
-    QTextBrowser* contentBrowser = new QTextBrowser;
-    contentBrowser->setMaximumHeight(300);
-    contentBrowser->setOpenExternalLinks(false);
-    contentBrowser->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    contentBrowser->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    
-    // 设置内容
-    if (message.contentType == RichContentType::RichText || message.contentType == RichContentType::Mixed) {
-        contentBrowser->setHtml(message.htmlContent);
-    } else {
-        contentBrowser->setPlainText(message.content);
-    }
-    
-    frameLayout->addWidget(contentBrowser);
-    
-    // 根据发送者设置样式和对齐
-    if (message.senderId == m_currentUser.id) {
-        // 自己的消息 - 右对齐，蓝色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #007AFF;
-                border-radius: 18px;
-                max-width: 400px;
-            }
-        )");
-        contentBrowser->setStyleSheet("color: white; font-size: 14px; background: transparent; border: none;");
-        headerLabel->setStyleSheet("font-size: 11px; color: rgba(255,255,255,0.8);");
-        
-    } else if (message.messageType == 1) {
-        // 系统消息 - 居中，灰色
-        layout->addStretch();
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #F2F2F7;
-                border-radius: 18px;
-                max-width: 300px;
-            }
-        )");
-        contentBrowser->setStyleSheet("color: #8E8E93; font-size: 13px; text-align: center; background: transparent; border: none;");
-        
-    } else {
-        // 对方的消息 - 左对齐，灰色
-        layout->addWidget(messageFrame);
-        layout->addStretch();
-        
-        messageFrame->setStyleSheet(R"(
-            QFrame {
-                background-color: #E5E5EA;
-                border-radius: 18px;
-                max-width: 400px;
-            }
-        )");
-        contentBrowser->setStyleSheet("color: #000000; font-size: 14px; background: transparent; border: none;");
-    }
+    if (!m_dbManager) return -1;
     
-    return bubble;
-}
-
-void StaffChatManager::saveRichChatHistory(const RichChatMessage& message)
-{
-    if (!m_dbManager) return;
-    
-    // 这里需要扩展数据库以支持富文本内容
-    // 暂时使用JSON格式存储富文本数据
-    // TODO: 实现富文本数据库存储
-    
-    // 临时转换为普通ChatMessage以保持兼容性
-    ChatMessage tempMessage;
-    tempMessage.sessionId = message.sessionId;
-    tempMessage.senderId = message.senderId;
-    tempMessage.senderName = message.senderName;
-    tempMessage.senderRole = message.senderRole;
-    tempMessage.content = message.content; // 使用纯文本内容
-    tempMessage.timestamp = message.timestamp;
-    tempMessage.messageType = message.messageType;
-    tempMessage.isRead = message.isRead;
-    
-    // 暂时保存为普通消息
-    int messageId = m_dbManager->sendMessage(tempMessage.sessionId, tempMessage.senderId, 
-                                           tempMessage.content, tempMessage.messageType);
+    // 纯文本、HTML和附件引用分字段保存
+    int messageId = m_dbManager->sendRichMessage(message.sessionId, message.senderId, 
+                                               message, message.messageType);
     
     if (messageId > 0) {
-        // 这里可以在将来添加富文本扩展信息的保存
-        qDebug() << "富文本消息已保存为普通消息，ID:" << messageId;
+        qDebug() << "富文本消息已保存，ID:" << messageId;
     }
+    return messageId;
 }
 
 void StaffChatManager::onRichMessageReceived(const RichChatMessage& message)
@@ -1253,61 +1086,6 @@ void StaffChatManager::onRichMessageReceived(const RichChatMessage& message)
     refreshSessionList();
 }
 
-void StaffChatManager::parseRichTextMessage(const ChatMessage& chatMessage, RichChatMessage& richMessage)
-{
-    // 初始化富文本消息结构
-    richMessage.sessionId = chatMessage.sessionId;
-    richMessage.senderId = chatMessage.senderId;
-    richMessage.senderName = chatMessage.senderName;
-    richMessage.senderRole = chatMessage.senderRole;
-    richMessage.timestamp = chatMessage.timestamp;
-    richMessage.messageType = chatMessage.messageType;
-    richMessage.isRead = chatMessage.isRead;
-    
-    QString fullContent = chatMessage.content;
-    
-    // 解析富文本标记 - 使用DotMatchesEverything选项处理多行HTML
-    QRegularExpression richTextRegex("\\[RICH_TEXT\\](.*?)\\[/RICH_TEXT\\]", QRegularExpression::DotMatchesEverythingOption);
-    QRegularExpressionMatch richTextMatch = richTextRegex.match(fullContent);
-    
-    QRegularExpression htmlRegex("\\[HTML\\](.*?)\\[/HTML\\]", QRegularExpression::DotMatchesEverythingOption);
-    QRegularExpressionMatch htmlMatch = htmlRegex.match(fullContent);
-    
-    if (richTextMatch.hasMatch() && htmlMatch.hasMatch()) {
-        // 这是一个富文本消息
-        richMessage.content = richTextMatch.captured(1);
-        richMessage.htmlContent = htmlMatch.captured(1);
-        
-        // 检查内容类型
-        if (richMessage.htmlContent.contains("<img")) {
-            richMessage.contentType = RichContentType::Mixed;
-        } else {
-            richMessage.contentType = RichContentType::RichText;
-        }
-        
-        qDebug() << "解析到富文本消息:" << richMessage.content;
-        qDebug() << "HTML内容长度:" << richMessage.htmlContent.length();
-        qDebug() << "HTML前100字符:" << richMessage.htmlContent.left(100);
-        
-        // 如果是完整的HTML文档，提取body内容
-        if (richMessage.htmlContent.contains("<!DOCTYPE") && richMessage.htmlContent.contains("<body")) {
-            QRegularExpression bodyRegex("<body[^>]*>(.*?)</body>", QRegularExpression::DotMatchesEverythingOption);
-            QRegularExpressionMatch bodyMatch = bodyRegex.match(richMessage.htmlContent);
-            if (bodyMatch.hasMatch()) {
-                richMessage.htmlContent = bodyMatch.captured(1);
-                qDebug() << "提取body内容，长度:" << richMessage.htmlContent.length();
-            }
-        }
-        
-    } else {
-        // 回退到普通文本
-        richMessage.content = fullContent;
-        richMessage.htmlContent = fullContent;
-        richMessage.contentType = RichContentType::Text;
-        qDebug() << "未找到富文本标记，使用普通文本模式";
-    }
-}
-
 // ========== 会话统计和评价管理 ==========
 
 void StaffChatManager::updateSessionStats()
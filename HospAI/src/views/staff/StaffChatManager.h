@@ -5,14 +5,14 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSplitter>
-#include <QListWidget>
-#include <QListWidgetItem>
+#include <QListView>
 #include <QScrollArea>
 #include <QLabel>
 #include <QTextEdit>
 #include <QPushButton>
 #include <QFrame>
 #include <QTimer>
+#include <QCache>
 #include <QGroupBox>
 #include <QDateTime>
 #include <QToolBar>
@@ -26,6 +26,8 @@
 #include <QTextBrowser>
 #include "../../core/DatabaseManager.h"
 #include "../../core/RichMessageTypes.h"
+#include "../common/ChatTranscriptView.h"
+#include "SessionListModel.h"
 
 class StaffChatManager : public QWidget
 {
@@ -46,10 +48,10 @@ private slots:
     void onSendRichMessage();
     void onAcceptSession(int sessionId);
     void onCloseSession(int sessionId);
-    void onMessageReceived(const ChatMessage& message);
+    void onMessageReceived(const SharedRichChatMessage& message);
     void onRichMessageReceived(const RichChatMessage& message);
-    void onSessionCreated(const ChatSession& session);
-    void onSessionUpdated(const ChatSession& session);
+    void onSessionCreated(const SharedChatSession& session);
+    void onSessionUpdated(const SharedChatSession& session);
     void checkForNewSessions();
     void checkForNewMessages();
     void refreshSessionList();
@@ -84,20 +86,21 @@ private:
     void setupWaitingList();
     void loadSessionList();
     void loadChatHistory(int sessionId);
-    void addMessage(const ChatMessage& message);
+    ChatTranscriptModel* createTranscript(int sessionId);
+    void syncTranscript(ChatTranscriptModel* transcript, int sessionId);
+    void releaseCurrentTranscript();
+    void dropTranscript(int sessionId);
+    void prefetchNeighbourSessions();
+    void appendToCachedTranscript(const SharedRichChatMessage& message);
+    void addMessage(const SharedRichChatMessage& message);
     void addRichMessage(const RichChatMessage& message);
     void scrollToBottom();
-    QWidget* createMessageBubble(const ChatMessage& message);
-    QWidget* createRichMessageBubble(const RichChatMessage& message);
-    QListWidgetItem* createSessionItem(const ChatSession& session);
-    QString formatTime(const QDateTime& time);
-    void updateSessionItemStyle(QListWidgetItem* item, const ChatSession& session);
+    void updateSessionListTitles();
     
     // 富文本处理方法
     void insertImageIntoEditor(const QString& imagePath);
     void insertFileIntoEditor(const QString& filePath);
-    void saveRichChatHistory(const RichChatMessage& message);
-    void parseRichTextMessage(const ChatMessage& chatMessage, RichChatMessage& richMessage);
+    int saveRichChatHistory(const RichChatMessage& message);
     
     // 客户信息和快捷回复方法
     void updateCustomerInfo(int sessionId);
@@ -111,9 +114,11 @@ private:
     QWidget* m_leftPanel;
     QVBoxLayout* m_leftLayout;
     QGroupBox* m_activeSessionsGroup;
-    QListWidget* m_activeSessionsList;
+    QListView* m_activeSessionsList;
     QGroupBox* m_waitingSessionsGroup;
-    QListWidget* m_waitingSessionsList;
+    QListView* m_waitingSessionsList;
+    SessionListModel* m_activeSessionsModel;
+    SessionListModel* m_waitingSessionsModel;
     QLabel* m_statsLabel;
     QLabel* m_ratingLabel;
     QPushButton* m_viewRatingsButton;
@@ -148,9 +153,12 @@ private:
     QFontComboBox* m_fontComboBox;
     QSpinBox* m_fontSizeSpinBox;
     
-    QScrollArea* m_messageScrollArea;
-    QWidget* m_messageContainer;
-    QVBoxLayout* m_messageLayout;
+    ChatTranscriptView* m_transcriptView;
+    
+    // 会话聊天记录缓存：当前显示的模型单独持有，其余按LRU保留
+    QCache<int, ChatTranscriptModel> m_transcriptCache;
+    ChatTranscriptModel* m_currentTranscript;
+    int m_currentTranscriptSessionId;
     
     // 输入区域
     QHBoxLayout* m_inputLayout;
@@ -170,9 +178,8 @@ private:
     // 状态
     bool m_isRichMode;               // 是否启用富文本模式
     
-    // 会话映射
-    QMap<int, ChatSession> m_sessions;
-    QMap<QListWidgetItem*, int> m_itemToSessionId;
+    // 会话列表增量刷新水位（最大的 last_message_at）
+    QString m_sessionWatermark;
 };
 
 #endif // STAFFCHATMANAGER_H 
\ No newline at end of file
@@ -16,7 +16,6 @@ StaffWindow::StaffWindow(QWidget *parent)
     , m_actSettings(nullptr)
 {
     setWindowTitle("医院智慧客服系统 - 客服端");
-    createWidgets();
     setupToolBar();
 }
 
@@ -32,22 +31,24 @@ void StaffWindow::setupMenu()
 
 void StaffWindow::setupFunctionWidgets()
 {
-    // 添加功能页面到堆叠widget
-    addFunctionWidget(m_recordWidget, "提问记录");
-    addFunctionWidget(m_statsWidget, "问题统计");
-    addFunctionWidget(m_manualChatWidget, "人工接管");
+    // 按菜单顺序注册页面，切换到页面时才创建，空闲时预取下一个
+    registerPage("人工接管", [this]() {
+        m_manualChatWidget = new ManualChatWidget(this);
+        return m_manualChatWidget;
+    });
+    registerPage("提问记录", [this]() {
+        m_recordWidget = new RecordWidget(this);
+        return m_recordWidget;
+    });
+    registerPage("问题统计", [this]() {
+        m_statsWidget = new StatsWidget(this);
+        return m_statsWidget;
+    });
     
     // 默认显示记录页面
     setCurrentWidget("提问记录");
 }
 
-void StaffWindow::createWidgets()
-{
-    m_recordWidget = new RecordWidget(this);
-    m_statsWidget = new StatsWidget(this);
-    m_manualChatWidget = new ManualChatWidget(this);
-}
-
 void StaffWindow::setupToolBar()
 {
     m_toolBar = addToolBar("工具栏");
@@ -30,11 +30,10 @@ private slots:
     void onSettingsClicked();
 
 private:
-    void createWidgets();
     void setupToolBar();
 
 private:
-    // 功能组件
+    // 功能组件，首次访问对应页面时才创建
     RecordWidget* m_recordWidget;
     StatsWidget* m_statsWidget;
     ManualChatWidget* m_manualChatWidget;
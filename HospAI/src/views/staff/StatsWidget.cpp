@@ -24,6 +24,7 @@ StatsWidget::StatsWidget(QWidget *parent)
     , m_tableStats(nullptr)
     , m_currentTimeRange(TimeRange::Last7Days)
     , m_isLoading(false)
+    , m_statsLoaded(false)
     , m_currentSortColumn(-1)
     , m_currentSortOrder(Qt::DescendingOrder)
 {
@@ -35,9 +36,17 @@ StatsWidget::StatsWidget(QWidget *parent)
     m_refreshTimer->setSingleShot(false);
     m_refreshTimer->setInterval(AUTO_REFRESH_INTERVAL);
     connect(m_refreshTimer, &QTimer::timeout, this, &StatsWidget::updateStatistics);
+}
+
+void StatsWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
     
-    // 加载初始数据
-    QTimer::singleShot(100, this, &StatsWidget::updateStatistics);
+    // 页面可能被提前创建，初始数据推迟到首次显示时加载
+    if (!m_statsLoaded) {
+        m_statsLoaded = true;
+        QTimer::singleShot(100, this, &StatsWidget::updateStatistics);
+    }
 }
 
 StatsWidget::~StatsWidget()
@@ -72,6 +72,10 @@ public:
     explicit StatsWidget(QWidget *parent = nullptr);
     ~StatsWidget();
 
+protected:
+    // 首次显示时才加载统计数据
+    void showEvent(QShowEvent* event) override;
+
 private slots:
     // 数据刷新和筛选
     void onRefreshStatsClicked();
@@ -207,6 +211,7 @@ private:
     QDateTime m_customEndDate;
     QTimer* m_refreshTimer;
     bool m_isLoading;
+    bool m_statsLoaded;
     int m_currentSortColumn;
     Qt::SortOrder m_currentSortOrder;
     
@@ -0,0 +1,90 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include "src/core/AIApiClient.h"
+#include "src/core/DatabaseManager.h"
+#include "tools/MockLlmServer.h"
+
+static const int REQUEST_TIMEOUT_MS = 2000;
+
+// 请求超时与重试：超时后在 RETRY_BUDGET_FACTOR 倍超时的预算内重试一次，
+// 重试的超时缩短到剩余预算，总等待不超出预算
+class TestAIApiClient : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void answersWithinTimeout();
+    void retriesAfterTimeout();
+
+private:
+    bool sendAndWait(AIApiClient& client, const QString& text, AIApiClient::Response* response);
+};
+
+void TestAIApiClient::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(DatabaseManager::instance()->initDatabase());
+}
+
+bool TestAIApiClient::sendAndWait(AIApiClient& client, const QString& text, AIApiClient::Response* response)
+{
+    AIApiClient::RequestOptions options;
+    options.tier = AIModelRouter::FastTier;
+    options.timeoutMs = REQUEST_TIMEOUT_MS;
+    options.useCache = false;
+
+    bool done = false;
+    client.sendTriageRequest(text, QString(), &client, [&](const AIApiClient::Response& result) {
+        *response = result;
+        done = true;
+    }, options);
+    return QTest::qWaitFor([&]() { return done; }, 4 * REQUEST_TIMEOUT_MS);
+}
+
+void TestAIApiClient::answersWithinTimeout()
+{
+    MockLlmServer::Options serverOptions;
+    serverOptions.latencyMs = REQUEST_TIMEOUT_MS / 2;
+    serverOptions.jitterMs = 0;
+    MockLlmServer server(serverOptions);
+    QVERIFY(server.start());
+
+    AIApiClient client;
+    client.setApiConfig(server.baseUrl(), "test-key", "mock-model");
+    AIApiClient::Response response;
+
+    QVERIFY(sendAndWait(client, "最近有点头晕，怎么办", &response));
+    QVERIFY(response.success);
+    QVERIFY(!response.timedOut);
+    QCOMPARE(response.attempts, 1);
+    QCOMPARE(server.stats().requests, 1);
+}
+
+void TestAIApiClient::retriesAfterTimeout()
+{
+    // 服务端每次都比超时慢：第一次超时后仍有预算，应再发一次，第二次也超时后放弃
+    MockLlmServer::Options serverOptions;
+    serverOptions.latencyMs = REQUEST_TIMEOUT_MS * 5 / 2;
+    serverOptions.jitterMs = 0;
+    MockLlmServer server(serverOptions);
+    QVERIFY(server.start());
+
+    AIApiClient client;
+    client.setApiConfig(server.baseUrl(), "test-key", "mock-model");
+    AIApiClient::Response response;
+
+    QVERIFY(sendAndWait(client, "最近有点头晕，怎么办", &response));
+    QVERIFY(!response.success);
+    QVERIFY(response.timedOut);
+    QCOMPARE(response.attempts, 2);
+    QCOMPARE(server.stats().requests, 2);
+
+    // 第二次的超时只用剩余预算，留出计时器的误差
+    QVERIFY2(response.latencyMs <= AIApiClient::RETRY_BUDGET_FACTOR * REQUEST_TIMEOUT_MS + 200,
+             qPrintable(QString("总等待 %1 ms").arg(response.latencyMs)));
+}
+
+QTEST_MAIN(TestAIApiClient)
+#include "tst_aiapiclient.moc"
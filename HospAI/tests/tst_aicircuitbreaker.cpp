@@ -0,0 +1,142 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include "src/core/AICircuitBreaker.h"
+
+static const int OPEN_DURATION_MS = 200;
+static const int MAX_OPEN_DURATION_MS = 800;
+
+// AI熔断器：按失败率和连续失败打开，冷却后只放行一个探测请求，探测失败时冷却时间加倍。
+// 每个用例单独构造冷却时间较短的实例；不打开数据库，状态切换不写库
+class TestAICircuitBreaker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void opensOnFailureRate();
+    void opensOnConsecutiveFailures();
+    void halfOpenAllowsSingleProbe();
+    void failedProbeDoublesOpenDuration();
+
+private:
+    static void openByFailures(AICircuitBreaker& breaker);
+    static void waitOpenDuration(const AICircuitBreaker& breaker);
+};
+
+void TestAICircuitBreaker::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestAICircuitBreaker::openByFailures(AICircuitBreaker& breaker)
+{
+    for (int i = 0; i < AICircuitBreaker::MAX_CONSECUTIVE_FAILURES; ++i) {
+        breaker.recordFailure();
+    }
+}
+
+// 多等一点，避免计时器误差
+void TestAICircuitBreaker::waitOpenDuration(const AICircuitBreaker& breaker)
+{
+    QTest::qWait(breaker.stats().openDurationMs + 50);
+}
+
+void TestAICircuitBreaker::opensOnFailureRate()
+{
+    AICircuitBreaker breaker(OPEN_DURATION_MS, MAX_OPEN_DURATION_MS);
+
+    // 成功失败交替，连续失败始终为 1；样本不足 MIN_SAMPLES 时不按失败率打开
+    for (int i = 0; i < AICircuitBreaker::MIN_SAMPLES - 1; ++i) {
+        if (i % 2 == 0) {
+            breaker.recordSuccess();
+        } else {
+            breaker.recordFailure();
+        }
+    }
+    QCOMPARE(breaker.state(), AICircuitBreaker::Closed);
+    QVERIFY(breaker.allowRequest());
+
+    // 第 8 个样本使失败率达到 50%
+    breaker.recordFailure();
+    QCOMPARE(breaker.state(), AICircuitBreaker::Open);
+    QCOMPARE(breaker.stats().opens, 1);
+    QCOMPARE(breaker.stats().consecutiveFailures, 1);
+    QVERIFY(!breaker.allowRequest());
+}
+
+void TestAICircuitBreaker::opensOnConsecutiveFailures()
+{
+    AICircuitBreaker breaker(OPEN_DURATION_MS, MAX_OPEN_DURATION_MS);
+
+    // 样本不足 MIN_SAMPLES，只有连续失败能打开
+    for (int i = 0; i < AICircuitBreaker::MAX_CONSECUTIVE_FAILURES - 1; ++i) {
+        breaker.recordFailure();
+    }
+    QCOMPARE(breaker.state(), AICircuitBreaker::Closed);
+    QVERIFY(breaker.allowRequest());
+
+    breaker.recordFailure();
+    QCOMPARE(breaker.state(), AICircuitBreaker::Open);
+    QCOMPARE(breaker.stats().windowSamples, AICircuitBreaker::MAX_CONSECUTIVE_FAILURES);
+    QVERIFY(!breaker.allowRequest());
+}
+
+void TestAICircuitBreaker::halfOpenAllowsSingleProbe()
+{
+    AICircuitBreaker breaker(OPEN_DURATION_MS, MAX_OPEN_DURATION_MS);
+    QSignalSpy stateSpy(&breaker, &AICircuitBreaker::stateChanged);
+    openByFailures(breaker);
+    QVERIFY(!breaker.allowRequest());
+
+    // 冷却结束后只放行一个探测请求，结果回来前其余请求仍然直接失败
+    waitOpenDuration(breaker);
+    QVERIFY(breaker.allowRequest());
+    QCOMPARE(breaker.state(), AICircuitBreaker::HalfOpen);
+    QVERIFY(!breaker.allowRequest());
+    QVERIFY(!breaker.allowRequest());
+
+    // 探测成功后恢复放行，重新开始统计
+    breaker.recordSuccess();
+    QCOMPARE(breaker.state(), AICircuitBreaker::Closed);
+    QCOMPARE(breaker.stats().windowSamples, 0);
+    QVERIFY(breaker.allowRequest());
+    QVERIFY(breaker.allowRequest());
+
+    QCOMPARE(stateSpy.size(), 3);
+    QCOMPARE(stateSpy.at(0).at(0).toInt(), int(AICircuitBreaker::Open));
+    QCOMPARE(stateSpy.at(1).at(0).toInt(), int(AICircuitBreaker::HalfOpen));
+    QCOMPARE(stateSpy.at(2).at(0).toInt(), int(AICircuitBreaker::Closed));
+}
+
+void TestAICircuitBreaker::failedProbeDoublesOpenDuration()
+{
+    AICircuitBreaker breaker(OPEN_DURATION_MS, MAX_OPEN_DURATION_MS);
+    openByFailures(breaker);
+    QCOMPARE(breaker.stats().openDurationMs, OPEN_DURATION_MS);
+
+    // 每次探测失败冷却时间加倍，不超过上限
+    const QList<int> expected = {2 * OPEN_DURATION_MS, 4 * OPEN_DURATION_MS, MAX_OPEN_DURATION_MS};
+    for (int durationMs : expected) {
+        waitOpenDuration(breaker);
+        QVERIFY(breaker.allowRequest());
+        breaker.recordFailure();
+        QCOMPARE(breaker.state(), AICircuitBreaker::Open);
+        QCOMPARE(breaker.stats().openDurationMs, durationMs);
+    }
+
+    // 加倍后的冷却没结束前不放行探测
+    QTest::qWait(OPEN_DURATION_MS + 50);
+    QVERIFY(!breaker.allowRequest());
+    QCOMPARE(breaker.state(), AICircuitBreaker::Open);
+
+    // 探测成功后冷却时间回到初始值
+    waitOpenDuration(breaker);
+    QVERIFY(breaker.allowRequest());
+    breaker.recordSuccess();
+    QCOMPARE(breaker.state(), AICircuitBreaker::Closed);
+    QCOMPARE(breaker.stats().openDurationMs, OPEN_DURATION_MS);
+}
+
+QTEST_MAIN(TestAICircuitBreaker)
+#include "tst_aicircuitbreaker.moc"
@@ -0,0 +1,130 @@
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QStandardPaths>
+#include <algorithm>
+#include "src/core/ChatHistoryLoader.h"
+#include "src/core/DatabaseManager.h"
+
+static const int SHORT_SESSION_MESSAGES = 20;
+static const int LONG_SESSION_MESSAGES = 20000;
+static const int TIMING_ROUNDS = 21;
+
+// 打开会话的首屏耗时：首页按 (session_id, id) 索引倒序读取，与会话总长度无关
+class TestChatHistory : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void latestPage();
+    void firstPageTimeIndependentOfLength();
+    void loadLatestPage_data();
+    void loadLatestPage();
+
+private:
+    int seedSession(int messageCount);
+    qint64 medianFirstPageNs(int sessionId);
+
+    int m_shortSessionId = 0;
+    int m_longSessionId = 0;
+};
+
+void TestChatHistory::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(DatabaseManager::instance()->initDatabase());
+
+    m_shortSessionId = seedSession(SHORT_SESSION_MESSAGES);
+    m_longSessionId = seedSession(LONG_SESSION_MESSAGES);
+    QVERIFY(m_shortSessionId > 0);
+    QVERIFY(m_longSessionId > 0);
+}
+
+// 患者和客服交替发言；放在一个事务里，2 万条的准备时间不计入测试
+int TestChatHistory::seedSession(int messageCount)
+{
+    DatabaseManager* db = DatabaseManager::instance();
+    int patientId = db->getUserByUsername("huanzhe1").id;
+    int staffId = db->getUserByUsername("kefu1").id;
+
+    int sessionId = db->createChatSession(patientId, staffId);
+    if (sessionId <= 0) {
+        return -1;
+    }
+
+    QSqlDatabase::database().transaction();
+    for (int i = 0; i < messageCount; ++i) {
+        int senderId = i % 2 == 0 ? patientId : staffId;
+        db->sendMessage(sessionId, senderId, QString("第 %1 条消息：最近三天头痛，伴有低烧").arg(i));
+    }
+    QSqlDatabase::database().commit();
+    return sessionId;
+}
+
+qint64 TestChatHistory::medianFirstPageNs(int sessionId)
+{
+    QList<qint64> samples;
+    QElapsedTimer timer;
+    for (int i = 0; i < TIMING_ROUNDS; ++i) {
+        timer.start();
+        QList<ChatMessage> page = ChatHistoryLoader::instance()->loadLatestPage(sessionId);
+        samples.append(timer.nsecsElapsed());
+        Q_UNUSED(page);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples.at(samples.size() / 2);
+}
+
+void TestChatHistory::latestPage()
+{
+    QList<ChatMessage> shortPage = ChatHistoryLoader::instance()->loadLatestPage(m_shortSessionId);
+    QCOMPARE(shortPage.size(), SHORT_SESSION_MESSAGES);
+
+    // 长会话只读最新一页，按时间正序返回
+    QList<ChatMessage> longPage = ChatHistoryLoader::instance()->loadLatestPage(m_longSessionId);
+    QCOMPARE(longPage.size(), int(ChatHistoryLoader::PAGE_SIZE));
+    QVERIFY(longPage.first().id < longPage.last().id);
+    QCOMPARE(longPage.last().content, QString("第 %1 条消息：最近三天头痛，伴有低烧").arg(LONG_SESSION_MESSAGES - 1));
+}
+
+// 验收标准：打开 2 万条的会话和 20 条的会话耗时相当。
+// 取中位数比较；长会话多读满一页（50 条对 20 条），留出 3 倍余量
+void TestChatHistory::firstPageTimeIndependentOfLength()
+{
+    // 预热语句缓存和页缓存
+    medianFirstPageNs(m_shortSessionId);
+    medianFirstPageNs(m_longSessionId);
+
+    qint64 shortNs = medianFirstPageNs(m_shortSessionId);
+    qint64 longNs = medianFirstPageNs(m_longSessionId);
+    qDebug() << "首屏中位耗时:" << SHORT_SESSION_MESSAGES << "条" << shortNs / 1000 << "us,"
+             << LONG_SESSION_MESSAGES << "条" << longNs / 1000 << "us";
+
+    QVERIFY2(longNs <= shortNs * 3 + 1000000,
+             qPrintable(QString("%1 条会话首屏 %2 us，%3 条会话 %4 us")
+                        .arg(LONG_SESSION_MESSAGES).arg(longNs / 1000)
+                        .arg(SHORT_SESSION_MESSAGES).arg(shortNs / 1000)));
+}
+
+void TestChatHistory::loadLatestPage_data()
+{
+    QTest::addColumn<bool>("longSession");
+
+    QTest::newRow("20 messages") << false;
+    QTest::newRow("20000 messages") << true;
+}
+
+void TestChatHistory::loadLatestPage()
+{
+    QFETCH(bool, longSession);
+
+    int sessionId = longSession ? m_longSessionId : m_shortSessionId;
+    QBENCHMARK {
+        QList<ChatMessage> page = ChatHistoryLoader::instance()->loadLatestPage(sessionId);
+        Q_UNUSED(page);
+    }
+}
+
+QTEST_MAIN(TestChatHistory)
+#include "tst_chathistory.moc"
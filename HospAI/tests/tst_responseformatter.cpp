@@ -0,0 +1,145 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include "src/core/ResponseFormatter.h"
+
+// 格式化前的实现：先换行再逐条正则替换。作为对照，固定输出并比较耗时
+static QString legacyToHtml(const QString& plainText)
+{
+    QString richText = plainText;
+    richText.replace('\n', "<br>");
+
+    richText.replace(QRegularExpression("(⚠️[^\\n]*紧急[^\\n]*)"),
+                     "<span style='color: #FF3B30; font-weight: bold;'>\\1</span>");
+    richText.replace(QRegularExpression("(🌡️[^\\n]*)"), "<span style='color: #FF9500;'>\\1</span>");
+    richText.replace(QRegularExpression("(🧠[^\\n]*)"), "<span style='color: #5856D6;'>\\1</span>");
+    richText.replace(QRegularExpression("(🫁[^\\n]*)"), "<span style='color: #34C759;'>\\1</span>");
+    richText.replace(QRegularExpression("(🏥[^\\n]*)"), "<span style='color: #007AFF;'>\\1</span>");
+    richText.replace(QRegularExpression("(📱[^\\n]*)"), "<span style='color: #5AC8FA;'>\\1</span>");
+
+    richText.replace(QRegularExpression("([内外妇儿急皮眼耳口中][科医]*)："),
+                     "<span style='font-weight: bold; color: #007AFF;'>\\1：</span>");
+    return richText;
+}
+
+// 金样例文件末尾统一带一个换行，读取时去掉
+static QString readFixture(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QString text = QString::fromUtf8(file.readAll());
+    if (text.endsWith('\n')) {
+        text.chop(1);
+    }
+    return text;
+}
+
+static QString fixtureDir()
+{
+    return QString(HOSPAI_FIXTURE_DIR) + "/response_formatter";
+}
+
+// 典型的分诊回复，用于耗时比较
+static QString sampleReply()
+{
+    return QString("根据您描述的症状，初步判断如下：\n"
+                   "🌡️ 体温：38.5度，属于中度发热\n"
+                   "🧠 可能原因：病毒性感冒或流感\n"
+                   "🫁 呼吸：如有胸闷气短请及时告知\n"
+                   "推荐科室：\n"
+                   "内科：发热、咳嗽等常见症状\n"
+                   "急诊科：高烧不退或意识模糊时\n"
+                   "⚠️ 如出现呼吸困难，属于紧急情况，请立即拨打120\n"
+                   "🏥 就近医院：市第一人民医院\n"
+                   "📱 可通过预约挂号功能在线预约");
+}
+
+class TestResponseFormatter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void golden_data();
+    void golden();
+    void matchesLegacy_data();
+    void matchesLegacy();
+    void benchmark_data();
+    void benchmark();
+};
+
+void TestResponseFormatter::golden_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("expected");
+
+    QDir dir(fixtureDir());
+    const QStringList inputs = dir.entryList(QStringList() << "*.txt", QDir::Files, QDir::Name);
+    QVERIFY2(!inputs.isEmpty(), qPrintable("没有找到金样例: " + dir.absolutePath()));
+
+    for (const QString& name : inputs) {
+        QString base = name.chopped(4);
+        QTest::newRow(qPrintable(base)) << readFixture(dir.filePath(name))
+                                        << readFixture(dir.filePath(base + ".html"));
+    }
+}
+
+void TestResponseFormatter::golden()
+{
+    QFETCH(QString, input);
+    QFETCH(QString, expected);
+
+    QCOMPARE(ResponseFormatter::instance()->toHtml(input), expected);
+}
+
+void TestResponseFormatter::matchesLegacy_data()
+{
+    QTest::addColumn<QString>("input");
+
+    QTest::newRow("sample") << sampleReply();
+    QTest::newRow("keyword before marker") << QString("紧急情况\n⚠️ 注意休息");
+    QTest::newRow("marker twice") << QString("⚠️ 提示\n⚠️ 紧急：立即就医");
+    QTest::newRow("label without colon") << QString("内科 外科医：看诊");
+    QTest::newRow("adjacent labels") << QString("内科：外科：儿科医：");
+    QTest::newRow("only newlines") << QString("\n\n\n");
+    QTest::newRow("markers out of order") << QString("📱 预约\n🌡️ 体温\n🏥 医院\n🧠 原因");
+}
+
+void TestResponseFormatter::matchesLegacy()
+{
+    QFETCH(QString, input);
+
+    QCOMPARE(ResponseFormatter::instance()->toHtml(input), legacyToHtml(input));
+}
+
+void TestResponseFormatter::benchmark_data()
+{
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("formatter") << false;
+    QTest::newRow("legacy regex") << true;
+}
+
+void TestResponseFormatter::benchmark()
+{
+    QFETCH(bool, legacy);
+
+    QString reply = sampleReply();
+    ResponseFormatter* formatter = ResponseFormatter::instance();
+    QString html;
+    if (legacy) {
+        QBENCHMARK {
+            html = legacyToHtml(reply);
+        }
+    } else {
+        QBENCHMARK {
+            html = formatter->toHtml(reply);
+        }
+    }
+    QVERIFY(!html.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestResponseFormatter)
+#include "tst_responseformatter.moc"
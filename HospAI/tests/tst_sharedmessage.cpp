@@ -0,0 +1,150 @@
+#include <QtTest>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "src/core/DatabaseManager.h"
+#include "src/core/RichMessageTypes.h"
+
+// 统计堆分配次数：替换全局 operator new，只在计数区间内累加
+static std::atomic<bool> g_counting(false);
+static std::atomic<int> g_allocations(0);
+
+void* operator new(std::size_t size)
+{
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+// 模拟 DatabaseManager 的新消息信号：旧做法按值分发，每个接收者各自转换一份；
+// 现在发送方转换一次，接收者只保存句柄
+class MessageHub : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void valueMessage(const ChatMessage& message);
+    void sharedMessage(const SharedRichChatMessage& message);
+};
+
+static ChatMessage sampleMessage(int id)
+{
+    ChatMessage message;
+    message.id = id;
+    message.sessionId = 7;
+    message.senderId = 42;
+    message.senderName = "张医生";
+    message.senderRole = UserRole::Staff;
+    message.content = "您好，请问哪里不舒服？描述一下症状和持续时间。";
+    message.timestamp = QDateTime::currentDateTime();
+    message.messageType = 0;
+    message.isRead = 0;
+    return message;
+}
+
+class TestSharedMessage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void allocationCounts_data();
+    void allocationCounts();
+};
+
+void TestSharedMessage::allocationCounts_data()
+{
+    QTest::addColumn<int>("receivers");
+
+    // 客服端：当前会话模型 + 后台缓存模型；同进程内患者端也在监听时为 3
+    QTest::newRow("1 receiver") << 1;
+    QTest::newRow("2 receivers") << 2;
+    QTest::newRow("3 receivers") << 3;
+}
+
+void TestSharedMessage::allocationCounts()
+{
+    QFETCH(int, receivers);
+
+    const int messageCount = 1000;
+    QList<ChatMessage> messages;
+    for (int i = 0; i < messageCount; ++i) {
+        messages.append(sampleMessage(i + 1));
+    }
+
+    MessageHub hub;
+    // 每个接收者相当于一个聊天记录模型，预先分配好，只统计消息本身
+    QList<QList<SharedRichChatMessage>> valueModels(receivers);
+    QList<QList<SharedRichChatMessage>> sharedModels(receivers);
+    for (int r = 0; r < receivers; ++r) {
+        valueModels[r].reserve(messageCount);
+        sharedModels[r].reserve(messageCount);
+        QList<SharedRichChatMessage>* valueModel = &valueModels[r];
+        QList<SharedRichChatMessage>* sharedModel = &sharedModels[r];
+        connect(&hub, &MessageHub::valueMessage, &hub, [valueModel](const ChatMessage& message) {
+            valueModel->append(SharedRichChatMessage(RichChatMessage::fromChatMessage(message)));
+        });
+        connect(&hub, &MessageHub::sharedMessage, &hub, [sharedModel](const SharedRichChatMessage& message) {
+            sharedModel->append(message);
+        });
+    }
+
+    g_allocations = 0;
+    g_counting = true;
+    for (const ChatMessage& message : messages) {
+        emit hub.valueMessage(message);
+    }
+    g_counting = false;
+    int before = g_allocations;
+
+    g_allocations = 0;
+    g_counting = true;
+    for (const ChatMessage& message : messages) {
+        emit hub.sharedMessage(SharedRichChatMessage(RichChatMessage::fromChatMessage(message)));
+    }
+    g_counting = false;
+    int after = g_allocations;
+
+    qInfo().noquote() << QString("%1 条消息，%2 个接收者：按值分发 %3 次分配，共享句柄 %4 次分配")
+                             .arg(messageCount).arg(receivers).arg(before).arg(after);
+
+    // 共享句柄的分配次数与接收者数量无关
+    QVERIFY(after <= messageCount * 2);
+    if (receivers > 1) {
+        QVERIFY(after < before);
+    }
+    for (int r = 0; r < receivers; ++r) {
+        QVERIFY(sharedModels[r].first().isSharedWith(sharedModels[0].first()));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestSharedMessage)
+#include "tst_sharedmessage.moc"
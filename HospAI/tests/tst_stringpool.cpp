@@ -0,0 +1,193 @@
+#include <QtTest>
+#include <QSet>
+#include "src/core/DatabaseManager.h"
+#include "src/core/StringPool.h"
+#include "src/core/UserRole.h"
+
+// 驻留前的消息结构：角色是每行各自的 QString
+struct BaselineChatMessage {
+    int id;
+    int sessionId;
+    int senderId;
+    QString senderName;
+    QString senderRole;
+    QString content;
+    QDateTime timestamp;
+    int messageType;
+    int isRead;
+    int contentVersion = 0;
+    QString htmlContent;
+    QStringList attachments;
+};
+
+static const int STAFF_COUNT = 50;
+static const int MESSAGES_PER_SESSION = 10;
+
+// 字符串缓冲区占用：同一缓冲区只计一次
+class BufferCounter
+{
+public:
+    void add(const QString& value)
+    {
+        if (value.isEmpty() || m_seen.contains(value.constData())) {
+            return;
+        }
+        m_seen.insert(value.constData());
+        m_bytes += sizeof(QArrayData) + qint64(value.capacity() + 1) * qint64(sizeof(QChar));
+    }
+
+    qint64 bytes() const { return m_bytes; }
+
+private:
+    QSet<const void*> m_seen;
+    qint64 m_bytes = 0;
+};
+
+// 按会话生成消息：每个会话一名患者、一名客服交替发言，姓名每行重新构造（与从查询结果读出一致）
+static int senderOf(int messageIndex, int userCount, bool* isStaff)
+{
+    int session = messageIndex / MESSAGES_PER_SESSION;
+    *isStaff = (messageIndex % 2) == 1;
+    return *isStaff ? session % STAFF_COUNT : STAFF_COUNT + session % (userCount - STAFF_COUNT);
+}
+
+static QString nameOf(int userIndex, bool isStaff)
+{
+    return isStaff ? QString("客服%1").arg(userIndex) : QString("患者%1").arg(userIndex);
+}
+
+static QString formatMegabytes(qint64 bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+class TestStringPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roleNames_data();
+    void roleNames();
+    void unknownRoleIsInvalid();
+    void poolIsBounded();
+    void hotStringsStayShared();
+    void memoryFootprint();
+};
+
+void TestStringPool::roleNames_data()
+{
+    QTest::addColumn<int>("role");
+
+    QTest::newRow("patient") << int(UserRole::Patient);
+    QTest::newRow("staff") << int(UserRole::Staff);
+    QTest::newRow("admin") << int(UserRole::Admin);
+    QTest::newRow("system") << int(UserRole::System);
+}
+
+void TestStringPool::roleNames()
+{
+    QFETCH(int, role);
+
+    QVERIFY(userRoleFromName(userRoleName(UserRole(role))) == UserRole(role));
+}
+
+void TestStringPool::unknownRoleIsInvalid()
+{
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("无法识别的用户角色"));
+    QVERIFY(userRoleFromName("医生") == UserRole::Invalid);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("无法识别的用户角色"));
+    QVERIFY(userRoleFromName(QString()) == UserRole::Invalid);
+}
+
+void TestStringPool::poolIsBounded()
+{
+    StringPool* pool = StringPool::instance();
+    pool->clear();
+
+    for (int i = 0; i < StringPool::MAX_SIZE * 3; ++i) {
+        pool->intern(QString("用户%1").arg(i));
+        QVERIFY(pool->size() <= StringPool::MAX_SIZE);
+    }
+    QVERIFY(pool->size() > 0);
+}
+
+void TestStringPool::hotStringsStayShared()
+{
+    StringPool* pool = StringPool::instance();
+    pool->clear();
+
+    QString first = pool->intern(QString("张医生"));
+    for (int i = 0; i < StringPool::MAX_SIZE * 3; ++i) {
+        pool->intern(QString("患者%1").arg(i));
+        if (i % 100 == 0) {
+            QString again = pool->intern(QString("张医生"));
+            QVERIFY(again.constData() == first.constData());
+        }
+    }
+}
+
+// 默认规模 1 万用户 / 10 万条消息；设置 HOSPAI_BENCH_FULL=1 时为 10 万用户 / 100 万条消息
+void TestStringPool::memoryFootprint()
+{
+    bool full = qEnvironmentVariableIntValue("HOSPAI_BENCH_FULL") == 1;
+    int userCount = full ? 100000 : 10000;
+    int messageCount = full ? 1000000 : 100000;
+
+    qint64 baselineBytes = 0;
+    {
+        QList<BaselineChatMessage> messages;
+        messages.reserve(messageCount);
+        BufferCounter buffers;
+        for (int i = 0; i < messageCount; ++i) {
+            bool isStaff = false;
+            int sender = senderOf(i, userCount, &isStaff);
+            BaselineChatMessage message;
+            message.id = i + 1;
+            message.sessionId = i / MESSAGES_PER_SESSION;
+            message.senderId = sender;
+            message.senderName = nameOf(sender, isStaff);
+            message.senderRole = QString(isStaff ? "客服" : "患者");
+            messages.append(message);
+            buffers.add(messages.last().senderName);
+            buffers.add(messages.last().senderRole);
+        }
+        baselineBytes = qint64(sizeof(BaselineChatMessage)) * messageCount + buffers.bytes();
+    }
+
+    qint64 pooledBytes = 0;
+    int poolSize = 0;
+    {
+        StringPool* pool = StringPool::instance();
+        pool->clear();
+        QList<ChatMessage> messages;
+        messages.reserve(messageCount);
+        BufferCounter buffers;
+        for (int i = 0; i < messageCount; ++i) {
+            bool isStaff = false;
+            int sender = senderOf(i, userCount, &isStaff);
+            ChatMessage message;
+            message.id = i + 1;
+            message.sessionId = i / MESSAGES_PER_SESSION;
+            message.senderId = sender;
+            message.senderName = pool->intern(nameOf(sender, isStaff));
+            message.senderRole = isStaff ? UserRole::Staff : UserRole::Patient;
+            messages.append(message);
+            buffers.add(messages.last().senderName);
+        }
+        poolSize = pool->size();
+        pooledBytes = qint64(sizeof(ChatMessage)) * messageCount + buffers.bytes();
+        pool->clear();
+    }
+
+    qInfo().noquote() << QString("%1 用户 / %2 条消息：每行字符串 %3，驻留姓名+角色枚举 %4，池条目 %5")
+                             .arg(userCount).arg(messageCount)
+                             .arg(formatMegabytes(baselineBytes), formatMegabytes(pooledBytes))
+                             .arg(poolSize);
+
+    QVERIFY(pooledBytes < baselineBytes);
+    QVERIFY(poolSize <= StringPool::MAX_SIZE);
+}
+
+QTEST_GUILESS_MAIN(TestStringPool)
+#include "tst_stringpool.moc"
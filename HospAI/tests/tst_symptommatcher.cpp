@@ -0,0 +1,146 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include "src/core/SymptomMatcher.h"
+
+// 症状词典匹配：使用 resources/data/triage_lexicon.json（编进测试的资源文件），
+// 覆盖重叠词条的最左最长选择、重复词条计分和急症类别的置信阈值
+class TestSymptomMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void match_data();
+    void match();
+    void matchPositions();
+    void emergencyThreshold();
+    void emergencyLevel_data();
+    void emergencyLevel();
+
+private:
+    static QString categoryId(int index);
+    static QStringList matchedTerms(const SymptomMatcher::MatchResult& result);
+};
+
+void TestSymptomMatcher::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(SymptomMatcher::instance()->loadLexicon(SymptomMatcher::BUILTIN_LEXICON_PATH));
+    QVERIFY(SymptomMatcher::instance()->isLoaded());
+}
+
+QString TestSymptomMatcher::categoryId(int index)
+{
+    return SymptomMatcher::instance()->category(index).id;
+}
+
+QStringList TestSymptomMatcher::matchedTerms(const SymptomMatcher::MatchResult& result)
+{
+    QStringList terms;
+    for (const SymptomMatcher::TermMatch& match : result.matches) {
+        terms.append(SymptomMatcher::instance()->termText(match.term));
+    }
+    return terms;
+}
+
+void TestSymptomMatcher::match_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QStringList>("terms");
+    QTest::addColumn<QString>("category");
+    QTest::addColumn<bool>("confident");
+    QTest::addColumn<bool>("emergency");
+
+    // 重叠时取最长的词条，被覆盖的短词条不计分
+    QTest::newRow("longest wins over prefix") << "我呼吸困难" << QStringList{"呼吸困难"} << "emergency" << true << true;
+    QTest::newRow("longest wins over suffix") << "过敏性休克" << QStringList{"过敏性休克"} << "emergency" << true << true;
+    QTest::newRow("longest wins across categories") << "高烧不退" << QStringList{"高烧不退"} << "emergency" << false << true;
+    QTest::newRow("longest wins inside category") << "偏头痛三天了" << QStringList{"偏头痛"} << "headache" << true << false;
+    QTest::newRow("short term alone") << "呼吸有点急" << QStringList{"呼吸"} << "cough" << false << false;
+
+    // 不重叠的词条都计入；同一词条重复出现只计一次分
+    QTest::newRow("adjacent terms") << "头痛发烧" << QStringList{"头痛", "发烧"} << "fever" << false << false;
+    QTest::newRow("repeated term") << "头痛头痛" << QStringList{"头痛", "头痛"} << "headache" << true << false;
+    QTest::newRow("full-width input") << "体温３９度" << QStringList{"体温", "39度"} << "fever" << true << false;
+
+    // 得分达标且明显领先时才直接回复
+    QTest::newRow("clear match") << "头痛" << QStringList{"头痛"} << "headache" << true << false;
+    QTest::newRow("below min score") << "头晕" << QStringList{"头晕"} << "headache" << false << false;
+    QTest::newRow("no match") << "你好" << QStringList() << QString() << false << false;
+}
+
+void TestSymptomMatcher::match()
+{
+    QFETCH(QString, text);
+    QFETCH(QStringList, terms);
+    QFETCH(QString, category);
+    QFETCH(bool, confident);
+    QFETCH(bool, emergency);
+
+    SymptomMatcher::MatchResult result = SymptomMatcher::instance()->match(text);
+    QCOMPARE(matchedTerms(result), terms);
+    QCOMPARE(categoryId(result.bestCategory), category);
+    QCOMPARE(result.confident, confident);
+    QCOMPARE(result.emergency, emergency);
+}
+
+void TestSymptomMatcher::matchPositions()
+{
+    // 位置和长度按规范化后的文本计算
+    SymptomMatcher::MatchResult result = SymptomMatcher::instance()->match("昨天开始呼吸困难，还有点发烧");
+    QCOMPARE(result.matches.size(), 2);
+    QCOMPARE(result.matches[0].position, 4);
+    QCOMPARE(result.matches[0].length, 4);
+    QCOMPARE(result.matches[1].position, 12);
+    QCOMPARE(result.matches[1].length, 2);
+}
+
+void TestSymptomMatcher::emergencyThreshold()
+{
+    SymptomMatcher* matcher = SymptomMatcher::instance();
+
+    // 急症得分达到 minScore（3）时优先于其他类别，即使其他类别同分
+    SymptomMatcher::MatchResult reached = matcher->match("胸痛，发烧，咳嗽");
+    QCOMPARE(categoryId(reached.bestCategory), QString("emergency"));
+    QVERIFY(reached.confident);
+
+    // 只提到权重 2 的急症词：不够明确，交给AI，也不按其他类别直接回复
+    SymptomMatcher::MatchResult weak = matcher->match("胸闷");
+    QVERIFY(weak.emergency);
+    QVERIFY(!weak.confident);
+
+    SymptomMatcher::MatchResult mixed = matcher->match("胸闷，发烧");
+    QVERIFY(mixed.emergency);
+    QCOMPARE(categoryId(mixed.bestCategory), QString("fever"));
+    QVERIFY(!mixed.confident);
+
+    // 两个弱急症词相加达到阈值
+    SymptomMatcher::MatchResult combined = matcher->match("胸闷，骨折");
+    QCOMPARE(categoryId(combined.bestCategory), QString("emergency"));
+    QVERIFY(combined.confident);
+}
+
+void TestSymptomMatcher::emergencyLevel_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("level");
+
+    QTest::newRow("confident emergency") << "胸痛" << "critical";
+    QTest::newRow("weak emergency") << "胸闷" << "high";
+    QTest::newRow("urgent modifier") << "高烧" << "high";
+    QTest::newRow("department") << "头痛" << "medium";
+    QTest::newRow("no department") << "你好" << "low";
+}
+
+void TestSymptomMatcher::emergencyLevel()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, level);
+
+    SymptomMatcher* matcher = SymptomMatcher::instance();
+    QCOMPARE(matcher->emergencyLevel(matcher->match(text)), level);
+}
+
+QTEST_MAIN(TestSymptomMatcher)
+#include "tst_symptommatcher.moc"
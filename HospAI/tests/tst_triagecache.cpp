@@ -0,0 +1,172 @@
+#include <QtTest>
+#include <QStandardPaths>
+#include "src/core/AIApiClient.h"
+#include "src/core/DatabaseManager.h"
+#include "src/core/TriageCache.h"
+#include "tools/MockLlmServer.h"
+
+// AI回复缓存：键的规范化、有效期、按最久未命中淘汰，以及急症描述绕过缓存
+class TestTriageCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+
+    void normalizeText_data();
+    void normalizeText();
+    void makeKey();
+    void expiresAfterTimeToLive();
+    void evictsLeastRecentlyHit();
+    void emergencyBypassesCache();
+
+private:
+    bool sendAndWait(AIApiClient& client, const QString& text, AIApiClient::Response* response);
+};
+
+void TestTriageCache::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(DatabaseManager::instance()->initDatabase());
+}
+
+void TestTriageCache::init()
+{
+    TriageCache* cache = TriageCache::instance();
+    cache->setTimeToLive(TriageCache::DEFAULT_TTL_SECS);
+    cache->setMaxEntries(TriageCache::DEFAULT_MAX_ENTRIES);
+    cache->clear();
+}
+
+void TestTriageCache::normalizeText_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("full-width letters and digits") << "ＦＥＶＥＲ ３９度" << "fever39度";
+    QTest::newRow("full-width punctuation") << "头痛，发烧！？" << "头痛发烧";
+    QTest::newRow("ascii punctuation") << "头痛, 发烧!?..." << "头痛发烧";
+    QTest::newRow("whitespace") << "  头痛\t发烧\n　咳嗽 " << "头痛发烧咳嗽";
+    QTest::newRow("case") << "Headache" << "headache";
+    QTest::newRow("symbols") << "体温~38.5℃" << "体温385c";
+}
+
+void TestTriageCache::normalizeText()
+{
+    QFETCH(QString, input);
+    QFETCH(QString, expected);
+
+    QCOMPARE(TriageCache::normalizeText(input), expected);
+}
+
+void TestTriageCache::makeKey()
+{
+    QString key = TriageCache::makeKey("triage", "model-a", "我头痛，发烧了！", "患者：你好");
+
+    // 措辞只差标点、空白和全半角时得到同一个键
+    QCOMPARE(TriageCache::makeKey("triage", "model-a", "我头痛 发烧了", "患者： 你好"), key);
+    QCOMPARE(TriageCache::makeKey("triage", "model-a", "我头痛，发烧了！", "患者：你好"), key);
+
+    // 请求类型、模型、提问或历史不同时不会串用
+    QVERIFY(TriageCache::makeKey("symptom", "model-a", "我头痛，发烧了！", "患者：你好") != key);
+    QVERIFY(TriageCache::makeKey("triage", "model-b", "我头痛，发烧了！", "患者：你好") != key);
+    QVERIFY(TriageCache::makeKey("triage", "model-a", "我头痛", "患者：你好") != key);
+    QVERIFY(TriageCache::makeKey("triage", "model-a", "我头痛，发烧了！", "患者：咳嗽") != key);
+    QCOMPARE(key.size(), 64);
+}
+
+void TestTriageCache::expiresAfterTimeToLive()
+{
+    TriageCache* cache = TriageCache::instance();
+    QString key = TriageCache::makeKey("triage", "model-a", "头痛", QString());
+    cache->store(key, "建议神经内科就诊", 800);
+
+    QString response;
+    QVERIFY(cache->lookup(key, &response));
+    QCOMPARE(response, QString("建议神经内科就诊"));
+
+    // 有效期按秒计，超过后查询时移除
+    cache->setTimeToLive(0);
+    QTest::qWait(1100);
+    QVERIFY(!cache->lookup(key, &response));
+    QCOMPARE(cache->size(), 0);
+}
+
+void TestTriageCache::evictsLeastRecentlyHit()
+{
+    TriageCache* cache = TriageCache::instance();
+    cache->setMaxEntries(2);
+    quint64 evictionsBefore = cache->stats().evictions;
+
+    QString first = TriageCache::makeKey("triage", "model-a", "头痛", QString());
+    QString second = TriageCache::makeKey("triage", "model-a", "咳嗽", QString());
+    QString third = TriageCache::makeKey("triage", "model-a", "发烧", QString());
+
+    cache->store(first, "回复一", 500);
+    QTest::qWait(10);
+    cache->store(second, "回复二", 500);
+    QTest::qWait(10);
+    // 命中后第一条比第二条新，超出上限时淘汰第二条
+    QVERIFY(cache->lookup(first, nullptr));
+    QTest::qWait(10);
+    cache->store(third, "回复三", 500);
+
+    QCOMPARE(cache->size(), 2);
+    QCOMPARE(cache->stats().evictions, evictionsBefore + 1);
+    QVERIFY(cache->lookup(first, nullptr));
+    QVERIFY(!cache->lookup(second, nullptr));
+    QVERIFY(cache->lookup(third, nullptr));
+}
+
+bool TestTriageCache::sendAndWait(AIApiClient& client, const QString& text, AIApiClient::Response* response)
+{
+    AIApiClient::RequestOptions options;
+    options.tier = AIModelRouter::FastTier;
+
+    bool done = false;
+    client.sendTriageRequest(text, QString(), &client, [&](const AIApiClient::Response& result) {
+        *response = result;
+        done = true;
+    }, options);
+    return QTest::qWaitFor([&]() { return done; }, 10000);
+}
+
+void TestTriageCache::emergencyBypassesCache()
+{
+    MockLlmServer::Options serverOptions;
+    serverOptions.latencyMs = 0;
+    serverOptions.jitterMs = 0;
+    MockLlmServer server(serverOptions);
+    QVERIFY(server.start());
+
+    AIApiClient client;
+    client.setApiConfig(server.baseUrl(), "test-key", "mock-model");
+    TriageCache* cache = TriageCache::instance();
+    AIApiClient::Response response;
+
+    // 普通描述：第二次只差标点，直接用缓存，不再发请求
+    QVERIFY(sendAndWait(client, "最近有点头晕，怎么办", &response));
+    QVERIFY(response.success);
+    QVERIFY(!response.fromCache);
+    QVERIFY(sendAndWait(client, "最近有点头晕怎么办？", &response));
+    QVERIFY(response.success);
+    QVERIFY(response.fromCache);
+    QCOMPARE(server.stats().requests, 1);
+
+    // 急症描述：每次都拿实时回复，既不查也不写缓存
+    quint64 bypassedBefore = cache->stats().bypassed;
+    int sizeBefore = cache->size();
+    QVERIFY(sendAndWait(client, "突然胸闷，出冷汗", &response));
+    QVERIFY(response.success);
+    QVERIFY(!response.fromCache);
+    QVERIFY(sendAndWait(client, "突然胸闷，出冷汗", &response));
+    QVERIFY(response.success);
+    QVERIFY(!response.fromCache);
+    QCOMPARE(server.stats().requests, 3);
+    QCOMPARE(cache->stats().bypassed, bypassedBefore + 2);
+    QCOMPARE(cache->size(), sizeBefore);
+}
+
+QTEST_MAIN(TestTriageCache)
+#include "tst_triagecache.moc"
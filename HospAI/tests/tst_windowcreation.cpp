@@ -0,0 +1,137 @@
+#include <QtTest>
+#include <QApplication>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QScrollArea>
+#include <QStandardPaths>
+#include <QVBoxLayout>
+#include "mainwindow.h"
+#include "src/core/DatabaseManager.h"
+#include "src/views/common/UIStyleManager.h"
+#include "src/views/patient/ChatWidget.h"
+
+static const int BUBBLE_COUNT = 50;
+
+// 窗口创建基准：变体规则在应用样式表中只解析一次，对照组按原先的做法给每个控件设置自身样式表
+class TestWindowCreation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    void variantRules();
+    void createWindow_data();
+    void createWindow();
+    void createBubbles_data();
+    void createBubbles();
+};
+
+void TestWindowCreation::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    UIStyleManager::applyGlobalStyleSheet(qApp);
+    QVERIFY(DatabaseManager::instance()->initDatabase());
+}
+
+void TestWindowCreation::cleanup()
+{
+    UIStyleManager::setPerWidgetStyleSheets(false);
+}
+
+void TestWindowCreation::variantRules()
+{
+    // 聊天页的规则带变体属性和上下文，不会影响其他页面的同类控件
+    QString styleSheet = qApp->styleSheet();
+    QVERIFY(styleSheet.contains("ChatWidget QPushButton[hospVariant=\"chatSend\"]:hover"));
+    QVERIFY(styleSheet.contains("ChatWidget QToolBar[hospVariant=\"chatRichToolbar\"] QToolButton:checked"));
+    QVERIFY(styleSheet.contains("ChatWidget QScrollArea[hospVariant=\"chatArea\"] QLabel[hospVariant=\"chatBubbleUser\"]"));
+    QVERIFY(styleSheet.contains("QMainWindow[hospVariant=\"roleWindow\"] QListWidget::item:selected"));
+
+    ChatWidget chat;
+    chat.ensurePolished();
+    QScrollArea *chatArea = chat.findChild<QScrollArea*>();
+    QVERIFY(chatArea);
+    QCOMPARE(chatArea->property(UIStyleManager::VARIANT_PROPERTY).toString(), QString("chatArea"));
+    QVERIFY(chatArea->styleSheet().isEmpty());
+}
+
+void TestWindowCreation::createWindow_data()
+{
+    QTest::addColumn<QString>("window");
+    QTest::addColumn<bool>("perWidget");
+
+    QTest::newRow("MainWindow/variants") << "MainWindow" << false;
+    QTest::newRow("MainWindow/per-widget sheets") << "MainWindow" << true;
+    QTest::newRow("ChatWidget/variants") << "ChatWidget" << false;
+    QTest::newRow("ChatWidget/per-widget sheets") << "ChatWidget" << true;
+}
+
+void TestWindowCreation::createWindow()
+{
+    QFETCH(QString, window);
+    QFETCH(bool, perWidget);
+
+    UIStyleManager::setPerWidgetStyleSheets(perWidget);
+
+    // 构造并完成 polish（样式表解析和匹配发生在这里），不显示窗口
+    QBENCHMARK {
+        QScopedPointer<QWidget> widget;
+        if (window == "MainWindow") {
+            widget.reset(new MainWindow);
+        } else {
+            widget.reset(new ChatWidget);
+        }
+        widget->ensurePolished();
+    }
+}
+
+void TestWindowCreation::createBubbles_data()
+{
+    QTest::addColumn<bool>("perWidget");
+
+    QTest::newRow("variants") << false;
+    QTest::newRow("per-widget sheets") << true;
+}
+
+void TestWindowCreation::createBubbles()
+{
+    QFETCH(bool, perWidget);
+
+    UIStyleManager::setPerWidgetStyleSheets(perWidget);
+
+    // 气泡放在聊天页的聊天区中，和实际一样受聊天区规则的影响
+    ChatWidget chat;
+    QScrollArea *chatArea = new QScrollArea(&chat);
+    UIStyleManager::setVariant(chatArea, "chatArea");
+
+    // 与 ChatWidget::displayMessage 相同的结构：气泡、时间戳，机器人消息另有头像
+    QBENCHMARK {
+        QWidget *container = new QWidget;
+        QVBoxLayout *layout = new QVBoxLayout(container);
+        for (int i = 0; i < BUBBLE_COUNT; ++i) {
+            QWidget *messageWidget = new QWidget;
+            QHBoxLayout *messageLayout = new QHBoxLayout(messageWidget);
+            QLabel *bubbleLabel = new QLabel(QString("消息 %1").arg(i));
+            QLabel *timeLabel = new QLabel("10:00");
+            UIStyleManager::setVariant(timeLabel, "chatTime");
+            if (i % 2 == 0) {
+                UIStyleManager::setVariant(bubbleLabel, "chatBubbleUser");
+            } else {
+                UIStyleManager::setVariant(bubbleLabel, "chatBubbleBot");
+                QLabel *avatarLabel = new QLabel("🤖");
+                UIStyleManager::setVariant(avatarLabel, "chatAvatar");
+                messageLayout->addWidget(avatarLabel);
+            }
+            messageLayout->addWidget(bubbleLabel);
+            messageLayout->addWidget(timeLabel);
+            layout->addWidget(messageWidget);
+        }
+        chatArea->setWidget(container);
+        container->ensurePolished();
+    }
+}
+
+QTEST_MAIN(TestWindowCreation)
+#include "tst_windowcreation.moc"
@@ -0,0 +1,457 @@
+#include "BatchTriageRunner.h"
+#include "src/core/SymptomMatcher.h"
+#include "src/core/AICircuitBreaker.h"
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+#include <QTimer>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+
+static const char* CORPUS_FLAG = "--batch-corpus=";
+static const char* OUTPUT_FLAG = "--batch-output=";
+static const char* MODE_FLAG = "--batch-mode=";
+static const char* PARALLEL_FLAG = "--batch-parallel=";
+static const char* TIER_FLAG = "--batch-tier=";
+static const char* TIMEOUT_FLAG = "--batch-timeout=";
+static const char* LIMIT_FLAG = "--batch-limit=";
+static const char* RESTART_FLAG = "--batch-restart";
+
+static const char* OUTPUT_HEADER =
+    "id,text,expected_department,local_department,local_emergency_level,local_confident,local_latency_ms,"
+    "ai_status,ai_tier,ai_model,ai_department,ai_emergency_level,ai_needs_human,ai_latency_ms,ai_attempts,ai_error\n";
+
+// 熔断打开时暂停，等到放行探测请求之后再继续
+static const int CIRCUIT_RESUME_MARGIN_MS = 500;
+
+static double percentile(QList<double> samples, double p)
+{
+    if (samples.isEmpty()) {
+        return -1.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    int rank = qCeil(p / 100.0 * samples.size());
+    return samples[qBound(0, rank - 1, int(samples.size()) - 1)];
+}
+
+BatchTriageRunner::Options BatchTriageRunner::Options::fromArguments(const QStringList& arguments)
+{
+    Options options;
+    for (const QString& argument : arguments) {
+        auto valueOf = [&argument](const char* flag) {
+            return argument.mid(qstrlen(flag));
+        };
+
+        if (argument.startsWith(CORPUS_FLAG)) {
+            options.corpusPath = valueOf(CORPUS_FLAG);
+        } else if (argument.startsWith(OUTPUT_FLAG)) {
+            options.outputPath = valueOf(OUTPUT_FLAG);
+        } else if (argument.startsWith(MODE_FLAG)) {
+            QString mode = valueOf(MODE_FLAG);
+            options.mode = mode == "local" ? LocalOnly : mode == "ai" ? AIOnly : LocalAndAI;
+        } else if (argument.startsWith(PARALLEL_FLAG)) {
+            options.parallel = qMax(1, valueOf(PARALLEL_FLAG).toInt());
+        } else if (argument.startsWith(TIER_FLAG)) {
+            options.tier = AIModelRouter::tierFromName(valueOf(TIER_FLAG));
+        } else if (argument.startsWith(TIMEOUT_FLAG)) {
+            options.timeoutMs = qMax(1, valueOf(TIMEOUT_FLAG).toInt());
+        } else if (argument.startsWith(LIMIT_FLAG)) {
+            options.limit = qMax(0, valueOf(LIMIT_FLAG).toInt());
+        } else if (argument == RESTART_FLAG) {
+            options.restart = true;
+        }
+    }
+
+    if (options.outputPath.isEmpty() && !options.corpusPath.isEmpty()) {
+        QFileInfo corpus(options.corpusPath);
+        options.outputPath = corpus.dir().filePath(corpus.completeBaseName() + ".results.csv");
+    }
+    return options;
+}
+
+BatchTriageRunner::BatchTriageRunner(const Options& options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_client(nullptr)
+    , m_inFlight(0)
+    , m_paused(false)
+    , m_finished(false)
+    , m_processed(0)
+    , m_skipped(0)
+    , m_aiSucceeded(0)
+    , m_aiFailed(0)
+    , m_expectedCount(0)
+    , m_localCorrect(0)
+    , m_aiCorrect(0)
+    , m_agreements(0)
+{
+}
+
+void BatchTriageRunner::start()
+{
+    if (m_options.corpusPath.isEmpty()) {
+        qWarning() << "未指定语料文件，用法: hospai_batch_triage --batch-corpus=语料.csv";
+        emit finished(1);
+        return;
+    }
+    if (!loadCorpus() || !openOutput()) {
+        emit finished(1);
+        return;
+    }
+
+    for (int i = 0; i < m_items.size(); ++i) {
+        if (m_doneIds.contains(m_items[i].id)) {
+            m_skipped++;
+            continue;
+        }
+        if (m_options.limit > 0 && m_queue.size() >= m_options.limit) {
+            break;
+        }
+        m_queue.append(i);
+    }
+
+    if (m_options.mode != LocalOnly) {
+        // 非紧急请求最多占用上限-1个名额，多留一个让并发数正好等于 parallel
+        m_client = new AIApiClient(this);
+        m_client->setMaxConcurrentRequests(m_options.parallel + 1);
+    }
+
+    qInfo().noquote() << QString("批量分诊: 共 %1 条，已有结果 %2 条，本次处理 %3 条，并发 %4，结果写入 %5")
+                         .arg(m_items.size())
+                         .arg(m_skipped)
+                         .arg(m_queue.size())
+                         .arg(m_options.parallel)
+                         .arg(m_options.outputPath);
+
+    m_wallTimer.start();
+    dispatch();
+}
+
+bool BatchTriageRunner::loadCorpus()
+{
+    QFile file(m_options.corpusPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "无法读取语料文件:" << m_options.corpusPath << file.errorString();
+        return false;
+    }
+
+    QStringList lines;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        lines.append(in.readLine());
+    }
+
+    // CSV 按表头取列，否则每行就是一条描述，以行号作为ID
+    QStringList header = parseCsvLine(lines.value(0));
+    for (QString& column : header) {
+        column = column.trimmed().toLower();
+    }
+    bool csv = m_options.corpusPath.endsWith(".csv", Qt::CaseInsensitive) || header.contains("text");
+    int idColumn = header.indexOf("id");
+    int textColumn = header.indexOf("text");
+    int expectedColumn = header.indexOf("expected_department");
+    if (csv && textColumn < 0) {
+        qWarning() << "语料CSV缺少 text 列:" << m_options.corpusPath;
+        return false;
+    }
+
+    QSet<QString> ids;
+    for (int i = csv ? 1 : 0; i < lines.size(); ++i) {
+        Item item;
+        if (csv) {
+            QStringList fields = parseCsvLine(lines[i]);
+            item.id = idColumn >= 0 ? fields.value(idColumn).trimmed() : QString::number(i);
+            item.text = fields.value(textColumn).trimmed();
+            item.expectedDepartment = expectedColumn >= 0 ? fields.value(expectedColumn).trimmed() : QString();
+        } else {
+            item.id = QString::number(i + 1);
+            item.text = lines[i].trimmed();
+            if (item.text.startsWith('#')) {
+                continue;
+            }
+        }
+
+        if (item.text.isEmpty() || item.id.isEmpty()) {
+            continue;
+        }
+        if (ids.contains(item.id)) {
+            qWarning() << "语料中ID重复，跳过:" << item.id;
+            continue;
+        }
+        ids.insert(item.id);
+        m_items.append(item);
+    }
+    return true;
+}
+
+bool BatchTriageRunner::openOutput()
+{
+    m_output.setFileName(m_options.outputPath);
+
+    if (m_options.restart || !m_output.exists()) {
+        if (!m_output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "无法写入结果文件:" << m_options.outputPath << m_output.errorString();
+            return false;
+        }
+        m_output.write(OUTPUT_HEADER);
+        m_output.flush();
+        return true;
+    }
+
+    if (!m_output.open(QIODevice::ReadWrite)) {
+        qWarning() << "无法打开结果文件:" << m_options.outputPath << m_output.errorString();
+        return false;
+    }
+
+    // 中断时最后一行可能只写了一半，截到最后一个完整行
+    QByteArray content = m_output.readAll();
+    qint64 complete = content.lastIndexOf('\n') + 1;
+    if (complete < content.size()) {
+        m_output.resize(complete);
+        content.truncate(complete);
+    }
+
+    const QStringList rows = QString::fromUtf8(content).split('\n', Qt::SkipEmptyParts);
+    for (int i = 1; i < rows.size(); ++i) {
+        m_doneIds.insert(parseCsvLine(rows[i]).value(0));
+    }
+
+    m_output.seek(m_output.size());
+    if (complete == 0) {
+        m_output.write(OUTPUT_HEADER);
+        m_output.flush();
+    }
+    return true;
+}
+
+void BatchTriageRunner::dispatch()
+{
+    if (m_paused || m_finished) {
+        return;
+    }
+
+    while (m_inFlight < m_options.parallel && !m_queue.isEmpty()) {
+        int index = m_queue.takeFirst();
+        Item& item = m_items[index];
+        if (m_options.mode != AIOnly && item.localEmergencyLevel.isEmpty()) {
+            runLocal(item);
+        }
+
+        if (m_options.mode == LocalOnly) {
+            writeRow(item, nullptr);
+            continue;
+        }
+        startAI(index);
+    }
+
+    if (m_inFlight == 0 && m_queue.isEmpty()) {
+        finish();
+    }
+}
+
+void BatchTriageRunner::runLocal(Item& item)
+{
+    // 与聊天窗口的本地回退相同，只用分诊词典
+    QElapsedTimer timer;
+    timer.start();
+
+    SymptomMatcher* matcher = SymptomMatcher::instance();
+    SymptomMatcher::MatchResult match = matcher->match(item.text);
+    const SymptomMatcher::Category& category = matcher->category(match.bestCategory);
+
+    item.localDepartment = category.department;
+    item.localConfident = match.confident;
+    item.localEmergencyLevel = matcher->emergencyLevel(match);
+    item.localLatencyMs = timer.nsecsElapsed() / 1e6;
+}
+
+void BatchTriageRunner::startAI(int itemIndex)
+{
+    AIApiClient::RequestOptions options;
+    options.priority = AIApiClient::BackgroundPriority;
+    options.timeoutMs = m_options.timeoutMs;
+    options.tier = m_options.tier;
+    // 评估要拿到每条描述的实际回复和耗时；明确指定 --batch-tier=local 时才用本地规则档
+    options.allowLocal = m_options.tier == AIModelRouter::LocalTier;
+    options.useCache = false;
+
+    m_inFlight++;
+    m_client->sendTriageRequest(m_items[itemIndex].text, QString(), this,
+        [this, itemIndex](const AIApiClient::Response& response) {
+            onAIResponse(itemIndex, response);
+        }, options);
+}
+
+void BatchTriageRunner::onAIResponse(int itemIndex, const AIApiClient::Response& response)
+{
+    m_inFlight--;
+
+    // 熔断期间的结果不记录，条目放回队首，等服务恢复后再跑
+    if (response.circuitOpen) {
+        m_queue.prepend(itemIndex);
+        if (!m_paused) {
+            m_paused = true;
+            qint64 waitMs = AICircuitBreaker::instance()->stats().reopenInMs + CIRCUIT_RESUME_MARGIN_MS;
+            qWarning().noquote() << QString("AI服务熔断，%1 秒后继续").arg((waitMs + 999) / 1000);
+            QTimer::singleShot(int(waitMs), this, [this]() {
+                m_paused = false;
+                dispatch();
+            });
+        }
+        return;
+    }
+
+    writeRow(m_items[itemIndex], &response);
+    dispatch();
+}
+
+void BatchTriageRunner::writeRow(const Item& item, const AIApiClient::Response* response)
+{
+    QString status = "skipped";
+    QString aiDepartment;
+    if (response) {
+        status = response->success ? "ok" : response->timedOut ? "timeout" : "failed";
+        aiDepartment = response->result.recommendedDepartment;
+    }
+
+    QStringList fields;
+    fields << item.id
+           << item.text
+           << item.expectedDepartment
+           << item.localDepartment
+           << item.localEmergencyLevel
+           << (item.localConfident ? "1" : "0")
+           << QString::number(item.localLatencyMs, 'f', 3)
+           << status
+           << (response ? AIModelRouter::tierName(response->tier) : QString())
+           << (response ? response->model : QString());
+    if (response && response->success) {
+        fields << aiDepartment
+               << response->result.emergencyLevel
+               << (response->result.needsHumanConsult ? "1" : "0")
+               << QString::number(response->latencyMs)
+               << QString::number(response->attempts)
+               << QString();
+    } else {
+        fields << QString() << QString() << QString()
+               << (response ? QString::number(response->latencyMs) : QString())
+               << (response ? QString::number(response->attempts) : QString())
+               << (response ? response->error : QString());
+    }
+
+    QStringList escaped;
+    for (const QString& field : std::as_const(fields)) {
+        escaped.append(csvField(field));
+    }
+    // 每行立即落盘，进程被中断时最多丢失正在写的一行
+    m_output.write((escaped.join(",") + "\n").toUtf8());
+    m_output.flush();
+
+    m_processed++;
+    if (response && response->success) {
+        m_aiSucceeded++;
+        m_aiLatencies.append(response->latencyMs);
+        if (m_options.mode != AIOnly && aiDepartment == item.localDepartment) {
+            m_agreements++;
+        }
+    } else if (response) {
+        m_aiFailed++;
+    }
+    if (!item.expectedDepartment.isEmpty()) {
+        m_expectedCount++;
+        if (m_options.mode != AIOnly && item.localDepartment == item.expectedDepartment) {
+            m_localCorrect++;
+        }
+        if (response && response->success && aiDepartment == item.expectedDepartment) {
+            m_aiCorrect++;
+        }
+    }
+
+    if (m_processed % PROGRESS_INTERVAL == 0) {
+        qInfo().noquote() << QString("批量分诊进度: %1 / %2").arg(m_processed).arg(m_processed + m_queue.size() + m_inFlight);
+    }
+}
+
+void BatchTriageRunner::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_output.close();
+
+    double wallSecs = qMax<qint64>(1, m_wallTimer.elapsed()) / 1000.0;
+    auto rate = [](int part, int total) {
+        return total > 0 ? QString::number(100.0 * part / total, 'f', 1) + "%" : QString("-");
+    };
+
+    QString summary = QString("批量分诊完成: 本次 %1 条（跳过已有 %2 条），耗时 %3 s，%4 条/s\n")
+                      .arg(m_processed)
+                      .arg(m_skipped)
+                      .arg(wallSecs, 0, 'f', 1)
+                      .arg(m_processed / wallSecs, 0, 'f', 2);
+    if (m_options.mode != LocalOnly) {
+        summary += QString("AI 成功 %1，失败 %2，延迟 p50 %3 ms，p95 %4 ms，与本地科室一致 %5\n")
+                   .arg(m_aiSucceeded)
+                   .arg(m_aiFailed)
+                   .arg(percentile(m_aiLatencies, 50), 0, 'f', 0)
+                   .arg(percentile(m_aiLatencies, 95), 0, 'f', 0)
+                   .arg(rate(m_agreements, m_aiSucceeded));
+    }
+    if (m_expectedCount > 0) {
+        summary += QString("标注 %1 条，本地科室准确率 %2")
+                   .arg(m_expectedCount)
+                   .arg(rate(m_localCorrect, m_expectedCount));
+        if (m_options.mode != LocalOnly) {
+            summary += QString("，AI科室准确率 %1").arg(rate(m_aiCorrect, m_expectedCount));
+        }
+        summary += "\n";
+    }
+    summary += "结果文件: " + m_options.outputPath;
+    qInfo().noquote() << summary;
+
+    emit finished(0);
+}
+
+QStringList BatchTriageRunner::parseCsvLine(const QString& line)
+{
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+    for (int i = 0; i < line.size(); ++i) {
+        QChar ch = line.at(i);
+        if (quoted) {
+            if (ch == '"' && i + 1 < line.size() && line.at(i + 1) == '"') {
+                field.append('"');
+                ++i;
+            } else if (ch == '"') {
+                quoted = false;
+            } else {
+                field.append(ch);
+            }
+        } else if (ch == '"') {
+            quoted = true;
+        } else if (ch == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field.append(ch);
+        }
+    }
+    fields.append(field);
+    return fields;
+}
+
+QString BatchTriageRunner::csvField(QString value)
+{
+    // 每条结果占一行，换行符替换为空格
+    value.replace('\r', ' ').replace('\n', ' ');
+
+    // CSV转义：如果包含逗号或引号，需要用引号包围
+    if (value.contains(',') || value.contains('"')) {
+        value.replace("\"", "\"\"");
+        value = "\"" + value + "\"";
+    }
+    return value;
+}
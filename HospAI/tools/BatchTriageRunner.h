@@ -0,0 +1,102 @@
+#ifndef BATCHTRIAGERUNNER_H
+#define BATCHTRIAGERUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QSet>
+#include <QFile>
+#include <QElapsedTimer>
+#include "src/core/AIApiClient.h"
+
+// 离线批量分诊评估：把历史症状描述逐条交给本地词典分诊和 AIApiClient，
+// 并发数有上限，每条结果（科室、紧急程度、耗时）写成CSV的一行并立即落盘。
+// 结果文件同时作为断点：重新运行时跳过已有结果的条目，中断后可以接着跑
+class BatchTriageRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        LocalAndAI,
+        LocalOnly,
+        AIOnly
+    };
+
+    static const int DEFAULT_PARALLEL = 4;
+    static const int PROGRESS_INTERVAL = 50;   // 每完成这么多条打印一次进度
+
+    struct Options {
+        QString corpusPath;      // 每行一条描述；.csv 或首行含 text 列时按表头读取 id、text、expected_department
+        QString outputPath;      // 默认为 语料文件名.results.csv
+        Mode mode = LocalAndAI;
+        int parallel = DEFAULT_PARALLEL;
+        // 固定AI档位；默认只在快速模型和大模型之间按复杂度路由，本地分诊的结果另有单独的列
+        AIModelRouter::Tier tier = AIModelRouter::AutoTier;
+        int timeoutMs = 0;       // 0 表示用各档位的超时
+        int limit = 0;           // 本次最多处理的新条目数，0 表示不限
+        bool restart = false;    // 忽略已有结果从头开始
+
+        // 识别 --batch-corpus=语料、--batch-output=、--batch-mode=both|local|ai、--batch-parallel=、
+        // --batch-tier=auto|local|fast|large、--batch-timeout=、--batch-limit=、--batch-restart
+        static Options fromArguments(const QStringList& arguments);
+    };
+
+    explicit BatchTriageRunner(const Options& options, QObject *parent = nullptr);
+
+public slots:
+    void start();
+
+signals:
+    // 全部完成或无法继续，参数为进程退出码
+    void finished(int exitCode);
+
+private:
+    struct Item {
+        QString id;
+        QString text;
+        QString expectedDepartment;
+        // 本地分诊结果
+        QString localDepartment;
+        QString localEmergencyLevel;
+        bool localConfident = false;
+        double localLatencyMs = 0.0;
+    };
+
+    bool loadCorpus();
+    bool openOutput();
+    void dispatch();
+    void runLocal(Item& item);
+    void startAI(int itemIndex);
+    void onAIResponse(int itemIndex, const AIApiClient::Response& response);
+    void writeRow(const Item& item, const AIApiClient::Response* response);
+    void finish();
+
+    static QStringList parseCsvLine(const QString& line);
+    static QString csvField(QString value);
+
+    Options m_options;
+    AIApiClient* m_client;
+    QList<Item> m_items;
+    QList<int> m_queue;          // 待处理条目的下标，熔断时未完成的条目放回队首
+    QSet<QString> m_doneIds;     // 结果文件中已有的条目
+    QFile m_output;
+    int m_inFlight;
+    bool m_paused;
+    bool m_finished;
+    QElapsedTimer m_wallTimer;
+
+    // 汇总
+    int m_processed;
+    int m_skipped;
+    int m_aiSucceeded;
+    int m_aiFailed;
+    int m_expectedCount;
+    int m_localCorrect;
+    int m_aiCorrect;
+    int m_agreements;
+    QList<double> m_aiLatencies;
+};
+
+#endif // BATCHTRIAGERUNNER_H
@@ -0,0 +1,431 @@
+#include "MockLlmServer.h"
+#include "src/core/SymptomMatcher.h"
+#include "src/core/ConversationContextBuilder.h"
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QDebug>
+
+static const char* PORT_FLAG = "--mock-port=";
+static const char* LATENCY_FLAG = "--mock-latency=";
+static const char* JITTER_FLAG = "--mock-jitter=";
+static const char* TOKEN_INTERVAL_FLAG = "--mock-token-interval=";
+static const char* CHUNK_CHARS_FLAG = "--mock-chunk-chars=";
+static const char* ERROR_RATE_FLAG = "--mock-error-rate=";
+static const char* DROP_RATE_FLAG = "--mock-drop-rate=";
+static const char* STALL_RATE_FLAG = "--mock-stall-rate=";
+
+// 请求头超过该大小仍不完整时按错误请求处理
+static const int MAX_HEADER_BYTES = 64 * 1024;
+
+MockLlmServer::Options MockLlmServer::Options::fromArguments(const QStringList& arguments)
+{
+    Options options;
+    for (const QString& argument : arguments) {
+        auto valueOf = [&argument](const char* flag) {
+            return argument.mid(qstrlen(flag));
+        };
+
+        if (argument.startsWith(PORT_FLAG)) {
+            options.port = valueOf(PORT_FLAG).toUShort();
+        } else if (argument.startsWith(LATENCY_FLAG)) {
+            options.latencyMs = qMax(0, valueOf(LATENCY_FLAG).toInt());
+        } else if (argument.startsWith(JITTER_FLAG)) {
+            options.jitterMs = qMax(0, valueOf(JITTER_FLAG).toInt());
+        } else if (argument.startsWith(TOKEN_INTERVAL_FLAG)) {
+            options.tokenIntervalMs = qMax(0, valueOf(TOKEN_INTERVAL_FLAG).toInt());
+        } else if (argument.startsWith(CHUNK_CHARS_FLAG)) {
+            options.charsPerChunk = qMax(1, valueOf(CHUNK_CHARS_FLAG).toInt());
+        } else if (argument.startsWith(ERROR_RATE_FLAG)) {
+            options.errorRate = qBound(0.0, valueOf(ERROR_RATE_FLAG).toDouble(), 1.0);
+        } else if (argument.startsWith(DROP_RATE_FLAG)) {
+            options.dropRate = qBound(0.0, valueOf(DROP_RATE_FLAG).toDouble(), 1.0);
+        } else if (argument.startsWith(STALL_RATE_FLAG)) {
+            options.stallRate = qBound(0.0, valueOf(STALL_RATE_FLAG).toDouble(), 1.0);
+        }
+    }
+    return options;
+}
+
+MockLlmServer::MockLlmServer(const Options& options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_server(new QTcpServer(this))
+    , m_nextCompletionId(1)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MockLlmServer::onNewConnection);
+}
+
+bool MockLlmServer::start()
+{
+    if (!m_server->listen(QHostAddress::LocalHost, m_options.port)) {
+        qWarning() << "Mock LLM 服务启动失败:" << m_server->errorString();
+        return false;
+    }
+
+    qInfo().noquote() << QString("Mock LLM 服务已启动: %1 延迟 %2±%3 ms 流式间隔 %4 ms 故障率 500:%5 断开:%6 无响应:%7")
+                         .arg(baseUrl())
+                         .arg(m_options.latencyMs)
+                         .arg(m_options.jitterMs)
+                         .arg(m_options.tokenIntervalMs)
+                         .arg(m_options.errorRate)
+                         .arg(m_options.dropRate)
+                         .arg(m_options.stallRate);
+    return true;
+}
+
+quint16 MockLlmServer::port() const
+{
+    return m_server->serverPort();
+}
+
+QString MockLlmServer::baseUrl() const
+{
+    return QString("http://127.0.0.1:%1/api/v3").arg(port());
+}
+
+MockLlmServer::Stats MockLlmServer::stats() const
+{
+    return m_stats;
+}
+
+void MockLlmServer::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket* socket = m_server->nextPendingConnection();
+        m_connections.insert(socket, Connection());
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockLlmServer::onReadyRead(QTcpSocket* socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+
+    it->buffer += socket->readAll();
+    if (it->busy) {
+        return;
+    }
+
+    HttpRequest request;
+    if (!takeRequest(*it, &request)) {
+        if (it->buffer.size() > MAX_HEADER_BYTES) {
+            it->busy = true;
+            it->closeAfterResponse = true;
+            sendResponse(socket, 400, "text/plain", "bad request");
+            finishResponse(socket);
+        }
+        return;
+    }
+
+    it->busy = true;
+    it->closeAfterResponse = request.headers.value("connection").toLower() == "close";
+    handleRequest(socket, request);
+}
+
+bool MockLlmServer::takeRequest(Connection& connection, HttpRequest* request)
+{
+    int headerEnd = connection.buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return false;
+    }
+
+    const QList<QByteArray> lines = connection.buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    request->method = requestLine.value(0);
+    request->path = requestLine.value(1);
+
+    for (int i = 1; i < lines.size(); ++i) {
+        int colon = lines[i].indexOf(':');
+        if (colon > 0) {
+            request->headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+        }
+    }
+
+    // 请求体按 Content-Length 收齐后才处理
+    int bodyStart = headerEnd + 4;
+    int contentLength = request->headers.value("content-length").toInt();
+    if (connection.buffer.size() < bodyStart + contentLength) {
+        return false;
+    }
+
+    request->body = connection.buffer.mid(bodyStart, contentLength);
+    connection.buffer.remove(0, bodyStart + contentLength);
+    return true;
+}
+
+void MockLlmServer::handleRequest(QTcpSocket* socket, const HttpRequest& request)
+{
+    if (request.method == "GET" && request.path == "/health") {
+        sendResponse(socket, 200, "text/plain", "ok");
+        finishResponse(socket);
+        return;
+    }
+
+    if (request.method != "POST" || !request.path.endsWith("/chat/completions")) {
+        QJsonObject error;
+        error["message"] = "未知接口: " + QString::fromUtf8(request.method + " " + request.path);
+        error["type"] = "invalid_request_error";
+        sendResponse(socket, 404, "application/json", QJsonDocument(QJsonObject{{"error", error}}).toJson(QJsonDocument::Compact));
+        finishResponse(socket);
+        return;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(request.body, &parseError);
+    if (!doc.isObject()) {
+        QJsonObject error;
+        error["message"] = "请求体不是合法的JSON: " + parseError.errorString();
+        error["type"] = "invalid_request_error";
+        sendResponse(socket, 400, "application/json", QJsonDocument(QJsonObject{{"error", error}}).toJson(QJsonDocument::Compact));
+        finishResponse(socket);
+        return;
+    }
+
+    m_stats.requests++;
+
+    // 不响应：连接保持打开，直到客户端超时后自行断开
+    if (roll(m_options.stallRate)) {
+        m_stats.stalls++;
+        qDebug() << "Mock LLM: 注入无响应";
+        return;
+    }
+
+    QJsonObject requestBody = doc.object();
+    QTimer::singleShot(responseDelayMs(), socket, [this, socket, requestBody]() {
+        respond(socket, requestBody);
+    });
+}
+
+void MockLlmServer::respond(QTcpSocket* socket, const QJsonObject& requestBody)
+{
+    if (roll(m_options.errorRate)) {
+        m_stats.errors++;
+        qDebug() << "Mock LLM: 注入HTTP 500";
+
+        QJsonObject error;
+        error["message"] = "模拟的服务端错误";
+        error["type"] = "server_error";
+        sendResponse(socket, 500, "application/json", QJsonDocument(QJsonObject{{"error", error}}).toJson(QJsonDocument::Compact));
+        finishResponse(socket);
+        return;
+    }
+
+    QString id = QString("chatcmpl-mock-%1").arg(m_nextCompletionId++);
+    QString model = requestBody["model"].toString("mock-model");
+    QString content = replyFor(requestBody);
+
+    if (requestBody["stream"].toBool()) {
+        m_stats.streamed++;
+        sendStream(socket, id, model, content);
+        return;
+    }
+
+    if (roll(m_options.dropRate)) {
+        m_stats.drops++;
+        qDebug() << "Mock LLM: 注入连接断开";
+        socket->abort();
+        return;
+    }
+
+    QJsonObject message;
+    message["role"] = "assistant";
+    message["content"] = content;
+
+    QJsonObject choice;
+    choice["index"] = 0;
+    choice["message"] = message;
+    choice["finish_reason"] = "stop";
+
+    // token 数按分诊上下文的同一估算规则给出
+    int promptTokens = 0;
+    const QJsonArray messages = requestBody["messages"].toArray();
+    for (const QJsonValue& value : messages) {
+        promptTokens += ConversationContextBuilder::estimateTokens(value.toObject()["content"].toString());
+    }
+    int completionTokens = ConversationContextBuilder::estimateTokens(content);
+
+    QJsonObject usage;
+    usage["prompt_tokens"] = promptTokens;
+    usage["completion_tokens"] = completionTokens;
+    usage["total_tokens"] = promptTokens + completionTokens;
+
+    QJsonObject completion = completionObject(id, model, choice, false);
+    completion["usage"] = usage;
+    sendResponse(socket, 200, "application/json", QJsonDocument(completion).toJson(QJsonDocument::Compact));
+    finishResponse(socket);
+}
+
+void MockLlmServer::sendResponse(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& body)
+{
+    QByteArray reason = status == 200 ? "OK"
+                      : status == 400 ? "Bad Request"
+                      : status == 404 ? "Not Found"
+                      : "Internal Server Error";
+    bool close = m_connections.value(socket).closeAfterResponse;
+
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n"
+                        + "Content-Type: " + contentType + "; charset=utf-8\r\n"
+                        + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                        + "Connection: " + (close ? "close" : "keep-alive") + "\r\n\r\n"
+                        + body;
+    socket->write(response);
+}
+
+void MockLlmServer::sendStream(QTcpSocket* socket, const QString& id, const QString& model, const QString& content)
+{
+    bool close = m_connections.value(socket).closeAfterResponse;
+    socket->write(QByteArray("HTTP/1.1 200 OK\r\n")
+                  + "Content-Type: text/event-stream; charset=utf-8\r\n"
+                  + "Cache-Control: no-cache\r\n"
+                  + "Transfer-Encoding: chunked\r\n"
+                  + "Connection: " + (close ? "close" : "keep-alive") + "\r\n\r\n");
+
+    QStringList pieces;
+    for (int i = 0; i < content.size(); i += m_options.charsPerChunk) {
+        pieces.append(content.mid(i, m_options.charsPerChunk));
+    }
+    // 断开注入发生在输出一半时，客户端已经收到部分文本
+    int dropAt = roll(m_options.dropRate) ? pieces.size() / 2 : -1;
+
+    auto sseEvent = [this, id, model](const QJsonObject& payload) {
+        return "data: " + QJsonDocument(completionObject(id, model, payload, true)).toJson(QJsonDocument::Compact) + "\n\n";
+    };
+
+    QJsonObject roleDelta;
+    roleDelta["role"] = "assistant";
+    roleDelta["content"] = "";
+    writeChunk(socket, sseEvent(QJsonObject{{"index", 0}, {"delta", roleDelta}, {"finish_reason", QJsonValue::Null}}));
+
+    // 定时器挂在连接上，连接断开销毁时一并停止
+    QTimer* timer = new QTimer(socket);
+    timer->setInterval(m_options.tokenIntervalMs);
+    connect(timer, &QTimer::timeout, socket, [this, socket, timer, pieces, dropAt, sseEvent, index = 0]() mutable {
+        if (index == dropAt) {
+            m_stats.drops++;
+            qDebug() << "Mock LLM: 注入流式中途断开";
+            timer->stop();
+            socket->abort();
+            return;
+        }
+
+        if (index < pieces.size()) {
+            QJsonObject delta;
+            delta["content"] = pieces[index++];
+            writeChunk(socket, sseEvent(QJsonObject{{"index", 0}, {"delta", delta}, {"finish_reason", QJsonValue::Null}}));
+            return;
+        }
+
+        timer->stop();
+        timer->deleteLater();
+        writeChunk(socket, sseEvent(QJsonObject{{"index", 0}, {"delta", QJsonObject()}, {"finish_reason", "stop"}}));
+        writeChunk(socket, "data: [DONE]\n\n");
+        socket->write("0\r\n\r\n");
+        finishResponse(socket);
+    });
+    timer->start();
+}
+
+void MockLlmServer::writeChunk(QTcpSocket* socket, const QByteArray& data)
+{
+    socket->write(QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n");
+}
+
+void MockLlmServer::finishResponse(QTcpSocket* socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+
+    it->busy = false;
+    if (it->closeAfterResponse) {
+        socket->disconnectFromHost();
+        return;
+    }
+
+    // 客户端已经发来下一个请求时接着处理
+    if (!it->buffer.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this, socket]() {
+            onReadyRead(socket);
+        }, Qt::QueuedConnection);
+    }
+}
+
+int MockLlmServer::responseDelayMs() const
+{
+    int jitter = 0;
+    if (m_options.jitterMs > 0) {
+        jitter = QRandomGenerator::global()->bounded(2 * m_options.jitterMs + 1) - m_options.jitterMs;
+    }
+    return qMax(0, m_options.latencyMs + jitter);
+}
+
+bool MockLlmServer::roll(double rate) const
+{
+    return rate > 0.0 && QRandomGenerator::global()->generateDouble() < rate;
+}
+
+QString MockLlmServer::replyFor(const QJsonObject& requestBody) const
+{
+    // 取最后一条用户消息，用分诊词典决定回复里的科室和紧急程度
+    QString userText;
+    const QJsonArray messages = requestBody["messages"].toArray();
+    for (const QJsonValue& value : messages) {
+        QJsonObject message = value.toObject();
+        if (message["role"].toString() == "user") {
+            userText = message["content"].toString();
+        }
+    }
+
+    SymptomMatcher* matcher = SymptomMatcher::instance();
+    SymptomMatcher::MatchResult match = matcher->match(userText);
+    if (match.emergency) {
+        return "您描述的情况可能比较危急，请立即就医，建议马上前往急诊科，必要时拨打120急救电话。"
+               "在等待期间请保持平躺、不要独自行动。紧急程度：critical。（本回复由本地模拟服务生成）";
+    }
+
+    QStringList terms;
+    for (const SymptomMatcher::TermMatch& termMatch : match.matches) {
+        QString term = matcher->termText(termMatch.term);
+        if (!terms.contains(term)) {
+            terms.append(term);
+        }
+    }
+
+    QString department = matcher->category(match.bestCategory).department;
+    if (department.isEmpty()) {
+        department = "内科";
+    }
+
+    QString symptoms = terms.isEmpty() ? QString() : "，您提到了" + terms.join("、");
+    return QString("您好，我已经了解您的情况%1。初步分析：这类症状比较常见，但仍需要医生面诊确认。"
+                   "建议您到%2就诊，紧急程度：一般。就诊前请注意休息、多喝温水，记录症状的变化；"
+                   "如果症状明显加重，请尽快就医。（本回复由本地模拟服务生成）")
+           .arg(symptoms, department);
+}
+
+QJsonObject MockLlmServer::completionObject(const QString& id, const QString& model,
+                                            const QJsonObject& payload, bool chunk) const
+{
+    QJsonObject completion;
+    completion["id"] = id;
+    completion["object"] = chunk ? "chat.completion.chunk" : "chat.completion";
+    completion["created"] = QDateTime::currentSecsSinceEpoch();
+    completion["model"] = model;
+    completion["choices"] = QJsonArray{payload};
+    return completion;
+}
@@ -0,0 +1,90 @@
+#ifndef MOCKLLMSERVER_H
+#define MOCKLLMSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QStringList>
+
+// 本地模拟的大模型服务：实现 /chat/completions 的请求和响应格式（普通JSON和SSE流式），
+// 可配置响应延迟、逐段输出的间隔和故障注入（HTTP 500、中途断开、不响应），
+// 用于离线开发和分诊链路的压测，不需要真实的API Key。
+// 只监听本机回环地址，HTTP/1.1 明文，支持 keep-alive
+class MockLlmServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const quint16 DEFAULT_PORT = 8089;
+
+    struct Options {
+        quint16 port = 0;            // 0 时由系统分配
+        int latencyMs = 300;         // 收到请求到返回首个字节
+        int jitterMs = 100;          // 延迟在 ±jitter 内随机浮动
+        int tokenIntervalMs = 30;    // 流式输出两段之间的间隔
+        int charsPerChunk = 4;       // 流式每段的字数
+        double errorRate = 0.0;      // 返回 HTTP 500 的比例
+        double dropRate = 0.0;       // 返回途中断开连接的比例
+        double stallRate = 0.0;      // 收下请求后不再响应的比例，用于触发客户端超时
+
+        // 识别 --mock-port=、--mock-latency=、--mock-jitter=、--mock-token-interval=、--mock-chunk-chars=、
+        // --mock-error-rate=、--mock-drop-rate=、--mock-stall-rate=
+        static Options fromArguments(const QStringList& arguments);
+    };
+
+    struct Stats {
+        int requests = 0;
+        int streamed = 0;
+        int errors = 0;
+        int drops = 0;
+        int stalls = 0;
+    };
+
+    explicit MockLlmServer(const Options& options, QObject *parent = nullptr);
+
+    bool start();
+    quint16 port() const;
+    // 供 AIApiClient::setApiConfig 使用的地址
+    QString baseUrl() const;
+    Stats stats() const;
+
+private:
+    struct HttpRequest {
+        QByteArray method;
+        QByteArray path;
+        QHash<QByteArray, QByteArray> headers;   // 名称小写
+        QByteArray body;
+    };
+
+    // 每条连接的状态；一条连接上同一时间只处理一个请求
+    struct Connection {
+        QByteArray buffer;
+        bool busy = false;
+        bool closeAfterResponse = false;
+    };
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    bool takeRequest(Connection& connection, HttpRequest* request);
+    void handleRequest(QTcpSocket* socket, const HttpRequest& request);
+    void respond(QTcpSocket* socket, const QJsonObject& requestBody);
+    void sendResponse(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& body);
+    void sendStream(QTcpSocket* socket, const QString& id, const QString& model, const QString& content);
+    void writeChunk(QTcpSocket* socket, const QByteArray& data);
+    void finishResponse(QTcpSocket* socket);
+    int responseDelayMs() const;
+    bool roll(double rate) const;
+    QString replyFor(const QJsonObject& requestBody) const;
+    QJsonObject completionObject(const QString& id, const QString& model, const QJsonObject& payload, bool chunk) const;
+
+    Options m_options;
+    QTcpServer* m_server;
+    QHash<QTcpSocket*, Connection> m_connections;
+    quint64 m_nextCompletionId;
+    Stats m_stats;
+};
+
+#endif // MOCKLLMSERVER_H
@@ -0,0 +1,443 @@
+#include "TriageBenchmark.h"
+#include "src/core/SymptomMatcher.h"
+#include "src/core/AIModelRouter.h"
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+
+static const char* SESSIONS_FLAG = "--bench-sessions=";
+static const char* TURNS_FLAG = "--bench-turns=";
+static const char* FLOW_FLAG = "--bench-flow=";
+static const char* NO_STREAM_FLAG = "--bench-no-stream";
+static const char* SHARED_CLIENT_FLAG = "--bench-shared-client";
+static const char* HEDGE_FLAG = "--bench-hedge";
+static const char* TIER_FLAG = "--bench-tier=";
+static const char* TIMEOUT_FLAG = "--bench-timeout=";
+static const char* THINK_TIME_FLAG = "--bench-think-time=";
+static const char* MAX_P95_FLAG = "--bench-max-p95=";
+static const char* INPUT_FLAG = "--bench-input=";
+static const char* REPORT_FLAG = "--bench-report=";
+
+// 内置提问样例：既有词典能直接回答的，也有需要AI判断的含糊描述和疑似急症
+static const QStringList BUILTIN_INPUTS = {
+    "我发烧两天了，体温38.5度",
+    "最近总觉得浑身没劲，吃饭也没胃口",
+    "头疼，晚上也睡不好",
+    "发烧还咳嗽，嗓子也疼",
+    "肚子疼还拉肚子，吃了东西就想吐",
+    "皮肤起了很多红疹子，特别痒",
+    "有点胸闷，走路快了就喘",
+    "腰疼两周了，弯腰的时候更明显",
+    "孩子三岁，晚上老是哭闹不肯睡",
+    "眼睛干涩，看东西有点模糊",
+    "我想挂号",
+    "血压160/100，还有点头晕"
+};
+
+TriageBenchmark::Options TriageBenchmark::Options::fromArguments(const QStringList& arguments)
+{
+    Options options;
+    options.mock = MockLlmServer::Options::fromArguments(arguments);
+
+    for (const QString& argument : arguments) {
+        auto valueOf = [&argument](const char* flag) {
+            return argument.mid(qstrlen(flag));
+        };
+
+        if (argument.startsWith(SESSIONS_FLAG)) {
+            options.sessions = qMax(1, valueOf(SESSIONS_FLAG).toInt());
+        } else if (argument.startsWith(TURNS_FLAG)) {
+            options.turns = qMax(1, valueOf(TURNS_FLAG).toInt());
+        } else if (argument.startsWith(FLOW_FLAG)) {
+            options.flow = valueOf(FLOW_FLAG) == "client" ? ClientFlow : ChatFlow;
+        } else if (argument == NO_STREAM_FLAG) {
+            options.stream = false;
+        } else if (argument == SHARED_CLIENT_FLAG) {
+            options.sharedClient = true;
+        } else if (argument == HEDGE_FLAG) {
+            options.hedge = true;
+        } else if (argument.startsWith(TIER_FLAG)) {
+            options.tier = AIModelRouter::tierFromName(valueOf(TIER_FLAG));
+        } else if (argument.startsWith(TIMEOUT_FLAG)) {
+            options.timeoutMs = qMax(1, valueOf(TIMEOUT_FLAG).toInt());
+        } else if (argument.startsWith(THINK_TIME_FLAG)) {
+            options.thinkTimeMs = qMax(0, valueOf(THINK_TIME_FLAG).toInt());
+        } else if (argument.startsWith(MAX_P95_FLAG)) {
+            options.maxP95Ms = valueOf(MAX_P95_FLAG).toLongLong();
+        } else if (argument.startsWith(INPUT_FLAG)) {
+            options.inputPath = valueOf(INPUT_FLAG);
+        } else if (argument.startsWith(REPORT_FLAG)) {
+            options.reportPath = valueOf(REPORT_FLAG);
+        }
+    }
+    return options;
+}
+
+TriageBenchmark::TriageBenchmark(const Options& options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_server(nullptr)
+    , m_finishedSessions(0)
+    , m_finished(false)
+    , m_aiRequests(0)
+    , m_failures(0)
+    , m_timeouts(0)
+    , m_transfers(0)
+    , m_reusedConnections(0)
+    , m_retried(0)
+    , m_hedged(0)
+    , m_hedgeWins(0)
+    , m_circuitOpen(0)
+    , m_tierRequests(AIModelRouter::TIER_COUNT)
+{
+}
+
+TriageBenchmark::~TriageBenchmark()
+{
+    qDeleteAll(m_sessions);
+}
+
+void TriageBenchmark::start()
+{
+    m_inputs = BUILTIN_INPUTS;
+    if (!m_options.inputPath.isEmpty()) {
+        QFile file(m_options.inputPath);
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QStringList inputs;
+            QTextStream stream(&file);
+            while (!stream.atEnd()) {
+                QString line = stream.readLine().trimmed();
+                if (!line.isEmpty()) {
+                    inputs.append(line);
+                }
+            }
+            if (!inputs.isEmpty()) {
+                m_inputs = inputs;
+            }
+        } else {
+            qWarning() << "无法读取压测输入文件，使用内置样例:" << m_options.inputPath;
+        }
+    }
+
+    // 指定了真实服务地址时直接压测该服务，否则在进程内启动模拟服务
+    bool useMock = qEnvironmentVariableIsEmpty("HOSPAI_AI_BASE_URL");
+    if (useMock) {
+        m_server = new MockLlmServer(m_options.mock, this);
+        if (!m_server->start()) {
+            emit finished(1);
+            return;
+        }
+        m_baseUrl = m_server->baseUrl();
+    }
+
+    // 每个会话对应一个聊天窗口，各自持有客户端；共用时所有请求在同一个队列里排队
+    int clientCount = m_options.sharedClient ? 1 : m_options.sessions;
+    for (int i = 0; i < clientCount; ++i) {
+        AIApiClient* client = new AIApiClient(this);
+        if (useMock) {
+            client->setApiConfig(m_baseUrl, "mock-key", "mock-model");
+        }
+        connect(client, &AIApiClient::firstTokenReceived, this, [this, client](quint64 requestId, qint64) {
+            onFirstToken(client, requestId);
+        });
+        client->warmUp();
+        m_clients.append(client);
+    }
+
+    for (int i = 0; i < m_options.sessions; ++i) {
+        Session* session = new Session;
+        session->index = i;
+        session->client = m_clients.value(m_options.sharedClient ? 0 : i);
+        m_sessions.append(session);
+    }
+
+    qInfo().noquote() << QString("分诊压测开始: %1 个会话 x %2 轮，%3流程，%4")
+                         .arg(m_options.sessions)
+                         .arg(m_options.turns)
+                         .arg(m_options.flow == ChatFlow ? "chat" : "client")
+                         .arg(m_options.stream ? "流式" : "非流式");
+
+    m_wallTimer.start();
+    for (Session* session : std::as_const(m_sessions)) {
+        nextTurn(session);
+    }
+}
+
+void TriageBenchmark::nextTurn(Session* session)
+{
+    if (session->turn >= m_options.turns) {
+        if (++m_finishedSessions == m_sessions.size()) {
+            finish();
+        }
+        return;
+    }
+
+    // 各会话从样例的不同位置开始，同一时刻发出的提问不同
+    QString text = m_inputs[(session->index * 3 + session->turn) % m_inputs.size()];
+    session->turnTimer.start();
+
+    QString history;
+    if (m_options.flow == ChatFlow) {
+        session->context.addTurn(ConversationContextBuilder::Patient, text);
+
+        // 转人工和明确的症状不请求AI，判断与聊天窗口共用
+        AIModelRouter::ChatStep step = AIModelRouter::classifyChatInput(text);
+        if (step.action == AIModelRouter::TransferChat) {
+            m_transfers++;
+            m_localLatencies.append(session->turnTimer.nsecsElapsed() / 1e6);
+            scheduleNextTurn(session);
+            return;
+        }
+        if (step.action == AIModelRouter::AnswerLocally) {
+            const SymptomMatcher::Category& category = SymptomMatcher::instance()->category(step.match.bestCategory);
+            session->context.addTurn(ConversationContextBuilder::Assistant, category.response);
+            m_localLatencies.append(session->turnTimer.nsecsElapsed() / 1e6);
+            scheduleNextTurn(session);
+            return;
+        }
+
+        history = session->context.build(1);
+    }
+
+    AIApiClient::RequestOptions options;
+    options.stream = m_options.stream;
+    options.timeoutMs = m_options.timeoutMs;
+    options.hedge = m_options.hedge;
+    options.tier = m_options.tier;
+    // 压测测的是网络链路，不走回复缓存
+    options.useCache = false;
+
+    session->requestId = session->client->sendTriageRequest(text, history, this,
+        [this, session](const AIApiClient::Response& response) {
+            onResponse(session, response);
+        }, options);
+}
+
+void TriageBenchmark::scheduleNextTurn(Session* session)
+{
+    session->turn++;
+    QTimer::singleShot(m_options.thinkTimeMs, this, [this, session]() {
+        nextTurn(session);
+    });
+}
+
+void TriageBenchmark::onResponse(Session* session, const AIApiClient::Response& response)
+{
+    session->requestId = 0;
+    m_aiRequests++;
+    if (response.attempts > 1) {
+        m_retried++;
+    }
+    if (response.hedged) {
+        m_hedged++;
+    }
+    if (response.hedgeWon) {
+        m_hedgeWins++;
+    }
+    if (response.circuitOpen) {
+        m_circuitOpen++;
+    }
+    if (!response.cancelled) {
+        m_tierRequests[response.tier]++;
+    }
+
+    if (response.success) {
+        m_aiLatencies.append(session->turnTimer.nsecsElapsed() / 1e6);
+        if (response.connectionReused) {
+            m_reusedConnections++;
+        }
+        if (m_options.flow == ChatFlow) {
+            session->context.addTurn(ConversationContextBuilder::Assistant, response.result.aiResponse);
+        }
+    } else {
+        m_failures++;
+        if (response.timedOut) {
+            m_timeouts++;
+        }
+    }
+
+    scheduleNextTurn(session);
+}
+
+void TriageBenchmark::onFirstToken(AIApiClient* client, quint64 requestId)
+{
+    // 首token时间从患者发出提问算起，包含本地处理和排队
+    for (Session* session : std::as_const(m_sessions)) {
+        if (session->client == client && session->requestId == requestId) {
+            m_firstTokenLatencies.append(session->turnTimer.nsecsElapsed() / 1e6);
+            return;
+        }
+    }
+}
+
+double TriageBenchmark::percentile(QList<double> samples, double p)
+{
+    if (samples.isEmpty()) {
+        return -1.0;
+    }
+
+    // 最近秩法
+    std::sort(samples.begin(), samples.end());
+    int rank = qCeil(p / 100.0 * samples.size());
+    return samples[qBound(0, rank - 1, int(samples.size()) - 1)];
+}
+
+QString TriageBenchmark::reportTable(qint64 wallMs) const
+{
+    auto latencyRow = [](const QString& name, const QList<double>& samples) {
+        auto cell = [](double value) {
+            return value < 0 ? QString("-") : QString::number(value, 'f', 1);
+        };
+        double maxValue = samples.isEmpty() ? -1.0 : *std::max_element(samples.begin(), samples.end());
+        return QString("%1  %2  %3  %4  %5  %6\n")
+               .arg(name, -16)
+               .arg(samples.size(), 8)
+               .arg(cell(percentile(samples, 50)), 10)
+               .arg(cell(percentile(samples, 95)), 10)
+               .arg(cell(percentile(samples, 99)), 10)
+               .arg(cell(maxValue), 10);
+    };
+
+    double wallSecs = qMax<qint64>(1, wallMs) / 1000.0;
+    int totalTurns = m_aiRequests + m_localLatencies.size();
+
+    QString table = QString("%1  %2  %3  %4  %5  %6\n")
+                    .arg("延迟(ms)", -16)
+                    .arg("样本", 8)
+                    .arg("p50", 10)
+                    .arg("p95", 10)
+                    .arg("p99", 10)
+                    .arg("max", 10);
+    table += latencyRow("AI请求", m_aiLatencies);
+    table += latencyRow("首token", m_firstTokenLatencies);
+    table += latencyRow("本地回复", m_localLatencies);
+
+    table += QString("\n总轮数 %1（本地回复 %2，其中转人工 %3；AI请求 %4，失败 %5，超时 %6）\n")
+             .arg(totalTurns)
+             .arg(m_localLatencies.size())
+             .arg(m_transfers)
+             .arg(m_aiRequests)
+             .arg(m_failures)
+             .arg(m_timeouts);
+    table += QString("总耗时 %1 s，吞吐量 %2 轮/s，AI %3 请求/s，复用连接 %4/%5\n")
+             .arg(wallSecs, 0, 'f', 2)
+             .arg(totalTurns / wallSecs, 0, 'f', 2)
+             .arg(m_aiRequests / wallSecs, 0, 'f', 2)
+             .arg(m_reusedConnections)
+             .arg(m_aiLatencies.size());
+    table += QString("重试 %1，对冲 %2（胜出 %3），熔断直接失败 %4\n")
+             .arg(m_retried)
+             .arg(m_hedged)
+             .arg(m_hedgeWins)
+             .arg(m_circuitOpen);
+    table += QString("AI请求档位: %1 %2，%3 %4，%5 %6\n")
+             .arg(AIModelRouter::tierLabel(AIModelRouter::LocalTier))
+             .arg(m_tierRequests[AIModelRouter::LocalTier])
+             .arg(AIModelRouter::tierLabel(AIModelRouter::FastTier))
+             .arg(m_tierRequests[AIModelRouter::FastTier])
+             .arg(AIModelRouter::tierLabel(AIModelRouter::LargeTier))
+             .arg(m_tierRequests[AIModelRouter::LargeTier]);
+
+    if (m_server) {
+        MockLlmServer::Stats stats = m_server->stats();
+        table += QString("模拟服务: 请求 %1，流式 %2，注入 500:%3 断开:%4 无响应:%5\n")
+                 .arg(stats.requests)
+                 .arg(stats.streamed)
+                 .arg(stats.errors)
+                 .arg(stats.drops)
+                 .arg(stats.stalls);
+    }
+    return table;
+}
+
+bool TriageBenchmark::writeReport(const QString& path, qint64 wallMs) const
+{
+    auto latencyObject = [](const QList<double>& samples) {
+        QJsonObject object;
+        object["count"] = samples.size();
+        object["p50"] = percentile(samples, 50);
+        object["p95"] = percentile(samples, 95);
+        object["p99"] = percentile(samples, 99);
+        object["max"] = samples.isEmpty() ? -1.0 : *std::max_element(samples.begin(), samples.end());
+        return object;
+    };
+
+    double wallSecs = qMax<qint64>(1, wallMs) / 1000.0;
+    int totalTurns = m_aiRequests + m_localLatencies.size();
+
+    QJsonObject root;
+    root["sessions"] = m_options.sessions;
+    root["turns"] = m_options.turns;
+    root["flow"] = m_options.flow == ChatFlow ? "chat" : "client";
+    root["stream"] = m_options.stream;
+    root["sharedClient"] = m_options.sharedClient;
+    root["hedge"] = m_options.hedge;
+    root["mockServer"] = m_server != nullptr;
+    root["wallMs"] = wallMs;
+    root["totalTurns"] = totalTurns;
+    root["aiRequests"] = m_aiRequests;
+    root["failures"] = m_failures;
+    root["timeouts"] = m_timeouts;
+    root["transfers"] = m_transfers;
+    root["reusedConnections"] = m_reusedConnections;
+    root["retried"] = m_retried;
+    root["hedged"] = m_hedged;
+    root["hedgeWins"] = m_hedgeWins;
+    root["circuitOpen"] = m_circuitOpen;
+    QJsonObject tiers;
+    for (int tier = AIModelRouter::LocalTier; tier < AIModelRouter::TIER_COUNT; ++tier) {
+        tiers[AIModelRouter::tierName(AIModelRouter::Tier(tier))] = m_tierRequests[tier];
+    }
+    root["tierRequests"] = tiers;
+    root["turnsPerSecond"] = totalTurns / wallSecs;
+    root["aiRequestsPerSecond"] = m_aiRequests / wallSecs;
+    root["aiLatencyMs"] = latencyObject(m_aiLatencies);
+    root["firstTokenMs"] = latencyObject(m_firstTokenLatencies);
+    root["localLatencyMs"] = latencyObject(m_localLatencies);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入压测报告:" << path << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+void TriageBenchmark::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+
+    qint64 wallMs = m_wallTimer.elapsed();
+    qInfo().noquote() << "\n" + reportTable(wallMs);
+
+    int exitCode = 0;
+    if (m_aiRequests > 0 && m_aiLatencies.isEmpty()) {
+        qWarning() << "所有AI请求均失败";
+        exitCode = 1;
+    }
+
+    double p95 = percentile(m_aiLatencies, 95);
+    if (exitCode == 0 && m_options.maxP95Ms > 0 && p95 > m_options.maxP95Ms) {
+        qWarning().noquote() << QString("AI请求 p95 %1 ms 超出预算 %2 ms").arg(p95, 0, 'f', 1).arg(m_options.maxP95Ms);
+        exitCode = 2;
+    }
+
+    if (!m_options.reportPath.isEmpty()) {
+        if (writeReport(m_options.reportPath, wallMs)) {
+            qInfo().noquote() << "压测报告已写入:" << m_options.reportPath;
+        } else if (exitCode == 0) {
+            exitCode = 3;
+        }
+    }
+
+    emit finished(exitCode);
+}
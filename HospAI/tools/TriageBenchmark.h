@@ -0,0 +1,104 @@
+#ifndef TRIAGEBENCHMARK_H
+#define TRIAGEBENCHMARK_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QElapsedTimer>
+#include "src/core/AIApiClient.h"
+#include "MockLlmServer.h"
+#include "src/core/ConversationContextBuilder.h"
+
+// 分诊链路压测：N 个会话并发，每个会话按顺序发送若干轮患者提问。
+// chat 流程与 ChatWidget::onSendMessage 一致（词典匹配、本地回复、上下文拼装、流式AI请求），
+// 只是不创建界面；client 流程每轮都直接请求AI。
+// 未设置 HOSPAI_AI_BASE_URL 时在进程内启动 MockLlmServer，结束后输出延迟分位数和吞吐量
+class TriageBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Flow {
+        ChatFlow,
+        ClientFlow
+    };
+
+    struct Options {
+        int sessions = 8;
+        int turns = 5;               // 每个会话的提问轮数
+        Flow flow = ChatFlow;
+        bool stream = true;
+        bool sharedClient = false;   // 所有会话共用一个 AIApiClient，用于观察排队
+        bool hedge = false;          // AI请求开启对冲
+        AIModelRouter::Tier tier = AIModelRouter::AutoTier;   // 固定档位，默认按复杂度路由
+        int timeoutMs = 0;           // 0 表示用各档位的超时
+        int thinkTimeMs = 0;         // 两轮提问之间的间隔
+        qint64 maxP95Ms = 0;         // AI请求 p95 预算，0 表示不检查
+        QString inputPath;           // 提问文本，每行一条；为空时使用内置样例
+        QString reportPath;          // 结果另存为JSON
+        MockLlmServer::Options mock;
+
+        // 识别 --bench-sessions=、--bench-turns=、--bench-flow=chat|client、--bench-no-stream、
+        // --bench-shared-client、--bench-hedge、--bench-tier=auto|local|fast|large、--bench-timeout=、--bench-think-time=、--bench-max-p95=、
+        // --bench-input=、--bench-report=，以及 MockLlmServer 的 --mock-* 参数
+        static Options fromArguments(const QStringList& arguments);
+    };
+
+    explicit TriageBenchmark(const Options& options, QObject *parent = nullptr);
+    ~TriageBenchmark();
+
+public slots:
+    void start();
+
+signals:
+    // 压测结束，参数为进程退出码
+    void finished(int exitCode);
+
+private:
+    struct Session {
+        int index = 0;
+        int turn = 0;
+        AIApiClient* client = nullptr;
+        ConversationContextBuilder context;
+        QElapsedTimer turnTimer;
+        quint64 requestId = 0;
+    };
+
+    void nextTurn(Session* session);
+    void scheduleNextTurn(Session* session);
+    void onResponse(Session* session, const AIApiClient::Response& response);
+    void onFirstToken(AIApiClient* client, quint64 requestId);
+    void finish();
+    QString reportTable(qint64 wallMs) const;
+    bool writeReport(const QString& path, qint64 wallMs) const;
+    static double percentile(QList<double> samples, double p);
+
+    Options m_options;
+    MockLlmServer* m_server;
+    QList<AIApiClient*> m_clients;
+    QList<Session*> m_sessions;
+    QStringList m_inputs;
+    QString m_baseUrl;
+    QElapsedTimer m_wallTimer;
+    int m_finishedSessions;
+    bool m_finished;
+
+    // 结果，延迟单位毫秒
+    QList<double> m_aiLatencies;
+    QList<double> m_firstTokenLatencies;
+    QList<double> m_localLatencies;
+    int m_aiRequests;
+    int m_failures;
+    int m_timeouts;
+    int m_transfers;
+    int m_reusedConnections;
+    int m_retried;           // 经过重试的请求
+    int m_hedged;
+    int m_hedgeWins;
+    int m_circuitOpen;       // 熔断中直接失败的请求
+    QVector<int> m_tierRequests;   // 按实际档位计数
+};
+
+#endif // TRIAGEBENCHMARK_H
@@ -0,0 +1,17 @@
+#include "BatchTriageRunner.h"
+#include <QCoreApplication>
+#include <QTimer>
+
+// 离线批量分诊评估，不显示界面也不打开数据库，不随 HospAI 发布
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("HospAI");
+    app.setOrganizationName("HospAI Team");
+    app.setOrganizationDomain("hospai.com");
+
+    BatchTriageRunner runner(BatchTriageRunner::Options::fromArguments(app.arguments()));
+    QObject::connect(&runner, &BatchTriageRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+    QTimer::singleShot(0, &runner, &BatchTriageRunner::start);
+    return app.exec();
+}
@@ -0,0 +1,22 @@
+#include "MockLlmServer.h"
+#include <QCoreApplication>
+
+// 开发工具：本地模拟大模型服务，供离线开发和压测使用，不随 HospAI 发布
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("HospAI");
+    app.setOrganizationName("HospAI Team");
+    app.setOrganizationDomain("hospai.com");
+
+    MockLlmServer::Options options = MockLlmServer::Options::fromArguments(app.arguments());
+    if (options.port == 0) {
+        options.port = MockLlmServer::DEFAULT_PORT;
+    }
+
+    MockLlmServer server(options);
+    if (!server.start()) {
+        return 1;
+    }
+    return app.exec();
+}
@@ -0,0 +1,17 @@
+#include "TriageBenchmark.h"
+#include <QCoreApplication>
+#include <QTimer>
+
+// 开发工具：分诊链路压测，未设置 HOSPAI_AI_BASE_URL 时在进程内启动模拟服务，不随 HospAI 发布
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("HospAI");
+    app.setOrganizationName("HospAI Team");
+    app.setOrganizationDomain("hospai.com");
+
+    TriageBenchmark benchmark(TriageBenchmark::Options::fromArguments(app.arguments()));
+    QObject::connect(&benchmark, &TriageBenchmark::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+    QTimer::singleShot(0, &benchmark, &TriageBenchmark::start);
+    return app.exec();
+}